@@ -49,6 +49,12 @@ endif
 include common_features.mk
 include $(TMK_PATH)/common.mk
 include $(QUANTUM_PATH)/serial_link/tests/rules.mk
+include $(QUANTUM_PATH)/tests/rules.mk
+include $(TMK_PATH)/protocol/midi/tests/rules.mk
+include $(TMK_PATH)/common/tests/rules.mk
+include $(TMK_PATH)/protocol/usb_hid/tests/rules.mk
+include $(TMK_PATH)/protocol/tests/rules.mk
+include $(DRIVER_PATH)/tests/rules.mk
 ifneq ($(filter $(FULL_TESTS),$(TEST)),)
 include build_full_test.mk
 endif
@@ -118,8 +118,11 @@ ifeq ($(strip $(RGB_MATRIX_ENABLE)), yes)
     OPT_DEFS += -DRGB_MATRIX_ENABLE
     SRC += is31fl3731.c
     SRC += i2c_master.c
+    SRC += i2c_queue.c
     SRC += $(QUANTUM_DIR)/color.c
     SRC += $(QUANTUM_DIR)/rgb_matrix.c
+    SRC += $(QUANTUM_DIR)/rgb_matrix_program.c
+    SRC += $(QUANTUM_DIR)/rgb_matrix_power.c
     CIE1931_CURVE = yes
 endif
 
@@ -203,10 +206,21 @@ ifeq ($(strip $(HD44780_ENABLE)), yes)
 	OPT_DEFS += -DHD44780_ENABLE
 endif
 
+ifeq ($(strip $(TOPRE_MATRIX_ENABLE)), yes)
+    SRC += topre_matrix.c
+    OPT_DEFS += -DTOPRE_MATRIX_ENABLE
+endif
+
+ifeq ($(strip $(STROBE_MATRIX_ENABLE)), yes)
+    SRC += strobe_matrix.c
+    OPT_DEFS += -DSTROBE_MATRIX_ENABLE
+endif
+
 QUANTUM_SRC:= \
     $(QUANTUM_DIR)/quantum.c \
     $(QUANTUM_DIR)/keymap_common.c \
     $(QUANTUM_DIR)/keycode_config.c \
+    $(QUANTUM_DIR)/deadline.c \
     $(QUANTUM_DIR)/process_keycode/process_leader.c
 
 ifndef CUSTOM_MATRIX
@@ -219,8 +233,10 @@ endif
 
 ifeq ($(strip $(SPLIT_KEYBOARD)), yes)
     OPT_DEFS += -DSPLIT_KEYBOARD
-    QUANTUM_SRC += $(QUANTUM_DIR)/split_common/split_flags.c \
-                $(QUANTUM_DIR)/split_common/split_util.c \
+    QUANTUM_SRC += $(QUANTUM_DIR)/split_common/split_util.c \
+                $(QUANTUM_DIR)/split_common/split_state.c \
                 $(QUANTUM_DIR)/split_common/i2c.c \
-                $(QUANTUM_DIR)/split_common/serial.c  
+                $(QUANTUM_DIR)/split_common/serial.c \
+                $(QUANTUM_DIR)/split_common/serial_usart.c \
+                $(QUANTUM_DIR)/serial_link/protocol/matrix_sync.c
 endif
@@ -0,0 +1,275 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/* I2C master backend for ChibiOS
+ *
+ * The ChibiOS I2C driver transfers with DMA, but blocks the calling thread,
+ * so the queued transactions run on their own thread. The driver can write
+ * and then read in one transfer, with a repeated start in between. Segments
+ * in the same direction are gathered into a buffer, unless there is only one,
+ * and other sequences are split into several transfers.
+ *
+ * The pins and I2C_DRIVER_CONFIG are specific to the MCU, so the keyboard
+ * sets them up. On the STM32 parts with the I2Cv2 peripheral, there is a
+ * default, and I2C1_TIMINGR sets the timing for other clocks or speeds.
+ */
+
+#include <string.h>
+#include "ch.h"
+#include "hal.h"
+#include "i2c_master.h"
+
+#ifndef I2C_DRIVER
+#define I2C_DRIVER I2CD1
+#endif
+
+#ifndef I2C_DRIVER_CONFIG
+#if defined(STM32_TIMINGR_PRESC)
+// The STM32 I2Cv2 peripheral, by default 400kHz with a 72MHz I2C clock
+#ifndef I2C1_TIMINGR
+#define I2C1_TIMINGR (STM32_TIMINGR_PRESC(0U) | STM32_TIMINGR_SCLDEL(10U) | STM32_TIMINGR_SDADEL(0U) | \
+  STM32_TIMINGR_SCLH(34U) | STM32_TIMINGR_SCLL(86U))
+#endif
+#define I2C_DRIVER_CONFIG { I2C1_TIMINGR, 0, 0 }
+#else
+#error "I2C_DRIVER_CONFIG has to be defined in config.h, as the I2CConfig of this MCU"
+#endif
+#endif
+
+// Bytes that can be gathered from several segments
+#ifndef I2C_GATHER_BUFFER_SIZE
+#define I2C_GATHER_BUFFER_SIZE 64
+#endif
+
+// How long one transfer can take, in milliseconds
+#ifndef I2C_TRANSFER_TIMEOUT
+#define I2C_TRANSFER_TIMEOUT 100
+#endif
+
+#ifndef I2C_THREAD_PRIORITY
+#define I2C_THREAD_PRIORITY (NORMALPRIO + 1)
+#endif
+
+static const I2CConfig i2c_config = I2C_DRIVER_CONFIG;
+
+static binary_semaphore_t start_semaphore;
+static i2c_transaction_t* pending = NULL;
+static bool aborted = false;
+static bool thread_started = false;
+
+static uint8_t tx_buffer[I2C_GATHER_BUFFER_SIZE];
+static uint8_t rx_buffer[I2C_GATHER_BUFFER_SIZE];
+
+void i2c_backend_lock(void)
+{
+  chSysLock();
+}
+
+void i2c_backend_unlock(void)
+{
+  chSysUnlock();
+}
+
+void i2c_backend_start(i2c_transaction_t* transaction)
+{
+  pending = transaction;
+  chBSemSignalI(&start_semaphore);
+  chSchRescheduleS();
+}
+
+void i2c_backend_abort(void)
+{
+  // The current transfer can't be stopped, but its result is dropped
+  pending = NULL;
+  aborted = true;
+}
+
+// Finds the segments from first that go in one direction, and returns the number of bytes
+static uint16_t collect(const i2c_transaction_t* transaction, uint8_t first, uint8_t* end)
+{
+  uint8_t read = transaction->segments[first].flags & I2C_SEGMENT_READ;
+  uint16_t length = 0;
+  uint8_t i = first;
+  do {
+    length += transaction->segments[i].length;
+    i++;
+  } while (i < transaction->num_segments &&
+      (transaction->segments[i].flags & (I2C_SEGMENT_READ | I2C_SEGMENT_RESTART)) == read);
+  *end = i;
+  return length;
+}
+
+static i2c_status_t transfer(const i2c_transaction_t* transaction)
+{
+  i2caddr_t address = transaction->address >> 1;
+  uint8_t segment = 0;
+
+  uint16_t total = 0;
+  for (uint8_t i = 0; i < transaction->num_segments; i++) {
+    total += transaction->segments[i].length;
+  }
+  if (total == 0) {
+    return I2C_STATUS_ERROR;
+  }
+
+  do {
+    const uint8_t* tx = NULL;
+    uint16_t tx_length = 0;
+    uint8_t* rx = NULL;
+    uint16_t rx_length = 0;
+    uint8_t rx_first = 0;
+    uint8_t rx_end = 0;
+    uint8_t end;
+
+    if (segment < transaction->num_segments && !(transaction->segments[segment].flags & I2C_SEGMENT_READ)) {
+      tx_length = collect(transaction, segment, &end);
+      if (end == segment + 1) {
+        tx = transaction->segments[segment].data;
+      } else if (tx_length <= sizeof(tx_buffer)) {
+        uint16_t offset = 0;
+        for (uint8_t i = segment; i < end; i++) {
+          memcpy(tx_buffer + offset, transaction->segments[i].data, transaction->segments[i].length);
+          offset += transaction->segments[i].length;
+        }
+        tx = tx_buffer;
+      } else {
+        return I2C_STATUS_ERROR;
+      }
+      segment = end;
+    }
+
+    // A read straight after the write follows a repeated start
+    if (segment < transaction->num_segments && (transaction->segments[segment].flags & I2C_SEGMENT_READ) &&
+        (tx_length == 0 || !(transaction->segments[segment].flags & I2C_SEGMENT_RESTART))) {
+      rx_first = segment;
+      rx_length = collect(transaction, segment, &rx_end);
+      if (rx_end == segment + 1) {
+        rx = transaction->segments[segment].data;
+      } else if (rx_length <= sizeof(rx_buffer)) {
+        rx = rx_buffer;
+      } else {
+        return I2C_STATUS_ERROR;
+      }
+      segment = rx_end;
+    }
+
+    // The driver can't send just the address
+    if (tx_length == 0 && rx_length == 0) {
+      continue;
+    }
+
+    msg_t result;
+    if (rx_length == 0) {
+      result = i2cMasterTransmitTimeout(&I2C_DRIVER, address, tx, tx_length, NULL, 0, MS2ST(I2C_TRANSFER_TIMEOUT));
+    } else if (tx_length == 0) {
+      result = i2cMasterReceiveTimeout(&I2C_DRIVER, address, rx, rx_length, MS2ST(I2C_TRANSFER_TIMEOUT));
+    } else {
+      result = i2cMasterTransmitTimeout(&I2C_DRIVER, address, tx, tx_length, rx, rx_length, MS2ST(I2C_TRANSFER_TIMEOUT));
+    }
+
+    if (result == MSG_TIMEOUT) {
+      // The driver has to be restarted after a timeout
+      i2cStop(&I2C_DRIVER);
+      i2cStart(&I2C_DRIVER, &i2c_config);
+      return I2C_STATUS_TIMEOUT;
+    }
+    if (result != MSG_OK) {
+      return I2C_STATUS_ERROR;
+    }
+
+    if (rx == rx_buffer) {
+      uint16_t offset = 0;
+      for (uint8_t i = rx_first; i < rx_end; i++) {
+        memcpy(transaction->segments[i].data, rx_buffer + offset, transaction->segments[i].length);
+        offset += transaction->segments[i].length;
+      }
+    }
+  } while (segment < transaction->num_segments);
+
+  return I2C_STATUS_SUCCESS;
+}
+
+static THD_WORKING_AREA(i2c_thread_stack, 256);
+static THD_FUNCTION(i2c_thread, arg)
+{
+  (void)arg;
+  chRegSetThreadName("i2c");
+  while (true) {
+    chBSemWait(&start_semaphore);
+
+    chSysLock();
+    i2c_transaction_t* transaction = pending;
+    pending = NULL;
+    aborted = false;
+    chSysUnlock();
+    if (!transaction) {
+      continue;
+    }
+
+    i2c_status_t status = transfer(transaction);
+
+    chSysLock();
+    bool keep = !aborted;
+    chSysUnlock();
+    if (keep) {
+      i2c_backend_done(transaction, status);
+    }
+  }
+}
+
+void i2c_backend_init(void)
+{
+  i2cStart(&I2C_DRIVER, &i2c_config);
+  if (!thread_started) {
+    thread_started = true;
+    chBSemObjectInit(&start_semaphore, true);
+    (void)chThdCreateStatic(i2c_thread_stack, sizeof(i2c_thread_stack), I2C_THREAD_PRIORITY, i2c_thread, NULL);
+  }
+}
+
+i2c_status_t i2c_start(uint8_t address, uint16_t timeout)
+{
+  (void)address;
+  (void)timeout;
+  // Byte by byte transfers aren't supported by the ChibiOS driver
+  return I2C_STATUS_ERROR;
+}
+
+i2c_status_t i2c_write(uint8_t data, uint16_t timeout)
+{
+  (void)data;
+  (void)timeout;
+  return I2C_STATUS_ERROR;
+}
+
+int16_t i2c_read_ack(uint16_t timeout)
+{
+  (void)timeout;
+  return I2C_STATUS_ERROR;
+}
+
+int16_t i2c_read_nack(uint16_t timeout)
+{
+  (void)timeout;
+  return I2C_STATUS_ERROR;
+}
+
+i2c_status_t i2c_stop(uint16_t timeout)
+{
+  (void)timeout;
+  return I2C_STATUS_SUCCESS;
+}
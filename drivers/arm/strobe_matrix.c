@@ -0,0 +1,177 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <string.h>
+#include "strobe_matrix.h"
+
+#if !defined(STROBE_MATRIX_ROW_PINS) || !defined(STROBE_MATRIX_COL_PINS)
+#   error "STROBE_MATRIX_ROW_PINS and STROBE_MATRIX_COL_PINS have to be defined."
+#endif
+
+// A DMAMUX slot that always requests, so that the PIT trigger paces it
+#ifndef STROBE_MATRIX_DMA_SOURCE
+#define STROBE_MATRIX_DMA_SOURCE 63
+#endif
+
+#define DMAMUX_ENBL         (1 << 7)
+#define DMAMUX_TRIG         (1 << 6)
+#define DMA_ATTR_32BIT      ((2 << 8) | 2)
+#define DMA_CR_EMLM_BIT     (1 << 7)
+#define DMA_NBYTES_SMLOE    (1UL << 31)
+#define DMA_NBYTES_MLOFF(n) (((uint32_t)(n) & 0xFFFFF) << 10)
+
+// The GPIO ports are evenly spaced, so one minor loop reads all column ports
+#define PORT_STRIDE ((uint32_t)GPIOB - (uint32_t)GPIOA)
+#define MAX_PORTS 5
+
+#define SLOTS (2 * STROBE_MATRIX_ROWS)
+
+static const strobe_matrix_pin_t row_pins[STROBE_MATRIX_ROWS] = STROBE_MATRIX_ROW_PINS;
+static const strobe_matrix_pin_t col_pins[MATRIX_COLS] = STROBE_MATRIX_COL_PINS;
+
+// Written by the DMA, two buffers of STROBE_MATRIX_ROWS rows of num_ports words
+static volatile uint32_t scan_buffer[SLOTS * MAX_PORTS];
+
+static GPIO_TypeDef* first_port;
+static uint8_t num_ports;
+static uint8_t col_port[MATRIX_COLS];
+static uint32_t col_mask[MATRIX_COLS];
+
+static uint8_t strobed;
+static volatile uint8_t completed_buffer;
+static volatile uint32_t scans;
+static uint32_t last_read;
+
+// Runs when the DMA has just read the strobed row. Where the DMA writes next
+// decides which row is strobed, so the two can't get out of step.
+static void strobe_callback(GPTDriver* gptp) {
+    (void)gptp;
+    uint16_t slot = SLOTS - DMA->TCD[STROBE_MATRIX_DMA_CHANNEL].CITER_ELINKNO;
+
+    palClearPad(row_pins[strobed].port, row_pins[strobed].pad);
+    strobed = slot % STROBE_MATRIX_ROWS;
+    palSetPad(row_pins[strobed].port, row_pins[strobed].pad);
+
+    if (strobed == 0) {
+        completed_buffer = slot == 0 ? 1 : 0;
+        scans++;
+    }
+}
+
+static const GPTConfig gpt_config = {
+    .frequency = 1000000,
+    .callback = strobe_callback,
+};
+
+static void dma_init(void) {
+    volatile DMA_TCD_TypeDef* tcd = &DMA->TCD[STROBE_MATRIX_DMA_CHANNEL];
+
+    SIM->SCGC6 |= SIM_SCGC6_DMAMUX;
+    SIM->SCGC7 |= SIM_SCGC7_DMA;
+    DMAMUX->CHCFG[STROBE_MATRIX_DMA_CHANNEL] = 0;
+
+    // Minor loop offsets, which other channels don't use as long as their
+    // minor loops are below 1GB
+    DMA->CR |= DMA_CR_EMLM_BIT;
+
+    // Each request reads num_ports ports into the next slot, and the minor loop
+    // offset moves the source back to the first port. The major loop goes
+    // through both buffers and starts over, the offset applies at its end too.
+    tcd->SADDR = (uint32_t)&first_port->PDIR;
+    tcd->SOFF = PORT_STRIDE;
+    tcd->ATTR = DMA_ATTR_32BIT;
+    tcd->NBYTES_MLNO = DMA_NBYTES_SMLOE |
+        DMA_NBYTES_MLOFF(-(int32_t)(num_ports * PORT_STRIDE)) |
+        (num_ports * sizeof(uint32_t));
+    tcd->SLAST = 0;
+    tcd->DADDR = (uint32_t)scan_buffer;
+    tcd->DOFF = sizeof(uint32_t);
+    tcd->CITER_ELINKNO = SLOTS;
+    tcd->BITER_ELINKNO = SLOTS;
+    tcd->DLASTSGA = -(int32_t)(SLOTS * num_ports * sizeof(uint32_t));
+    tcd->CSR = 0;
+
+    DMA->SERQ = STROBE_MATRIX_DMA_CHANNEL;
+    DMAMUX->CHCFG[STROBE_MATRIX_DMA_CHANNEL] = DMAMUX_ENBL | DMAMUX_TRIG | STROBE_MATRIX_DMA_SOURCE;
+}
+
+void strobe_matrix_init(void) {
+    GPIO_TypeDef* last_port = col_pins[0].port;
+    first_port = col_pins[0].port;
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        palSetPadMode(col_pins[col].port, col_pins[col].pad, STROBE_MATRIX_COL_MODE);
+        if (col_pins[col].port < first_port) {
+            first_port = col_pins[col].port;
+        }
+        if (col_pins[col].port > last_port) {
+            last_port = col_pins[col].port;
+        }
+    }
+    num_ports = ((uint32_t)last_port - (uint32_t)first_port) / PORT_STRIDE + 1;
+    osalDbgAssert(num_ports <= MAX_PORTS, "too many column ports");
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        col_port[col] = ((uint32_t)col_pins[col].port - (uint32_t)first_port) / PORT_STRIDE;
+        col_mask[col] = 1UL << col_pins[col].pad;
+    }
+
+    for (uint8_t row = 0; row < STROBE_MATRIX_ROWS; row++) {
+        palSetPadMode(row_pins[row].port, row_pins[row].pad, PAL_MODE_OUTPUT_PUSHPULL);
+        palClearPad(row_pins[row].port, row_pins[row].pad);
+    }
+
+    memset((void*)scan_buffer, 0, sizeof(scan_buffer));
+    scans = 0;
+    last_read = 0;
+    completed_buffer = 0;
+
+    // The first row settles for a period before the first request
+    strobed = 0;
+    palSetPad(row_pins[0].port, row_pins[0].pad);
+    dma_init();
+    gptStart(&STROBE_MATRIX_GPT, &gpt_config);
+    gptStartContinuous(&STROBE_MATRIX_GPT, STROBE_MATRIX_PERIOD_US);
+}
+
+// The DMA only writes to the completed buffer again after the next scan is
+// complete, so the read is tried again if that happened in the middle
+bool strobe_matrix_read(matrix_row_t* rows) {
+    uint32_t count;
+    do {
+        count = scans;
+        const volatile uint32_t* words = &scan_buffer[completed_buffer * STROBE_MATRIX_ROWS * num_ports];
+        for (uint8_t row = 0; row < STROBE_MATRIX_ROWS; row++) {
+            matrix_row_t data = 0;
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                if (words[col_port[col]] & col_mask[col]) {
+                    data |= (matrix_row_t)1 << col;
+                }
+            }
+            rows[row] = data;
+            words += num_ports;
+        }
+    } while (count != scans);
+
+    if (count == last_read) {
+        return false;
+    }
+    last_read = count;
+    return true;
+}
+
+uint32_t strobe_matrix_scans(void) {
+    return scans;
+}
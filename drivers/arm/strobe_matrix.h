@@ -0,0 +1,77 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef STROBE_MATRIX_H
+#define STROBE_MATRIX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal.h"
+#include "matrix.h"
+
+/* Background matrix scanning for Kinetis
+ *
+ * A PIT channel, through the GPT driver, strobes one row at a time from
+ * STROBE_MATRIX_ROW_PINS. The same timer triggers a DMA channel, which
+ * captures the column ports of the row that has been strobed for a whole
+ * period, just before the interrupt moves on to the next row. The DMA fills
+ * two buffers of STROBE_MATRIX_ROWS rows in turn, so the whole matrix is
+ * scanned at a fixed rate, and matrix_scan only has to read the last
+ * complete buffer.
+ *
+ * The columns can be on more than one port, but the DMA reads every port
+ * from the first to the last one that has a column, so they should be close
+ * together.
+ *
+ * The keyboard defines the pins in config.h, as { port, pad } pairs, and
+ * enables KINETIS_GPT_USE_PIT0 in mcuconf.h and HAL_USE_GPT in halconf.h.
+ */
+
+#ifndef STROBE_MATRIX_ROWS
+#define STROBE_MATRIX_ROWS MATRIX_ROWS
+#endif
+
+// How long each row is strobed before it's read, in microseconds
+#ifndef STROBE_MATRIX_PERIOD_US
+#define STROBE_MATRIX_PERIOD_US 50
+#endif
+
+// The DMA channel has to be the one the PIT channel of the GPT driver triggers
+#ifndef STROBE_MATRIX_GPT
+#define STROBE_MATRIX_GPT GPTD1
+#endif
+#ifndef STROBE_MATRIX_DMA_CHANNEL
+#define STROBE_MATRIX_DMA_CHANNEL 0
+#endif
+
+#ifndef STROBE_MATRIX_COL_MODE
+#define STROBE_MATRIX_COL_MODE PAL_MODE_INPUT_PULLDOWN
+#endif
+
+typedef struct {
+    ioportid_t port;
+    uint8_t pad;
+} strobe_matrix_pin_t;
+
+// Sets up the pins and starts scanning
+void strobe_matrix_init(void);
+// Reads the last complete scan into rows, and returns false if it was read before
+bool strobe_matrix_read(matrix_row_t* rows);
+// Complete scans since the start
+uint32_t strobe_matrix_scans(void);
+
+#endif
@@ -2,7 +2,9 @@
  * Github repository: https://github.com/g4lvanix/I2C-master-lib
  */
 
+#include <stddef.h>
 #include <avr/io.h>
+#include <avr/interrupt.h>
 #include <util/twi.h>
 
 #include "i2c_master.h"
@@ -12,14 +14,177 @@
 #define Prescaler 1
 #define TWBR_val ((((F_CPU / F_SCL) / Prescaler) - 16 ) / 2)
 
-void i2c_init(void)
+void i2c_backend_init(void)
 {
   TWSR = 0;     /* no prescaler */
   TWBR = (uint8_t)TWBR_val;
 }
 
+/* Queued transactions run from the TWI interrupt, which is called after every
+ * start, address and data byte, with the result in TW_STATUS.
+ */
+
+#define TWCR_NEXT (_BV(TWINT) | _BV(TWEN) | _BV(TWIE))
+
+enum {
+  NEXT_BYTE,
+  NEXT_RESTART,
+  NEXT_END,
+};
+
+static i2c_transaction_t* current = NULL;
+static uint8_t segment;
+static uint16_t position;
+static bool reading;
+static uint8_t saved_sreg;
+
+void i2c_backend_lock(void)
+{
+  uint8_t sreg = SREG;
+  cli();
+  saved_sreg = sreg;
+}
+
+void i2c_backend_unlock(void)
+{
+  SREG = saved_sreg;
+}
+
+void i2c_backend_start(i2c_transaction_t* transaction)
+{
+  current = transaction;
+  segment = 0;
+  position = 0;
+  // The stop of the previous transaction takes a few microseconds
+  for (uint8_t i = 0; (TWCR & _BV(TWSTO)) && i < 0xFF; i++) {}
+  TWCR = TWCR_NEXT | _BV(TWSTA);
+}
+
+void i2c_backend_abort(void)
+{
+  current = NULL;
+  // Disabling the TWI releases the bus
+  TWCR = 0;
+}
+
+// Moves to the segment of the next byte, and tells if it needs a repeated start
+static uint8_t next_byte(void)
+{
+  bool restart = false;
+  while (segment < current->num_segments) {
+    const i2c_segment_t* s = &current->segments[segment];
+    if (position < s->length) {
+      return restart ? NEXT_RESTART : NEXT_BYTE;
+    }
+    segment++;
+    position = 0;
+    if (segment < current->num_segments) {
+      uint8_t flags = current->segments[segment].flags;
+      if ((flags & I2C_SEGMENT_RESTART) || (bool)(flags & I2C_SEGMENT_READ) != reading) {
+        restart = true;
+      }
+    }
+  }
+  return NEXT_END;
+}
+
+// The byte at position is received next, and gets an ACK if more are read after it
+static bool more_to_read(void)
+{
+  if (position + 1 < current->segments[segment].length) {
+    return true;
+  }
+  for (uint8_t i = segment + 1; i < current->num_segments; i++) {
+    const i2c_segment_t* s = &current->segments[i];
+    if (!(s->flags & I2C_SEGMENT_READ) || (s->flags & I2C_SEGMENT_RESTART)) {
+      return false;
+    }
+    if (s->length) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void complete(i2c_status_t status)
+{
+  i2c_transaction_t* transaction = current;
+  current = NULL;
+  i2c_backend_done(transaction, status);
+}
+
+static void finish(i2c_status_t status)
+{
+  TWCR = _BV(TWINT) | _BV(TWEN) | _BV(TWSTO);
+  complete(status);
+}
+
+static void continue_transfer(void)
+{
+  switch (next_byte()) {
+    case NEXT_BYTE:
+      if (reading) {
+        TWCR = TWCR_NEXT | (more_to_read() ? _BV(TWEA) : 0);
+      } else {
+        TWDR = current->segments[segment].data[position++];
+        TWCR = TWCR_NEXT;
+      }
+      break;
+    case NEXT_RESTART:
+      TWCR = TWCR_NEXT | _BV(TWSTA);
+      break;
+    default:
+      finish(I2C_STATUS_SUCCESS);
+      break;
+  }
+}
+
+ISR(TWI_vect)
+{
+  if (!current) {
+    TWCR = 0;
+    return;
+  }
+
+  switch (TW_STATUS) {
+    case TW_START:
+    case TW_REP_START:
+      // Leading empty segments are skipped, and without any data only the address is written
+      while (segment < current->num_segments && current->segments[segment].length == 0) {
+        segment++;
+      }
+      reading = segment < current->num_segments && (current->segments[segment].flags & I2C_SEGMENT_READ);
+      TWDR = current->address | (reading ? I2C_READ : I2C_WRITE);
+      TWCR = TWCR_NEXT;
+      break;
+    case TW_MT_SLA_ACK:
+    case TW_MT_DATA_ACK:
+    case TW_MR_SLA_ACK:
+      continue_transfer();
+      break;
+    case TW_MR_DATA_ACK:
+    case TW_MR_DATA_NACK:
+      current->segments[segment].data[position++] = TWDR;
+      continue_transfer();
+      break;
+    case TW_MT_ARB_LOST:
+      // Another master has the bus, so don't send a stop
+      TWCR = _BV(TWINT) | _BV(TWEN);
+      complete(I2C_STATUS_ERROR);
+      break;
+    default:
+      // Address or data NACK, or a bus error
+      finish(I2C_STATUS_ERROR);
+      break;
+  }
+}
+
 i2c_status_t i2c_start(uint8_t address, uint16_t timeout)
 {
+  // wait for the queued transactions
+  i2c_status_t status = i2c_flush(timeout);
+  if (status) return status;
+
   // reset TWI control register
   TWCR = 0;
   // transmit START condition
@@ -107,101 +272,6 @@ int16_t i2c_read_nack(uint16_t timeout)
   return TWDR;
 }
 
-i2c_status_t i2c_transmit(uint8_t address, uint8_t* data, uint16_t length, uint16_t timeout)
-{
-  i2c_status_t status = i2c_start(address | I2C_WRITE, timeout);
-  if (status) return status;
-
-  for (uint16_t i = 0; i < length; i++) {
-    status = i2c_write(data[i], timeout);
-    if (status) return status;
-  }
-
-  status = i2c_stop(timeout);
-  if (status) return status;
-
-  return I2C_STATUS_SUCCESS;
-}
-
-i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16_t timeout)
-{
-  i2c_status_t status = i2c_start(address | I2C_READ, timeout);
-  if (status) return status;
-
-  for (uint16_t i = 0; i < (length-1); i++) {
-    status = i2c_read_ack(timeout);
-    if (status >= 0) {
-      data[i] = status;
-    } else {
-      return status;
-    }
-  }
-
-  status = i2c_read_nack(timeout);
-  if (status >= 0 ) {
-    data[(length-1)] = status;
-  } else {
-    return status;
-  }
-
-  status = i2c_stop(timeout);
-  if (status) return status;
-
-  return I2C_STATUS_SUCCESS;
-}
-
-i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout)
-{
-  i2c_status_t status = i2c_start(devaddr | 0x00, timeout);
-  if (status) return status;
-
-  status = i2c_write(regaddr, timeout);
-  if (status) return status;
-
-  for (uint16_t i = 0; i < length; i++) {
-    status = i2c_write(data[i], timeout);
-    if (status) return status;
-  }
-
-  status = i2c_stop(timeout);
-  if (status) return status;
-
-  return I2C_STATUS_SUCCESS;
-}
-
-i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout)
-{
-  i2c_status_t status = i2c_start(devaddr, timeout);
-  if (status) return status;
-
-  status = i2c_write(regaddr, timeout);
-  if (status) return status;
-
-  status = i2c_start(devaddr | 0x01, timeout);
-  if (status) return status;
-
-  for (uint16_t i = 0; i < (length-1); i++) {
-    status = i2c_read_ack(timeout);
-    if (status >= 0) {
-      data[i] = status;
-    } else {
-      return status;
-    }
-  }
-
-  status = i2c_read_nack(timeout);
-  if (status >= 0 ) {
-    data[(length-1)] = status;
-  } else {
-    return status;
-  }
-
-  status = i2c_stop(timeout);
-  if (status) return status;
-
-  return I2C_STATUS_SUCCESS;
-}
-
 i2c_status_t i2c_stop(uint16_t timeout)
 {
   // transmit STOP condition
@@ -57,19 +57,17 @@
   #define ISSI_PERSISTENCE 0
 #endif
 
-// Transfer buffer for TWITransmitData()
-uint8_t g_twi_transfer_buffer[20];
+// Frames 0 and 1 take turns, the other six are left for the chip's own animations
+#define ISSI_FRAMES 2
 
-// These buffers match the IS31FL3731 PWM registers 0x24-0xB3.
-// Storing them like this is optimal for I2C transfers to the registers.
-// We could optimize this and take out the unused registers from these
-// buffers and the transfers in IS31FL3731_write_pwm_buffer() but it's
-// probably not worth the extra complexity.
-uint8_t g_pwm_buffer[DRIVER_COUNT][144];
-bool g_pwm_buffer_update_required = false;
+#define ISSI_REG_AUTOPLAY 0x02
+#define ISSI_REG_BREATH 0x08
+#define ISSI_BREATH_ENABLE 0x10
 
-uint8_t g_led_control_registers[DRIVER_COUNT][18] = { { 0 }, { 0 } };
-bool g_led_control_registers_update_required = false;
+// The register addresses that are sent before the buffers
+static uint8_t g_control_register = 0x00;
+static uint8_t g_pwm_register = 0x24;
+static uint8_t g_select_function[2] = { ISSI_COMMANDREGISTER, ISSI_BANK_FUNCTIONREG };
 
 // This is the bit pattern in the LED control registers
 // (for matrix A, add one to register for matrix B)
@@ -86,59 +84,54 @@ bool g_led_control_registers_update_required = false;
 // 0x10 - R16,R15,R14,R13,R12,R11,R10,R09
 
 
-void IS31FL3731_write_register( uint8_t addr, uint8_t reg, uint8_t data )
+i2c_status_t IS31FL3731_write_register( uint8_t addr, uint8_t reg, uint8_t data )
 {
-	g_twi_transfer_buffer[0] = reg;
-	g_twi_transfer_buffer[1] = data;
+	uint8_t payload[2] = { reg, data };
+	i2c_status_t status = i2c_transmit(addr << 1, payload, 2, ISSI_TIMEOUT);
 
   #if ISSI_PERSISTENCE > 0
-    for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-      if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 2, ISSI_TIMEOUT) == 0)
-        break;
+    for (uint8_t i = 0; i < ISSI_PERSISTENCE && status != I2C_STATUS_SUCCESS; i++) {
+      status = i2c_transmit(addr << 1, payload, 2, ISSI_TIMEOUT);
     }
-  #else
-    i2c_transmit(addr << 1, g_twi_transfer_buffer, 2, ISSI_TIMEOUT);
   #endif
+	return status;
 }
 
-void IS31FL3731_write_pwm_buffer( uint8_t addr, uint8_t *pwm_buffer )
+// Writes zeros to all 180 registers of the selected frame in one go, which
+// are taken from the buffers of a device that was just cleared
+static i2c_status_t IS31FL3731_clear_frame( is31_device_t *device )
 {
-	// assumes bank is already selected
-
-	// transmit PWM registers in 9 transfers of 16 bytes
-	// g_twi_transfer_buffer[] is 20 bytes
-
-	// iterate over the pwm_buffer contents at 16 byte intervals
-	for ( int i = 0; i < 144; i += 16 ) {
-		// set the first register, e.g. 0x24, 0x34, 0x44, etc.
-		g_twi_transfer_buffer[0] = 0x24 + i;
-		// copy the data from i to i+15
-		// device will auto-increment register for data after the first byte
-		// thus this sets registers 0x24-0x33, 0x34-0x43, etc. in one transfer
-		for ( int j = 0; j < 16; j++ ) {
-			g_twi_transfer_buffer[1 + j] = pwm_buffer[i + j];
-		}
-
-    #if ISSI_PERSISTENCE > 0
-      for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0)
-          break;
-      }
-    #else
-      i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT);
-    #endif
+	i2c_segment_t segments[] = {
+		I2C_WRITE_SEGMENT(&g_control_register, 1),
+		I2C_WRITE_SEGMENT(device->pwm, 144),
+		I2C_WRITE_SEGMENT(device->pwm, 36),
+	};
+	i2c_transaction_t transaction = {
+		.address = device->addr << 1,
+		.num_segments = 3,
+		.segments = segments,
+	};
+	if ( i2c_submit( &transaction ) != I2C_STATUS_PENDING ) {
+		return I2C_STATUS_ERROR;
 	}
+	return i2c_wait( &transaction, ISSI_TIMEOUT );
 }
 
-void IS31FL3731_init( uint8_t addr )
+bool IS31FL3731_init_device( is31_device_t *device, uint8_t addr )
 {
+	memset( device, 0, sizeof(is31_device_t) );
+	device->addr = addr;
+	device->transaction.status = I2C_STATUS_SUCCESS;
+
 	// In order to avoid the LEDs being driven with garbage data
 	// in the LED driver's PWM registers, first enable software shutdown,
 	// then set up the mode and other settings, clear the PWM registers,
 	// then disable software shutdown.
 
 	// select "function register" bank
-	IS31FL3731_write_register( addr, ISSI_COMMANDREGISTER, ISSI_BANK_FUNCTIONREG );
+	if ( IS31FL3731_write_register( addr, ISSI_COMMANDREGISTER, ISSI_BANK_FUNCTIONREG ) != I2C_STATUS_SUCCESS ) {
+		return false;
+	}
 
 	// enable software shutdown
 	IS31FL3731_write_register( addr, ISSI_REG_SHUTDOWN, 0x00 );
@@ -152,50 +145,269 @@ void IS31FL3731_init( uint8_t addr )
 	// audio sync off
 	IS31FL3731_write_register( addr, ISSI_REG_AUDIOSYNC, 0x00 );
 
-	// select bank 0
-	IS31FL3731_write_register( addr, ISSI_COMMANDREGISTER, 0 );
+	// turn off all LEDs, blinking and PWM in both frames
+	for ( uint8_t frame = 0; frame < ISSI_FRAMES; frame++ ) {
+		IS31FL3731_write_register( addr, ISSI_COMMANDREGISTER, frame );
+		IS31FL3731_clear_frame( device );
+	}
+
+	// select "function register" bank
+	IS31FL3731_write_register( addr, ISSI_COMMANDREGISTER, ISSI_BANK_FUNCTIONREG );
 
-	// turn off all LEDs in the LED control register
-	for ( int i = 0x00; i <= 0x11; i++ )
-	{
-		IS31FL3731_write_register( addr, i, 0x00 );
+	// disable software shutdown
+	IS31FL3731_write_register( addr, ISSI_REG_SHUTDOWN, 0x01 );
+
+	// every update selects its frame, so the function register bank stays selected
+	return true;
+}
+
+void IS31FL3731_set_pwm( is31_device_t *device, uint8_t index, uint8_t value )
+{
+	if ( device->pwm[index] != value ) {
+		device->pwm_total += value - device->pwm[index];
+		device->pwm[index] = value;
+		device->pwm_dirty = true;
 	}
+}
 
-	// turn off all LEDs in the blink control register (not really needed)
-	for ( int i = 0x12; i <= 0x23; i++ )
-	{
-		IS31FL3731_write_register( addr, i, 0x00 );
+void IS31FL3731_set_led_control( is31_device_t *device, uint8_t index, bool on )
+{
+	uint8_t control = device->control[index / 8];
+	uint8_t bit = 1 << (index % 8);
+
+	control = on ? (control | bit) : (control & ~bit);
+	if ( device->control[index / 8] != control ) {
+		device->control[index / 8] = control;
+		device->control_frames = (1 << ISSI_FRAMES) - 1;
 	}
+}
 
-	// set PWM on all LEDs to 0
-	for ( int i = 0x24; i <= 0xB3; i++ )
-	{
-		IS31FL3731_write_register( addr, i, 0x00 );
+void IS31FL3731_invalidate( is31_device_t *device )
+{
+	device->control_frames = (1 << ISSI_FRAMES) - 1;
+	device->pwm_dirty = true;
+}
+
+bool IS31FL3731_busy( is31_device_t *device )
+{
+	return device->transaction.status == I2C_STATUS_PENDING;
+}
+
+// What a transaction changes in the state, once it succeeded
+#define PENDING_NONE     0
+#define PENDING_FLIP     1    // displays a new frame
+#define PENDING_STOP     2    // back to the picture frames
+#define PENDING_SHUTDOWN 3    // into or out of shutdown, as in shutdown[1]
+
+// Takes the result of the last transaction that was sent
+static void IS31FL3731_frame_done( is31_device_t *device )
+{
+	uint8_t pending = device->pending;
+	bool success = device->transaction.status == I2C_STATUS_SUCCESS;
+	device->pending = PENDING_NONE;
+
+	switch ( pending ) {
+	case PENDING_FLIP:
+		if ( success ) {
+			device->frame = device->show_frame[1];
+			device->control_frames &= ~(1 << device->frame);
+		} else {
+			// The frame may be half written, send it again
+			device->pwm_dirty = true;
+		}
+		break;
+	case PENDING_STOP:
+		if ( success ) {
+			device->animating = false;
+			// The buffers have the animation, the picture frames need them again
+			device->pwm_dirty = true;
+		}
+		break;
+	case PENDING_SHUTDOWN:
+		if ( success ) {
+			// 0 is shutdown
+			device->shut_down = device->shutdown[1] == 0x00;
+		}
+		break;
 	}
+}
 
-	// select "function register" bank
-	IS31FL3731_write_register( addr, ISSI_COMMANDREGISTER, ISSI_BANK_FUNCTIONREG );
+static bool IS31FL3731_submit( is31_device_t *device, uint8_t num_segments, uint8_t pending )
+{
+	device->transaction.address = device->addr << 1;
+	device->transaction.num_segments = num_segments;
+	device->transaction.segments = device->segments;
+	device->pending = pending;
+	if ( i2c_submit( &device->transaction ) != I2C_STATUS_PENDING ) {
+		device->pending = PENDING_NONE;
+		return false;
+	}
+	return true;
+}
 
-	// disable software shutdown
-	IS31FL3731_write_register( addr, ISSI_REG_SHUTDOWN, 0x01 );
+// Adds the segments that write the buffers to a frame, and returns the count
+static uint8_t IS31FL3731_frame_segments( is31_device_t *device, uint8_t frame, bool control )
+{
+	uint8_t count = 0;
+	i2c_segment_t *segments = device->segments;
+
+	device->select_frame[0] = ISSI_COMMANDREGISTER;
+	device->select_frame[1] = frame;
+	segments[count++] = (i2c_segment_t)I2C_WRITE_SEGMENT(device->select_frame, 2);
+	if ( control ) {
+		segments[count++] = (i2c_segment_t){ &g_control_register, 1, I2C_SEGMENT_RESTART };
+		segments[count++] = (i2c_segment_t)I2C_WRITE_SEGMENT(device->control, 18);
+	}
+	// The whole frame, the address increments after each byte
+	segments[count++] = (i2c_segment_t){ &g_pwm_register, 1, I2C_SEGMENT_RESTART };
+	segments[count++] = (i2c_segment_t)I2C_WRITE_SEGMENT(device->pwm, 144);
+	return count;
+}
 
-	// select bank 0 and leave it selected.
-	// most usage after initialization is just writing PWM buffers in bank 0
-	// as there's not much point in double-buffering
-	IS31FL3731_write_register( addr, ISSI_COMMANDREGISTER, 0 );
+bool IS31FL3731_update( is31_device_t *device )
+{
+	if ( IS31FL3731_busy( device ) ) {
+		return false;
+	}
+	IS31FL3731_frame_done( device );
 
+	// The picture frames wait while the animation is written and played,
+	// and everything waits while the chip is shut down
+	if ( device->animating || device->shut_down ) {
+		return true;
+	}
+
+	// The displayed frame doesn't need anything, so only the other frame is checked
+	uint8_t frame = device->frame ^ 1;
+	bool control = device->control_frames & (1 << frame);
+	if ( !device->pwm_dirty && !control ) {
+		return true;
+	}
+
+	uint8_t count = IS31FL3731_frame_segments( device, frame, control );
+	// Flip to the new frame
+	device->show_frame[0] = ISSI_REG_PICTUREFRAME;
+	device->show_frame[1] = frame;
+	device->segments[count++] = (i2c_segment_t){ g_select_function, 2, I2C_SEGMENT_RESTART };
+	device->segments[count++] = (i2c_segment_t){ device->show_frame, 2, I2C_SEGMENT_RESTART };
+
+	// Changes from now on go into the next frame
+	device->pwm_dirty = false;
+	if ( !IS31FL3731_submit( device, count, PENDING_FLIP ) ) {
+		device->pwm_dirty = true;
+		return false;
+	}
+	return true;
+}
+
+bool IS31FL3731_write_animation_frame( is31_device_t *device, uint8_t index )
+{
+	if ( IS31FL3731_busy( device ) ) {
+		return false;
+	}
+	IS31FL3731_frame_done( device );
+
+	// Every frame has its own control registers
+	uint8_t count = IS31FL3731_frame_segments( device, ISSI_FRAMES + index, true );
+	if ( !IS31FL3731_submit( device, count, PENDING_NONE ) ) {
+		return false;
+	}
+	device->animating = true;
+	return true;
 }
 
+bool IS31FL3731_play( is31_device_t *device, const is31_animation_t *animation )
+{
+	if ( IS31FL3731_busy( device ) ) {
+		return false;
+	}
+	IS31FL3731_frame_done( device );
+
+	device->autoplay[0] = ISSI_REG_AUTOPLAY;
+	// Endless loops of the frames
+	device->autoplay[1] = animation->frames;
+	// 0 is the longest delay, 64 steps
+	device->autoplay[2] = animation->frame_delay & 0x3F;
+	device->breath[0] = ISSI_REG_BREATH;
+	device->breath[1] = (animation->fade_out << 4) | animation->fade_in;
+	device->breath[2] = (animation->breathe ? ISSI_BREATH_ENABLE : 0) | animation->extinguish;
+	device->config[0] = ISSI_REG_CONFIG;
+	device->config[1] = ISSI_REG_CONFIG_AUTOPLAYMODE | ISSI_FRAMES;
+
+	i2c_segment_t *segments = device->segments;
+	segments[0] = (i2c_segment_t)I2C_WRITE_SEGMENT(g_select_function, 2);
+	segments[1] = (i2c_segment_t){ device->autoplay, 3, I2C_SEGMENT_RESTART };
+	segments[2] = (i2c_segment_t){ device->breath, 3, I2C_SEGMENT_RESTART };
+	// Writing the mode starts the first frame
+	segments[3] = (i2c_segment_t){ device->config, 2, I2C_SEGMENT_RESTART };
+	if ( !IS31FL3731_submit( device, 4, PENDING_NONE ) ) {
+		return false;
+	}
+	device->animating = true;
+	return true;
+}
+
+bool IS31FL3731_stop( is31_device_t *device )
+{
+	if ( IS31FL3731_busy( device ) ) {
+		return false;
+	}
+	IS31FL3731_frame_done( device );
+	if ( !device->animating ) {
+		return true;
+	}
+
+	device->breath[0] = ISSI_REG_BREATH;
+	device->breath[1] = 0;
+	device->breath[2] = 0;
+	device->config[0] = ISSI_REG_CONFIG;
+	device->config[1] = ISSI_REG_CONFIG_PICTUREMODE;
+
+	i2c_segment_t *segments = device->segments;
+	segments[0] = (i2c_segment_t)I2C_WRITE_SEGMENT(g_select_function, 2);
+	segments[1] = (i2c_segment_t){ device->breath, 3, I2C_SEGMENT_RESTART };
+	segments[2] = (i2c_segment_t){ device->config, 2, I2C_SEGMENT_RESTART };
+	IS31FL3731_submit( device, 3, PENDING_STOP );
+	// Done once the transaction succeeded
+	return false;
+}
+
+bool IS31FL3731_shutdown( is31_device_t *device, bool shutdown )
+{
+	if ( IS31FL3731_busy( device ) ) {
+		return false;
+	}
+	IS31FL3731_frame_done( device );
+	if ( device->shut_down == shutdown ) {
+		return true;
+	}
+
+	// 0 is shutdown
+	device->shutdown[0] = ISSI_REG_SHUTDOWN;
+	device->shutdown[1] = shutdown ? 0x00 : 0x01;
+
+	i2c_segment_t *segments = device->segments;
+	segments[0] = (i2c_segment_t)I2C_WRITE_SEGMENT(g_select_function, 2);
+	segments[1] = (i2c_segment_t){ device->shutdown, 2, I2C_SEGMENT_RESTART };
+	IS31FL3731_submit( device, 2, PENDING_SHUTDOWN );
+	// Done once the transaction succeeded
+	return false;
+}
+
+#ifdef DRIVER_LED_TOTAL
+
+is31_device_t g_is31_devices[DRIVER_COUNT];
+
 void IS31FL3731_set_color( int index, uint8_t red, uint8_t green, uint8_t blue )
 {
 	if ( index >= 0 && index < DRIVER_LED_TOTAL ) {
 		is31_led led = g_is31_leds[index];
+		is31_device_t *device = &g_is31_devices[led.driver];
 
-		// Subtract 0x24 to get the second index of g_pwm_buffer
-		g_pwm_buffer[led.driver][led.r - 0x24] = red;
-		g_pwm_buffer[led.driver][led.g - 0x24] = green;
-		g_pwm_buffer[led.driver][led.b - 0x24] = blue;
-		g_pwm_buffer_update_required = true;
+		// Subtract 0x24 to get the index of the PWM buffer
+		IS31FL3731_set_pwm( device, led.r - 0x24, red );
+		IS31FL3731_set_pwm( device, led.g - 0x24, green );
+		IS31FL3731_set_pwm( device, led.b - 0x24, blue );
 	}
 }
 
@@ -210,53 +422,50 @@ void IS31FL3731_set_color_all( uint8_t red, uint8_t green, uint8_t blue )
 void IS31FL3731_set_led_control_register( uint8_t index, bool red, bool green, bool blue )
 {
 	is31_led led = g_is31_leds[index];
+	is31_device_t *device = &g_is31_devices[led.driver];
 
-  uint8_t control_register_r = (led.r - 0x24) / 8;
-  uint8_t control_register_g = (led.g - 0x24) / 8;
-  uint8_t control_register_b = (led.b - 0x24) / 8;
-  uint8_t bit_r = (led.r - 0x24) % 8;
-  uint8_t bit_g = (led.g - 0x24) % 8;
-  uint8_t bit_b = (led.b - 0x24) % 8;
-
-	if ( red ) {
-		g_led_control_registers[led.driver][control_register_r] |= (1 << bit_r);
-	} else {
-		g_led_control_registers[led.driver][control_register_r] &= ~(1 << bit_r);
-	}
-	if ( green ) {
-		g_led_control_registers[led.driver][control_register_g] |= (1 << bit_g);
-	} else {
-		g_led_control_registers[led.driver][control_register_g] &= ~(1 << bit_g);
-	}
-	if ( blue ) {
-		g_led_control_registers[led.driver][control_register_b] |= (1 << bit_b);
-	} else {
-		g_led_control_registers[led.driver][control_register_b] &= ~(1 << bit_b);
-	}
+	IS31FL3731_set_led_control( device, led.r - 0x24, red );
+	IS31FL3731_set_led_control( device, led.g - 0x24, green );
+	IS31FL3731_set_led_control( device, led.b - 0x24, blue );
+}
 
-	g_led_control_registers_update_required = true;
+void IS31FL3731_update_pwm_buffers( void )
+{
+	for ( int i = 0; i < DRIVER_COUNT; i++ )
+	{
+		IS31FL3731_update( &g_is31_devices[i] );
+	}
+}
 
+bool IS31FL3731_busy_all( void )
+{
+	for ( int i = 0; i < DRIVER_COUNT; i++ )
+	{
+		if ( IS31FL3731_busy( &g_is31_devices[i] ) ) {
+			return true;
+		}
+	}
+	return false;
 }
 
-void IS31FL3731_update_pwm_buffers( uint8_t addr1, uint8_t addr2 )
+bool IS31FL3731_shutdown_all( bool shutdown )
 {
-	if ( g_pwm_buffer_update_required )
+	bool done = true;
+	for ( int i = 0; i < DRIVER_COUNT; i++ )
 	{
-		IS31FL3731_write_pwm_buffer( addr1, g_pwm_buffer[0] );
-		IS31FL3731_write_pwm_buffer( addr2, g_pwm_buffer[1] );
+		done &= IS31FL3731_shutdown( &g_is31_devices[i], shutdown );
 	}
-	g_pwm_buffer_update_required = false;
+	return done;
 }
 
-void IS31FL3731_update_led_control_registers( uint8_t addr1, uint8_t addr2 )
+uint32_t IS31FL3731_pwm_total( void )
 {
-	if ( g_led_control_registers_update_required )
+	uint32_t total = 0;
+	for ( int i = 0; i < DRIVER_COUNT; i++ )
 	{
-		for ( int i=0; i<18; i++ )
-		{
-			IS31FL3731_write_register(addr1, i, g_led_control_registers[0][i] );
-			IS31FL3731_write_register(addr2, i, g_led_control_registers[1][i] );
-		}
+		total += g_is31_devices[i].pwm_total;
 	}
+	return total;
 }
 
+#endif
@@ -21,6 +21,89 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "i2c_master.h"
+
+// One IS31FL3731, double buffered with frames 0 and 1.
+//
+// The buffers hold the registers of the frame, and IS31FL3731_update sends
+// them to the frame that isn't displayed in one queued transaction. The PWM
+// registers go in a single auto-increment write straight from pwm[], and the
+// same transaction then displays the frame, so a frame is never shown while
+// it's being written. pwm[] isn't copied though, so a change made while it's
+// sent can show up in that frame already, with the rest of the changes in the
+// next one. Wait for IS31FL3731_busy to be false first if that matters.
+typedef struct is31_device {
+  uint8_t pwm[144];               // registers 0x24-0xB3
+  uint8_t control[18];            // registers 0x00-0x11
+  uint8_t addr;                   // 7-bit address
+  uint8_t frame;                  // the frame that is displayed
+  uint8_t control_frames;         // bits of the frames that need control[]
+  bool pwm_dirty;
+  uint8_t pending;                // what the transaction changes once it succeeded
+  bool animating;                 // the picture frames are on hold
+  bool shut_down;                 // in software shutdown
+  uint16_t pwm_total;             // sum of pwm[], for the current
+  uint8_t select_frame[2];
+  uint8_t show_frame[2];
+  uint8_t autoplay[3];
+  uint8_t breath[3];
+  uint8_t config[2];
+  uint8_t shutdown[2];
+  i2c_segment_t segments[7];
+  i2c_transaction_t transaction;
+} is31_device_t;
+
+i2c_status_t IS31FL3731_write_register( uint8_t addr, uint8_t reg, uint8_t data );
+
+// Sets up the chip and clears both frames. Returns false if it doesn't answer.
+bool IS31FL3731_init_device( is31_device_t *device, uint8_t addr );
+
+// index is the PWM register minus 0x24, which is also the bit of the control registers
+void IS31FL3731_set_pwm( is31_device_t *device, uint8_t index, uint8_t value );
+void IS31FL3731_set_led_control( is31_device_t *device, uint8_t index, bool on );
+// Sends everything again, after the chip has lost it
+void IS31FL3731_invalidate( is31_device_t *device );
+
+// Starts sending the buffers if they changed, and returns false if the
+// previous frame is still being sent. It doesn't wait, so this can be called
+// every scan, but not from an interrupt.
+bool IS31FL3731_update( is31_device_t *device );
+bool IS31FL3731_busy( is31_device_t *device );
+
+// Software shutdown turns off the current sinks and the oscillator, so the
+// chip only draws a few uA, but keeps all registers. Nothing is sent while
+// it's shut down, and waking it up shows the last frame again, or carries
+// on with the animation. Like IS31FL3731_update, this doesn't wait. It
+// returns true once the chip has taken the change, so it has to be called
+// again until then, which also sends it again if it failed.
+bool IS31FL3731_shutdown( is31_device_t *device, bool shutdown );
+
+// The chip can also play frames 2-7 by itself, with its own breathing.
+//
+// Each animation frame is written from the buffers, like a picture frame but
+// without displaying it, and IS31FL3731_play then loops through them until
+// IS31FL3731_stop goes back to the picture frames. From the first animation
+// frame until then, IS31FL3731_update doesn't send anything, so the buffers
+// can change without any bus traffic.
+// These don't wait either, and return false while the bus is busy with the
+// device's previous transaction. IS31FL3731_stop returns true once the chip
+// is back on the picture frames, like IS31FL3731_shutdown.
+#define IS31FL3731_ANIMATION_FRAMES 6
+
+typedef struct {
+  uint8_t frames;                 // 1-6
+  uint8_t frame_delay;            // how long each frame is shown, in 11ms steps, 1-64
+  uint8_t fade_in;                // breathing, 26ms << fade_in, 0-7
+  uint8_t fade_out;               // 26ms << fade_out, 0-7
+  uint8_t extinguish;             // how long it stays off, 3.5ms << extinguish, 0-7
+  bool breathe;
+} is31_animation_t;
+
+bool IS31FL3731_write_animation_frame( is31_device_t *device, uint8_t index );
+bool IS31FL3731_play( is31_device_t *device, const is31_animation_t *animation );
+bool IS31FL3731_stop( is31_device_t *device );
+
+#ifdef DRIVER_LED_TOTAL
 
 typedef struct is31_led {
 	uint8_t driver:2;
@@ -30,22 +113,21 @@ typedef struct is31_led {
 } __attribute__((packed)) is31_led;
 
 extern const is31_led g_is31_leds[DRIVER_LED_TOTAL];
-
-void IS31FL3731_init( uint8_t addr );
-void IS31FL3731_write_register( uint8_t addr, uint8_t reg, uint8_t data );
-void IS31FL3731_write_pwm_buffer( uint8_t addr, uint8_t *pwm_buffer );
+extern is31_device_t g_is31_devices[DRIVER_COUNT];
 
 void IS31FL3731_set_color( int index, uint8_t red, uint8_t green, uint8_t blue );
 void IS31FL3731_set_color_all( uint8_t red, uint8_t green, uint8_t blue );
 
 void IS31FL3731_set_led_control_register( uint8_t index, bool red, bool green, bool blue );
 
-// This should not be called from an interrupt
-// (eg. from a timer interrupt).
-// Call this while idle (in between matrix scans).
-// If the buffer is dirty, it will update the driver with the buffer.
-void IS31FL3731_update_pwm_buffers( uint8_t addr1, uint8_t addr2 );
-void IS31FL3731_update_led_control_registers( uint8_t addr1, uint8_t addr2 );
+// Sends the changed PWM and LED control registers of all drivers
+void IS31FL3731_update_pwm_buffers( void );
+bool IS31FL3731_busy_all( void );
+// Returns false while one of the drivers is busy, so it has to be called again
+bool IS31FL3731_shutdown_all( bool shutdown );
+uint32_t IS31FL3731_pwm_total( void );
+
+#endif
 
 #define C1_1  0x24
 #define C1_2  0x25
@@ -0,0 +1,337 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <string.h>
+#include <avr/io.h>
+#include <util/atomic.h>
+#include "topre_matrix.h"
+#include "wait.h"
+#include "timer.h"
+#include "print.h"
+#include "eeconfig.h"
+
+#define TOPRE_KEYS (MATRIX_ROWS * MATRIX_COLS)
+
+#if TOPRE_KEYS > 256
+#   error "The Topre matrix can have at most 256 keys."
+#endif
+
+#if (1000000/TIMER_RAW_FREQ > TOPRE_WINDOW_US)
+#   error "Timer resolution is not enough for the Topre key window."
+#endif
+
+#define WINDOW_TICKS (TOPRE_WINDOW_US * (TIMER_RAW_FREQ / 1000) / 1000)
+
+// V-USB can't wait for the window, so it can be left open to interrupts
+#ifdef TOPRE_MATRIX_NO_ATOMIC
+#   define KEY_WINDOW
+#else
+#   define KEY_WINDOW ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#endif
+
+static topre_matrix_stats_t stats;
+static uint32_t stats_since;
+
+static uint8_t retry[TOPRE_RETRY_SIZE];
+static uint8_t num_retries;
+
+#ifdef TOPRE_THRESHOLD_LEVELS
+static uint8_t threshold[MATRIX_ROWS][MATRIX_COLS];
+static uint8_t base_level;
+static int16_t current_level = -1;
+static bool has_thresholds;
+
+// Only writes the level when it changes, as that can take a while
+static void set_level(uint8_t level) {
+    if (level != current_level) {
+        topre_matrix_set_level(level);
+        current_level = level;
+    }
+}
+#endif
+
+// TIMER_RAW counts up to TIMER_RAW_TOP and starts over
+static inline uint8_t raw_elapsed(uint8_t start) {
+    uint8_t now = TIMER_RAW;
+    return now >= start ? now - start : now + (TIMER_RAW_TOP + 1 - start);
+}
+
+// Returns false when the key wasn't read in time
+static bool sample(uint8_t row, uint8_t col, bool hys, bool* on) {
+    bool valid = false;
+
+    topre_matrix_select(row, col);
+    wait_us(TOPRE_SELECT_US);
+    if (hys) {
+        topre_matrix_hys(true);
+    }
+    wait_us(TOPRE_HYS_US);
+
+    KEY_WINDOW {
+        uint8_t start = TIMER_RAW;
+        topre_matrix_enable(true);
+        wait_us(TOPRE_SETTLE_US);
+        *on = topre_matrix_key_on();
+        valid = raw_elapsed(start) <= WINDOW_TICKS;
+    }
+
+    wait_us(TOPRE_HOLD_US);
+    topre_matrix_hys(false);
+    topre_matrix_enable(false);
+    wait_us(TOPRE_IDLE_US);
+    return valid;
+}
+
+static void scan_key(matrix_row_t* matrix, const matrix_row_t* matrix_prev, uint8_t row, uint8_t col) {
+    matrix_row_t mask = (matrix_row_t)1 << col;
+    bool on;
+
+    stats.samples++;
+    if (!sample(row, col, matrix_prev[row] & mask, &on)) {
+        stats.overruns++;
+        if (num_retries < TOPRE_RETRY_SIZE) {
+            retry[num_retries++] = row * MATRIX_COLS + col;
+        } else {
+            stats.kept++;
+        }
+        return;
+    }
+    if (on) {
+        matrix[row] |= mask;
+    } else {
+        matrix[row] &= ~mask;
+    }
+}
+
+// Samples the keys that overran again, the ones that are added back are
+// never ahead of the one that is read
+static void scan_retries(matrix_row_t* matrix, const matrix_row_t* matrix_prev) {
+    for (uint8_t round = 0; round < TOPRE_RETRIES && num_retries; round++) {
+        uint8_t count = num_retries;
+        num_retries = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            uint8_t key = retry[i];
+            scan_key(matrix, matrix_prev, key / MATRIX_COLS, key % MATRIX_COLS);
+        }
+    }
+    stats.kept += num_retries;
+    num_retries = 0;
+}
+
+static void scan_keys(matrix_row_t* matrix, const matrix_row_t* matrix_prev, uint8_t level) {
+#ifdef TOPRE_THRESHOLD_LEVELS
+    if (has_thresholds) {
+        set_level(level);
+    }
+#endif
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+#ifdef TOPRE_THRESHOLD_LEVELS
+            if (has_thresholds && threshold[row][col] != level) {
+                continue;
+            }
+#endif
+            scan_key(matrix, matrix_prev, row, col);
+        }
+    }
+    scan_retries(matrix, matrix_prev);
+}
+
+// The lowest threshold above last, or -1 when all have been scanned. Without
+// thresholds, all keys are scanned once at level 0.
+static int16_t next_threshold(int16_t last) {
+#ifdef TOPRE_THRESHOLD_LEVELS
+    if (has_thresholds) {
+        int16_t next = -1;
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                int16_t t = threshold[row][col];
+                if (t > last && (next < 0 || t < next)) {
+                    next = t;
+                }
+            }
+        }
+        return next;
+    }
+#endif
+    return last < 0 ? 0 : -1;
+}
+
+void topre_matrix_init(void) {
+    topre_matrix_init_pins();
+    topre_matrix_hys(false);
+    topre_matrix_enable(false);
+    num_retries = 0;
+    topre_matrix_clear_stats();
+}
+
+bool topre_matrix_scan(matrix_row_t* matrix, const matrix_row_t* matrix_prev) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        matrix[row] = matrix_prev[row];
+    }
+
+    uint8_t count = 0;
+    int16_t level = -1;
+    while ((level = next_threshold(level)) >= 0) {
+        scan_keys(matrix, matrix_prev, level);
+        count++;
+    }
+    stats.thresholds = count;
+    stats.scans++;
+
+    bool changed = false;
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        if (matrix[row] != matrix_prev[row]) {
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+#ifdef TOPRE_THRESHOLD_LEVELS
+static uint8_t clamp_level(int16_t level) {
+    if (level < 0) {
+        return 0;
+    }
+    if (level > TOPRE_THRESHOLD_LEVELS - 1) {
+        return TOPRE_THRESHOLD_LEVELS - 1;
+    }
+    return level;
+}
+
+// Turns the level where each key reads off into its threshold, in place
+static void set_thresholds(void) {
+    uint8_t* levels = &threshold[0][0];
+    uint16_t sum = 0;
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < TOPRE_KEYS; i++) {
+        if (levels[i] != TOPRE_LEVEL_UNKNOWN) {
+            sum += levels[i];
+            count++;
+        }
+    }
+    int16_t offset = count ? base_level - (int16_t)((sum + count / 2) / count) : 0;
+
+    for (uint16_t i = 0; i < TOPRE_KEYS; i++) {
+        if (levels[i] == TOPRE_LEVEL_UNKNOWN) {
+            levels[i] = base_level;
+            continue;
+        }
+        int16_t t = levels[i] + offset;
+        if (t < levels[i] + TOPRE_THRESHOLD_MARGIN) {
+            t = levels[i] + TOPRE_THRESHOLD_MARGIN;
+        }
+        // Rounded up to a step from the base level, so that it's one of them
+        int16_t d = t - base_level;
+        if (d > 0) {
+            d = (d + TOPRE_THRESHOLD_STEP - 1) / TOPRE_THRESHOLD_STEP * TOPRE_THRESHOLD_STEP;
+        } else {
+            d = d / TOPRE_THRESHOLD_STEP * TOPRE_THRESHOLD_STEP;
+        }
+        levels[i] = clamp_level(base_level + d);
+    }
+    has_thresholds = true;
+}
+
+static bool load_thresholds(void) {
+    uint8_t* levels = &threshold[0][0];
+    bool calibrated = eeconfig_read_topre(levels, TOPRE_KEYS);
+    if (!calibrated) {
+        memset(levels, TOPRE_LEVEL_UNKNOWN, TOPRE_KEYS);
+    }
+    set_thresholds();
+    return calibrated;
+}
+
+void topre_matrix_threshold_init(uint8_t level) {
+    base_level = clamp_level(level);
+    if (!load_thresholds()) {
+        topre_matrix_calibrate();
+    }
+}
+
+void topre_matrix_set_threshold(uint8_t level) {
+    base_level = clamp_level(level);
+    load_thresholds();
+}
+
+uint8_t topre_matrix_get_threshold(void) {
+    return base_level;
+}
+
+uint8_t topre_matrix_key_threshold(uint8_t row, uint8_t col) {
+    return has_thresholds ? threshold[row][col] : base_level;
+}
+
+void topre_matrix_calibrate(void) {
+    uint8_t* levels = &threshold[0][0];
+    has_thresholds = false;
+    memset(levels, TOPRE_LEVEL_UNKNOWN, TOPRE_KEYS);
+
+    // A key that is on at every level is pressed, or broken, and gets the base level
+    for (uint8_t level = 0; level < TOPRE_THRESHOLD_LEVELS; level++) {
+        set_level(level);
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                uint8_t* key = &threshold[row][col];
+                if (*key != TOPRE_LEVEL_UNKNOWN) {
+                    continue;
+                }
+                for (uint8_t i = 0; i <= TOPRE_RETRIES; i++) {
+                    bool on;
+                    if (sample(row, col, false, &on)) {
+                        if (!on) {
+                            *key = level;
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    eeconfig_update_topre(levels, TOPRE_KEYS);
+    set_thresholds();
+}
+#endif
+
+uint16_t topre_matrix_scan_rate(void) {
+    uint32_t elapsed = timer_elapsed32(stats_since);
+    if (elapsed == 0) {
+        return 0;
+    }
+    if (stats.scans < UINT32_MAX / 1000) {
+        return stats.scans * 1000 / elapsed;
+    }
+    return stats.scans / (elapsed / 1000);
+}
+
+const topre_matrix_stats_t* topre_matrix_stats(void) {
+    return &stats;
+}
+
+void topre_matrix_clear_stats(void) {
+    memset(&stats, 0, sizeof(stats));
+    stats_since = timer_read32();
+}
+
+void topre_matrix_print_stats(void) {
+#ifndef NO_PRINT
+    print("\n\t- Topre matrix -\n");
+    xprintf("scans/s: %u, thresholds: %u\n", topre_matrix_scan_rate(), stats.thresholds);
+    xprintf("samples: %lu, overruns: %lu, kept: %u\n", stats.samples, stats.overruns, stats.kept);
+#endif
+}
@@ -0,0 +1,138 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TOPRE_MATRIX_H
+#define TOPRE_MATRIX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix.h"
+
+/* Scanning of Topre capacitive matrices
+ *
+ * The Topre controller compares the capacitance of the selected key with a
+ * threshold, which is lower when the hysteresis input is set, so a key that
+ * was on before is held with a little less pressure. Its output is only
+ * valid for 20us after the key is enabled, so enabling and reading the key is
+ * done with interrupts disabled. A key that still takes too long is sampled
+ * again at the end of the scan, and only keeps its old state when that fails
+ * TOPRE_RETRIES times.
+ *
+ * When the keyboard can set the threshold, with a digital potentiometer for
+ * example, each key gets its own. topre_matrix_threshold_init finds the
+ * lowest level where each key reads off when it's not pressed, or reads them
+ * from eeconfig, and the thresholds are that far above it, so all keys
+ * actuate at about the same depth, on average at the level that's set. The
+ * scan goes through the keys once for each different threshold, so they are
+ * rounded to TOPRE_THRESHOLD_STEP to keep that low.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Delays of a key, in microseconds
+#ifndef TOPRE_SELECT_US
+#define TOPRE_SELECT_US 2
+#endif
+// After setting the hysteresis, before enabling the key
+#ifndef TOPRE_HYS_US
+#define TOPRE_HYS_US 10
+#endif
+// From enabling the key to reading it
+#ifndef TOPRE_SETTLE_US
+#define TOPRE_SETTLE_US 2
+#endif
+// After reading, before disabling the key
+#ifndef TOPRE_HOLD_US
+#define TOPRE_HOLD_US 5
+#endif
+// The output takes this long to go back to idle
+#ifndef TOPRE_IDLE_US
+#define TOPRE_IDLE_US 75
+#endif
+// How long the output is valid after enabling the key
+#ifndef TOPRE_WINDOW_US
+#define TOPRE_WINDOW_US 20
+#endif
+
+// Keys that can wait for another sample in one scan
+#ifndef TOPRE_RETRY_SIZE
+#define TOPRE_RETRY_SIZE 8
+#endif
+#ifndef TOPRE_RETRIES
+#define TOPRE_RETRIES 3
+#endif
+
+#ifdef TOPRE_THRESHOLD_LEVELS
+#ifndef TOPRE_THRESHOLD_STEP
+#define TOPRE_THRESHOLD_STEP 4
+#endif
+// The least a threshold can be above the level where the key reads off
+#ifndef TOPRE_THRESHOLD_MARGIN
+#define TOPRE_THRESHOLD_MARGIN 2
+#endif
+#endif
+
+// A key that read on at every level
+#define TOPRE_LEVEL_UNKNOWN 0xFF
+
+typedef struct {
+    uint32_t scans;
+    uint32_t samples;
+    uint32_t overruns;    // samples that weren't read in TOPRE_WINDOW_US
+    uint16_t kept;        // keys that kept their old state
+    uint8_t thresholds;   // different thresholds in a scan
+} topre_matrix_stats_t;
+
+// Implemented by the keyboard. The key is selected while it's disabled.
+void topre_matrix_init_pins(void);
+void topre_matrix_select(uint8_t row, uint8_t col);
+void topre_matrix_hys(bool on);
+void topre_matrix_enable(bool on);
+bool topre_matrix_key_on(void);
+#ifdef TOPRE_THRESHOLD_LEVELS
+// A higher level means the key has to be pressed deeper
+void topre_matrix_set_level(uint8_t level);
+#endif
+
+void topre_matrix_init(void);
+// Scans all keys into matrix, with matrix_prev for the hysteresis and the
+// keys that couldn't be read. Returns true when a key changed.
+bool topre_matrix_scan(matrix_row_t* matrix, const matrix_row_t* matrix_prev);
+
+#ifdef TOPRE_THRESHOLD_LEVELS
+// Sets the average threshold, and calibrates the keys when eeconfig has nothing yet
+void topre_matrix_threshold_init(uint8_t level);
+void topre_matrix_set_threshold(uint8_t level);
+uint8_t topre_matrix_get_threshold(void);
+uint8_t topre_matrix_key_threshold(uint8_t row, uint8_t col);
+// Finds the level where each key reads off again, and saves it. No key should be pressed.
+void topre_matrix_calibrate(void);
+#endif
+
+// Scans per second since the stats were cleared
+uint16_t topre_matrix_scan_rate(void);
+const topre_matrix_stats_t* topre_matrix_stats(void);
+void topre_matrix_clear_stats(void);
+void topre_matrix_print_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
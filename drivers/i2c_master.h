@@ -0,0 +1,108 @@
+/* Library made by: g4lvanix
+ * Github repository: https://github.com/g4lvanix/I2C-master-lib
+ */
+
+#ifndef I2C_MASTER_H
+#define I2C_MASTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define I2C_READ 0x01
+#define I2C_WRITE 0x00
+
+typedef int16_t i2c_status_t;
+
+#define I2C_STATUS_SUCCESS (0)
+#define I2C_STATUS_ERROR   (-1)
+#define I2C_STATUS_TIMEOUT (-2)
+#define I2C_STATUS_PENDING (1)
+
+#define I2C_TIMEOUT_IMMEDIATE (0)
+#define I2C_TIMEOUT_INFINITE (0xFFFF)
+
+// Transactions waiting for the bus, a power of two
+#ifndef I2C_QUEUE_SIZE
+#define I2C_QUEUE_SIZE 8
+#endif
+
+/* Queued transactions
+ *
+ * A transaction is a list of segments, which are sent to one device without
+ * releasing the bus. Segments in the same direction are joined into one
+ * transfer, so a register address and the data can come from different
+ * buffers. A change of direction, or I2C_SEGMENT_RESTART, sends a repeated
+ * start with the address again.
+ *
+ * The transaction and the segments belong to the caller, and must stay valid
+ * until the status is no longer I2C_STATUS_PENDING. The callback is called
+ * when it's done, from the interrupt on AVR and from the I2C thread on
+ * ChibiOS, and can submit the next transaction.
+ */
+
+#define I2C_SEGMENT_READ    0x01
+#define I2C_SEGMENT_RESTART 0x02
+
+typedef struct {
+    uint8_t* data;
+    uint16_t length;
+    uint8_t flags;
+} i2c_segment_t;
+
+#define I2C_WRITE_SEGMENT(data, length) { (data), (length), 0 }
+#define I2C_READ_SEGMENT(data, length) { (data), (length), I2C_SEGMENT_READ }
+
+struct i2c_transaction;
+typedef void (*i2c_callback_t)(struct i2c_transaction* transaction);
+
+typedef struct i2c_transaction {
+    uint8_t address;              // with the read bit clear, like i2c_transmit
+    uint8_t num_segments;
+    i2c_segment_t* segments;
+    i2c_callback_t callback;      // can be NULL
+    void* context;
+    volatile i2c_status_t status;
+} i2c_transaction_t;
+
+void i2c_init(void);
+
+// Queues the transaction, and returns I2C_STATUS_PENDING, or I2C_STATUS_ERROR when the queue is full
+i2c_status_t i2c_submit(i2c_transaction_t* transaction);
+// Waits for the transaction. On a timeout, it's taken off the queue and fails with I2C_STATUS_TIMEOUT,
+// the rest of the queue carries on.
+i2c_status_t i2c_wait(i2c_transaction_t* transaction, uint16_t timeout);
+// Waits until the queue is empty
+i2c_status_t i2c_flush(uint16_t timeout);
+bool i2c_idle(void);
+// Stops the current transaction, and fails everything that is queued with I2C_STATUS_TIMEOUT
+void i2c_reset(void);
+
+// Blocking transfers, which go through the queue
+i2c_status_t i2c_transmit(uint8_t address, uint8_t* data, uint16_t length, uint16_t timeout);
+i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16_t timeout);
+i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout);
+i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout);
+
+// Byte by byte transfers, only on AVR. i2c_start waits for the queue to be empty,
+// and nothing should be submitted until i2c_stop.
+i2c_status_t i2c_start(uint8_t address, uint16_t timeout);
+i2c_status_t i2c_write(uint8_t data, uint16_t timeout);
+int16_t i2c_read_ack(uint16_t timeout);
+int16_t i2c_read_nack(uint16_t timeout);
+i2c_status_t i2c_stop(uint16_t timeout);
+
+/* Implemented by the backends for i2c_queue.c
+ *
+ * i2c_backend_start is called with the lock held, or from i2c_backend_done,
+ * and the backend calls i2c_backend_done once for each started transaction,
+ * unless it was aborted.
+ */
+void i2c_backend_init(void);
+void i2c_backend_start(i2c_transaction_t* transaction);
+void i2c_backend_abort(void);
+void i2c_backend_lock(void);
+void i2c_backend_unlock(void);
+
+void i2c_backend_done(i2c_transaction_t* transaction, i2c_status_t status);
+
+#endif // I2C_MASTER_H
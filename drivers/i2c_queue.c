@@ -0,0 +1,228 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/* Transaction queue of the I2C master
+ *
+ * Transactions are queued in a ring, which is pushed here and popped when the
+ * backend is done with the oldest one. Both happen with the backend's lock
+ * held, which keeps out the backend's interrupt. The backend only ever sees
+ * the oldest transaction, so the ring keeps the order. The blocking functions
+ * of the old API submit a transaction from the stack and wait for it. On a
+ * timeout the transaction is taken off the ring, as the stack goes away.
+ */
+
+#include "i2c_master.h"
+#include "spsc_ring.h"
+#include "timer.h"
+
+// A typedef, so that the ring's const applies to the pointer
+typedef i2c_transaction_t* i2c_transaction_ptr_t;
+SPSC_RING(i2c_queue, i2c_transaction_ptr_t, I2C_QUEUE_SIZE)
+
+static i2c_queue_t queue;
+// The backend has the oldest transaction of the queue
+static volatile bool running = false;
+
+void i2c_init(void)
+{
+  i2c_backend_init();
+  i2c_backend_lock();
+  i2c_queue_clear(&queue);
+  running = false;
+  i2c_backend_unlock();
+}
+
+i2c_status_t i2c_submit(i2c_transaction_t* transaction)
+{
+  transaction->status = I2C_STATUS_PENDING;
+
+  // Callbacks can submit too, so the lock is needed for the push as well
+  i2c_backend_lock();
+  if (!i2c_queue_push(&queue, &transaction)) {
+    i2c_backend_unlock();
+    transaction->status = I2C_STATUS_ERROR;
+    return I2C_STATUS_ERROR;
+  }
+  i2c_transaction_t* first;
+  if (!running && i2c_queue_peek(&queue, &first)) {
+    running = true;
+    i2c_backend_start(first);
+  }
+  i2c_backend_unlock();
+  return I2C_STATUS_PENDING;
+}
+
+void i2c_backend_done(i2c_transaction_t* transaction, i2c_status_t status)
+{
+  i2c_transaction_t* current;
+
+  i2c_backend_lock();
+  // An aborted transaction has already been taken off the queue
+  if (!running || !i2c_queue_peek(&queue, &current) || current != transaction) {
+    i2c_backend_unlock();
+    return;
+  }
+  i2c_queue_pop(&queue, &current);
+  transaction->status = status;
+  // Keep the bus busy while the callback runs
+  i2c_transaction_t* next;
+  if (i2c_queue_peek(&queue, &next)) {
+    i2c_backend_start(next);
+  } else {
+    running = false;
+  }
+  i2c_backend_unlock();
+
+  if (transaction->callback) {
+    transaction->callback(transaction);
+  }
+}
+
+void i2c_reset(void)
+{
+  i2c_transaction_t* failed[I2C_QUEUE_SIZE];
+
+  i2c_backend_lock();
+  if (running) {
+    i2c_backend_abort();
+    running = false;
+  }
+  uint8_t count = i2c_queue_pop_bulk(&queue, failed, I2C_QUEUE_SIZE);
+  i2c_backend_unlock();
+
+  for (uint8_t i = 0; i < count; i++) {
+    failed[i]->status = I2C_STATUS_TIMEOUT;
+    if (failed[i]->callback) {
+      failed[i]->callback(failed[i]);
+    }
+  }
+}
+
+bool i2c_idle(void)
+{
+  return !running;
+}
+
+// Takes the transaction off the queue, and aborts it if the backend has it.
+// Returns false if it was already done.
+static bool i2c_remove(i2c_transaction_t* transaction)
+{
+  i2c_transaction_t* queued[I2C_QUEUE_SIZE];
+  bool found = false;
+
+  i2c_backend_lock();
+  uint8_t count = i2c_queue_pop_bulk(&queue, queued, I2C_QUEUE_SIZE);
+  for (uint8_t i = 0; i < count; i++) {
+    if (queued[i] != transaction) {
+      i2c_queue_push(&queue, &queued[i]);
+    } else {
+      found = true;
+      if (i == 0 && running) {
+        i2c_backend_abort();
+        running = false;
+      }
+    }
+  }
+  i2c_transaction_t* next;
+  if (!running && i2c_queue_peek(&queue, &next)) {
+    running = true;
+    i2c_backend_start(next);
+  }
+  i2c_backend_unlock();
+  return found;
+}
+
+i2c_status_t i2c_wait(i2c_transaction_t* transaction, uint16_t timeout)
+{
+  uint16_t timeout_timer = timer_read();
+  while (transaction->status == I2C_STATUS_PENDING) {
+    if ((timeout != I2C_TIMEOUT_INFINITE) && (timer_elapsed(timeout_timer) >= timeout)) {
+      if (i2c_remove(transaction)) {
+        transaction->status = I2C_STATUS_TIMEOUT;
+        if (transaction->callback) {
+          transaction->callback(transaction);
+        }
+      }
+      break;
+    }
+  }
+  return transaction->status;
+}
+
+i2c_status_t i2c_flush(uint16_t timeout)
+{
+  uint16_t timeout_timer = timer_read();
+  while (running) {
+    if ((timeout != I2C_TIMEOUT_INFINITE) && (timer_elapsed(timeout_timer) >= timeout)) {
+      i2c_reset();
+      return I2C_STATUS_TIMEOUT;
+    }
+  }
+  return I2C_STATUS_SUCCESS;
+}
+
+static i2c_status_t i2c_run(uint8_t address, i2c_segment_t* segments, uint8_t num_segments, uint16_t timeout)
+{
+  i2c_transaction_t transaction = {
+    .address = address & ~I2C_READ,
+    .num_segments = num_segments,
+    .segments = segments,
+  };
+
+  // Wait for room in the queue
+  uint16_t timeout_timer = timer_read();
+  while (i2c_submit(&transaction) != I2C_STATUS_PENDING) {
+    if ((timeout != I2C_TIMEOUT_INFINITE) && (timer_elapsed(timeout_timer) >= timeout)) {
+      return I2C_STATUS_TIMEOUT;
+    }
+  }
+  return i2c_wait(&transaction, timeout);
+}
+
+i2c_status_t i2c_transmit(uint8_t address, uint8_t* data, uint16_t length, uint16_t timeout)
+{
+  i2c_segment_t segments[] = {
+    I2C_WRITE_SEGMENT(data, length),
+  };
+  return i2c_run(address, segments, 1, timeout);
+}
+
+i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16_t timeout)
+{
+  i2c_segment_t segments[] = {
+    I2C_READ_SEGMENT(data, length),
+  };
+  return i2c_run(address, segments, 1, timeout);
+}
+
+i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout)
+{
+  i2c_segment_t segments[] = {
+    I2C_WRITE_SEGMENT(&regaddr, 1),
+    I2C_WRITE_SEGMENT(data, length),
+  };
+  return i2c_run(devaddr, segments, 2, timeout);
+}
+
+i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout)
+{
+  i2c_segment_t segments[] = {
+    I2C_WRITE_SEGMENT(&regaddr, 1),
+    I2C_READ_SEGMENT(data, length),
+  };
+  return i2c_run(devaddr, segments, 2, timeout);
+}
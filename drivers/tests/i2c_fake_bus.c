@@ -0,0 +1,171 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <string.h>
+#include "i2c_fake_bus.h"
+
+static i2c_fake_device_t devices[I2C_FAKE_BUS_DEVICES];
+static uint8_t num_devices = 0;
+static i2c_transaction_t* current = NULL;
+static bool stalled = false;
+static bool locked = false;
+static i2c_fake_bus_stats_t stats;
+
+void i2c_fake_bus_clear(void)
+{
+  num_devices = 0;
+  current = NULL;
+  stalled = false;
+  locked = false;
+  memset(&stats, 0, sizeof(stats));
+}
+
+i2c_fake_device_t* i2c_fake_bus_add_device(uint8_t address)
+{
+  if (num_devices == I2C_FAKE_BUS_DEVICES) {
+    return NULL;
+  }
+  i2c_fake_device_t* device = &devices[num_devices++];
+  memset(device, 0, sizeof(*device));
+  device->address = address;
+  return device;
+}
+
+void i2c_fake_bus_stall(bool stall)
+{
+  stalled = stall;
+}
+
+i2c_transaction_t* i2c_fake_bus_current(void)
+{
+  return current;
+}
+
+bool i2c_fake_bus_locked(void)
+{
+  return locked;
+}
+
+const i2c_fake_bus_stats_t* i2c_fake_bus_stats(void)
+{
+  return &stats;
+}
+
+void i2c_backend_init(void)
+{
+  current = NULL;
+}
+
+void i2c_backend_start(i2c_transaction_t* transaction)
+{
+  current = transaction;
+}
+
+void i2c_backend_abort(void)
+{
+  current = NULL;
+  stats.stops++;
+}
+
+void i2c_backend_lock(void)
+{
+  locked = true;
+}
+
+void i2c_backend_unlock(void)
+{
+  locked = false;
+}
+
+static i2c_fake_device_t* find_device(uint8_t address)
+{
+  for (uint8_t i = 0; i < num_devices; i++) {
+    if (devices[i].address == address && !devices[i].nack) {
+      return &devices[i];
+    }
+  }
+  return NULL;
+}
+
+// Goes through the segments with the same rules as the TWI interrupt
+static i2c_status_t transfer(const i2c_transaction_t* transaction)
+{
+  i2c_fake_device_t* device = NULL;
+  bool reading = false;
+  bool first_write = false;
+  bool started = false;
+  bool restart = true;
+
+  stats.transactions++;
+  for (uint8_t i = 0; i < transaction->num_segments; i++) {
+    const i2c_segment_t* segment = &transaction->segments[i];
+    bool read = segment->flags & I2C_SEGMENT_READ;
+    if (started && (read != reading || (segment->flags & I2C_SEGMENT_RESTART))) {
+      restart = true;
+    }
+    if (segment->length == 0) {
+      continue;
+    }
+    if (restart) {
+      restart = false;
+      stats.starts++;
+      started = true;
+      reading = read;
+      first_write = !read;
+      device = find_device(transaction->address);
+      if (!device) {
+        stats.stops++;
+        return I2C_STATUS_ERROR;
+      }
+    }
+    for (uint16_t j = 0; j < segment->length; j++) {
+      if (reading) {
+        segment->data[j] = device->registers[device->pointer++];
+        stats.read++;
+      } else {
+        if (first_write) {
+          device->pointer = segment->data[j];
+          first_write = false;
+        } else {
+          device->registers[device->pointer++] = segment->data[j];
+        }
+        stats.written++;
+      }
+    }
+  }
+  if (!started) {
+    // Only the address
+    stats.starts++;
+    if (!find_device(transaction->address)) {
+      stats.stops++;
+      return I2C_STATUS_ERROR;
+    }
+  }
+  stats.stops++;
+  return I2C_STATUS_SUCCESS;
+}
+
+bool i2c_fake_bus_step(void)
+{
+  if (!current || stalled || locked) {
+    return false;
+  }
+  i2c_transaction_t* transaction = current;
+  current = NULL;
+  i2c_backend_done(transaction, transfer(transaction));
+  return true;
+}
@@ -0,0 +1,72 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef I2C_FAKE_BUS_H
+#define I2C_FAKE_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "i2c_master.h"
+
+/* An I2C backend for the native tests
+ *
+ * The devices on the bus have 256 registers. Like most I2C chips, the first
+ * byte that is written sets the register, and the following bytes are written
+ * and read from there, with the register incrementing after each byte.
+ *
+ * Transactions don't progress on their own. i2c_fake_bus_step completes the
+ * current one, as the interrupt would, and can't be called with the lock held.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef I2C_FAKE_BUS_DEVICES
+#define I2C_FAKE_BUS_DEVICES 4
+#endif
+
+typedef struct {
+    uint8_t address;       // 8 bit address, like i2c_transmit
+    bool nack;             // doesn't answer to its address
+    uint8_t pointer;
+    uint8_t registers[256];
+} i2c_fake_device_t;
+
+typedef struct {
+    uint16_t transactions;
+    uint16_t starts;       // including the repeated starts
+    uint16_t stops;
+    uint16_t written;      // data bytes, not counting the addresses
+    uint16_t read;
+} i2c_fake_bus_stats_t;
+
+void i2c_fake_bus_clear(void);
+i2c_fake_device_t* i2c_fake_bus_add_device(uint8_t address);
+// While stalled, transactions never complete, as with a stuck bus
+void i2c_fake_bus_stall(bool stall);
+// Completes the current transaction, and returns false if there was none
+bool i2c_fake_bus_step(void);
+i2c_transaction_t* i2c_fake_bus_current(void);
+bool i2c_fake_bus_locked(void);
+const i2c_fake_bus_stats_t* i2c_fake_bus_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,290 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "gtest/gtest.h"
+#include <vector>
+
+extern "C" {
+    #include "i2c_master.h"
+    #include "i2c_fake_bus.h"
+}
+
+static uint16_t fake_time = 0;
+// When set, the bus progresses while the blocking functions wait, like the interrupt would
+static bool bus_runs = false;
+
+extern "C" uint16_t timer_read(void) {
+    if (bus_runs) {
+        i2c_fake_bus_step();
+    }
+    return fake_time++;
+}
+
+extern "C" uint16_t timer_elapsed(uint16_t last) {
+    return timer_read() - last;
+}
+
+static std::vector<i2c_transaction_t*> completed;
+
+static void record(i2c_transaction_t* transaction) {
+    completed.push_back(transaction);
+}
+
+class I2CQueue : public testing::Test {
+public:
+    I2CQueue() {
+        fake_time = 0;
+        bus_runs = true;
+        completed.clear();
+        i2c_fake_bus_clear();
+        i2c_init();
+        device = i2c_fake_bus_add_device(0x40);
+    }
+    i2c_fake_device_t* device;
+};
+
+TEST_F(I2CQueue, TransmitWritesFromTheFirstByte) {
+    uint8_t data[] = {0x10, 1, 2, 3};
+    EXPECT_EQ(i2c_transmit(0x40, data, sizeof(data), 100), I2C_STATUS_SUCCESS);
+    EXPECT_EQ(device->registers[0x10], 1);
+    EXPECT_EQ(device->registers[0x11], 2);
+    EXPECT_EQ(device->registers[0x12], 3);
+    EXPECT_EQ(i2c_fake_bus_stats()->starts, 1);
+    EXPECT_EQ(i2c_fake_bus_stats()->stops, 1);
+}
+
+TEST_F(I2CQueue, WriteRegGathersTheRegisterAndTheData) {
+    uint8_t data[] = {4, 5};
+    EXPECT_EQ(i2c_writeReg(0x40, 0x20, data, sizeof(data), 100), I2C_STATUS_SUCCESS);
+    EXPECT_EQ(device->registers[0x20], 4);
+    EXPECT_EQ(device->registers[0x21], 5);
+    EXPECT_EQ(i2c_fake_bus_stats()->starts, 1);
+    EXPECT_EQ(i2c_fake_bus_stats()->written, 3);
+}
+
+TEST_F(I2CQueue, ReadRegUsesARepeatedStart) {
+    device->registers[0x30] = 7;
+    device->registers[0x31] = 8;
+    uint8_t data[2] = {0};
+    EXPECT_EQ(i2c_readReg(0x40, 0x30, data, sizeof(data), 100), I2C_STATUS_SUCCESS);
+    EXPECT_EQ(data[0], 7);
+    EXPECT_EQ(data[1], 8);
+    EXPECT_EQ(i2c_fake_bus_stats()->starts, 2);
+    EXPECT_EQ(i2c_fake_bus_stats()->stops, 1);
+}
+
+TEST_F(I2CQueue, MissingDeviceIsAnError) {
+    uint8_t data[] = {0x10, 1};
+    EXPECT_EQ(i2c_transmit(0x42, data, sizeof(data), 100), I2C_STATUS_ERROR);
+    device->nack = true;
+    EXPECT_EQ(i2c_transmit(0x40, data, sizeof(data), 100), I2C_STATUS_ERROR);
+    EXPECT_TRUE(i2c_idle());
+}
+
+TEST_F(I2CQueue, TransactionsCompleteInOrder) {
+    bus_runs = false;
+    uint8_t reg[3] = {0x00, 0x10, 0x20};
+    uint8_t values[3] = {1, 2, 3};
+    i2c_segment_t segments[3][2];
+    i2c_transaction_t transactions[3];
+    for (int i = 0; i < 3; i++) {
+        segments[i][0] = I2C_WRITE_SEGMENT(&reg[i], 1);
+        segments[i][1] = I2C_WRITE_SEGMENT(&values[i], 1);
+        transactions[i] = { 0x40, 2, segments[i], record, nullptr, 0 };
+        EXPECT_EQ(i2c_submit(&transactions[i]), I2C_STATUS_PENDING);
+    }
+    EXPECT_EQ(i2c_fake_bus_current(), &transactions[0]);
+    EXPECT_FALSE(i2c_idle());
+    while (i2c_fake_bus_step()) {}
+    ASSERT_EQ(completed.size(), 3u);
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(completed[i], &transactions[i]);
+        EXPECT_EQ(transactions[i].status, I2C_STATUS_SUCCESS);
+        EXPECT_EQ(device->registers[reg[i]], values[i]);
+    }
+    EXPECT_TRUE(i2c_idle());
+}
+
+static i2c_transaction_t chained;
+static uint8_t chained_data[] = {0x50, 9};
+static i2c_segment_t chained_segment = I2C_WRITE_SEGMENT(chained_data, 2);
+
+static void submit_chained(i2c_transaction_t* transaction) {
+    record(transaction);
+    chained = { 0x40, 1, &chained_segment, record, nullptr, 0 };
+    i2c_submit(&chained);
+}
+
+TEST_F(I2CQueue, CallbackCanSubmitTheNextTransaction) {
+    bus_runs = false;
+    uint8_t data[] = {0x40, 1};
+    i2c_segment_t segment = I2C_WRITE_SEGMENT(data, 2);
+    i2c_transaction_t first = { 0x40, 1, &segment, submit_chained, nullptr, 0 };
+    i2c_submit(&first);
+    EXPECT_TRUE(i2c_fake_bus_step());
+    EXPECT_FALSE(i2c_fake_bus_locked());
+    EXPECT_EQ(i2c_fake_bus_current(), &chained);
+    EXPECT_TRUE(i2c_fake_bus_step());
+    ASSERT_EQ(completed.size(), 2u);
+    EXPECT_EQ(completed[1], &chained);
+    EXPECT_EQ(device->registers[0x50], 9);
+    EXPECT_TRUE(i2c_idle());
+}
+
+TEST_F(I2CQueue, SubmitFailsWhenTheQueueIsFull) {
+    bus_runs = false;
+    uint8_t data[] = {0x00, 1};
+    i2c_segment_t segment = I2C_WRITE_SEGMENT(data, 2);
+    i2c_transaction_t transactions[I2C_QUEUE_SIZE + 1];
+    for (int i = 0; i < I2C_QUEUE_SIZE; i++) {
+        transactions[i] = { 0x40, 1, &segment, nullptr, nullptr, 0 };
+        EXPECT_EQ(i2c_submit(&transactions[i]), I2C_STATUS_PENDING);
+    }
+    transactions[I2C_QUEUE_SIZE] = { 0x40, 1, &segment, nullptr, nullptr, 0 };
+    EXPECT_EQ(i2c_submit(&transactions[I2C_QUEUE_SIZE]), I2C_STATUS_ERROR);
+    EXPECT_EQ(transactions[I2C_QUEUE_SIZE].status, I2C_STATUS_ERROR);
+    EXPECT_TRUE(i2c_fake_bus_step());
+    EXPECT_EQ(i2c_submit(&transactions[I2C_QUEUE_SIZE]), I2C_STATUS_PENDING);
+}
+
+TEST_F(I2CQueue, TimeoutFailsOnlyTheTransactionThatTimedOut) {
+    bus_runs = false;
+    uint8_t data[] = {0x00, 1};
+    i2c_segment_t segment = I2C_WRITE_SEGMENT(data, 2);
+    i2c_transaction_t queued = { 0x40, 1, &segment, record, nullptr, 0 };
+    i2c_submit(&queued);
+    i2c_fake_bus_stall(true);
+    bus_runs = true;
+    EXPECT_EQ(i2c_transmit(0x40, data, sizeof(data), 10), I2C_STATUS_TIMEOUT);
+    EXPECT_TRUE(completed.empty());
+    EXPECT_EQ(queued.status, I2C_STATUS_PENDING);
+    EXPECT_EQ(i2c_fake_bus_current(), &queued);
+
+    // The bus works again afterwards
+    bus_runs = false;
+    i2c_fake_bus_stall(false);
+    EXPECT_TRUE(i2c_fake_bus_step());
+    EXPECT_EQ(queued.status, I2C_STATUS_SUCCESS);
+    EXPECT_FALSE(i2c_fake_bus_step());
+    EXPECT_TRUE(i2c_idle());
+}
+
+TEST_F(I2CQueue, TimeoutAbortsTheCurrentTransactionAndStartsTheNext) {
+    bus_runs = false;
+    uint8_t data[] = {0x00, 1};
+    i2c_segment_t segment = I2C_WRITE_SEGMENT(data, 2);
+    i2c_transaction_t stuck = { 0x40, 1, &segment, record, nullptr, 0 };
+    i2c_transaction_t next = { 0x40, 1, &segment, record, nullptr, 0 };
+    i2c_submit(&stuck);
+    i2c_submit(&next);
+    i2c_fake_bus_stall(true);
+    EXPECT_EQ(i2c_wait(&stuck, 10), I2C_STATUS_TIMEOUT);
+    ASSERT_EQ(completed.size(), 1u);
+    EXPECT_EQ(completed[0], &stuck);
+    EXPECT_EQ(next.status, I2C_STATUS_PENDING);
+    EXPECT_EQ(i2c_fake_bus_current(), &next);
+
+    i2c_fake_bus_stall(false);
+    EXPECT_TRUE(i2c_fake_bus_step());
+    EXPECT_EQ(next.status, I2C_STATUS_SUCCESS);
+    EXPECT_TRUE(i2c_idle());
+}
+
+TEST_F(I2CQueue, ResetFailsEverythingQueued) {
+    bus_runs = false;
+    uint8_t data[] = {0x00, 1};
+    i2c_segment_t segment = I2C_WRITE_SEGMENT(data, 2);
+    i2c_transaction_t first = { 0x40, 1, &segment, record, nullptr, 0 };
+    i2c_transaction_t second = { 0x40, 1, &segment, record, nullptr, 0 };
+    i2c_submit(&first);
+    i2c_submit(&second);
+    i2c_reset();
+    ASSERT_EQ(completed.size(), 2u);
+    EXPECT_EQ(first.status, I2C_STATUS_TIMEOUT);
+    EXPECT_EQ(second.status, I2C_STATUS_TIMEOUT);
+    EXPECT_TRUE(i2c_idle());
+    EXPECT_EQ(i2c_fake_bus_current(), nullptr);
+}
+
+TEST_F(I2CQueue, CompletionOfAnAbortedTransactionIsIgnored) {
+    bus_runs = false;
+    uint8_t data[] = {0x00, 1};
+    i2c_segment_t segment = I2C_WRITE_SEGMENT(data, 2);
+    i2c_transaction_t aborted = { 0x40, 1, &segment, record, nullptr, 0 };
+    i2c_transaction_t next = { 0x40, 1, &segment, record, nullptr, 0 };
+    i2c_submit(&aborted);
+    i2c_reset();
+    i2c_submit(&next);
+    i2c_backend_done(&aborted, I2C_STATUS_SUCCESS);
+    EXPECT_EQ(aborted.status, I2C_STATUS_TIMEOUT);
+    EXPECT_EQ(next.status, I2C_STATUS_PENDING);
+    EXPECT_TRUE(i2c_fake_bus_step());
+    EXPECT_EQ(next.status, I2C_STATUS_SUCCESS);
+}
+
+TEST_F(I2CQueue, ReadsScatterIntoSegments) {
+    for (int i = 0; i < 6; i++) {
+        device->registers[0x60 + i] = 0xA0 + i;
+    }
+    uint8_t reg = 0x60;
+    uint8_t first[2];
+    uint8_t second[4];
+    i2c_segment_t segments[] = {
+        I2C_WRITE_SEGMENT(&reg, 1),
+        I2C_READ_SEGMENT(first, 2),
+        I2C_READ_SEGMENT(second, 4),
+    };
+    i2c_transaction_t transaction = { 0x40, 3, segments, nullptr, nullptr, 0 };
+    i2c_submit(&transaction);
+    EXPECT_EQ(i2c_wait(&transaction, 100), I2C_STATUS_SUCCESS);
+    EXPECT_EQ(first[0], 0xA0);
+    EXPECT_EQ(first[1], 0xA1);
+    EXPECT_EQ(second[0], 0xA2);
+    EXPECT_EQ(second[3], 0xA5);
+    EXPECT_EQ(i2c_fake_bus_stats()->starts, 2);
+}
+
+TEST_F(I2CQueue, RestartFlagStartsANewWrite) {
+    uint8_t first[] = {0x70, 1};
+    uint8_t second[] = {0x78, 2};
+    i2c_segment_t segments[] = {
+        I2C_WRITE_SEGMENT(first, 2),
+        { second, 2, I2C_SEGMENT_RESTART },
+    };
+    i2c_transaction_t transaction = { 0x40, 2, segments, nullptr, nullptr, 0 };
+    i2c_submit(&transaction);
+    EXPECT_EQ(i2c_wait(&transaction, 100), I2C_STATUS_SUCCESS);
+    EXPECT_EQ(device->registers[0x70], 1);
+    EXPECT_EQ(device->registers[0x78], 2);
+    EXPECT_EQ(i2c_fake_bus_stats()->starts, 2);
+    EXPECT_EQ(i2c_fake_bus_stats()->stops, 1);
+}
+
+TEST_F(I2CQueue, FlushWaitsForTheQueue) {
+    uint8_t data[] = {0x00, 1};
+    i2c_segment_t segment = I2C_WRITE_SEGMENT(data, 2);
+    i2c_transaction_t transactions[3];
+    bus_runs = false;
+    for (int i = 0; i < 3; i++) {
+        transactions[i] = { 0x40, 1, &segment, record, nullptr, 0 };
+        i2c_submit(&transactions[i]);
+    }
+    bus_runs = true;
+    EXPECT_EQ(i2c_flush(100), I2C_STATUS_SUCCESS);
+    EXPECT_EQ(completed.size(), 3u);
+    EXPECT_TRUE(i2c_idle());
+}
@@ -0,0 +1,2 @@
+TEST_LIST +=\
+	i2c_queue
@@ -22,7 +22,6 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "Usb.h"
 #include "usbhub.h"
 #include "hid.h"
-#include "hidboot.h"
 #include "parser.h"
 
 #include "keycode.h"
@@ -56,34 +55,26 @@ extern "C" {
  *   : |                |
  *  16 +----------------+
  */
-#define ROW_MASK 0xF0
-#define COL_MASK 0x0F
 #define CODE(row, col)  (((row) << 4) | (col))
-#define ROW(code)       (((code) & ROW_MASK) >> 4)
-#define COL(code)       ((code) & COL_MASK)
-#define ROW_BITS(code)  (1 << COL(code))
 
 
-// Integrated key state of all keyboards
-static report_keyboard_t local_keyboard_report;
-
 static bool matrix_is_mod = false;
 
 /*
  * USB Host Shield HID keyboards
  * This supports two cascaded hubs and four keyboards
+ *
+ * The keyboards are kept in report protocol, so NKRO keyboards send all their
+ * keys. The keys of all of them are merged by nkro_merge, which passes on the
+ * changes one at a time in the order the reports came in.
  */
 USB usb_host;
 USBHub hub1(&usb_host);
 USBHub hub2(&usb_host);
-HIDBoot<HID_PROTOCOL_KEYBOARD>    kbd1(&usb_host);
-HIDBoot<HID_PROTOCOL_KEYBOARD>    kbd2(&usb_host);
-HIDBoot<HID_PROTOCOL_KEYBOARD>    kbd3(&usb_host);
-HIDBoot<HID_PROTOCOL_KEYBOARD>    kbd4(&usb_host);
-KBDReportParser kbd_parser1;
-KBDReportParser kbd_parser2;
-KBDReportParser kbd_parser3;
-KBDReportParser kbd_parser4;
+NKROKeyboard kbd1(&usb_host, 0);
+NKROKeyboard kbd2(&usb_host, 1);
+NKROKeyboard kbd3(&usb_host, 2);
+NKROKeyboard kbd4(&usb_host, 3);
 
 
 extern "C"
@@ -94,62 +85,10 @@ extern "C"
     void matrix_init(void) {
         // USB Host Shield setup
         usb_host.Init();
-        kbd1.SetReportParser(0, (HIDReportParser*)&kbd_parser1);
-        kbd2.SetReportParser(0, (HIDReportParser*)&kbd_parser2);
-        kbd3.SetReportParser(0, (HIDReportParser*)&kbd_parser3);
-        kbd4.SetReportParser(0, (HIDReportParser*)&kbd_parser4);
-    }
-
-    static void or_report(report_keyboard_t report) {
-        // integrate reports into local_keyboard_report
-        local_keyboard_report.mods |= report.mods;
-        for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
-            if (IS_ANY(report.keys[i])) {
-                for (uint8_t j = 0; j < KEYBOARD_REPORT_KEYS; j++) {
-                    if (! local_keyboard_report.keys[j]) {
-                        local_keyboard_report.keys[j] = report.keys[i];
-                        break;
-                    }
-                }
-            }
-        }
+        nkro_merge_clear();
     }
 
     uint8_t matrix_scan(void) {
-        static uint16_t last_time_stamp1 = 0;
-        static uint16_t last_time_stamp2 = 0;
-        static uint16_t last_time_stamp3 = 0;
-        static uint16_t last_time_stamp4 = 0;
-
-        // check report came from keyboards
-        if (kbd_parser1.time_stamp != last_time_stamp1 ||
-            kbd_parser2.time_stamp != last_time_stamp2 ||
-            kbd_parser3.time_stamp != last_time_stamp3 ||
-            kbd_parser4.time_stamp != last_time_stamp4) {
-
-            last_time_stamp1 = kbd_parser1.time_stamp;
-            last_time_stamp2 = kbd_parser2.time_stamp;
-            last_time_stamp3 = kbd_parser3.time_stamp;
-            last_time_stamp4 = kbd_parser4.time_stamp;
-
-            // clear and integrate all reports
-            local_keyboard_report = {};
-            or_report(kbd_parser1.report);
-            or_report(kbd_parser2.report);
-            or_report(kbd_parser3.report);
-            or_report(kbd_parser4.report);
-
-            matrix_is_mod = true;
-
-            dprintf("state:  %02X %02X", local_keyboard_report.mods, local_keyboard_report.reserved);
-            for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
-                dprintf(" %02X", local_keyboard_report.keys[i]);
-            }
-            dprint("\r\n");
-        } else {
-            matrix_is_mod = false;
-        }
-
         uint16_t timer;
         timer = timer_read();
         usb_host.Task();
@@ -158,6 +97,9 @@ extern "C"
             dprintf("host.Task: %d\n", timer);
         }
 
+        // keyboard_task takes one change per scan, so give it one at a time
+        matrix_is_mod = nkro_merge_apply(timer_read());
+
         static uint8_t usb_state = 0;
         if (usb_state != usb_host.getUsbTaskState()) {
             usb_state = usb_host.getUsbTaskState();
@@ -177,48 +119,15 @@ extern "C"
     }
 
     bool matrix_is_on(uint8_t row, uint8_t col) {
-        uint8_t code = CODE(row, col);
-
-        if (IS_MOD(code)) {
-            if (local_keyboard_report.mods & ROW_BITS(code)) {
-                return true;
-            }
-        }
-        for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
-            if (local_keyboard_report.keys[i] == code) {
-                return true;
-            }
-        }
-        return false;
+        return nkro_merge_is_on(CODE(row, col));
     }
 
     matrix_row_t matrix_get_row(uint8_t row) {
-        uint16_t row_bits = 0;
-
-        if (IS_MOD(CODE(row, 0)) && local_keyboard_report.mods) {
-            row_bits |= local_keyboard_report.mods;
-        }
-
-        for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
-            if (IS_ANY(local_keyboard_report.keys[i])) {
-                if (row == ROW(local_keyboard_report.keys[i])) {
-                    row_bits |= ROW_BITS(local_keyboard_report.keys[i]);
-                }
-            }
-        }
-        return row_bits;
+        return nkro_merge_get_row(row);
     }
 
     uint8_t matrix_key_count(void) {
-        uint8_t count = 0;
-
-        count += bitpop(local_keyboard_report.mods);
-        for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
-            if (IS_ANY(local_keyboard_report.keys[i])) {
-                count++;
-            }
-        }
-        return count;
+        return nkro_merge_key_count();
     }
 
     void matrix_print(void) {
@@ -228,6 +137,11 @@ extern "C"
             print_bin_reverse16(matrix_get_row(row));
             print("\n");
         }
+        for (uint8_t i = 0; i < NKRO_MERGE_DEVICES; i++) {
+            const nkro_merge_stats_t* stats = nkro_merge_stats(i);
+            xprintf("kbd%d: reports %u latency %ums max %ums\n", i + 1,
+                    stats->reports, stats->latency_last, stats->latency_max);
+        }
     }
 
     void led_set(uint8_t usb_led)
@@ -38,4 +38,4 @@ F_USB = $(F_CPU)
 # Interrupt driven control endpoint task(+60)
 OPT_DEFS += -DINTERRUPT_CONTROL_ENDPOINT
 
-SRC = ../lfkeyboards/TWIlib.c ../lfkeyboards/issi.c ../lfkeyboards/lighting.c
\ No newline at end of file
+SRC = ../lfkeyboards/issi.c ../lfkeyboards/lighting.c is31fl3731.c i2c_master.c i2c_queue.c
\ No newline at end of file
@@ -1,5 +1,6 @@
 SRC += matrix.c \
-      ../../../drivers/avr/i2c_master.c
+      ../../../drivers/avr/i2c_master.c \
+      ../../../drivers/i2c_queue.c
 
 # MCU name
 #MCU = at90usb1286
@@ -139,6 +139,20 @@ uint8_t init_mcp23018(void) {
     mcp23018_status = i2c_write(0b00000000, ERGODOX_EZ_I2C_TIMEOUT);        if (mcp23018_status) goto out;
     mcp23018_status = i2c_write(0b00111111, ERGODOX_EZ_I2C_TIMEOUT);        if (mcp23018_status) goto out;
 
+#ifdef ERGODOX_EZ_INTERRUPT_ON_CHANGE
+    // flag a change on any column
+    // - GPINTENB : columns : 1
+    // - INTCONB  : compare with the previous value : 0
+    i2c_stop(ERGODOX_EZ_I2C_TIMEOUT);
+    mcp23018_status = i2c_start(I2C_ADDR_WRITE, ERGODOX_EZ_I2C_TIMEOUT);    if (mcp23018_status) goto out;
+    mcp23018_status = i2c_write(GPINTENB, ERGODOX_EZ_I2C_TIMEOUT);          if (mcp23018_status) goto out;
+    mcp23018_status = i2c_write(0b00111111, ERGODOX_EZ_I2C_TIMEOUT);        if (mcp23018_status) goto out;
+    i2c_stop(ERGODOX_EZ_I2C_TIMEOUT);
+    mcp23018_status = i2c_start(I2C_ADDR_WRITE, ERGODOX_EZ_I2C_TIMEOUT);    if (mcp23018_status) goto out;
+    mcp23018_status = i2c_write(INTCONB, ERGODOX_EZ_I2C_TIMEOUT);           if (mcp23018_status) goto out;
+    mcp23018_status = i2c_write(0b00000000, ERGODOX_EZ_I2C_TIMEOUT);        if (mcp23018_status) goto out;
+#endif
+
 out:
     i2c_stop(ERGODOX_EZ_I2C_TIMEOUT);
 
@@ -152,34 +166,55 @@ out:
 }
 
 #ifdef LEFT_LEDS
+// The LEDs are written with a queued transaction, so that the matrix scan
+// doesn't wait for it. A change while it's pending is written on the next call.
+static uint8_t left_leds_data[3] = { OLATA, 0xFF, 0xFF };
+static i2c_segment_t left_leds_segment = I2C_WRITE_SEGMENT(left_leds_data, 3);
+static i2c_transaction_t left_leds_transaction = {
+    .address = I2C_ADDR_WRITE,
+    .num_segments = 1,
+    .segments = &left_leds_segment,
+};
+static bool left_leds_written = false;
+
 uint8_t ergodox_left_leds_update(void) {
     if (mcp23018_status) { // if there was an error
+        left_leds_written = false;
         return mcp23018_status;
     }
 #define LEFT_LED_1_SHIFT        7       // in MCP23018 port B
 #define LEFT_LED_2_SHIFT        6       // in MCP23018 port B
 #define LEFT_LED_3_SHIFT        7       // in MCP23018 port A
 
+    if (left_leds_transaction.status == I2C_STATUS_PENDING) {
+        return mcp23018_status;
+    }
+    if (left_leds_transaction.status < 0) {
+        mcp23018_status = left_leds_transaction.status;
+        left_leds_transaction.status = I2C_STATUS_SUCCESS;
+        left_leds_written = false;
+        return mcp23018_status;
+    }
+
     // set logical value (doesn't matter on inputs)
     // - unused  : hi-Z : 1
     // - input   : hi-Z : 1
     // - driving : hi-Z : 1
-    mcp23018_status = i2c_start(I2C_ADDR_WRITE, ERGODOX_EZ_I2C_TIMEOUT);
-    if (mcp23018_status) goto out;
-    mcp23018_status = i2c_write(OLATA, ERGODOX_EZ_I2C_TIMEOUT);
-    if (mcp23018_status) goto out;
-    mcp23018_status = i2c_write(0b11111111
-                                & ~(ergodox_left_led_3<<LEFT_LED_3_SHIFT),
-                                ERGODOX_EZ_I2C_TIMEOUT);
-    if (mcp23018_status) goto out;
-    mcp23018_status = i2c_write(0b11111111
-                                & ~(ergodox_left_led_2<<LEFT_LED_2_SHIFT)
-                                & ~(ergodox_left_led_1<<LEFT_LED_1_SHIFT),
-                                ERGODOX_EZ_I2C_TIMEOUT);
-    if (mcp23018_status) goto out;
-
- out:
-    i2c_stop(ERGODOX_EZ_I2C_TIMEOUT);
+    uint8_t port_a = 0b11111111
+                     & ~(ergodox_left_led_3<<LEFT_LED_3_SHIFT);
+    uint8_t port_b = 0b11111111
+                     & ~(ergodox_left_led_2<<LEFT_LED_2_SHIFT)
+                     & ~(ergodox_left_led_1<<LEFT_LED_1_SHIFT);
+    if (left_leds_written && left_leds_data[1] == port_a && left_leds_data[2] == port_b) {
+        return mcp23018_status;
+    }
+    left_leds_data[1] = port_a;
+    left_leds_data[2] = port_b;
+    left_leds_written = i2c_submit(&left_leds_transaction) == I2C_STATUS_PENDING;
+    if (!left_leds_written) {
+        // The queue is full, which isn't the MCP23018's fault, so it's tried again on the next call
+        left_leds_transaction.status = I2C_STATUS_SUCCESS;
+    }
     return mcp23018_status;
 }
 #endif
@@ -16,8 +16,11 @@
 #define I2C_ADDR_READ   ( (I2C_ADDR<<1) | I2C_READ  )
 #define IODIRA          0x00            // i/o direction register
 #define IODIRB          0x01
+#define GPINTENB        0x05            // interrupt-on-change enable register
+#define INTCONB         0x09            // interrupt-on-change control register
 #define GPPUA           0x0C            // GPIO pull-up resistor register
 #define GPPUB           0x0D
+#define INTFB           0x0F            // interrupt flag register
 #define GPIOA           0x12            // general purpose i/o port register (write modifies OLAT)
 #define GPIOB           0x13
 #define OLATA           0x14            // output latch register
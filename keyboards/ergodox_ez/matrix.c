@@ -63,10 +63,12 @@ static matrix_row_t matrix[MATRIX_ROWS];
 // already changed in the last DEBOUNCE scans.
 static uint8_t debounce_matrix[MATRIX_ROWS * MATRIX_COLS];
 
-static matrix_row_t read_cols(uint8_t row);
+static matrix_row_t read_cols(void);
 static void init_cols(void);
 static void unselect_rows(void);
 static void select_row(uint8_t row);
+static void left_scan_reset(void);
+static void left_scan(void);
 
 static uint8_t mcp23018_reset_loop;
 // static uint16_t mcp23018_reset_loop;
@@ -74,6 +76,7 @@ static uint8_t mcp23018_reset_loop;
 #ifdef DEBUG_MATRIX_SCAN_RATE
 uint32_t matrix_timer;
 uint32_t matrix_scan_count;
+uint32_t left_pass_count;
 #endif
 
 
@@ -110,6 +113,7 @@ void matrix_init(void)
     // initialize row and col
 
     mcp23018_status = init_mcp23018();
+    left_scan_reset();
 
 
     unselect_rows();
@@ -134,6 +138,7 @@ void matrix_init(void)
 
 void matrix_power_up(void) {
     mcp23018_status = init_mcp23018();
+    left_scan_reset();
 
     unselect_rows();
     init_cols();
@@ -182,6 +187,7 @@ uint8_t matrix_scan(void)
             // this will be approx bit more frequent than once per second
             print("trying to reset mcp23018\n");
             mcp23018_status = init_mcp23018();
+            left_scan_reset();
             if (mcp23018_status) {
                 print("left side not responding\n");
             } else {
@@ -198,31 +204,31 @@ uint8_t matrix_scan(void)
     if (TIMER_DIFF_32(timer_now, matrix_timer)>1000) {
         print("matrix scan frequency: ");
         pdec(matrix_scan_count);
+        print(", left hand: ");
+        pdec(left_pass_count);
         print("\n");
 
         matrix_timer = timer_now;
         matrix_scan_count = 0;
+        left_pass_count = 0;
     }
 #endif
 
 #ifdef LEFT_LEDS
     mcp23018_status = ergodox_left_leds_update();
 #endif // LEFT_LEDS
-    for (uint8_t i = 0; i < MATRIX_ROWS_PER_SIDE; i++) {
+
+    // The left hand is scanned in the background, while the right hand is
+    // scanned here
+    left_scan();
+
+    for (uint8_t i = MATRIX_ROWS_PER_SIDE; i < MATRIX_ROWS; i++) {
         select_row(i);
-        // and select on left hand
-        select_row(i + MATRIX_ROWS_PER_SIDE);
-        // we don't need a 30us delay anymore, because selecting a
-        // left-hand row requires more than 30us for i2c.
+        wait_us(30);
         matrix_row_t mask = debounce_mask(i);
-        matrix_row_t cols = (read_cols(i) & mask) | (matrix[i] & ~mask);
+        matrix_row_t cols = (read_cols() & mask) | (matrix[i] & ~mask);
         debounce_report(cols ^ matrix[i], i);
         matrix[i] = cols;
-        // grab cols from right hand
-        mask = debounce_mask(i + MATRIX_ROWS_PER_SIDE);
-        cols = (read_cols(i + MATRIX_ROWS_PER_SIDE) & mask) | (matrix[i + MATRIX_ROWS_PER_SIDE] & ~mask);
-        debounce_report(cols ^ matrix[i + MATRIX_ROWS_PER_SIDE], i + MATRIX_ROWS_PER_SIDE);
-        matrix[i + MATRIX_ROWS_PER_SIDE] = cols;
         unselect_rows();
     }
 
@@ -267,6 +273,185 @@ uint8_t matrix_key_count(void)
     return count;
 }
 
+/* Left hand scanning
+ *
+ * Each left-hand row is one queued I2C transaction, which selects the row on
+ * GPIOA and then reads the columns from GPIOB. The transaction of the next row
+ * is submitted from the completion callback, so a whole pass runs from the
+ * I2C interrupt while the right hand is scanned. The rows are debounced when
+ * the pass is complete, so DEBOUNCE counts left-hand passes there.
+ *
+ * With ERGODOX_EZ_INTERRUPT_ON_CHANGE, all rows are selected when no left-hand
+ * key is down, and each pass only reads INTFB. The MCP23018 sets it when a
+ * column changes, so a key that is released again before the next poll still
+ * wakes up the scan for a full pass.
+ */
+
+static uint8_t left_select[2] = { GPIOA, 0xFF };
+static uint8_t left_read_register = GPIOB;
+static uint8_t left_data;
+static i2c_segment_t left_row_segments[] = {
+    I2C_WRITE_SEGMENT(left_select, 2),
+    { &left_read_register, 1, I2C_SEGMENT_RESTART },
+    I2C_READ_SEGMENT(&left_data, 1),
+};
+static i2c_transaction_t left_transaction = {
+    .address = I2C_ADDR_WRITE,
+};
+
+static uint8_t left_row;
+static uint8_t left_cols[MATRIX_ROWS_PER_SIDE];
+static volatile bool left_busy = false;
+static volatile bool left_done = false;
+static volatile i2c_status_t left_status = I2C_STATUS_SUCCESS;
+
+#ifdef ERGODOX_EZ_INTERRUPT_ON_CHANGE
+// All rows selected, waiting for INTFB
+#define LEFT_ROW_IDLE 0xFF
+#define LEFT_ROW_ALL MATRIX_ROWS_PER_SIDE
+static uint8_t left_intf_register = INTFB;
+static i2c_segment_t left_idle_segments[] = {
+    I2C_WRITE_SEGMENT(&left_intf_register, 1),
+    I2C_READ_SEGMENT(&left_data, 1),
+};
+static bool left_idle = false;
+static bool left_woken = false;
+#endif
+
+// Returns false when the I2C queue is full
+static bool left_submit_row(uint8_t row)
+{
+    left_row = row;
+#ifdef ERGODOX_EZ_INTERRUPT_ON_CHANGE
+    if (row == LEFT_ROW_IDLE) {
+        left_transaction.segments = left_idle_segments;
+        left_transaction.num_segments = 2;
+        return i2c_submit(&left_transaction) == I2C_STATUS_PENDING;
+    }
+    // active row low : 0, other rows hi-Z : 1
+    left_select[1] = row == LEFT_ROW_ALL ? (uint8_t)(0xFF << MATRIX_ROWS_PER_SIDE) : 0xFF & ~(1<<row);
+#else
+    left_select[1] = 0xFF & ~(1<<row);
+#endif
+    left_transaction.segments = left_row_segments;
+    left_transaction.num_segments = 3;
+    return i2c_submit(&left_transaction) == I2C_STATUS_PENDING;
+}
+
+// Called from the I2C interrupt
+static void left_row_done(i2c_transaction_t* transaction)
+{
+    if (transaction->status != I2C_STATUS_SUCCESS) {
+        left_status = transaction->status;
+        left_busy = false;
+        return;
+    }
+#ifdef ERGODOX_EZ_INTERRUPT_ON_CHANGE
+    if (left_row >= LEFT_ROW_ALL) {
+        // Any column change, or a key that is already down, wakes up the scan
+        if (left_row == LEFT_ROW_ALL) {
+            left_idle = (~left_data & 0x3F) == 0;
+        } else {
+            left_idle = (left_data & 0x3F) == 0;
+        }
+        left_woken = !left_idle;
+        left_busy = false;
+        return;
+    }
+#endif
+    left_cols[left_row] = ~left_data;
+    if (left_row + 1 < MATRIX_ROWS_PER_SIDE) {
+        if (!left_submit_row(left_row + 1)) {
+            // The pass starts again on the next scan
+            left_busy = false;
+        }
+        return;
+    }
+    left_done = true;
+    left_busy = false;
+}
+
+static void left_scan_reset(void)
+{
+    left_transaction.callback = left_row_done;
+    left_busy = false;
+    left_done = false;
+    left_status = I2C_STATUS_SUCCESS;
+#ifdef ERGODOX_EZ_INTERRUPT_ON_CHANGE
+    left_idle = false;
+    left_woken = false;
+#endif
+}
+
+static void left_debounce(uint8_t row, matrix_row_t read)
+{
+    matrix_row_t mask = debounce_mask(row);
+    matrix_row_t cols = (read & mask) | (matrix[row] & ~mask);
+    debounce_report(cols ^ matrix[row], row);
+    matrix[row] = cols;
+}
+
+#ifdef ERGODOX_EZ_INTERRUPT_ON_CHANGE
+static bool left_settled(void)
+{
+    for (uint8_t i = 0; i < MATRIX_ROWS_PER_SIDE; i++) {
+        if (matrix[i]) {
+            return false;
+        }
+        for (uint8_t j = 0; j < MATRIX_COLS; j++) {
+            if (debounce_matrix[i * MATRIX_COLS + j]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+#endif
+
+static void left_scan(void)
+{
+    if (mcp23018_status) {
+        // Release the keys of a left hand that isn't responding
+        for (uint8_t i = 0; i < MATRIX_ROWS_PER_SIDE; i++) {
+            left_debounce(i, 0);
+        }
+        return;
+    }
+    if (left_busy) {
+        return;
+    }
+    if (left_status) {
+        mcp23018_status = left_status;
+        return;
+    }
+
+    if (left_done) {
+        left_done = false;
+        for (uint8_t i = 0; i < MATRIX_ROWS_PER_SIDE; i++) {
+            left_debounce(i, left_cols[i]);
+        }
+#ifdef DEBUG_MATRIX_SCAN_RATE
+        left_pass_count++;
+#endif
+    }
+
+    uint8_t row = 0;
+#ifdef ERGODOX_EZ_INTERRUPT_ON_CHANGE
+    if (left_idle) {
+        row = LEFT_ROW_IDLE;
+    } else if (left_woken) {
+        left_woken = false;
+    } else if (left_settled()) {
+        row = LEFT_ROW_ALL;
+    }
+#endif
+    // The pass can be done before i2c_submit returns
+    left_busy = true;
+    if (!left_submit_row(row)) {
+        left_busy = false;
+    }
+}
+
 /* Column pin configuration
  *
  * Teensy
@@ -288,32 +473,15 @@ static void  init_cols(void)
     PORTF |=  (1<<7 | 1<<6 | 1<<5 | 1<<4 | 1<<1 | 1<<0);
 }
 
-static matrix_row_t read_cols(uint8_t row)
+static matrix_row_t read_cols(void)
 {
-    if (row < 7) {
-        if (mcp23018_status) { // if there was an error
-            return 0;
-        } else {
-            uint8_t data = 0;
-            mcp23018_status = i2c_start(I2C_ADDR_WRITE, ERGODOX_EZ_I2C_TIMEOUT);    if (mcp23018_status) goto out;
-            mcp23018_status = i2c_write(GPIOB, ERGODOX_EZ_I2C_TIMEOUT);             if (mcp23018_status) goto out;
-            mcp23018_status = i2c_start(I2C_ADDR_READ, ERGODOX_EZ_I2C_TIMEOUT);     if (mcp23018_status) goto out;
-            mcp23018_status = i2c_read_nack(ERGODOX_EZ_I2C_TIMEOUT);                if (mcp23018_status < 0) goto out;
-            data = ~((uint8_t)mcp23018_status);
-            mcp23018_status = I2C_STATUS_SUCCESS;
-        out:
-            i2c_stop(ERGODOX_EZ_I2C_TIMEOUT);
-            return data;
-        }
-    } else {
-        /* read from teensy
-	 * bitmask is 0b11110011, but we want those all
-	 * in the lower six bits.
-	 * we'll return 1s for the top two, but that's harmless.
-	 */
+    /* read from teensy
+     * bitmask is 0b11110011, but we want those all
+     * in the lower six bits.
+     * we'll return 1s for the top two, but that's harmless.
+     */
 
-        return ~((PINF & 0x03) | ((PINF & 0xF0) >> 2));
-    }
+    return ~((PINF & 0x03) | ((PINF & 0xF0) >> 2));
 }
 
 /* Row pin configuration
@@ -344,52 +512,37 @@ static void unselect_rows(void)
 
 static void select_row(uint8_t row)
 {
-    if (row < 7) {
-        // select on mcp23018
-        if (mcp23018_status) { // if there was an error
-            // do nothing
-        } else {
-            // set active row low  : 0
-            // set other rows hi-Z : 1
-            mcp23018_status = i2c_start(I2C_ADDR_WRITE, ERGODOX_EZ_I2C_TIMEOUT);        if (mcp23018_status) goto out;
-            mcp23018_status = i2c_write(GPIOA, ERGODOX_EZ_I2C_TIMEOUT);                 if (mcp23018_status) goto out;
-            mcp23018_status = i2c_write(0xFF & ~(1<<row), ERGODOX_EZ_I2C_TIMEOUT);      if (mcp23018_status) goto out;
-        out:
-            i2c_stop(ERGODOX_EZ_I2C_TIMEOUT);
-        }
-    } else {
-        // select on teensy
-        // Output low(DDR:1, PORT:0) to select
-        switch (row) {
-            case 7:
-                DDRB  |= (1<<0);
-                PORTB &= ~(1<<0);
-                break;
-            case 8:
-                DDRB  |= (1<<1);
-                PORTB &= ~(1<<1);
-                break;
-            case 9:
-                DDRB  |= (1<<2);
-                PORTB &= ~(1<<2);
-                break;
-            case 10:
-                DDRB  |= (1<<3);
-                PORTB &= ~(1<<3);
-                break;
-            case 11:
-                DDRD  |= (1<<2);
-                PORTD &= ~(1<<3);
-                break;
-            case 12:
-                DDRD  |= (1<<3);
-                PORTD &= ~(1<<3);
-                break;
-            case 13:
-                DDRC  |= (1<<6);
-                PORTC &= ~(1<<6);
-                break;
-        }
+    // select on teensy
+    // Output low(DDR:1, PORT:0) to select
+    switch (row) {
+        case 7:
+            DDRB  |= (1<<0);
+            PORTB &= ~(1<<0);
+            break;
+        case 8:
+            DDRB  |= (1<<1);
+            PORTB &= ~(1<<1);
+            break;
+        case 9:
+            DDRB  |= (1<<2);
+            PORTB &= ~(1<<2);
+            break;
+        case 10:
+            DDRB  |= (1<<3);
+            PORTB &= ~(1<<3);
+            break;
+        case 11:
+            DDRD  |= (1<<2);
+            PORTD &= ~(1<<3);
+            break;
+        case 12:
+            DDRD  |= (1<<3);
+            PORTD &= ~(1<<3);
+            break;
+        case 13:
+            DDRC  |= (1<<6);
+            PORTC &= ~(1<<6);
+            break;
     }
 }
 
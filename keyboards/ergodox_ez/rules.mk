@@ -16,7 +16,8 @@
 
 # # project specific files
 SRC = matrix.c \
-  i2c_master.c
+  i2c_master.c \
+  i2c_queue.c
 
 # MCU name
 MCU = atmega32u4
@@ -24,6 +24,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "print.h"
 #include "debug.h"
 #include "matrix.h"
+#include "strobe_matrix.h"
 #include "serial_link/system/serial_link.h"
 
 
@@ -44,23 +45,7 @@ static uint16_t debouncing_time = 0;
 
 void matrix_init(void)
 {
-    /* Column(sense) */
-    palSetPadMode(GPIOD, 1,  PAL_MODE_INPUT_PULLDOWN);
-    palSetPadMode(GPIOD, 4,  PAL_MODE_INPUT_PULLDOWN);
-    palSetPadMode(GPIOD, 5,  PAL_MODE_INPUT_PULLDOWN);
-    palSetPadMode(GPIOD, 6,  PAL_MODE_INPUT_PULLDOWN);
-    palSetPadMode(GPIOD, 7,  PAL_MODE_INPUT_PULLDOWN);
-
-    /* Row(strobe) */
-    palSetPadMode(GPIOB, 2,  PAL_MODE_OUTPUT_PUSHPULL);
-    palSetPadMode(GPIOB, 3,  PAL_MODE_OUTPUT_PUSHPULL);
-    palSetPadMode(GPIOB, 18, PAL_MODE_OUTPUT_PUSHPULL);
-    palSetPadMode(GPIOB, 19, PAL_MODE_OUTPUT_PUSHPULL);
-    palSetPadMode(GPIOC, 0,  PAL_MODE_OUTPUT_PUSHPULL);
-    palSetPadMode(GPIOC, 9,  PAL_MODE_OUTPUT_PUSHPULL);
-    palSetPadMode(GPIOC, 10, PAL_MODE_OUTPUT_PUSHPULL);
-    palSetPadMode(GPIOC, 11, PAL_MODE_OUTPUT_PUSHPULL);
-    palSetPadMode(GPIOD, 0,  PAL_MODE_OUTPUT_PUSHPULL);
+    strobe_matrix_init();
 
     memset(matrix, 0, MATRIX_ROWS * sizeof(matrix_row_t));
     memset(matrix_debouncing, 0, LOCAL_MATRIX_ROWS * sizeof(matrix_row_t));
@@ -70,50 +55,14 @@ void matrix_init(void)
 
 uint8_t matrix_scan(void)
 {
-    for (int row = 0; row < LOCAL_MATRIX_ROWS; row++) {
-        matrix_row_t data = 0;
-
-        // strobe row
-        switch (row) {
-            case 0: palSetPad(GPIOB, 2);    break;
-            case 1: palSetPad(GPIOB, 3);    break;
-            case 2: palSetPad(GPIOB, 18);   break;
-            case 3: palSetPad(GPIOB, 19);   break;
-            case 4: palSetPad(GPIOC, 0);    break;
-            case 5: palSetPad(GPIOC, 9);    break;
-            case 6: palSetPad(GPIOC, 10);   break;
-            case 7: palSetPad(GPIOC, 11);   break;
-            case 8: palSetPad(GPIOD, 0);    break;
-        }
-
-        // need wait to settle pin state
-        // if you wait too short, or have a too high update rate
-        // the keyboard might freeze, or there might not be enough
-        // processing power to update the LCD screen properly.
-        // 20us, or two ticks at 100000Hz seems to be OK
-        wait_us(20);
-
-        // read col data: { PTD1, PTD4, PTD5, PTD6, PTD7 }
-        data = ((palReadPort(GPIOD) & 0xF0) >> 3) |
-               ((palReadPort(GPIOD) & 0x02) >> 1);
-
-        // un-strobe row
-        switch (row) {
-            case 0: palClearPad(GPIOB, 2);  break;
-            case 1: palClearPad(GPIOB, 3);  break;
-            case 2: palClearPad(GPIOB, 18); break;
-            case 3: palClearPad(GPIOB, 19); break;
-            case 4: palClearPad(GPIOC, 0);  break;
-            case 5: palClearPad(GPIOC, 9);  break;
-            case 6: palClearPad(GPIOC, 10); break;
-            case 7: palClearPad(GPIOC, 11); break;
-            case 8: palClearPad(GPIOD, 0);  break;
-        }
-
-        if (matrix_debouncing[row] != data) {
-            matrix_debouncing[row] = data;
-            debouncing = true;
-            debouncing_time = timer_read();
+    matrix_row_t data[LOCAL_MATRIX_ROWS];
+    if (strobe_matrix_read(data)) {
+        for (int row = 0; row < LOCAL_MATRIX_ROWS; row++) {
+            if (matrix_debouncing[row] != data[row]) {
+                matrix_debouncing[row] = data[row];
+                debouncing = true;
+                debouncing_time = timer_read();
+            }
         }
     }
 
@@ -18,6 +18,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "actuation_point.h"
 #include "i2c.h"
+#ifdef TOPRE_THRESHOLD_LEVELS
+#include "topre_matrix.h"
+#endif
 
 ///////////////////////////////////////////////////////////////////////////////
 //
@@ -55,22 +58,39 @@ void write_rdac(uint8_t rdac) {
     i2c_master_stop();
 };
 
+#ifdef TOPRE_THRESHOLD_LEVELS
+void topre_matrix_set_level(uint8_t level) {
+    write_rdac(level);
+}
+#endif
+
 void actuation_point_up(void) {
     // write RDAC register: lower value makes actuation point shallow
+#ifdef TOPRE_THRESHOLD_LEVELS
+    // the matrix writes the RDAC for each key, following this level
+    uint8_t level = topre_matrix_get_threshold();
+    topre_matrix_set_threshold(level == 0 ? 0 : level - 1);
+#else
     uint8_t rdac = read_rdac();
     if (rdac == 0)
         write_rdac(0);
     else
         write_rdac(rdac-1);
+#endif
 };
 
 void actuation_point_down(void) {
     // write RDAC register: higher value makes actuation point deep
+#ifdef TOPRE_THRESHOLD_LEVELS
+    uint8_t level = topre_matrix_get_threshold();
+    topre_matrix_set_threshold(level == 63 ? 63 : level + 1);
+#else
     uint8_t rdac = read_rdac();
     if (rdac == 63)
         write_rdac(63);
     else
         write_rdac(rdac+1);
+#endif
 };
 
 void adjust_actuation_point(int offset) {
@@ -78,10 +98,13 @@ void adjust_actuation_point(int offset) {
     uint8_t rdac = read_eeprom() + offset;
     if (rdac > 63) { // protects from under and overflows
         if (offset > 0)
-            write_rdac(63);
+            rdac = 63;
         else
-            write_rdac(0);
-    } else {
-        write_rdac(rdac);
+            rdac = 0;
     }
+#ifdef TOPRE_THRESHOLD_LEVELS
+    topre_matrix_threshold_init(rdac);
+#else
+    write_rdac(rdac);
+#endif
 }
@@ -90,4 +90,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // this should probably stay in the range +/-5.
 // #define ACTUATION_DEPTH_ADJUSTMENT 0
 
+// opt-in: the actuation point is set for each key, around the one above.
+// keys are calibrated on the first start, with no key pressed, and the
+// calibration is saved to the EEPROM. see README.md before enabling it.
+// #define TOPRE_THRESHOLD_LEVELS 64
+
 #endif
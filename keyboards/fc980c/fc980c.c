@@ -17,7 +17,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "fc980c.h"
 
-#ifdef ACTUATION_DEPTH_ADJUSTMENT
+#if defined(ACTUATION_DEPTH_ADJUSTMENT) || defined(TOPRE_THRESHOLD_LEVELS)
 #include "actuation_point.h"
 #endif
 
@@ -27,6 +27,8 @@ void matrix_init_kb(void) {
 
 #ifdef ACTUATION_DEPTH_ADJUSTMENT
     adjust_actuation_point(ACTUATION_DEPTH_ADJUSTMENT);
+#elif defined(TOPRE_THRESHOLD_LEVELS)
+    adjust_actuation_point(0);
 #endif
 
 	matrix_init_user();
@@ -16,6 +16,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include QMK_KEYBOARD_H
 #include "actuation_point.h"
+#include "topre_matrix.h"
 
 enum custom_keycodes
 {
@@ -23,6 +24,7 @@ enum custom_keycodes
     AP_DN,              // Lower actuation point, less sensitive
     AP_READ_RDAC,       // Prints current RDAC value to console
     AP_READ_EEPROM,     // Prints base RDAC value to console
+    AP_CALIBRATE,       // Finds the actuation point of each key again, with no other key pressed
 };
 
 const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
@@ -34,7 +36,7 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
         KC_LSFT, KC_Z, KC_X, KC_C, KC_V, KC_B, KC_N, KC_M, KC_COMM, KC_DOT, KC_SLSH, KC_RSFT, KC_UP, KC_P1, KC_P2, KC_P3, KC_PENT,
         KC_LCTL, KC_LGUI, KC_LALT, KC_SPC, KC_RALT, KC_RCTL, MO(1), KC_LEFT, KC_DOWN, KC_RGHT, KC_P0, KC_PDOT),
     [1] = LAYOUT(
-        _______, _______, _______, _______, _______, _______, _______, _______, _______, AP_READ_RDAC, AP_READ_EEPROM, AP_DN, AP_UP, _______, _______, KC_HOME, KC_END,
+        _______, _______, _______, _______, _______, _______, _______, _______, _______, AP_READ_RDAC, AP_READ_EEPROM, AP_DN, AP_UP, AP_CALIBRATE, _______, KC_HOME, KC_END,
         _______, _______, _______, _______, _______, _______, _______, _______, _______, _______, _______, _______, _______, _______, _______, _______, _______, _______,
         KC_CAPS, KC_MPRV, KC_VOLU, KC_MNXT, KC_PGUP, KC_INS, KC_HOME, LCTL(KC_LEFT), LCTL(KC_RGHT), KC_END, KC_PSCR, KC_SLCK, KC_PAUS, _______, _______, _______, _______, _______,
         _______, KC_MUTE, KC_VOLD, KC_MPLY, KC_PGDN, KC_DEL, KC_LEFT, KC_DOWN, KC_UP, KC_RGHT, _______, _______, _______, _______, _______, _______,
@@ -70,6 +72,13 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record)
             xprintf("EEPROM: %d", read_eeprom());
             return false;
         }
+#ifdef TOPRE_THRESHOLD_LEVELS
+        case AP_CALIBRATE:
+        {
+            topre_matrix_calibrate();
+            return false;
+        }
+#endif
 
         default:
             return true;
@@ -28,15 +28,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "timer.h"
 #include "matrix.h"
 #include "led.h"
+#include "topre_matrix.h"
 // #include QMK_KEYBOARD_H
 
 
-// Timer resolution check
-#if (1000000/TIMER_RAW_FREQ > 20)
-#   error "Timer resolution(>20us) is not enough for HHKB matrix scan tweak on V-USB."
-#endif
-
-
 /*
  * Pin configuration for ATMega32U4
  *
@@ -76,6 +71,40 @@ static inline void SET_COL(uint8_t COL)
     PORTB = (PORTB & 0xF0) | (COL & 0x0F);
 }
 
+void topre_matrix_init_pins(void)
+{
+    KEY_INIT();
+}
+
+void topre_matrix_select(uint8_t row, uint8_t col)
+{
+    SET_COL(col);
+    SET_ROW(row);
+}
+
+void topre_matrix_hys(bool on)
+{
+    if (on) {
+        KEY_HYS_ON();
+    } else {
+        KEY_HYS_OFF();
+    }
+}
+
+void topre_matrix_enable(bool on)
+{
+    if (on) {
+        KEY_ENABLE();
+    } else {
+        KEY_UNABLE();
+    }
+}
+
+bool topre_matrix_key_on(void)
+{
+    return !KEY_STATE();
+}
+
 static uint32_t matrix_last_modified = 0;
 
 // matrix state buffer(1:on, 0:off)
@@ -132,54 +161,8 @@ uint8_t matrix_scan(void)
     matrix_prev = matrix;
     matrix = tmp;
 
-    uint8_t row, col;
-    for (col = 0; col < MATRIX_COLS; col++) {
-        SET_COL(col);
-        for (row = 0; row < MATRIX_ROWS; row++) {
-            //KEY_SELECT(row, col);
-            SET_ROW(row);
-            _delay_us(2);
-
-            // Not sure this is needed. This just emulates HHKB controller's behaviour.
-            if (matrix_prev[row] & (1<<col)) {
-                KEY_HYS_ON();
-            }
-            _delay_us(10);
-
-            // NOTE: KEY_STATE is valid only in 20us after KEY_ENABLE.
-            // If V-USB interrupts in this section we could lose 40us or so
-            // and would read invalid value from KEY_STATE.
-            uint8_t last = TIMER_RAW;
-
-            KEY_ENABLE();
-
-            // Wait for KEY_STATE outputs its value.
-            _delay_us(2);
-
-            if (KEY_STATE()) {
-                matrix[row] &= ~(1<<col);
-            } else {
-                matrix[row] |= (1<<col);
-            }
-
-            // Ignore if this code region execution time elapses more than 20us.
-            // MEMO: 20[us] * (TIMER_RAW_FREQ / 1000000)[count per us]
-            // MEMO: then change above using this rule: a/(b/c) = a*1/(b/c) = a*(c/b)
-            if (TIMER_DIFF_RAW(TIMER_RAW, last) > 20/(1000000/TIMER_RAW_FREQ)) {
-                matrix[row] = matrix_prev[row];
-            }
-
-            _delay_us(5);
-            KEY_HYS_OFF();
-            KEY_UNABLE();
-
-            // NOTE: KEY_STATE keep its state in 20us after KEY_ENABLE.
-            // This takes 25us or more to make sure KEY_STATE returns to idle state.
-            _delay_us(75);
-        }
-        if (matrix[row] ^ matrix_prev[row]) {
-            matrix_last_modified = timer_read32();
-        }
+    if (topre_matrix_scan(matrix, matrix_prev)) {
+        matrix_last_modified = timer_read32();
     }
     matrix_scan_quantum();
     return 1;
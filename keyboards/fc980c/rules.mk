@@ -61,6 +61,7 @@ NKRO_ENABLE = yes		# USB Nkey Rollover - not yet supported in LUFA
 #EXTRALDFLAGS = -Wl,--relax
 
 CUSTOM_MATRIX = yes
+TOPRE_MATRIX_ENABLE = yes
 SRC +=	matrix.c \
 		actuation_point.c \
 		i2c.c
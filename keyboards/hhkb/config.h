@@ -36,6 +36,27 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #endif
 #define MATRIX_COLS 8
 
+/* key timing of the Topre matrix, in microseconds */
+#define TOPRE_SELECT_US 5
+// Wait for KEY_STATE outputs its value.
+// 1us was ok on one HHKB, but not worked on another.
+// no   wait doesn't work on Teensy++ with pro(1us works)
+// no   wait does    work on tmk PCB(8MHz) with pro2
+// 1us  wait does    work on both of above
+// 1us  wait doesn't work on tmk(16MHz)
+// 5us  wait does    work on tmk(16MHz)
+// 5us  wait does    work on tmk(16MHz/2)
+// 5us  wait does    work on tmk(8MHz)
+// 10us wait does    work on Teensy++ with pro
+// 10us wait does    work on 328p+iwrap with pro
+// 10us wait doesn't work on tmk PCB(8MHz) with pro2(very lagged scan)
+#define TOPRE_SETTLE_US 5
+#ifdef HHKB_JP
+// Looks like JP needs faster scan due to its twice larger matrix
+// or it can drop keys in fast key typing
+#   define TOPRE_IDLE_US 30
+#endif
+
 #define TAPPING_TERM    200
 
 /* number of backlight levels */
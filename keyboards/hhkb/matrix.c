@@ -27,6 +27,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "timer.h"
 #include "matrix.h"
 #include "hhkb_avr.h"
+#include "topre_matrix.h"
 #include <avr/wdt.h>
 #include "suspend.h"
 #include "lufa.h"
@@ -43,6 +44,40 @@ static matrix_row_t _matrix0[MATRIX_ROWS];
 static matrix_row_t _matrix1[MATRIX_ROWS];
 
 
+void topre_matrix_init_pins(void)
+{
+    KEY_INIT();
+}
+
+void topre_matrix_select(uint8_t row, uint8_t col)
+{
+    KEY_SELECT(row, col);
+}
+
+// Not sure this is needed. This just emulates HHKB controller's behaviour.
+void topre_matrix_hys(bool on)
+{
+    if (on) {
+        KEY_PREV_ON();
+    } else {
+        KEY_PREV_OFF();
+    }
+}
+
+void topre_matrix_enable(bool on)
+{
+    if (on) {
+        KEY_ENABLE();
+    } else {
+        KEY_UNABLE();
+    }
+}
+
+bool topre_matrix_key_on(void)
+{
+    return !KEY_STATE();
+}
+
 inline
 uint8_t matrix_rows(void)
 {
@@ -62,7 +97,7 @@ void matrix_init(void)
     debug_keyboard = true;
 #endif
 
-    KEY_INIT();
+    topre_matrix_init();
 
     // initialize matrix state: all keys off
     for (uint8_t i=0; i < MATRIX_ROWS; i++) _matrix0[i] = 0x00;
@@ -89,66 +124,8 @@ uint8_t matrix_scan(void)
 
     // power on
     if (!KEY_POWER_STATE()) KEY_POWER_ON();
-    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
-        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
-            KEY_SELECT(row, col);
-            _delay_us(5);
-
-            // Not sure this is needed. This just emulates HHKB controller's behaviour.
-            if (matrix_prev[row] & (1<<col)) {
-                KEY_PREV_ON();
-            }
-            _delay_us(10);
-
-            // NOTE: KEY_STATE is valid only in 20us after KEY_ENABLE.
-            // If V-USB interrupts in this section we could lose 40us or so
-            // and would read invalid value from KEY_STATE.
-            uint8_t last = TIMER_RAW;
-
-            KEY_ENABLE();
-
-            // Wait for KEY_STATE outputs its value.
-            // 1us was ok on one HHKB, but not worked on another.
-            // no   wait doesn't work on Teensy++ with pro(1us works)
-            // no   wait does    work on tmk PCB(8MHz) with pro2
-            // 1us  wait does    work on both of above
-            // 1us  wait doesn't work on tmk(16MHz)
-            // 5us  wait does    work on tmk(16MHz)
-            // 5us  wait does    work on tmk(16MHz/2)
-            // 5us  wait does    work on tmk(8MHz)
-            // 10us wait does    work on Teensy++ with pro
-            // 10us wait does    work on 328p+iwrap with pro
-            // 10us wait doesn't work on tmk PCB(8MHz) with pro2(very lagged scan)
-            _delay_us(5);
-
-            if (KEY_STATE()) {
-                matrix[row] &= ~(1<<col);
-            } else {
-                matrix[row] |= (1<<col);
-            }
-
-            // Ignore if this code region execution time elapses more than 20us.
-            // MEMO: 20[us] * (TIMER_RAW_FREQ / 1000000)[count per us]
-            // MEMO: then change above using this rule: a/(b/c) = a*1/(b/c) = a*(c/b)
-            if (TIMER_DIFF_RAW(TIMER_RAW, last) > 20/(1000000/TIMER_RAW_FREQ)) {
-                matrix[row] = matrix_prev[row];
-            }
-
-            _delay_us(5);
-            KEY_PREV_OFF();
-            KEY_UNABLE();
-
-            // NOTE: KEY_STATE keep its state in 20us after KEY_ENABLE.
-            // This takes 25us or more to make sure KEY_STATE returns to idle state.
-#ifdef HHKB_JP
-            // Looks like JP needs faster scan due to its twice larger matrix
-            // or it can drop keys in fast key typing
-            _delay_us(30);
-#else
-            _delay_us(75);
-#endif
-        }
-        if (matrix[row] ^ matrix_prev[row]) matrix_last_modified = timer_read32();
+    if (topre_matrix_scan(matrix, matrix_prev)) {
+        matrix_last_modified = timer_read32();
     }
     // power off
     if (KEY_POWER_STATE() &&
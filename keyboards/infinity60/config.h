@@ -52,6 +52,21 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 /* Keymap for Infinity 1.1a (first revision with LED support) */
 #define INFINITY_LED
 
+/* I2C of the LED controller, through the I2C queue */
+#define I2C_DRIVER I2CD1
+#define I2C_DRIVER_CONFIG { 400000 } // clock speed (Hz); 400kHz max for IS31
+
+/* matrix pins, strobed by PIT0 */
+#ifdef INFINITY_LED
+#define STROBE_MATRIX_ROW_PINS { {GPIOC, 0}, {GPIOC, 1}, {GPIOC, 2}, {GPIOC, 3}, {GPIOC, 4}, \
+                                 {GPIOC, 5}, {GPIOC, 6}, {GPIOC, 7}, {GPIOD, 0} }
+#else
+#define STROBE_MATRIX_ROW_PINS { {GPIOB, 0}, {GPIOB, 1}, {GPIOB, 2}, {GPIOB, 3}, {GPIOB, 16}, \
+                                 {GPIOB, 17}, {GPIOC, 4}, {GPIOC, 5}, {GPIOD, 0} }
+#endif
+#define STROBE_MATRIX_COL_PINS { {GPIOD, 1}, {GPIOD, 2}, {GPIOD, 3}, {GPIOD, 4}, {GPIOD, 5}, \
+                                 {GPIOD, 6}, {GPIOD, 7} }
+
 /*
  * Feature disable options
  *  These options are also useful to firmware size reduction.
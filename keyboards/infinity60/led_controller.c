@@ -70,13 +70,6 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define BREATHE_LED_ADDRESS CAPS_LOCK_LED_ADDRESS
 #endif
 
-/* =================
- * ChibiOS I2C setup
- * ================= */
-static const I2CConfig i2ccfg = {
-  400000 // clock speed (Hz); 400kHz max for IS31
-};
-
 /* ==============
  *   variables
  * ============== */
@@ -107,29 +100,29 @@ uint8_t pwm_register_array[9] = {0};
 /* ============================
  *   communication functions
  * ============================ */
-msg_t is31_select_page(uint8_t page) {
+// the transfers go through the I2C queue, which takes 8-bit addresses
+i2c_status_t is31_select_page(uint8_t page) {
   tx[0] = IS31_COMMANDREGISTER;
   tx[1] = page;
-  return i2cMasterTransmitTimeout(&I2CD1, IS31_ADDR_DEFAULT, tx, 2, NULL, 0, US2ST(IS31_TIMEOUT));
+  return i2c_transmit(IS31_ADDR_DEFAULT << 1, tx, 2, IS31_TIMEOUT);
 }
 
-msg_t is31_write_data(uint8_t page, uint8_t *buffer, uint8_t size) {
+i2c_status_t is31_write_data(uint8_t page, uint8_t *buffer, uint8_t size) {
   is31_select_page(page);
-  return i2cMasterTransmitTimeout(&I2CD1, IS31_ADDR_DEFAULT, buffer, size, NULL, 0, US2ST(IS31_TIMEOUT));
+  return i2c_transmit(IS31_ADDR_DEFAULT << 1, buffer, size, IS31_TIMEOUT);
 }
 
-msg_t is31_write_register(uint8_t page, uint8_t reg, uint8_t data) {
+i2c_status_t is31_write_register(uint8_t page, uint8_t reg, uint8_t data) {
   is31_select_page(page);
   tx[0] = reg;
   tx[1] = data;
-  return i2cMasterTransmitTimeout(&I2CD1, IS31_ADDR_DEFAULT, tx, 2, NULL, 0, US2ST(IS31_TIMEOUT));
+  return i2c_transmit(IS31_ADDR_DEFAULT << 1, tx, 2, IS31_TIMEOUT);
 }
 
-msg_t is31_read_register(uint8_t page, uint8_t reg, uint8_t *result) {
+i2c_status_t is31_read_register(uint8_t page, uint8_t reg, uint8_t *result) {
   is31_select_page(page);
 
-  tx[0] = reg;
-  return i2cMasterTransmitTimeout(&I2CD1, IS31_ADDR_DEFAULT, tx, 1, result, 1, US2ST(IS31_TIMEOUT));
+  return i2c_readReg(IS31_ADDR_DEFAULT << 1, reg, result, 1, IS31_TIMEOUT);
 }
 
 /* ========================
@@ -450,8 +443,8 @@ void led_controller_init(void) {
   /* I2C pins */
   palSetPadMode(GPIOB, 0, PAL_MODE_ALTERNATIVE_2); // PTB0/I2C0/SCL
   palSetPadMode(GPIOB, 1, PAL_MODE_ALTERNATIVE_2); // PTB1/I2C0/SDA
-  /* start I2C */
-  i2cStart(&I2CD1, &i2ccfg);
+  /* start I2C, with I2C_DRIVER_CONFIG from config.h */
+  i2c_init();
   // try high drive (from kiibohd)
   I2CD1.i2c->C2 |= I2Cx_C2_HDRS;
   // try glitch fixing (from kiibohd)
@@ -19,13 +19,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef _LED_CONTROLLER_H_
 #define _LED_CONTROLLER_H_
 
+#include "i2c_master.h"
+
 /* =========================
  *  communication functions
  * ========================= */
 
-msg_t is31_write_data(uint8_t page, uint8_t *buffer, uint8_t size);
-msg_t is31_write_register(uint8_t page, uint8_t reg, uint8_t data);
-msg_t is31_read_register(uint8_t page, uint8_t reg, uint8_t *result);
+i2c_status_t is31_write_data(uint8_t page, uint8_t *buffer, uint8_t size);
+i2c_status_t is31_write_register(uint8_t page, uint8_t reg, uint8_t data);
+i2c_status_t is31_read_register(uint8_t page, uint8_t reg, uint8_t *result);
 
 /* ============================
  *  init functions/definitions
@@ -85,7 +87,7 @@ void led_controller_init(void);
 #define IS31_COMMANDREGISTER 0xFD
 #define IS31_FUNCTIONREG 0x0B    // helpfully called 'page nine'
 
-#define IS31_TIMEOUT 10000 // needs to be long enough to write a whole page
+#define IS31_TIMEOUT 10 // ms, needs to be long enough to write a whole page
 
 /* ========================================
  * LED Thread related items
@@ -1,7 +1,9 @@
 # project specific files
 SRC =	matrix.c \
 	led.c \
-	led_controller.c
+	led_controller.c \
+	i2c_master.c \
+	i2c_queue.c
 
 ## chip/board settings
 # - the next two should match the directories in
@@ -68,5 +70,6 @@ COMMAND_ENABLE = yes    # Commands for debug and configuration
 SLEEP_LED_ENABLE = yes  # Breathing sleep LED during USB suspend
 NKRO_ENABLE = yes	    # USB Nkey Rollover
 CUSTOM_MATRIX = yes # Custom matrix file
+STROBE_MATRIX_ENABLE = yes
 
 LAYOUTS = 60_ansi_split_bs_rshift
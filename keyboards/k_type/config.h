@@ -32,6 +32,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define MATRIX_ROWS 10
 #define MATRIX_COLS 10
 
+/* matrix pins, strobed by PIT0 */
+#define STROBE_MATRIX_ROW_PINS { {GPIOB, 2}, {GPIOB, 3}, {GPIOB, 18}, {GPIOB, 19}, {GPIOC, 0}, \
+                                 {GPIOC, 8}, {GPIOC, 9}, {GPIOD, 0}, {GPIOD, 1}, {GPIOD, 4} }
+#define STROBE_MATRIX_COL_PINS { {GPIOD, 5}, {GPIOD, 6}, {GPIOD, 7}, {GPIOC, 1}, {GPIOC, 2}, \
+                                 {GPIOC, 3}, {GPIOC, 4}, {GPIOC, 5}, {GPIOC, 6}, {GPIOC, 7} }
+
 /* define if matrix has ghost */
 //#define MATRIX_HAS_GHOST
 
@@ -2,25 +2,13 @@
 #ifndef ISSI_H
 #define ISSI_H
 
-typedef struct ISSIDeviceStruct{
-    uint8_t fn_dirty;       // function registers need to be resent
-    uint8_t fn_device_addr;
-    uint8_t fn_register_addr;
-    uint8_t fn_registers[13];
-    uint8_t led_dirty;      // LED data has changed and needs to be resent
-    uint8_t led_device_addr;
-    uint8_t led_register_addr;
-    uint8_t led_ctrl[18];
-    uint8_t led_blink_ctrl[18];
-    uint8_t led_pwm[144];
-}ISSIDeviceStruct;
+#include "is31fl3731.h"
 
-extern ISSIDeviceStruct *issi_devices[];
+// The drivers that answered at init, the others are NULL
+extern is31_device_t *issi_devices[];
 
-// Low level commands- 'device' is the 2-bit i2c id.
+// 'device' is the 2-bit i2c id, the registers are written by is31fl3731.c
 void issi_init(void);
-void set_shutdown(uint8_t device, uint8_t shutdown);
-void writeRegister8(uint8_t device, uint8_t frame, uint8_t reg, uint8_t data);
 
 // Higher level, no device is given, but it is calculated from 'matrix'
 // Each device has 2 blocks, max of 4 devices:
@@ -34,7 +22,10 @@ void writeRegister8(uint8_t device, uint8_t frame, uint8_t reg, uint8_t data);
 //    3           A           6
 //    3           B           7
 void activateLED(uint8_t matrix, uint8_t cx, uint8_t cy, uint8_t pwm);
+// Sends the LEDs of a device if they changed, and waits for them when blocking
 void update_issi(uint8_t device_addr, uint8_t blocking);
+// Sends the changes of all devices without waiting, and resets the bus if it's stuck
+void issi_task(void);
 
 #endif
-#endif
\ No newline at end of file
+#endif
@@ -5,7 +5,7 @@ BOOT_SECTION_SIZE_KB = 4
 BOOT_LOADER = BootloaderHID
 
 # Extra source files for IS3731 lighting
-SRC = TWIlib.c issi.c lighting.c
+SRC = issi.c lighting.c is31fl3731.c i2c_master.c i2c_queue.c
 
 # Processor frequency.
 F_CPU = 16000000
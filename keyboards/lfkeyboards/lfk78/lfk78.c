@@ -4,7 +4,6 @@
 #include "lfk78.h"
 #include "keymap.h"
 #include "issi.h"
-#include "TWIlib.h"
 #include "lighting.h"
 #include "debug.h"
 #include <audio/audio.h>
@@ -52,28 +51,8 @@ void matrix_scan_kb(void)
     wdt_reset();
 #endif
 #ifdef ISSI_ENABLE
-    // switch/underglow lighting update
-    static uint32_t issi_device = 0;
-    static uint32_t twi_last_ready = 0;
-    if(twi_last_ready > 1000){
-        // Its been way too long since the last ISSI update, reset the I2C bus and start again
-        dprintf("TWI failed to recover, TWI re-init\n");
-        twi_last_ready = 0;
-        TWIInit();
-        force_issi_refresh();
-    }
-    if(isTWIReady()){
-        twi_last_ready = 0;
-        // If the i2c bus is available, kick off the issi update, alternate between devices
-        update_issi(issi_device, issi_device);
-        if(issi_device){
-            issi_device = 0;
-        }else{
-            issi_device = 3;
-        }
-    }else{
-        twi_last_ready++;
-    }
+    // switch/underglow lighting update, the frames are sent in the background
+    issi_task();
 #endif
     // Update layer indicator LED
     //
@@ -19,7 +19,7 @@ OPT_DEFS += -DLFK_REV_$(LFK_REV)
 OPT_DEFS += -DLFK_REV_STRING=\"Rev$(LFK_REV)\"
 
 # Extra source files for IS3731 lighting
-SRC = TWIlib.c issi.c lighting.c
+SRC = issi.c lighting.c is31fl3731.c i2c_master.c i2c_queue.c
 
 # Processor frequency.
 F_CPU = 16000000
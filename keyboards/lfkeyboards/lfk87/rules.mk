@@ -16,7 +16,7 @@ endif
 OPT_DEFS += -DLFK_TKL_REV_$(LFK_REV)
 
 # Extra source files for IS3731 lighting
-SRC = TWIlib.c issi.c lighting.c
+SRC = issi.c lighting.c is31fl3731.c i2c_master.c i2c_queue.c
 
 # Processor frequency.
 F_CPU = 16000000
@@ -1,4 +1,4 @@
-SRC = TWIlib.c issi.c lighting.c
+SRC = issi.c lighting.c is31fl3731.c i2c_master.c i2c_queue.c
 
 MCU = atmega32u4
 OPT_DEFS += -DBOOTLOADER_SIZE=4096
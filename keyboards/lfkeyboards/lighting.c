@@ -7,7 +7,6 @@
 #include "quantum.h"
 // #include "lfk87.h"
 #include "issi.h"
-#include "TWIlib.h"
 #include "lighting.h"
 #include "debug.h"
 #include "rgblight.h"
@@ -106,7 +105,6 @@ void set_backlight_by_keymap(uint8_t col, uint8_t row){
     if(lookup_value & 0x80){
         matrix = switch_matrices[1];
     }
-    issi_devices[0]->led_dirty = 1;
     uint8_t led_col = (lookup_value & 0x70) >> 4;
     uint8_t led_row = lookup_value & 0x0F;
     activateLED(matrix, led_col, led_row, 255);
@@ -115,10 +113,12 @@ void set_backlight_by_keymap(uint8_t col, uint8_t row){
 
 void force_issi_refresh(){
 #ifdef ISSI_ENABLE
-    issi_devices[0]->led_dirty = true;
-    update_issi(0, true);
-    issi_devices[3]->led_dirty = true;
-    update_issi(3, true);
+    for(uint8_t device_addr = 0; device_addr < 4; device_addr++){
+        if(issi_devices[device_addr] != 0){
+            IS31FL3731_invalidate(issi_devices[device_addr]);
+            update_issi(device_addr, true);
+        }
+    }
 #endif
 }
 
@@ -1 +1 @@
-SRC = TWIlib.c issi.c lighting.c
+SRC = issi.c lighting.c is31fl3731.c i2c_master.c i2c_queue.c
@@ -2,7 +2,7 @@ MCU = at90usb646
 OPT_DEFS += -DBOOTLOADER_SIZE=4096
 
 # Extra source files for IS3731 lighting
-SRC = TWIlib.c issi.c lighting.c
+SRC = issi.c lighting.c is31fl3731.c i2c_master.c i2c_queue.c
 
 # Processor frequency.
 F_CPU = 16000000
@@ -5,7 +5,6 @@
 #include "keymap.h"
 #include "debug.h"
 #include "issi.h"
-#include "TWIlib.h"
 #include "lighting.h"
 
 uint16_t click_hz = CLICK_HZ;
@@ -31,6 +31,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define MATRIX_ROWS 9
 #define MATRIX_COLS 8
 
+/* matrix pins, strobed by PIT0 */
+#define STROBE_MATRIX_ROW_PINS { {GPIOB, 2}, {GPIOB, 3}, {GPIOB, 18}, {GPIOB, 19}, {GPIOC, 0}, \
+                                 {GPIOC, 8}, {GPIOC, 9}, {GPIOC, 10}, {GPIOC, 11} }
+#define STROBE_MATRIX_COL_PINS { {GPIOD, 0}, {GPIOD, 1}, {GPIOD, 4}, {GPIOD, 5}, {GPIOD, 6}, \
+                                 {GPIOD, 7}, {GPIOC, 1}, {GPIOC, 2} }
+
 /* number of backlight levels */
 #define BACKLIGHT_LEVELS 3
 
@@ -49,6 +49,11 @@
  * I2C driver settings
  */
 #define KINETIS_I2C_USE_I2C0                TRUE
+
+/*
+ * GPT driver system settings, PIT0 strobes the matrix.
+ */
+#define KINETIS_GPT_USE_PIT0                TRUE
 #define KINETIS_I2C_I2C0_PRIORITY           4
 
 #endif /* _MCUCONF_H_ */
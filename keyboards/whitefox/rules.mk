@@ -68,6 +68,7 @@ COMMAND_ENABLE = yes    # Commands for debug and configuration
 #SLEEP_LED_ENABLE = yes  # Breathing sleep LED during USB suspend
 NKRO_ENABLE = yes	    # USB Nkey Rollover
 CUSTOM_MATRIX = yes # Custom matrix file
+STROBE_MATRIX_ENABLE = yes
 BACKLIGHT_ENABLE = yes
 VISUALIZER_ENABLE = yes
 
@@ -0,0 +1,157 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "deadline.h"
+#include "timer.h"
+#include <stddef.h>
+
+static deadline_t* heap[DEADLINE_MAX];
+static uint8_t heap_size = 0;
+// The deadlines that didn't fit into the heap
+static deadline_t* polled = NULL;
+
+// The deadlines are compared relative to each other, so that it works when the timer wraps
+static inline bool is_before(deadline_t* a, deadline_t* b) {
+    return (int16_t)(a->time - b->time) < 0;
+}
+
+static inline void place(deadline_t* deadline, uint8_t pos) {
+    heap[pos] = deadline;
+    deadline->index = pos + 1;
+}
+
+static void sift_up(uint8_t pos) {
+    deadline_t* deadline = heap[pos];
+    while (pos > 0) {
+        uint8_t parent = (pos - 1) / 2;
+        if (!is_before(deadline, heap[parent])) {
+            break;
+        }
+        place(heap[parent], pos);
+        pos = parent;
+    }
+    place(deadline, pos);
+}
+
+static void sift_down(uint8_t pos) {
+    deadline_t* deadline = heap[pos];
+    while (true) {
+        uint8_t child = pos * 2 + 1;
+        if (child >= heap_size) {
+            break;
+        }
+        if (child + 1 < heap_size && is_before(heap[child + 1], heap[child])) {
+            child++;
+        }
+        if (!is_before(heap[child], deadline)) {
+            break;
+        }
+        place(heap[child], pos);
+        pos = child;
+    }
+    place(deadline, pos);
+}
+
+static void remove_at(uint8_t pos) {
+    heap[pos]->index = 0;
+    heap_size--;
+    if (pos == heap_size) {
+        return;
+    }
+    place(heap[heap_size], pos);
+    if (pos > 0 && is_before(heap[pos], heap[(pos - 1) / 2])) {
+        sift_up(pos);
+    } else {
+        sift_down(pos);
+    }
+}
+
+static void unlink_polled(deadline_t* deadline) {
+    deadline_t** next = &polled;
+    while (*next != deadline) {
+        next = &(*next)->next;
+    }
+    *next = deadline->next;
+    deadline->index = 0;
+}
+
+static void unschedule(deadline_t* deadline) {
+    if (deadline->index == DEADLINE_POLLED) {
+        unlink_polled(deadline);
+    } else {
+        remove_at(deadline->index - 1);
+    }
+}
+
+static void insert(deadline_t* deadline) {
+    place(deadline, heap_size);
+    heap_size++;
+    sift_up(heap_size - 1);
+}
+
+bool deadline_set(deadline_t* deadline, uint16_t time, deadline_fn_t fn) {
+    if (deadline_is_set(deadline)) {
+        unschedule(deadline);
+    }
+    deadline->time = time;
+    deadline->fn = fn;
+    if (heap_size >= DEADLINE_MAX) {
+        deadline->index = DEADLINE_POLLED;
+        deadline->next = polled;
+        polled = deadline;
+        return false;
+    }
+    insert(deadline);
+    return true;
+}
+
+void deadline_cancel(deadline_t* deadline) {
+    if (deadline_is_set(deadline)) {
+        unschedule(deadline);
+    }
+}
+
+void deadline_task(void) {
+    // Move what didn't fit before into the heap
+    while (polled && heap_size < DEADLINE_MAX) {
+        deadline_t* deadline = polled;
+        polled = deadline->next;
+        insert(deadline);
+    }
+    if (heap_size == 0) {
+        return;
+    }
+    uint16_t now = timer_read();
+    while (heap_size > 0 && (int16_t)(now - heap[0]->time) >= 0) {
+        deadline_t* deadline = heap[0];
+        remove_at(0);
+        deadline->fn(deadline);
+    }
+    // Only when the heap is full
+    deadline_t** next = &polled;
+    while (*next) {
+        deadline_t* deadline = *next;
+        if ((int16_t)(now - deadline->time) >= 0) {
+            unlink_polled(deadline);
+            deadline->fn(deadline);
+            // The callback can change the list
+            next = &polled;
+        } else {
+            next = &deadline->next;
+        }
+    }
+}
@@ -0,0 +1,73 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef DEADLINE_H
+#define DEADLINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// A scheduler for the timeouts of the key processing features
+//
+// Instead of every feature checking its timers on every scan, the features set a
+// deadline, and deadline_task calls it when the time is up. The deadlines are kept
+// in a min-heap, so a scan only does work when something expires.
+//
+// The times are 16-bit timer_read values, so a deadline can't be more than 32 seconds
+// away from the others.
+//
+// When the heap is full, a deadline goes into a list that deadline_task walks on
+// every scan instead, until there's room in the heap again. So a deadline always
+// fires, it's just slower to check when there are too many.
+
+// The number of deadlines in the heap, the rest are polled
+#ifndef DEADLINE_MAX
+#define DEADLINE_MAX 16
+#endif
+
+#if DEADLINE_MAX > 254
+#error "DEADLINE_MAX can be at most 254"
+#endif
+
+typedef struct deadline_t deadline_t;
+typedef void (*deadline_fn_t)(deadline_t* deadline);
+
+// Embed this in the feature's own state, the callback can find it with offsetof
+struct deadline_t {
+    uint16_t time;
+    // 1 + the position in the heap, DEADLINE_POLLED when it's in the list, 0 when it's not set
+    uint8_t index;
+    deadline_fn_t fn;
+    deadline_t* next;
+};
+
+#define DEADLINE_POLLED 0xFF
+
+// Calls fn once the timer has reached time, moves the deadline if it's already set
+// Returns false if there are already DEADLINE_MAX deadlines in the heap, and this one
+// is checked on every scan instead
+bool deadline_set(deadline_t* deadline, uint16_t time, deadline_fn_t fn);
+void deadline_cancel(deadline_t* deadline);
+
+static inline bool deadline_is_set(const deadline_t* deadline) {
+    return deadline->index != 0;
+}
+
+// Calls the expired deadlines, the callbacks can set new ones
+void deadline_task(void);
+
+#endif
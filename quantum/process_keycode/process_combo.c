@@ -15,7 +15,9 @@
  */
 
 #include "process_combo.h"
+#include "action_tapping.h"
 #include "print.h"
+#include "latency_trace.h"
 
 
 #define COMBO_TIMER_ELAPSED -1
@@ -33,6 +35,18 @@ void process_combo_event(uint8_t combo_index, bool pressed) {
 
 static uint8_t current_combo_index = 0;
 
+// One deadline for all the combos, set to the one that times out first
+static deadline_t combo_deadline;
+static void combo_timed_out(deadline_t *deadline);
+
+static inline void schedule_combo_timeout(uint16_t timer)
+{
+    // The timers are started in order, so an earlier one is already scheduled
+    if (!deadline_is_set(&combo_deadline)) {
+        deadline_set(&combo_deadline, timer + COMBO_TERM + 1, combo_timed_out);
+    }
+}
+
 static inline void send_combo(uint16_t action, bool pressed)
 {
     if (action) {
@@ -46,24 +60,112 @@ static inline void send_combo(uint16_t action, bool pressed)
     }
 }
 
+/* The keys of all the combos sorted by keycode, and by combo for the same
+ * keycode, so that a key event only visits the combos it is part of. If the
+ * combos have more keys than COMBO_INDEX_SIZE, every combo is searched instead.
+ */
+#if COMBO_INDEX_SIZE > 0
+#if COMBO_COUNT > 256
+#error "The combo index supports at most 256 combos"
+#endif
+static combo_key_t combo_index[COMBO_INDEX_SIZE];
+static uint16_t combo_index_count = 0;
+static uint8_t combo_sizes[COMBO_COUNT];
+static bool combo_index_built = false;
+static bool combo_index_valid = false;
+static bool combo_index_enabled = true;
+
+static bool build_combo_index(void)
+{
+    for (uint16_t c = 0; c < COMBO_COUNT; ++c) {
+        // Do not treat the (weak) key_combos too strict.
+        #pragma GCC diagnostic push
+        #pragma GCC diagnostic ignored "-Warray-bounds"
+        const uint16_t *keys = key_combos[c].keys;
+        #pragma GCC diagnostic pop
+        uint8_t count = 0;
+        while (COMBO_END != pgm_read_word(&keys[count])) ++count;
+        combo_sizes[c] = count;
+
+        for (uint8_t position = 0; position < count; ++position) {
+            uint16_t keycode = pgm_read_word(&keys[position]);
+            /* A keycode that is repeated uses the last position, like the full search */
+            bool repeated = false;
+            for (uint8_t later = position + 1; later < count; ++later) {
+                if (keycode == pgm_read_word(&keys[later])) repeated = true;
+            }
+            if (repeated) continue;
+
+            if (COMBO_INDEX_SIZE == combo_index_count) return false;
+            /* Insert after the keys with the same keycode to keep the combos in order */
+            uint16_t i = combo_index_count++;
+            for (; i > 0 && combo_index[i - 1].keycode > keycode; --i) {
+                combo_index[i] = combo_index[i - 1];
+            }
+            combo_index[i].keycode = keycode;
+            combo_index[i].combo = c;
+            combo_index[i].position = position;
+        }
+    }
+    return true;
+}
+
+bool combo_index_init(void)
+{
+    if (!combo_index_built) {
+        combo_index_built = true;
+        combo_index_valid = build_combo_index();
+    }
+    return combo_index_valid;
+}
+
+void combo_index_enable(bool enable)
+{
+    combo_index_enabled = enable;
+}
+
+uint16_t combo_keys_for(uint16_t keycode, const combo_key_t **keys)
+{
+    uint16_t first = 0;
+    uint16_t last = combo_index_init() ? combo_index_count : 0;
+
+    while (first < last) {
+        uint16_t middle = first + (last - first) / 2;
+        if (combo_index[middle].keycode < keycode) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+
+    uint16_t count = 0;
+    while (first + count < combo_index_count && keycode == combo_index[first + count].keycode) ++count;
+    *keys = &combo_index[first];
+    return count;
+}
+#else
+bool combo_index_init(void)
+{
+    return false;
+}
+
+uint16_t combo_keys_for(uint16_t keycode, const combo_key_t **keys)
+{
+    *keys = NULL;
+    return 0;
+}
+
+void combo_index_enable(bool enable)
+{
+}
+#endif
+
 #define ALL_COMBO_KEYS_ARE_DOWN     (((1<<count)-1) == combo->state)
 #define NO_COMBO_KEYS_ARE_DOWN      (0 == combo->state)
 #define KEY_STATE_DOWN(key)         do{ combo->state |= (1<<key); } while(0)
 #define KEY_STATE_UP(key)           do{ combo->state &= ~(1<<key); } while(0)
-static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *record) 
+static bool process_combo_key(combo_t *combo, uint8_t index, uint8_t count, uint16_t keycode, keyrecord_t *record)
 {
-    uint8_t count = 0;
-    uint8_t index = -1;
-    /* Find index of keycode and number of combo keys */
-    for (const uint16_t *keys = combo->keys; ;++count) {
-        uint16_t key = pgm_read_word(&keys[count]);
-        if (keycode == key) index = count;
-        if (COMBO_END == key) break;
-    }
-
-    /* Return if not a combo key */
-    if (-1 == (int8_t)index) return false;
-
     /* The combos timer is used to signal whether the combo is active */
     bool is_combo_active = COMBO_TIMER_ELAPSED == combo->timer ? false : true;
 
@@ -76,10 +178,14 @@ static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *
                 combo->timer = COMBO_TIMER_ELAPSED;
             } else { /* Combo key was pressed */
                 combo->timer = timer_read();
+                schedule_combo_timeout(combo->timer);
 #ifdef COMBO_ALLOW_ACTION_KEYS
                 combo->prev_record = *record;
 #else
                 combo->prev_key = keycode;
+#ifdef LATENCY_TRACE_ENABLE
+                combo->prev_ticks = record->event.ticks;
+#endif
 #endif
             }
         }
@@ -112,10 +218,40 @@ static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *
     return is_combo_active;
 }
 
+static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *record) 
+{
+    uint8_t count = 0;
+    uint8_t index = -1;
+    /* Find index of keycode and number of combo keys */
+    for (const uint16_t *keys = combo->keys; ;++count) {
+        uint16_t key = pgm_read_word(&keys[count]);
+        if (keycode == key) index = count;
+        if (COMBO_END == key) break;
+    }
+
+    /* Return if not a combo key */
+    if (-1 == (int8_t)index) return false;
+
+    return process_combo_key(combo, index, count, keycode, record);
+}
+
 bool process_combo(uint16_t keycode, keyrecord_t *record)
 {
     bool is_combo_key = false;
 
+#if COMBO_INDEX_SIZE > 0
+    if (combo_index_enabled && combo_index_init()) {
+        const combo_key_t *keys;
+        uint16_t count = combo_keys_for(keycode, &keys);
+        for (uint16_t i = 0; i < count; ++i) {
+            current_combo_index = keys[i].combo;
+            combo_t *combo = &key_combos[current_combo_index];
+            is_combo_key |= process_combo_key(combo, keys[i].position, combo_sizes[current_combo_index], keycode, record);
+        }
+        return !is_combo_key;
+    }
+#endif
+
     for (current_combo_index = 0; current_combo_index < COMBO_COUNT; ++current_combo_index) {
         combo_t *combo = &key_combos[current_combo_index];
         is_combo_key |= process_single_combo(combo, keycode, record);
@@ -124,8 +260,11 @@ bool process_combo(uint16_t keycode, keyrecord_t *record)
     return !is_combo_key;
 }
 
-void matrix_scan_combo(void)
+static void combo_timed_out(deadline_t *deadline)
 {
+    bool pending = false;
+    uint16_t next = 0;
+
     for (int i = 0; i < COMBO_COUNT; ++i) {
         // Do not treat the (weak) key_combos too strict.
         #pragma GCC diagnostic push
@@ -142,13 +281,26 @@ void matrix_scan_combo(void)
             combo->timer = COMBO_TIMER_ELAPSED;
 
 #ifdef COMBO_ALLOW_ACTION_KEYS
+            LATENCY_TRACE_BEGIN(combo->prev_record.event.ticks);
             process_action(&combo->prev_record, 
                 store_or_get_action(combo->prev_record.event.pressed, 
                                     combo->prev_record.event.key));
 #else
+            LATENCY_TRACE_BEGIN(combo->prev_ticks);
             unregister_code16(combo->prev_key);
             register_code16(combo->prev_key);
 #endif
+            LATENCY_TRACE_END();
+        } else if (combo->timer && combo->timer != COMBO_TIMER_ELAPSED) {
+            uint16_t time = combo->timer + COMBO_TERM + 1;
+            if (!pending || (int16_t)(time - next) < 0) {
+                next = time;
+            }
+            pending = true;
         }
     }
+
+    if (pending) {
+        deadline_set(deadline, next, combo_timed_out);
+    }
 }
@@ -37,6 +37,9 @@ typedef struct
     keyrecord_t prev_record;
 #else
     uint16_t prev_key;
+#ifdef LATENCY_TRACE_ENABLE
+    uint32_t prev_ticks;
+#endif
 #endif
 } combo_t;
 
@@ -51,9 +54,29 @@ typedef struct
 #ifndef COMBO_TERM
 #define COMBO_TERM TAPPING_TERM
 #endif
+// The total number of keys in all the combos that fits in the index, 0 to search every combo.
+// The index takes 4 bytes of RAM per key, so it's off unless the keymap sets it, which is
+// worth it with many combos.
+#ifndef COMBO_INDEX_SIZE
+#define COMBO_INDEX_SIZE 0
+#endif
+
+// A key of a combo, in the index from keycode to the combos that contain it
+typedef struct
+{
+    uint16_t keycode;
+    uint8_t combo;
+    uint8_t position;
+} combo_key_t;
 
 bool process_combo(uint16_t keycode, keyrecord_t *record);
-void matrix_scan_combo(void);
 void process_combo_event(uint8_t combo_index, bool pressed);
 
+// Builds the index on the first call, returns false if the combos don't fit in it
+bool combo_index_init(void);
+// Returns the number of combos that contain the keycode, and sets keys to the first one
+uint16_t combo_keys_for(uint16_t keycode, const combo_key_t **keys);
+// Searches every combo instead when disabled, the index is used by default
+void combo_index_enable(bool enable);
+
 #endif
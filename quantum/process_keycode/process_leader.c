@@ -35,6 +35,60 @@ uint16_t leader_time = 0;
 uint16_t leader_sequence[5] = {0, 0, 0, 0, 0};
 uint8_t leader_sequence_size = 0;
 
+__attribute__ ((weak))
+const leader_key_t leader_trie[] PROGMEM = {
+  LEADER_END
+};
+
+__attribute__ ((weak))
+void process_leader_action(uint16_t action) {}
+
+// The keys of the node reached by the sequence so far, NULL when the trie isn't used,
+// and the action that fires if the sequence ends here
+static const leader_key_t *leader_node = NULL;
+static uint16_t leader_action = 0;
+static deadline_t leader_deadline;
+
+static void leader_finish(uint16_t action) {
+  deadline_cancel(&leader_deadline);
+  leading = false;
+  leader_node = NULL;
+  leader_end();
+  if (action) {
+    process_leader_action(action);
+  }
+}
+
+static void leader_timed_out(deadline_t *deadline) {
+  leader_finish(leader_action);
+}
+
+// The timeout starts again from every key, so a sequence can be of any length
+static void leader_wait(void) {
+  deadline_set(&leader_deadline, timer_read() + LEADER_TIMEOUT + 1, leader_timed_out);
+}
+
+static void leader_trie_key(uint16_t keycode) {
+  const leader_key_t *key = leader_node;
+  uint16_t key_keycode;
+  while ((key_keycode = pgm_read_word(&key->keycode)) != 0 && key_keycode != keycode) {
+    ++key;
+  }
+
+  if (!key_keycode) { /* No sequence starts like this */
+    leader_finish(0);
+    return;
+  }
+
+  leader_action = pgm_read_word(&key->action);
+  leader_node = pgm_read_ptr(&key->next);
+  if (!leader_node) { /* The only sequence left */
+    leader_finish(leader_action);
+    return;
+  }
+  leader_wait();
+}
+
 bool process_leader(uint16_t keycode, keyrecord_t *record) {
   // Leader key set-up
   if (record->event.pressed) {
@@ -48,11 +102,22 @@ bool process_leader(uint16_t keycode, keyrecord_t *record) {
       leader_sequence[2] = 0;
       leader_sequence[3] = 0;
       leader_sequence[4] = 0;
+      if (pgm_read_word(&leader_trie[0].keycode)) {
+        leader_node = leader_trie;
+        leader_action = 0;
+        leader_wait();
+      }
+      return false;
+    }
+    if (leading && leader_node) {
+      leader_trie_key(keycode);
       return false;
     }
     if (leading && timer_elapsed(leader_time) < LEADER_TIMEOUT) {
-      leader_sequence[leader_sequence_size] = keycode;
-      leader_sequence_size++;
+      if (leader_sequence_size < sizeof(leader_sequence) / sizeof(leader_sequence[0])) {
+        leader_sequence[leader_sequence_size] = keycode;
+        leader_sequence_size++;
+      }
       return false;
     }
   }
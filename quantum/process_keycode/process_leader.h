@@ -25,6 +25,26 @@ bool process_leader(uint16_t keycode, keyrecord_t *record);
 void leader_start(void);
 void leader_end(void);
 
+// A key in the leader trie. The keys of a node are an array that ends with
+// LEADER_END. A key can lead to another node, fire an action, or both. An
+// action on a key with no node fires right away, otherwise it fires when no
+// key follows within LEADER_TIMEOUT.
+typedef struct leader_key_t {
+  uint16_t keycode;
+  uint16_t action;
+  const struct leader_key_t *next;
+} leader_key_t;
+
+#define LEADER_NODE(kc, node)             {.keycode = (kc), .action = 0, .next = (node)}
+#define LEADER_ACTION(kc, act)            {.keycode = (kc), .action = (act), .next = NULL}
+#define LEADER_NODE_ACTION(kc, node, act) {.keycode = (kc), .action = (act), .next = (node)}
+#define LEADER_END                        {.keycode = 0, .action = 0, .next = NULL}
+
+// The root node of the trie, a keymap that defines it doesn't need LEADER_DICTIONARY
+extern const leader_key_t leader_trie[];
+// Called with the action of the sequence, the actions have to be non-zero
+void process_leader_action(uint16_t action);
+
 
 #define SEQ_ONE_KEY(key) if (leader_sequence[0] == (key) && leader_sequence[1] == 0 && leader_sequence[2] == 0 && leader_sequence[3] == 0 && leader_sequence[4] == 0)
 #define SEQ_TWO_KEYS(key1, key2) if (leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == 0 && leader_sequence[3] == 0 && leader_sequence[4] == 0)
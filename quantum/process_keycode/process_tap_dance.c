@@ -13,15 +13,35 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <stddef.h>
 #include "quantum.h"
 #include "action_tapping.h"
+#include "latency_trace.h"
 
 #ifndef NO_ACTION_ONESHOT
 uint8_t get_oneshot_mods(void);
 #endif
 
 static uint16_t last_td;
-static int8_t highest_td = -1;
+// The dances with a count, in the order of tap_dance_actions
+static qk_tap_dance_action_t *active_tds = NULL;
+
+static void activate_tap_dance (qk_tap_dance_action_t *action) {
+  qk_tap_dance_action_t **next = &active_tds;
+  while (*next && *next < action)
+    next = &(*next)->next_active;
+  action->next_active = *next;
+  *next = action;
+}
+
+static void deactivate_tap_dance (qk_tap_dance_action_t *action) {
+  qk_tap_dance_action_t **next = &active_tds;
+  while (*next && *next != action)
+    next = &(*next)->next_active;
+  // Leave next_active as it is, so that a loop over the list can go on from it
+  if (*next)
+    *next = action->next_active;
+}
 
 void qk_tap_dance_pair_on_each_tap (qk_tap_dance_state_t *state, void *user_data) {
   qk_tap_dance_pair_t *pair = (qk_tap_dance_pair_t *)user_data;
@@ -118,11 +138,7 @@ void preprocess_tap_dance(uint16_t keycode, keyrecord_t *record) {
   if (!record->event.pressed)
     return;
 
-  if (highest_td == -1)
-    return;
-
-  for (int i = 0; i <= highest_td; i++) {
-    action = &tap_dance_actions[i];
+  for (action = active_tds; action; action = action->next_active) {
     if (action->state.count) {
       if (keycode == action->state.keycode && keycode == last_td)
         continue;
@@ -133,21 +149,38 @@ void preprocess_tap_dance(uint16_t keycode, keyrecord_t *record) {
   }
 }
 
+static void tap_dance_timed_out(deadline_t *deadline) {
+  qk_tap_dance_action_t *action = (qk_tap_dance_action_t *)((char *)deadline - offsetof(qk_tap_dance_action_t, deadline));
+
+  if (action->state.count) {
+    LATENCY_TRACE_BEGIN(action->state.ticks);
+    process_tap_dance_action_on_dance_finished (action);
+    reset_tap_dance (&action->state);
+    LATENCY_TRACE_END();
+  }
+}
+
 bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
   uint16_t idx = keycode - QK_TAP_DANCE;
   qk_tap_dance_action_t *action;
 
   switch(keycode) {
   case QK_TAP_DANCE ... QK_TAP_DANCE_MAX:
-    if ((int16_t)idx > highest_td)
-      highest_td = idx;
     action = &tap_dance_actions[idx];
 
     action->state.pressed = record->event.pressed;
     if (record->event.pressed) {
       action->state.keycode = keycode;
+      if (!action->state.count)
+        activate_tap_dance (action);
       action->state.count++;
       action->state.timer = timer_read();
+#ifdef LATENCY_TRACE_ENABLE
+      action->state.ticks = record->event.ticks;
+#endif
+      uint16_t tapping_term = action->custom_tapping_term > 0 ? action->custom_tapping_term : TAPPING_TERM;
+      // When the heap is full this is polled on every scan, so it still times out
+      deadline_set(&action->deadline, action->state.timer + tapping_term + 1, tap_dance_timed_out);
 #ifndef NO_ACTION_ONESHOT
       action->state.oneshot_mods = get_oneshot_mods();
 #else
@@ -172,26 +205,6 @@ bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
 
 
 
-void matrix_scan_tap_dance () {
-  if (highest_td == -1)
-    return;
-  uint16_t tap_user_defined;
-
-  for (uint8_t i = 0; i <= highest_td; i++) {
-    qk_tap_dance_action_t *action = &tap_dance_actions[i];
-    if(action->custom_tapping_term > 0 ) {
-      tap_user_defined = action->custom_tapping_term;
-    }
-    else{
-      tap_user_defined = TAPPING_TERM;
-    }
-    if (action->state.count && timer_elapsed (action->state.timer) > tap_user_defined) {
-      process_tap_dance_action_on_dance_finished (action);
-      reset_tap_dance (&action->state);
-    }
-  }
-}
-
 void reset_tap_dance (qk_tap_dance_state_t *state) {
   qk_tap_dance_action_t *action;
 
@@ -201,6 +214,9 @@ void reset_tap_dance (qk_tap_dance_state_t *state) {
   action = &tap_dance_actions[state->keycode - QK_TAP_DANCE];
 
   process_tap_dance_action_on_reset (action);
+  deadline_cancel (&action->deadline);
+  if (state->count)
+    deactivate_tap_dance (action);
 
   state->count = 0;
   state->interrupted = false;
@@ -20,6 +20,7 @@
 
 #include <stdbool.h>
 #include <inttypes.h>
+#include "deadline.h"
 
 typedef struct
 {
@@ -31,13 +32,16 @@ typedef struct
   bool interrupted;
   bool pressed;
   bool finished;
+#ifdef LATENCY_TRACE_ENABLE
+  uint32_t ticks;   // of the last tap
+#endif
 } qk_tap_dance_state_t;
 
 #define TD(n) (QK_TAP_DANCE + n)
 
 typedef void (*qk_tap_dance_user_fn_t) (qk_tap_dance_state_t *state, void *user_data);
 
-typedef struct
+typedef struct qk_tap_dance_action_t
 {
   struct {
     qk_tap_dance_user_fn_t on_each_tap;
@@ -47,6 +51,9 @@ typedef struct
   qk_tap_dance_state_t state;
   uint16_t custom_tapping_term;
   void *user_data;
+  deadline_t deadline;
+  // The next dance in the list of dances that have been tapped and not reset
+  struct qk_tap_dance_action_t *next_active;
 } qk_tap_dance_action_t;
 
 typedef struct
@@ -93,7 +100,6 @@ extern qk_tap_dance_action_t tap_dance_actions[];
 
 void preprocess_tap_dance(uint16_t keycode, keyrecord_t *record);
 bool process_tap_dance(uint16_t keycode, keyrecord_t *record);
-void matrix_scan_tap_dance (void);
 void reset_tap_dance (qk_tap_dance_state_t *state);
 
 void qk_tap_dance_pair_on_each_tap (qk_tap_dance_state_t *state, void *user_data);
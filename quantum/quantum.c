@@ -30,6 +30,8 @@
 #include "backlight.h"
 extern backlight_config_t backlight_config;
 
+#include "profile.h"
+
 #ifdef FAUXCLICKY_ENABLE
 #include "fauxclicky.h"
 #endif
@@ -319,9 +321,6 @@ bool process_record_quantum(keyrecord_t *record) {
     if (!record->event.pressed) {
     #endif
       rgblight_toggle();
-      #ifdef SPLIT_KEYBOARD
-          RGB_DIRTY = true;
-      #endif
     }
     return false;
   case RGB_MODE_FORWARD:
@@ -333,9 +332,6 @@ bool process_record_quantum(keyrecord_t *record) {
       else {
         rgblight_step();
       }
-      #ifdef SPLIT_KEYBOARD
-          RGB_DIRTY = true;
-      #endif
     }
     return false;
   case RGB_MODE_REVERSE:
@@ -347,9 +343,6 @@ bool process_record_quantum(keyrecord_t *record) {
       else {
         rgblight_step_reverse();
       }
-      #ifdef SPLIT_KEYBOARD
-          RGB_DIRTY = true;
-      #endif
     }
     return false;
   case RGB_HUI:
@@ -360,9 +353,6 @@ bool process_record_quantum(keyrecord_t *record) {
     if (!record->event.pressed) {
     #endif
       rgblight_increase_hue();
-      #ifdef SPLIT_KEYBOARD
-          RGB_DIRTY = true;
-      #endif
     }
     return false;
   case RGB_HUD:
@@ -373,9 +363,6 @@ bool process_record_quantum(keyrecord_t *record) {
     if (!record->event.pressed) {
     #endif
       rgblight_decrease_hue();
-      #ifdef SPLIT_KEYBOARD
-          RGB_DIRTY = true;
-      #endif
     }
     return false;
   case RGB_SAI:
@@ -386,9 +373,6 @@ bool process_record_quantum(keyrecord_t *record) {
     if (!record->event.pressed) {
     #endif
       rgblight_increase_sat();
-      #ifdef SPLIT_KEYBOARD
-          RGB_DIRTY = true;
-      #endif
     }
     return false;
   case RGB_SAD:
@@ -399,9 +383,6 @@ bool process_record_quantum(keyrecord_t *record) {
     if (!record->event.pressed) {
     #endif
       rgblight_decrease_sat();
-      #ifdef SPLIT_KEYBOARD
-          RGB_DIRTY = true;
-      #endif
     }
     return false;
   case RGB_VAI:
@@ -412,9 +393,6 @@ bool process_record_quantum(keyrecord_t *record) {
     if (!record->event.pressed) {
     #endif
       rgblight_increase_val();
-      #ifdef SPLIT_KEYBOARD
-          RGB_DIRTY = true;
-      #endif
     }
     return false;
   case RGB_VAD:
@@ -425,9 +403,6 @@ bool process_record_quantum(keyrecord_t *record) {
     if (!record->event.pressed) {
     #endif
       rgblight_decrease_val();
-      #ifdef SPLIT_KEYBOARD
-          RGB_DIRTY = true;
-      #endif
     }
     return false;
   case RGB_SPI:
@@ -443,9 +418,6 @@ bool process_record_quantum(keyrecord_t *record) {
   case RGB_MODE_PLAIN:
     if (record->event.pressed) {
       rgblight_mode(1);
-      #ifdef SPLIT_KEYBOARD
-          RGB_DIRTY = true;
-      #endif
     }
     return false;
   case RGB_MODE_BREATHE:
@@ -924,45 +896,42 @@ void matrix_init_quantum() {
   matrix_init_kb();
 }
 
-uint8_t rgb_matrix_task_counter = 0;
-
-#ifndef RGB_MATRIX_SKIP_FRAMES
-  #define RGB_MATRIX_SKIP_FRAMES 1
-#endif
-
 void matrix_scan_quantum() {
+  PROFILE_BEGIN(PROFILE_SCAN_QUANTUM);
+
   #if defined(AUDIO_ENABLE)
+    PROFILE_BEGIN(PROFILE_AUDIO);
     matrix_scan_music();
+    PROFILE_END(PROFILE_AUDIO);
   #endif
 
-  #ifdef TAP_DANCE_ENABLE
-    matrix_scan_tap_dance();
-  #endif
-
-  #ifdef COMBO_ENABLE
-    matrix_scan_combo();
-  #endif
+  // Tap dance and combo timeouts
+  PROFILE_BEGIN(PROFILE_DEADLINES);
+  deadline_task();
+  PROFILE_END(PROFILE_DEADLINES);
 
-  #if defined(BACKLIGHT_ENABLE) && defined(BACKLIGHT_PIN)
+  #if defined(BACKLIGHT_ENABLE) && (defined(BACKLIGHT_PIN) || defined(BACKLIGHT_PINS))
     backlight_task();
   #endif
 
   #ifdef RGB_MATRIX_ENABLE
+    PROFILE_BEGIN(PROFILE_RGB_MATRIX);
+    // Draws a frame when it's time, and sends it when the bus is free
     rgb_matrix_task();
-    if (rgb_matrix_task_counter == 0) {
-      rgb_matrix_update_pwm_buffers();
-    }
-    rgb_matrix_task_counter = ((rgb_matrix_task_counter + 1) % (RGB_MATRIX_SKIP_FRAMES + 1));
+    rgb_matrix_update_pwm_buffers();
+    PROFILE_END(PROFILE_RGB_MATRIX);
   #endif
 
   matrix_scan_kb();
-}
-#if defined(BACKLIGHT_ENABLE) && defined(BACKLIGHT_PIN)
 
-static const uint8_t backlight_pin = BACKLIGHT_PIN;
+  PROFILE_END(PROFILE_SCAN_QUANTUM);
+}
+#if defined(BACKLIGHT_ENABLE) && (defined(BACKLIGHT_PIN) || defined(BACKLIGHT_PINS))
 
 // depending on the pin, we use a different output compare unit
-#if BACKLIGHT_PIN == B7
+#if defined(BACKLIGHT_PINS)
+#  define NO_HARDWARE_PWM
+#elif BACKLIGHT_PIN == B7
 #  define TCCRxA TCCR1A
 #  define TCCRxB TCCR1B
 #  define COMxx1 COM1C1
@@ -994,58 +963,35 @@ static const uint8_t backlight_pin = BACKLIGHT_PIN;
 #define BACKLIGHT_ON_STATE 0
 #endif
 
-#ifdef NO_HARDWARE_PWM // pwm through software
+#if defined(NO_HARDWARE_PWM) && defined(BACKLIGHT_CUSTOM_DRIVER)
+
+#ifdef BACKLIGHT_PINS
+static const uint8_t backlight_pins[] = BACKLIGHT_PINS;
+#else
+static const uint8_t backlight_pins[] = { BACKLIGHT_PIN };
+#endif
 
 __attribute__ ((weak))
 void backlight_init_ports(void)
 {
-  // Setup backlight pin as output and output to on state.
-  // DDRx |= n
-  _SFR_IO8((backlight_pin >> 4) + 1) |= _BV(backlight_pin & 0xF);
-  #if BACKLIGHT_ON_STATE == 0
-    // PORTx &= ~n
-    _SFR_IO8((backlight_pin >> 4) + 2) &= ~_BV(backlight_pin & 0xF);
-  #else
-    // PORTx |= n
-    _SFR_IO8((backlight_pin >> 4) + 2) |= _BV(backlight_pin & 0xF);
-  #endif
-}
-
-__attribute__ ((weak))
-void backlight_set(uint8_t level) {}
-
-uint8_t backlight_tick = 0;
-
-#ifndef BACKLIGHT_CUSTOM_DRIVER
-void backlight_task(void) {
-  if ((0xFFFF >> ((BACKLIGHT_LEVELS - get_backlight_level()) * ((BACKLIGHT_LEVELS + 1) / 2))) & (1 << backlight_tick)) {
+  // Setup backlight pins as output and output to on state.
+  for (uint8_t i = 0; i < sizeof(backlight_pins); i++) {
+    // DDRx |= n
+    _SFR_IO8((backlight_pins[i] >> 4) + 1) |= _BV(backlight_pins[i] & 0xF);
     #if BACKLIGHT_ON_STATE == 0
       // PORTx &= ~n
-      _SFR_IO8((backlight_pin >> 4) + 2) &= ~_BV(backlight_pin & 0xF);
+      _SFR_IO8((backlight_pins[i] >> 4) + 2) &= ~_BV(backlight_pins[i] & 0xF);
     #else
       // PORTx |= n
-      _SFR_IO8((backlight_pin >> 4) + 2) |= _BV(backlight_pin & 0xF);
-    #endif
-  } else {
-    #if BACKLIGHT_ON_STATE == 0
-      // PORTx |= n
-      _SFR_IO8((backlight_pin >> 4) + 2) |= _BV(backlight_pin & 0xF);
-    #else
-      // PORTx &= ~n
-      _SFR_IO8((backlight_pin >> 4) + 2) &= ~_BV(backlight_pin & 0xF);
+      _SFR_IO8((backlight_pins[i] >> 4) + 2) |= _BV(backlight_pins[i] & 0xF);
     #endif
   }
-  backlight_tick = (backlight_tick + 1) % 16;
 }
-#endif
 
-#ifdef BACKLIGHT_BREATHING
-  #ifndef BACKLIGHT_CUSTOM_DRIVER
-  #error "Backlight breathing only available with hardware PWM. Please disable."
-  #endif
-#endif
+__attribute__ ((weak))
+void backlight_set(uint8_t level) {}
 
-#else // pwm through timer
+#else
 
 #define TIMER_TOP 0xFFFFU
 
@@ -1065,6 +1011,81 @@ static uint16_t cie_lightness(uint16_t v) {
   }
 }
 
+#ifdef NO_HARDWARE_PWM // pwm through software
+
+#include <util/atomic.h>
+
+/* Timer 1 runs as it does for the hardware PWM, but without driving a pin.
+ * Instead, the overflow interrupt turns the backlight pins on, and the compare
+ * match A interrupt turns them off again, so the brightness doesn't depend on
+ * the matrix scan. Several pins can be given with BACKLIGHT_PINS.
+ */
+
+#if defined(B5_AUDIO) || defined(B6_AUDIO) || defined(B7_AUDIO)
+#error "The software PWM backlight uses timer 1, which is used by audio on B5, B6 and B7."
+#endif
+#ifdef SLEEP_LED_ENABLE
+#error "The software PWM backlight uses timer 1, which is used by the sleep LED."
+#endif
+
+#ifndef TIMSK1
+#define TIMSK1 TIMSK
+#endif
+
+#ifdef BACKLIGHT_PINS
+static const uint8_t backlight_pins[] = BACKLIGHT_PINS;
+#else
+static const uint8_t backlight_pins[] = { BACKLIGHT_PIN };
+#endif
+#define BACKLIGHT_PIN_COUNT (sizeof(backlight_pins) / sizeof(backlight_pins[0]))
+
+static volatile uint16_t backlight_pwm = 0;
+
+static inline void backlight_pins_on(void) {
+  for (uint8_t i = 0; i < BACKLIGHT_PIN_COUNT; i++) {
+    #if BACKLIGHT_ON_STATE == 0
+      // PORTx &= ~n
+      _SFR_IO8((backlight_pins[i] >> 4) + 2) &= ~_BV(backlight_pins[i] & 0xF);
+    #else
+      // PORTx |= n
+      _SFR_IO8((backlight_pins[i] >> 4) + 2) |= _BV(backlight_pins[i] & 0xF);
+    #endif
+  }
+}
+
+static inline void backlight_pins_off(void) {
+  for (uint8_t i = 0; i < BACKLIGHT_PIN_COUNT; i++) {
+    #if BACKLIGHT_ON_STATE == 0
+      // PORTx |= n
+      _SFR_IO8((backlight_pins[i] >> 4) + 2) |= _BV(backlight_pins[i] & 0xF);
+    #else
+      // PORTx &= ~n
+      _SFR_IO8((backlight_pins[i] >> 4) + 2) &= ~_BV(backlight_pins[i] & 0xF);
+    #endif
+  }
+}
+
+// range for val is [0..TIMER_TOP]. The pins are on while the timer count is below val.
+static inline void set_pwm(uint16_t val) {
+  // the interrupts read the timer registers too, which share one temporary register
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    backlight_pwm = val;
+    OCR1A = val;
+  }
+}
+
+__attribute__ ((weak))
+void backlight_set(uint8_t level) {
+  if (level > BACKLIGHT_LEVELS)
+    level = BACKLIGHT_LEVELS;
+
+  set_pwm(cie_lightness(TIMER_TOP * (uint32_t)level / BACKLIGHT_LEVELS));
+}
+
+void backlight_task(void) {}
+
+#else // pwm through timer
+
 // range for val is [0..TIMER_TOP]. PWM pin is high while the timer count is below val.
 static inline void set_pwm(uint16_t val) {
 	OCRxx = val;
@@ -1090,6 +1111,8 @@ void backlight_set(uint8_t level) {
 void backlight_task(void) {}
 #endif  // BACKLIGHT_CUSTOM_DRIVER
 
+#endif // NO_HARDWARE_PWM
+
 #ifdef BACKLIGHT_BREATHING
 
 #define BREATHING_NO_HALT  0
@@ -1101,12 +1124,24 @@ static uint8_t breathing_period = BREATHING_PERIOD;
 static uint8_t breathing_halt = BREATHING_NO_HALT;
 static uint16_t breathing_counter = 0;
 
+#ifdef NO_HARDWARE_PWM
+// The overflow interrupt always runs for the software PWM
+static volatile bool breathing_active = false;
+
+bool is_breathing(void) {
+    return breathing_active;
+}
+
+#define breathing_interrupt_enable() do {breathing_active = true;} while (0)
+#define breathing_interrupt_disable() do {breathing_active = false;} while (0)
+#else
 bool is_breathing(void) {
     return !!(TIMSK1 & _BV(TOIE1));
 }
 
 #define breathing_interrupt_enable() do {TIMSK1 |= _BV(TOIE1);} while (0)
 #define breathing_interrupt_disable() do {TIMSK1 &= ~_BV(TOIE1);} while (0)
+#endif
 #define breathing_min() do {breathing_counter = 0;} while (0)
 #define breathing_max() do {breathing_counter = breathing_period * 244 / 2;} while (0)
 
@@ -1180,10 +1215,10 @@ static inline uint16_t scale_backlight(uint16_t v) {
   return v / BACKLIGHT_LEVELS * get_backlight_level();
 }
 
-/* Assuming a 16MHz CPU clock and a timer that resets at 64k (ICR1), the following interrupt handler will run
+/* Assuming a 16MHz CPU clock and a timer that resets at 64k (ICR1), this is called from the overflow interrupt
  * about 244 times per second.
  */
-ISR(TIMER1_OVF_vect)
+static inline void breathing_task(void)
 {
   uint16_t interval = (uint16_t) breathing_period * 244 / BREATHING_STEPS;
   // resetting after one period to prevent ugly reset at overflow.
@@ -1199,8 +1234,65 @@ ISR(TIMER1_OVF_vect)
   set_pwm(cie_lightness(scale_backlight((uint16_t) pgm_read_byte(&breathing_table[index]) * 0x0101U)));
 }
 
+#ifndef NO_HARDWARE_PWM
+ISR(TIMER1_OVF_vect)
+{
+  breathing_task();
+}
+#endif
+
 #endif // BACKLIGHT_BREATHING
 
+#ifdef NO_HARDWARE_PWM
+
+ISR(TIMER1_COMPA_vect)
+{
+  if (backlight_pwm != TIMER_TOP) {
+    backlight_pins_off();
+  }
+}
+
+ISR(TIMER1_OVF_vect)
+{
+  // OCR1A took its new value at the overflow. For short pulses, the compare
+  // match can already be over by now, and then the pins stay off.
+  uint16_t pwm = backlight_pwm;
+  if (pwm == TIMER_TOP || (pwm && TCNT1 < pwm)) {
+    backlight_pins_on();
+  }
+  #ifdef BACKLIGHT_BREATHING
+    if (breathing_active) {
+      breathing_task();
+    }
+  #endif
+}
+
+__attribute__ ((weak))
+void backlight_init_ports(void)
+{
+  // Setup backlight pins as output and output to on state.
+  for (uint8_t i = 0; i < BACKLIGHT_PIN_COUNT; i++) {
+    // DDRx |= n
+    _SFR_IO8((backlight_pins[i] >> 4) + 1) |= _BV(backlight_pins[i] & 0xF);
+  }
+  backlight_pins_on();
+
+  // Fast PWM up to ICR1 (WGM mode 14), with clk/1 and the output compare pins disconnected
+  TCCR1A = _BV(WGM11);
+  TCCR1B = _BV(WGM13) | _BV(WGM12) | _BV(CS10);
+  ICR1 = TIMER_TOP;
+  TIMSK1 |= _BV(TOIE1) | _BV(OCIE1A);
+
+  backlight_init();
+  #ifdef BACKLIGHT_BREATHING
+    breathing_enable();
+  #endif
+}
+
+#else
+
+static const uint8_t backlight_pin = BACKLIGHT_PIN;
+
 __attribute__ ((weak))
 void backlight_init_ports(void)
 {
@@ -1242,6 +1334,8 @@ void backlight_init_ports(void)
 
 #endif // NO_HARDWARE_PWM
 
+#endif // NO_HARDWARE_PWM && BACKLIGHT_CUSTOM_DRIVER
+
 #else // backlight
 
 __attribute__ ((weak))
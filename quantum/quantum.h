@@ -34,9 +34,6 @@
   #include "rgblight.h"
 #endif
 
-#ifdef SPLIT_KEYBOARD
-    #include "split_flags.h"
-#endif
 
 #ifdef RGB_MATRIX_ENABLE
 	#include "rgb_matrix.h"
@@ -47,6 +44,7 @@
 #include <stddef.h>
 #include "bootloader.h"
 #include "timer.h"
+#include "deadline.h"
 #include "config_common.h"
 #include "led.h"
 #include "action_util.h"
@@ -17,15 +17,19 @@
 
 
 #include "rgb_matrix.h"
+#include "rgb_matrix_program.h"
+#include "rgb_matrix_power.h"
 #include <avr/io.h>
 #include "i2c_master.h"
 #include <util/delay.h>
 #include <avr/interrupt.h>
 #include "progmem.h"
+#include "timer.h"
 #include "config.h"
 #include "eeprom.h"
 #include "lufa.h"
 #include <math.h>
+#include <string.h>
 
 rgb_config_t rgb_matrix_config;
 
@@ -45,9 +49,21 @@ rgb_config_t rgb_matrix_config;
     #define RGB_MATRIX_MAXIMUM_BRIGHTNESS 255
 #endif
 
+#ifdef RGB_MATRIX_PROGRAMS
+    // From the header that util/rgb_matrix_compile.py writes
+    extern const uint8_t * const rgb_matrix_programs[] PROGMEM;
+    extern const uint8_t rgb_matrix_program_count;
+    #define RGB_MATRIX_MODE_MAX (RGB_MATRIX_EFFECT_MAX + rgb_matrix_program_count)
+#else
+    #define RGB_MATRIX_MODE_MAX RGB_MATRIX_EFFECT_MAX
+#endif
+
 bool g_suspend_state = false;
 
-// Global tick at 20 Hz
+// The drivers are in shutdown, while suspended or after the timeout
+bool g_shut_down = false;
+
+// Global tick, every RGB_MATRIX_TICK_MS
 uint32_t g_tick = 0;
 
 // Ticks since this key was last hit.
@@ -105,18 +121,69 @@ void map_row_column_to_led( uint8_t row, uint8_t column, uint8_t *led_i, uint8_t
     }
 }
 
+static void rgb_matrix_limit_current(void);
+
 void rgb_matrix_update_pwm_buffers(void) {
-    IS31FL3731_update_pwm_buffers( DRIVER_ADDR_1, DRIVER_ADDR_2 );
-    IS31FL3731_update_led_control_registers( DRIVER_ADDR_1, DRIVER_ADDR_2 );
+#if RGB_MATRIX_CURRENT_BUDGET > 0
+    // For the colors that were set outside of a frame
+    rgb_matrix_limit_current();
+#endif
+    IS31FL3731_update_pwm_buffers();
 }
 
+#ifdef RGB_MATRIX_HARDWARE_ANIMATIONS
+// While the indicators are probed, setting a color only tells that they want to show something
+static bool g_indicators_probe = false;
+static bool g_indicators_set = false;
+
+#define RGB_MATRIX_PROBE_INDICATORS() \
+    if ( g_indicators_probe ) { \
+        g_indicators_set = true; \
+        return; \
+    }
+#else
+#define RGB_MATRIX_PROBE_INDICATORS()
+#endif
+
+#if RGB_MATRIX_CURRENT_BUDGET > 0
+// The frame as it was drawn, the drivers get it dimmed to fit the budget.
+// Effects that only draw some of the LEDs keep the rest from here, so
+// nothing is dimmed twice.
+static RGB g_rgb_frame[DRIVER_LED_TOTAL];
+static uint32_t g_rgb_frame_total = 0;
+static bool g_rgb_frame_dirty = false;
+
 void rgb_matrix_set_color( int index, uint8_t red, uint8_t green, uint8_t blue ) {
+    RGB_MATRIX_PROBE_INDICATORS();
+    if ( index >= 0 && index < DRIVER_LED_TOTAL ) {
+        RGB *led = &g_rgb_frame[index];
+        if ( led->r != red || led->g != green || led->b != blue ) {
+            g_rgb_frame_total -= (uint16_t)led->r + led->g + led->b;
+            g_rgb_frame_total += (uint16_t)red + green + blue;
+            led->r = red;
+            led->g = green;
+            led->b = blue;
+            g_rgb_frame_dirty = true;
+        }
+    }
+}
+
+void rgb_matrix_set_color_all( uint8_t red, uint8_t green, uint8_t blue ) {
+    for ( int i = 0; i < DRIVER_LED_TOTAL; i++ ) {
+        rgb_matrix_set_color( i, red, green, blue );
+    }
+}
+#else
+void rgb_matrix_set_color( int index, uint8_t red, uint8_t green, uint8_t blue ) {
+    RGB_MATRIX_PROBE_INDICATORS();
     IS31FL3731_set_color( index, red, green, blue );
 }
 
 void rgb_matrix_set_color_all( uint8_t red, uint8_t green, uint8_t blue ) {
+    RGB_MATRIX_PROBE_INDICATORS();
     IS31FL3731_set_color_all( red, green, blue );
 }
+#endif
 
 bool process_rgb_matrix(uint16_t keycode, keyrecord_t *record) {
     if ( record->event.pressed ) {
@@ -146,9 +213,52 @@ bool process_rgb_matrix(uint16_t keycode, keyrecord_t *record) {
 }
 
 void rgb_matrix_set_suspend_state(bool state) {
+    // The task doesn't run while suspended, so the drivers are shut down from here
+    if ( RGB_DISABLE_WHEN_USB_SUSPENDED && state != g_suspend_state ) {
+        // Each call takes the shutdown a step further, until the drivers have it
+        uint16_t start = timer_read();
+        bool done;
+        while ( !( done = IS31FL3731_shutdown_all( state ) ) && timer_elapsed( start ) < 100 ) {
+        }
+        if ( done ) {
+            g_shut_down = state;
+        } else if ( state ) {
+            // Still suspending, this is called again while suspended and tries again
+            return;
+        }
+        // On wake up, the task finishes it
+    }
     g_suspend_state = state;
 }
 
+const rgb_power_stats_t *rgb_matrix_get_power_stats(void) {
+    return rgb_matrix_power_stats();
+}
+
+// Gives the drivers the frame, dimmed when it would draw more than the budget
+static void rgb_matrix_limit_current(void) {
+#if RGB_MATRIX_CURRENT_BUDGET > 0
+    // A frame that stays the same isn't dimmed or sent again
+    if ( !g_rgb_frame_dirty ) {
+        return;
+    }
+    g_rgb_frame_dirty = false;
+    uint8_t scale = rgb_matrix_power_limit( g_rgb_frame_total );
+    for ( int i = 0; i < DRIVER_LED_TOTAL; i++ ) {
+        RGB led = g_rgb_frame[i];
+        if ( scale < 255 ) {
+            led.r = (led.r * (scale + 1)) >> 8;
+            led.g = (led.g * (scale + 1)) >> 8;
+            led.b = (led.b * (scale + 1)) >> 8;
+        }
+        IS31FL3731_set_color( i, led.r, led.g, led.b );
+    }
+#else
+    // Only for the estimate in the stats
+    rgb_matrix_power_limit( IS31FL3731_pwm_total() );
+#endif
+}
+
 void rgb_matrix_test(void) {
     // Mask out bits 4 and 5
     // Increase the factor to make the test animation slower (and reduce to make it faster)
@@ -564,6 +674,199 @@ void rgb_matrix_solid_splash(void) {
 }
 
 
+// A breath takes as long as the chip's breathing of RGB_MATRIX_HARDWARE_ANIMATIONS,
+// fading in and out in 26ms << (6 - speed) each
+void rgb_matrix_breathing(void) {
+    uint16_t period = (26 << (7 - rgb_matrix_config.speed)) / RGB_MATRIX_TICK_MS;
+    HSV hsv = { .h = rgb_matrix_config.hue, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val };
+    hsv.v = hsv.v * (1 - cos((g_tick % period) * 2 * PI / period)) / 2;
+    RGB rgb = hsv_to_rgb( hsv );
+    rgb_matrix_set_color_all( rgb.r, rgb.g, rgb.b );
+}
+
+#ifdef RGB_MATRIX_HARDWARE_ANIMATIONS
+
+#if !defined(RGB_MATRIX_HARDWARE_FRAMES) || RGB_MATRIX_HARDWARE_FRAMES > IS31FL3731_ANIMATION_FRAMES
+    #define RGB_MATRIX_HARDWARE_FRAMES IS31FL3731_ANIMATION_FRAMES
+#endif
+
+// Periodic effects are rendered once into the animation frames of the
+// drivers, which then play them without the MCU or the bus. They are
+// rendered again when the config changes.
+static uint32_t g_hardware_config = 0;
+static uint8_t g_hardware_frames = 0;   // frames that the drivers have
+static bool g_hardware_sent = false;    // a frame is being written
+static bool g_hardware_playing = false;
+
+// Tells how the drivers play the effect, and returns false for the effects that they can't
+static bool rgb_matrix_hardware_animation( uint8_t effect, is31_animation_t *animation ) {
+    uint8_t speed = rgb_matrix_config.speed;
+    memset( animation, 0, sizeof(is31_animation_t) );
+    switch ( effect ) {
+        case RGB_MATRIX_CYCLE_ALL:
+        case RGB_MATRIX_CYCLE_LEFT_RIGHT:
+        case RGB_MATRIX_CYCLE_UP_DOWN:
+            // The hue goes around in 256 >> speed ticks of 50ms, which
+            // is limited by the longest frame delay of 64 * 11ms
+            animation->frames = RGB_MATRIX_HARDWARE_FRAMES;
+            animation->frame_delay = MIN( ((256 >> speed) * 50) / (11 * RGB_MATRIX_HARDWARE_FRAMES), 64 );
+            return true;
+        case RGB_MATRIX_BREATHING:
+            animation->frames = 1;
+            animation->frame_delay = 1;
+            animation->fade_in = 6 - speed;
+            animation->fade_out = 6 - speed;
+            animation->breathe = true;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void rgb_matrix_hardware_render( uint8_t effect, uint8_t frame ) {
+    // The frames split one period of the hue
+    uint32_t tick = g_tick;
+    g_tick = ((256 >> rgb_matrix_config.speed) * frame) / RGB_MATRIX_HARDWARE_FRAMES;
+    switch ( effect ) {
+        case RGB_MATRIX_CYCLE_ALL:
+            rgb_matrix_cycle_all();
+            break;
+        case RGB_MATRIX_CYCLE_LEFT_RIGHT:
+            rgb_matrix_cycle_left_right();
+            break;
+        case RGB_MATRIX_CYCLE_UP_DOWN:
+            rgb_matrix_cycle_up_down();
+            break;
+        case RGB_MATRIX_BREATHING:
+            // The drivers breathe, the frame has the full color
+            rgb_matrix_solid_color();
+            break;
+    }
+    g_tick = tick;
+    rgb_matrix_limit_current();
+}
+
+static bool rgb_matrix_hardware_failed(void) {
+    for ( int i = 0; i < DRIVER_COUNT; i++ ) {
+        if ( g_is31_devices[i].transaction.status < 0 ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Goes back to the picture frames, returns false while the drivers are busy
+static bool rgb_matrix_hardware_stop(void) {
+    bool stopped = true;
+    for ( int i = 0; i < DRIVER_COUNT; i++ ) {
+        if ( !IS31FL3731_stop( &g_is31_devices[i] ) ) {
+            stopped = false;
+        }
+    }
+    if ( stopped ) {
+        g_hardware_frames = 0;
+        g_hardware_sent = false;
+        g_hardware_playing = false;
+    }
+    return stopped;
+}
+
+// Runs the indicators without drawing anything, and tells if they set a color
+static bool rgb_matrix_indicators_active(void) {
+    g_indicators_probe = true;
+    g_indicators_set = false;
+    rgb_matrix_indicators();
+    g_indicators_probe = false;
+    return g_indicators_set;
+}
+
+// Returns true when the drivers play the effect, or the frames are being
+// written, so that nothing else touches the buffers. The MCU draws the
+// effect while an indicator is shown, as the frames don't have it.
+static bool rgb_matrix_hardware_task( uint8_t effect ) {
+    is31_animation_t animation;
+    bool playable = rgb_matrix_hardware_animation( effect, &animation ) && !rgb_matrix_indicators_active();
+
+    if ( !playable || rgb_matrix_config.raw != g_hardware_config ) {
+        if ( !rgb_matrix_hardware_stop() ) {
+            return false;
+        }
+        g_hardware_config = rgb_matrix_config.raw;
+        if ( !playable ) {
+            return false;
+        }
+    }
+    if ( g_hardware_playing ) {
+        // Start again if the drivers didn't take it
+        if ( !IS31FL3731_busy_all() && rgb_matrix_hardware_failed() ) {
+            rgb_matrix_hardware_stop();
+            return false;
+        }
+        return true;
+    }
+    // Wait until key hits have faded out of the cycles, so that they don't end up in the frames
+    if ( g_hardware_frames == 0 && !g_hardware_sent && g_any_key_hit < 16 ) {
+        return false;
+    }
+
+    // One frame at a time, while the buffers aren't being sent
+    if ( IS31FL3731_busy_all() ) {
+        return true;
+    }
+    if ( g_hardware_sent ) {
+        g_hardware_sent = false;
+        if ( !rgb_matrix_hardware_failed() ) {
+            g_hardware_frames++;
+        }
+    }
+    if ( g_hardware_frames < animation.frames ) {
+        rgb_matrix_hardware_render( effect, g_hardware_frames );
+        for ( int i = 0; i < DRIVER_COUNT; i++ ) {
+            IS31FL3731_write_animation_frame( &g_is31_devices[i], g_hardware_frames );
+        }
+        g_hardware_sent = true;
+        return true;
+    }
+    for ( int i = 0; i < DRIVER_COUNT; i++ ) {
+        IS31FL3731_play( &g_is31_devices[i], &animation );
+    }
+    g_hardware_playing = true;
+    return true;
+}
+
+#endif
+
+#ifdef RGB_MATRIX_PROGRAMS
+// Runs one of the compiled programs for every LED
+void rgb_matrix_program( uint8_t index ) {
+#ifdef __AVR__
+    const uint8_t *program = (const uint8_t *)pgm_read_word( &rgb_matrix_programs[index] );
+#else
+    const uint8_t *program = rgb_matrix_programs[index];
+#endif
+    rgb_program_frame_t frame = {
+        .time = ( g_tick << rgb_matrix_config.speed ) & 0xFF,
+        .color = { .h = rgb_matrix_config.hue, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val },
+        .last_age = 255,
+    };
+    if ( g_last_led_count > 0 ) {
+        uint8_t last = g_last_led_hit[0];
+        frame.last_age = g_key_hit[last];
+        frame.last_x = g_rgb_leds[last].point.x;
+        frame.last_y = g_rgb_leds[last].point.y;
+    }
+
+    rgb_program_led_t led;
+    for ( int i = 0; i < DRIVER_LED_TOTAL; i++ ) {
+        led.x = g_rgb_leds[i].point.x;
+        led.y = g_rgb_leds[i].point.y;
+        led.age = g_key_hit[i];
+        RGB rgb = hsv_to_rgb( rgb_matrix_program_run( program, &frame, &led ) );
+        rgb_matrix_set_color( i, rgb.r, rgb.g, rgb.b );
+    }
+}
+#endif
+
 // Needs eeprom access that we don't have setup currently
 
 void rgb_matrix_custom(void) {
@@ -581,29 +884,36 @@ void rgb_matrix_custom(void) {
 
 void rgb_matrix_task(void) {
     static uint8_t toggle_enable_last = 255;
+    uint8_t ticks = rgb_matrix_power_tick( timer_read() );
 	if (!rgb_matrix_config.enable) {
+        #ifdef RGB_MATRIX_HARDWARE_ANIMATIONS
+            rgb_matrix_hardware_task( 0 );
+        #endif
     	rgb_matrix_all_off();
         toggle_enable_last = rgb_matrix_config.enable;
     	return;
     }
     // delay 1 second before driving LEDs or doing anything else
-    static uint8_t startup_tick = 0;
-    if ( startup_tick < 20 ) {
-        startup_tick++;
+    static uint16_t startup_tick = 0;
+    if ( startup_tick < 1000 / RGB_MATRIX_TICK_MS ) {
+        startup_tick += ticks;
         return;
     }
 
-    g_tick++;
+    if ( ticks > 0 ) {
+        g_tick += ticks;
 
-    if ( g_any_key_hit < 0xFFFFFFFF ) {
-        g_any_key_hit++;
-    }
+        g_any_key_hit = g_any_key_hit > 0xFFFFFFFF - ticks ? 0xFFFFFFFF : g_any_key_hit + ticks;
 
-    for ( int led = 0; led < DRIVER_LED_TOTAL; led++ ) {
-        if ( g_key_hit[led] < 255 ) {
-            if (g_key_hit[led] == 254)
-                g_last_led_count = MAX(g_last_led_count - 1, 0);
-            g_key_hit[led]++;
+        for ( int led = 0; led < DRIVER_LED_TOTAL; led++ ) {
+            if ( g_key_hit[led] < 255 ) {
+                uint16_t hit = g_key_hit[led] + ticks;
+                if ( hit >= 255 ) {
+                    g_last_led_count = MAX(g_last_led_count - 1, 0);
+                    hit = 255;
+                }
+                g_key_hit[led] = hit;
+            }
         }
     }
 
@@ -613,11 +923,25 @@ void rgb_matrix_task(void) {
         return;
     }
 
-    // Ideally we would also stop sending zeros to the LED driver PWM buffers
-    // while suspended and just do a software shutdown. This is a cheap hack for now.
-    bool suspend_backlight = ((g_suspend_state && RGB_DISABLE_WHEN_USB_SUSPENDED) ||
-            (RGB_DISABLE_AFTER_TIMEOUT > 0 && g_any_key_hit > RGB_DISABLE_AFTER_TIMEOUT * 60 * 20));
-    uint8_t effect = suspend_backlight ? 0 : rgb_matrix_config.mode;
+    // The drivers keep the last frame, and go back to it when they wake up
+    bool shut_down = ((g_suspend_state && RGB_DISABLE_WHEN_USB_SUSPENDED) ||
+            (RGB_DISABLE_AFTER_TIMEOUT > 0 && g_any_key_hit > RGB_DISABLE_AFTER_TIMEOUT * 60UL * (1000 / RGB_MATRIX_TICK_MS)));
+    if ( shut_down != g_shut_down ) {
+        // Tried again on the next scan while the bus is busy
+        if ( IS31FL3731_shutdown_all( shut_down ) ) {
+            g_shut_down = shut_down;
+        }
+    }
+    if ( shut_down ) {
+        return;
+    }
+
+    // Skip the frame when it's not time yet, or the last one is still being sent
+    if ( !rgb_matrix_power_frame_due() || IS31FL3731_busy_all() ) {
+        return;
+    }
+    uint16_t frame_start = timer_read();
+    uint8_t effect = rgb_matrix_config.mode;
 
     // Keep track of the effect used last time,
     // detect change in effect, so each effect can
@@ -627,7 +951,14 @@ void rgb_matrix_task(void) {
     effect_last = effect;
     toggle_enable_last = rgb_matrix_config.enable;
 
-    // this gets ticked at 20 Hz.
+    #ifdef RGB_MATRIX_HARDWARE_ANIMATIONS
+        if ( rgb_matrix_hardware_task( effect ) ) {
+            rgb_matrix_power_frame_done( timer_read(), timer_elapsed( frame_start ) );
+            return;
+        }
+    #endif
+
+    // this gets ticked every frame, which is every few ticks.
     // each effect can opt to do calculations
     // and/or request PWM buffer updates.
     switch ( effect ) {
@@ -684,15 +1015,24 @@ void rgb_matrix_task(void) {
                 rgb_matrix_solid_multisplash();
                 break;
         #endif
+        case RGB_MATRIX_BREATHING:
+            rgb_matrix_breathing();
+            break;
         default:
+            #ifdef RGB_MATRIX_PROGRAMS
+                if ( effect >= RGB_MATRIX_EFFECT_MAX && effect < RGB_MATRIX_MODE_MAX ) {
+                    rgb_matrix_program( effect - RGB_MATRIX_EFFECT_MAX );
+                    break;
+                }
+            #endif
             rgb_matrix_custom();
             break;
     }
 
-    if ( ! suspend_backlight ) {
-        rgb_matrix_indicators();
-    }
+    rgb_matrix_indicators();
+    rgb_matrix_limit_current();
 
+    rgb_matrix_power_frame_done( timer_read(), timer_elapsed( frame_start ) );
 }
 
 void rgb_matrix_indicators(void) {
@@ -726,6 +1066,7 @@ void rgb_matrix_indicators_user(void) {}
 
 void rgb_matrix_init(void) {
   rgb_matrix_setup_drivers();
+  rgb_matrix_power_init( timer_read() );
 
   // TODO: put the 1 second startup delay here?
 
@@ -752,8 +1093,8 @@ void rgb_matrix_init(void) {
 void rgb_matrix_setup_drivers(void) {
   // Initialize TWI
   i2c_init();
-  IS31FL3731_init( DRIVER_ADDR_1 );
-  IS31FL3731_init( DRIVER_ADDR_2 );
+  IS31FL3731_init_device( &g_is31_devices[0], DRIVER_ADDR_1 );
+  IS31FL3731_init_device( &g_is31_devices[1], DRIVER_ADDR_2 );
 
   for ( int index = 0; index < DRIVER_LED_TOTAL; index++ ) {
     bool enabled = true;
@@ -761,7 +1102,7 @@ void rgb_matrix_setup_drivers(void) {
     IS31FL3731_set_led_control_register( index, enabled, enabled, enabled );
   }
   // This actually updates the LED drivers
-  IS31FL3731_update_led_control_registers( DRIVER_ADDR_1, DRIVER_ADDR_2 );
+  IS31FL3731_update_pwm_buffers();
 }
 
 // Deals with the messy details of incrementing an integer
@@ -831,7 +1172,7 @@ void rgblight_toggle(void) {
 
 void rgblight_step(void) {
     rgb_matrix_config.mode++;
-    if (rgb_matrix_config.mode >= RGB_MATRIX_EFFECT_MAX)
+    if (rgb_matrix_config.mode >= RGB_MATRIX_MODE_MAX)
         rgb_matrix_config.mode = 1;
     eeconfig_update_rgb_matrix(rgb_matrix_config.raw);
 }
@@ -839,7 +1180,7 @@ void rgblight_step(void) {
 void rgblight_step_reverse(void) {
     rgb_matrix_config.mode--;
     if (rgb_matrix_config.mode < 1)
-        rgb_matrix_config.mode = RGB_MATRIX_EFFECT_MAX - 1;
+        rgb_matrix_config.mode = RGB_MATRIX_MODE_MAX - 1;
     eeconfig_update_rgb_matrix(rgb_matrix_config.raw);
 }
 
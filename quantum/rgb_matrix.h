@@ -22,6 +22,7 @@
 #include <stdbool.h>
 #include "color.h"
 #include "is31fl3731.h"
+#include "rgb_matrix_power.h"
 #include "quantum.h"
 
 typedef struct Point {
@@ -82,6 +83,7 @@ enum rgb_matrix_effects {
     RGB_MATRIX_SOLID_SPLASH,
     RGB_MATRIX_SOLID_MULTISPLASH,
 #endif
+    RGB_MATRIX_BREATHING,
     RGB_MATRIX_EFFECT_MAX
 };
 
@@ -98,6 +100,7 @@ void rgb_matrix_single_LED_test(void);
 void rgb_matrix_init(void);
 void rgb_matrix_setup_drivers(void);
 
+// Shuts the drivers down while suspended, with RGB_DISABLE_WHEN_USB_SUSPENDED
 void rgb_matrix_set_suspend_state(bool state);
 void rgb_matrix_set_indicator_state(uint8_t state);
 
@@ -110,6 +113,9 @@ void rgb_matrix_task(void);
 // If the buffer is dirty, it will update the driver with the buffer.
 void rgb_matrix_update_pwm_buffers(void);
 
+// The frame rate and the estimated current
+const rgb_power_stats_t *rgb_matrix_get_power_stats(void);
+
 bool process_rgb_matrix(uint16_t keycode, keyrecord_t *record);
 
 void rgb_matrix_increase(void);
@@ -0,0 +1,110 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rgb_matrix_power.h"
+
+// The average follows the last few frames, with this as the weight of the newest
+#define FRAME_TIME_SHIFT 3
+
+static uint16_t tick_time;
+static uint16_t second_time;
+static uint8_t ticks_since_frame;
+static uint8_t frames;
+static rgb_power_stats_t stats;
+
+void rgb_matrix_power_init( uint16_t now ) {
+    tick_time = now;
+    second_time = now;
+    ticks_since_frame = 0;
+    frames = 0;
+    stats = (rgb_power_stats_t){ .frame_ticks = 1 };
+}
+
+uint8_t rgb_matrix_power_tick( uint16_t now ) {
+    uint16_t elapsed = (uint16_t)(now - tick_time);
+    uint16_t ticks = elapsed / RGB_MATRIX_TICK_MS;
+
+    // The rest of the tick carries over, so the ticks don't drift
+    tick_time += ticks * RGB_MATRIX_TICK_MS;
+    if ( ticks > 255 ) {
+        ticks = 255;
+    }
+    ticks_since_frame = ticks_since_frame > 255 - ticks ? 255 : ticks_since_frame + ticks;
+    return ticks;
+}
+
+bool rgb_matrix_power_frame_due( void ) {
+    return ticks_since_frame >= stats.frame_ticks;
+}
+
+void rgb_matrix_power_frame_done( uint16_t now, uint16_t time ) {
+    ticks_since_frame = 0;
+
+    uint16_t sample = time > 0x0FFF ? 0xFFFF : time << 4;
+    int32_t average = stats.frame_time;
+    average += ((int32_t)sample - average) >> FRAME_TIME_SHIFT;
+    stats.frame_time = average;
+
+    // The period that keeps drawing within the load, rounded up to whole ticks
+    uint32_t period = (uint32_t)stats.frame_time * 100 / (16 * RGB_MATRIX_LOAD_PERCENT);
+    uint32_t frame_ticks = (period + RGB_MATRIX_TICK_MS - 1) / RGB_MATRIX_TICK_MS;
+    if ( frame_ticks < 1 ) {
+        frame_ticks = 1;
+    } else if ( frame_ticks > RGB_MATRIX_MAX_FRAME_TICKS ) {
+        frame_ticks = RGB_MATRIX_MAX_FRAME_TICKS;
+    }
+    stats.frame_ticks = frame_ticks;
+
+    frames++;
+    if ( (uint16_t)(now - second_time) >= 1000 ) {
+        second_time = now;
+        stats.fps = frames;
+        frames = 0;
+    }
+}
+
+uint16_t rgb_matrix_power_current( uint32_t pwm_total ) {
+    // Fits in 32 bits up to seven drivers of 144 channels
+    uint32_t current = pwm_total * RGB_MATRIX_CHANNEL_CURRENT / (255UL * 1000);
+    return current > 0xFFFF ? 0xFFFF : current;
+}
+
+uint8_t rgb_matrix_power_limit( uint32_t pwm_total ) {
+    uint16_t current = rgb_matrix_power_current( pwm_total );
+    uint8_t scale = 255;
+
+    if ( current > stats.current_max ) {
+        stats.current_max = current;
+    }
+#if RGB_MATRIX_CURRENT_BUDGET > 0
+    // The PWM total that draws the budget
+    const uint32_t budget = RGB_MATRIX_CURRENT_BUDGET * 255000UL / RGB_MATRIX_CHANNEL_CURRENT;
+    if ( pwm_total > budget ) {
+        // Each value becomes value * (scale + 1) / 256, rounded down
+        uint32_t fraction = (budget << 8) / pwm_total;
+        scale = fraction > 0 ? fraction - 1 : 0;
+        pwm_total = pwm_total * (scale + 1) >> 8;
+        current = rgb_matrix_power_current( pwm_total );
+        stats.limited++;
+    }
+#endif
+    stats.current = current;
+    return scale;
+}
+
+const rgb_power_stats_t *rgb_matrix_power_stats( void ) {
+    return &stats;
+}
@@ -0,0 +1,99 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RGB_MATRIX_POWER_H
+#define RGB_MATRIX_POWER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Frame scheduling and the current budget of rgb_matrix
+ *
+ * The effects run on ticks of RGB_MATRIX_TICK_MS, which follow the timer,
+ * so they go at the same speed however often frames are drawn. A frame is
+ * drawn at most once a tick, and less often when drawing takes more than
+ * RGB_MATRIX_LOAD_PERCENT of the time, so that the matrix is still scanned
+ * often enough. How long a frame takes is a running average, and the ticks
+ * between frames follow it, up to RGB_MATRIX_MAX_FRAME_TICKS.
+ *
+ * The current is estimated from the sum of all PWM values, each of which
+ * is a duty cycle of RGB_MATRIX_CHANNEL_CURRENT. When it's more than
+ * RGB_MATRIX_CURRENT_BUDGET, the frame is dimmed to fit before it's sent.
+ *
+ * Everything takes the time as an argument, so that it can be tested.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// How long a tick is, in milliseconds
+#ifndef RGB_MATRIX_TICK_MS
+#define RGB_MATRIX_TICK_MS 50
+#endif
+
+// How much of the time drawing frames can take, in percent
+#ifndef RGB_MATRIX_LOAD_PERCENT
+#define RGB_MATRIX_LOAD_PERCENT 25
+#endif
+
+// The slowest frame rate, in ticks per frame
+#ifndef RGB_MATRIX_MAX_FRAME_TICKS
+#define RGB_MATRIX_MAX_FRAME_TICKS 8
+#endif
+
+// The current that all LEDs can draw together, in mA, 0 for no limit
+#ifndef RGB_MATRIX_CURRENT_BUDGET
+#define RGB_MATRIX_CURRENT_BUDGET 0
+#endif
+
+// The average current of one channel at full PWM, in uA. The IS31FL3731
+// sinks about 20mA, but each LED is only on for one of the nine phases.
+#ifndef RGB_MATRIX_CHANNEL_CURRENT
+#define RGB_MATRIX_CHANNEL_CURRENT 2200
+#endif
+
+typedef struct {
+    uint16_t frame_time;   // average time to draw a frame, in 1/16 ms
+    uint8_t frame_ticks;   // ticks between frames now
+    uint8_t fps;           // frames in the last second
+    uint16_t current;      // estimated mA of the last frame, after the limit
+    uint16_t current_max;  // the highest estimate before the limit
+    uint16_t limited;      // frames that were dimmed to fit the budget
+} rgb_power_stats_t;
+
+void rgb_matrix_power_init( uint16_t now );
+
+// Returns how many ticks have passed since the last call
+uint8_t rgb_matrix_power_tick( uint16_t now );
+// Whether it's time to draw a frame, after the ticks were taken
+bool rgb_matrix_power_frame_due( void );
+// A frame was drawn, which took time milliseconds
+void rgb_matrix_power_frame_done( uint16_t now, uint16_t time );
+
+// Takes the sum of the PWM values of a frame, and returns the scale that
+// fits it into the budget, 255 for none
+uint8_t rgb_matrix_power_limit( uint32_t pwm_total );
+// The estimated current of a sum of PWM values, in mA
+uint16_t rgb_matrix_power_current( uint32_t pwm_total );
+
+const rgb_power_stats_t *rgb_matrix_power_stats( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
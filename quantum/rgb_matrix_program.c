@@ -0,0 +1,109 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "rgb_matrix_program.h"
+#include "progmem.h"
+
+static uint8_t absdiff( uint8_t a, uint8_t b ) {
+    return a > b ? a - b : b - a;
+}
+
+// An octagon instead of a circle, which is close enough without a square root
+static uint8_t distance( const rgb_program_frame_t *frame, const rgb_program_led_t *led ) {
+    uint8_t dx = absdiff( led->x, frame->last_x );
+    uint8_t dy = absdiff( led->y, frame->last_y );
+    uint16_t dist = dx > dy ? dx + (dy >> 1) : dy + (dx >> 1);
+    return dist > 255 ? 255 : dist;
+}
+
+HSV rgb_matrix_program_run( const uint8_t *program, const rgb_program_frame_t *frame, const rgb_program_led_t *led ) {
+    HSV hsv = frame->color;
+    uint8_t a = 0;
+
+    for (;;) {
+        uint8_t instruction = pgm_read_byte( program++ );
+        uint8_t op = instruction & 0xF0;
+        uint8_t operand = 0;
+
+        if ( op == RGBP_END ) {
+            return hsv;
+        }
+        switch ( instruction & 0x0F ) {
+            // Only the operations with an operand have the byte
+            case RGBP_CONST:     operand = op <= RGBP_MAX ? pgm_read_byte( program++ ) : 0; break;
+            case RGBP_X:         operand = led->x; break;
+            case RGBP_Y:         operand = led->y; break;
+            case RGBP_TIME:      operand = frame->time; break;
+            case RGBP_HUE:       operand = frame->color.h; break;
+            case RGBP_SAT:       operand = frame->color.s; break;
+            case RGBP_VAL:       operand = frame->color.v; break;
+            case RGBP_AGE:       operand = led->age; break;
+            case RGBP_DIST:      operand = distance( frame, led ); break;
+            case RGBP_LAST_AGE:  operand = frame->last_age; break;
+            case RGBP_H:         operand = hsv.h; break;
+            case RGBP_S:         operand = hsv.s; break;
+            case RGBP_V:         operand = hsv.v; break;
+        }
+
+        switch ( op ) {
+            case RGBP_LOAD:
+                a = operand;
+                break;
+            case RGBP_ADD:
+                a += operand;
+                break;
+            case RGBP_ADDS:
+                a = a > 255 - operand ? 255 : a + operand;
+                break;
+            case RGBP_SUBS:
+                a = a > operand ? a - operand : 0;
+                break;
+            case RGBP_DIFF:
+                a = absdiff( a, operand );
+                break;
+            case RGBP_SCALE:
+                a = ((uint16_t)a * (operand + 1)) >> 8;
+                break;
+            case RGBP_MUL: {
+                uint16_t product = (uint16_t)a * operand;
+                a = product > 255 ? 255 : product;
+                break;
+            }
+            case RGBP_MIN:
+                a = a < operand ? a : operand;
+                break;
+            case RGBP_MAX:
+                a = a > operand ? a : operand;
+                break;
+            case RGBP_STORE:
+                switch ( instruction & 0x0F ) {
+                    case RGBP_H: hsv.h = a; break;
+                    case RGBP_S: hsv.s = a; break;
+                    case RGBP_V: hsv.v = a; break;
+                }
+                break;
+            case RGBP_INV:
+                a = 255 - a;
+                break;
+            case RGBP_WAVE:
+                a = (a & 0x80) ? (uint8_t)(255 - a) << 1 : a << 1;
+                break;
+            default:
+                return hsv;
+        }
+    }
+}
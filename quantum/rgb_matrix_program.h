@@ -0,0 +1,97 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef RGB_MATRIX_PROGRAM_H
+#define RGB_MATRIX_PROGRAM_H
+
+#include <stdint.h>
+#include "color.h"
+
+/* Effects as programs in PROGMEM
+ *
+ * A program runs once for every LED, and leaves the LED's color in the H, S
+ * and V registers, which start with the configured color. Everything is 8-bit,
+ * and goes through one accumulator.
+ *
+ * An instruction is one byte, with the operation in the high nibble and the
+ * operand in the low nibble. The operand is one of the sources below, and
+ * RGBP_CONST takes its value from the next byte. The unary operations ignore
+ * it. The program ends with RGBP_END.
+ *
+ * util/rgb_matrix_compile.py turns a text description of effects into these
+ * arrays, see docs/feature_rgb_matrix.md.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum rgb_program_op {
+    RGBP_END = 0x00,
+    RGBP_LOAD = 0x10,   // A = operand
+    RGBP_ADD = 0x20,    // A += operand, wrapping like the hue
+    RGBP_ADDS = 0x30,   // A += operand, up to 255
+    RGBP_SUBS = 0x40,   // A -= operand, down to 0
+    RGBP_DIFF = 0x50,   // A = |A - operand|
+    RGBP_SCALE = 0x60,  // A = A * operand / 255
+    RGBP_MUL = 0x70,    // A = A * operand, up to 255
+    RGBP_MIN = 0x80,
+    RGBP_MAX = 0x90,
+    RGBP_STORE = 0xA0,  // the operand is RGBP_H, RGBP_S or RGBP_V
+    RGBP_INV = 0xB0,    // A = 255 - A
+    RGBP_WAVE = 0xC0,   // A goes up and back down as it goes around, 0-255-0
+};
+
+enum rgb_program_source {
+    RGBP_CONST = 0,
+    RGBP_X,             // the LED's position, 0-224
+    RGBP_Y,             // 0-64
+    RGBP_TIME,          // wraps around, faster with a higher speed
+    RGBP_HUE,           // the configured color
+    RGBP_SAT,
+    RGBP_VAL,
+    RGBP_AGE,           // ticks since the LED was hit, up to 255
+    RGBP_DIST,          // from the LED that was hit last, up to 255
+    RGBP_LAST_AGE,      // ticks since the last hit, up to 255
+    RGBP_H,             // the registers
+    RGBP_S,
+    RGBP_V,
+};
+
+// Everything that is the same for all LEDs of a frame
+typedef struct {
+    uint8_t time;
+    HSV color;
+    uint8_t last_age;
+    uint8_t last_x;
+    uint8_t last_y;
+} rgb_program_frame_t;
+
+typedef struct {
+    uint8_t x;
+    uint8_t y;
+    uint8_t age;
+} rgb_program_led_t;
+
+// The program is read from PROGMEM
+HSV rgb_matrix_program_run( const uint8_t *program, const rgb_program_frame_t *frame, const rgb_program_led_t *led );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -35,9 +35,12 @@ typedef struct byte_stuffer_state {
     uint16_t next_zero;
     uint16_t data_pos;
     bool long_frame;
-    uint8_t data[MAX_FRAME_SIZE];
+    // The received frames can be forwarded to the next link without copying
+    uint8_t buffer[BYTE_STUFFER_HEADROOM + MAX_FRAME_SIZE + BYTE_STUFFER_TAILROOM];
 }byte_stuffer_state_t;
 
+#define FRAME_DATA(state) ((state)->buffer + BYTE_STUFFER_HEADROOM)
+
 static byte_stuffer_state_t states[NUM_LINKS];
 
 void init_byte_stuffer_state(byte_stuffer_state_t* state) {
@@ -68,7 +71,7 @@ void byte_stuffer_recv_byte(uint8_t link, uint8_t data) {
         if (state->next_zero == 0) {
             // The frame is completed
             if (state->data_pos > 0) {
-                validator_recv_frame(link, state->data, state->data_pos);
+                validator_recv_frame(link, FRAME_DATA(state), state->data_pos);
             }
         }
         else {
@@ -93,11 +96,11 @@ void byte_stuffer_recv_byte(uint8_t link, uint8_t data) {
             else {
                 // Special case for zeroes
                 state->next_zero = data;
-                state->data[state->data_pos++] = 0;
+                FRAME_DATA(state)[state->data_pos++] = 0;
             }
         }
         else {
-            state->data[state->data_pos++] = data;
+            FRAME_DATA(state)[state->data_pos++] = data;
         }
     }
 }
@@ -140,3 +143,28 @@ void byte_stuffer_send_frame(uint8_t link, uint8_t* data, uint16_t size) {
         send_data(link, &zero, 1);
     }
 }
+
+void byte_stuffer_send_frame_in_place(uint8_t link, uint8_t* data, uint16_t size) {
+    // Frames with more than 254 non-zero bytes in a row need extra bytes in the middle
+    // so only the shorter ones, which are the absolute majority, can be encoded in place
+    if (size == 0 || size > 254) {
+        byte_stuffer_send_frame(link, data, size);
+        return;
+    }
+    // Go backwards and replace each zero with the distance to the next one
+    // The end of frame marker acts as the last zero
+    uint8_t distance = 1;
+    uint16_t i = size;
+    data[size] = 0;
+    while (i-- != 0) {
+        if (data[i] == 0) {
+            data[i] = distance;
+            distance = 1;
+        }
+        else {
+            distance++;
+        }
+    }
+    data[-1] = distance;
+    send_data(link, data - 1, size + 2);
+}
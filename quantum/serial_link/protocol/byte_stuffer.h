@@ -30,8 +30,15 @@ SOFTWARE.
 #define MAX_FRAME_SIZE 1024
 #define NUM_LINKS 2
 
+// The space byte_stuffer_send_frame_in_place needs before and after the frame
+#define BYTE_STUFFER_HEADROOM 1
+#define BYTE_STUFFER_TAILROOM 1
+
 void init_byte_stuffer(void);
 void byte_stuffer_recv_byte(uint8_t link, uint8_t data);
 void byte_stuffer_send_frame(uint8_t link, uint8_t* data, uint16_t size);
+// Encodes the frame in the buffer itself, and sends it with a single send_data call
+// The data is destroyed in the process
+void byte_stuffer_send_frame_in_place(uint8_t link, uint8_t* data, uint16_t size);
 
 #endif
@@ -0,0 +1,50 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 agent <agent@local>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SERIAL_LINK_CRC_H
+#define SERIAL_LINK_CRC_H
+
+#include <stdint.h>
+
+// Define SERIAL_LINK_CRC32_SLICES as 1, 4 or 8 to select how many bytes the software
+// CRC-32 processes per step. More slices are faster, but need 1KB more flash per slice.
+// Defining SERIAL_LINK_CRC_HARDWARE uses the CRC unit instead, if the HAL supports it.
+#ifndef SERIAL_LINK_CRC32_SLICES
+#define SERIAL_LINK_CRC32_SLICES 4
+#endif
+
+// All of these calculate the standard CRC-32 (the same one as Ethernet and zlib)
+uint32_t crc32_bytewise(const uint8_t* data, uint16_t size);
+uint32_t crc32_slice_by_4(const uint8_t* data, uint16_t size);
+uint32_t crc32_slice_by_8(const uint8_t* data, uint16_t size);
+#ifdef SERIAL_LINK_CRC_HARDWARE
+uint32_t crc32_hardware(const uint8_t* data, uint16_t size);
+#endif
+// Uses the implementation selected by the configuration
+uint32_t crc32_calculate(const uint8_t* data, uint16_t size);
+
+// CRC-16/CCITT-FALSE, used for short frames
+uint16_t crc16_ccitt(const uint8_t* data, uint16_t size);
+
+#endif
@@ -27,12 +27,18 @@ SOFTWARE.
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "serial_link/protocol/frame_validator.h"
 
 #define UP_LINK 0
 #define DOWN_LINK 1
 
+// The space router_send_frame needs before and after the frame
+#define ROUTER_HEADROOM VALIDATOR_HEADROOM
+#define ROUTER_TAILROOM (1 + VALIDATOR_TAILROOM)
+
 void router_set_master(bool master);
 void route_incoming_frame(uint8_t link, uint8_t* data, uint16_t size);
+// The buffer needs ROUTER_HEADROOM bytes before, and ROUTER_TAILROOM bytes after the data
 void router_send_frame(uint8_t destination, uint8_t* data, uint16_t size);
 
 #endif
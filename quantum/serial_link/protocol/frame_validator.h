@@ -26,9 +26,15 @@ SOFTWARE.
 #define SERIAL_LINK_FRAME_VALIDATOR_H
 
 #include <stdint.h>
+#include "serial_link/protocol/byte_stuffer.h"
+
+// The space validator_send_frame needs before and after the frame
+#define VALIDATOR_HEADROOM BYTE_STUFFER_HEADROOM
+#define VALIDATOR_TAILROOM (4 + BYTE_STUFFER_TAILROOM)
 
 void validator_recv_frame(uint8_t link, uint8_t* data, uint16_t size);
-// The buffer pointed to by the data needs 4 additional bytes
+// The frame is sent without copying, so the buffer pointed to by the data needs
+// VALIDATOR_HEADROOM bytes before, and VALIDATOR_TAILROOM bytes after the data
 void validator_send_frame(uint8_t link, uint8_t* data, uint16_t size);
 
 #endif
@@ -0,0 +1,163 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 agent <agent@local>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "serial_link/protocol/matrix_sync.h"
+#include <string.h>
+
+void matrix_sync_sender_init(matrix_sync_sender_t* sender, uint8_t* acked_rows, uint8_t* published_rows,
+        uint8_t num_rows, uint8_t row_size) {
+    sender->acked_rows = acked_rows;
+    sender->published_rows = published_rows;
+    sender->num_rows = num_rows;
+    sender->row_size = row_size;
+    sender->sequence = 0;
+    sender->published_sequence = 0;
+    sender->published_type = MATRIX_SYNC_HEARTBEAT;
+    sender->next_sequence = 1;
+    memset(acked_rows, 0, num_rows * row_size);
+    memset(published_rows, 0, num_rows * row_size);
+}
+
+static uint8_t allocate_sequence(matrix_sync_sender_t* sender) {
+    uint8_t sequence = sender->next_sequence;
+    if (sequence == sender->sequence) {
+        sequence = (sequence + 1) & 0x7F;
+    }
+    sender->next_sequence = (sequence + 1) & 0x7F;
+    return sequence;
+}
+
+uint8_t matrix_sync_encode(matrix_sync_sender_t* sender, const uint8_t* rows, uint8_t ack, uint8_t* message) {
+    const uint8_t row_size = sender->row_size;
+    const uint16_t rows_size = sender->num_rows * row_size;
+
+    if (ack == sender->published_sequence && ack != sender->sequence) {
+        // The receiver has got the last message
+        memcpy(sender->acked_rows, sender->published_rows, rows_size);
+        sender->sequence = ack;
+    }
+
+    uint8_t num_changed = 0;
+    for (uint16_t i = 0; i < rows_size; i += row_size) {
+        if (memcmp(rows + i, sender->acked_rows + i, row_size) != 0) {
+            num_changed++;
+        }
+    }
+
+    uint8_t type;
+    if (ack != sender->sequence) {
+        type = MATRIX_SYNC_FULL;
+    }
+    else if (num_changed == 0) {
+        message[0] = MATRIX_SYNC_HEARTBEAT << 6;
+        message[1] = sender->sequence;
+        return 2;
+    }
+    else if (3 + num_changed * (1 + row_size) >= MATRIX_SYNC_MAX_MESSAGE_SIZE(sender->num_rows, row_size)) {
+        type = MATRIX_SYNC_FULL;
+    }
+    else {
+        type = MATRIX_SYNC_DELTA;
+    }
+
+    // Only start a new sequence if the message is different from the one that hasn't been
+    // acknowledged yet, otherwise the acknowledgement of that would be lost
+    if (sender->published_sequence == sender->sequence || type != sender->published_type ||
+            memcmp(rows, sender->published_rows, rows_size) != 0) {
+        sender->published_sequence = allocate_sequence(sender);
+        sender->published_type = type;
+        memcpy(sender->published_rows, rows, rows_size);
+    }
+
+    if (type == MATRIX_SYNC_FULL) {
+        message[0] = (MATRIX_SYNC_FULL << 6) | sender->num_rows;
+        message[1] = sender->published_sequence;
+        memcpy(message + 2, rows, rows_size);
+        return 2 + rows_size;
+    }
+
+    message[0] = (MATRIX_SYNC_DELTA << 6) | num_changed;
+    message[1] = sender->sequence;
+    message[2] = sender->published_sequence;
+    uint8_t* pos = message + 3;
+    for (uint8_t row = 0; row < sender->num_rows; row++) {
+        const uint8_t* value = rows + row * row_size;
+        if (memcmp(value, sender->acked_rows + row * row_size, row_size) != 0) {
+            *pos++ = row;
+            memcpy(pos, value, row_size);
+            pos += row_size;
+        }
+    }
+    return pos - message;
+}
+
+void matrix_sync_receiver_init(matrix_sync_receiver_t* receiver, uint8_t* rows, uint8_t num_rows, uint8_t row_size) {
+    receiver->rows = rows;
+    receiver->num_rows = num_rows;
+    receiver->row_size = row_size;
+    matrix_sync_receiver_reset(receiver);
+}
+
+void matrix_sync_receiver_reset(matrix_sync_receiver_t* receiver) {
+    receiver->sequence = MATRIX_SYNC_NO_SEQUENCE;
+}
+
+bool matrix_sync_decode(matrix_sync_receiver_t* receiver, const uint8_t* message, uint8_t size) {
+    const uint8_t row_size = receiver->row_size;
+    if (size < 2 || size != matrix_sync_message_size(message[0], row_size)) {
+        return false;
+    }
+    uint8_t count = MATRIX_SYNC_COUNT(message[0]);
+    switch (MATRIX_SYNC_TYPE(message[0])) {
+    case MATRIX_SYNC_HEARTBEAT:
+        // If the sequence doesn't match, the sender sees that from the acknowledgement
+        return true;
+    case MATRIX_SYNC_DELTA:
+        for (uint8_t i = 0; i < count; i++) {
+            if (message[3 + i * (1 + row_size)] >= receiver->num_rows) {
+                return false;
+            }
+        }
+        // A delta based on something else than what we have is useless,
+        // the sender will send everything once it sees our acknowledgement
+        if (message[1] == receiver->sequence) {
+            const uint8_t* pos = message + 3;
+            for (uint8_t i = 0; i < count; i++) {
+                memcpy(receiver->rows + pos[0] * row_size, pos + 1, row_size);
+                pos += 1 + row_size;
+            }
+            receiver->sequence = message[2];
+        }
+        return true;
+    case MATRIX_SYNC_FULL:
+        if (count != receiver->num_rows) {
+            return false;
+        }
+        memcpy(receiver->rows, message + 2, count * row_size);
+        receiver->sequence = message[1];
+        return true;
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,102 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 agent <agent@local>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SERIAL_LINK_MATRIX_SYNC_H
+#define SERIAL_LINK_MATRIX_SYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Synchronizes the matrix of one keyboard half to another by sending only the rows
+// that have changed. Every message carries the sequence number it's based on, and
+// the receiver acknowledges the sequence number it has. So the sender always knows
+// what the receiver has, and sends all the rows when it doesn't.
+//
+// The message formats are (the type is stored in the top two bits of the first byte)
+// heartbeat: [type | 0] [sequence]
+// delta:     [type | num_changed] [base sequence] [new sequence] num_changed * ([row] [value])
+// full:      [type | num_rows] [new sequence] num_rows * [value]
+// The row values are row_size bytes in native byte order
+
+#define MATRIX_SYNC_HEARTBEAT 0
+#define MATRIX_SYNC_DELTA 1
+#define MATRIX_SYNC_FULL 2
+
+#define MATRIX_SYNC_TYPE(header) ((header) >> 6)
+#define MATRIX_SYNC_COUNT(header) ((header) & 0x3F)
+
+// The sequence numbers are 7 bits, this tells the sender that the receiver doesn't have anything
+#define MATRIX_SYNC_NO_SEQUENCE 0x80
+
+// A full message is always sent if it's smaller than the delta, so this is the maximum size
+#define MATRIX_SYNC_MAX_MESSAGE_SIZE(num_rows, row_size) (2 + (num_rows) * (row_size))
+
+typedef struct {
+    uint8_t* acked_rows;
+    uint8_t* published_rows;
+    uint8_t num_rows;
+    uint8_t row_size;
+    uint8_t sequence;
+    uint8_t published_sequence;
+    uint8_t published_type;
+    uint8_t next_sequence;
+} matrix_sync_sender_t;
+
+typedef struct {
+    uint8_t* rows;
+    uint8_t num_rows;
+    uint8_t row_size;
+    uint8_t sequence;
+} matrix_sync_receiver_t;
+
+// Returns the size of the message, based on the first byte only
+static inline uint8_t matrix_sync_message_size(uint8_t header, uint8_t row_size) {
+    uint8_t count = MATRIX_SYNC_COUNT(header);
+    switch (MATRIX_SYNC_TYPE(header)) {
+    case MATRIX_SYNC_DELTA:
+        return 3 + count * (1 + row_size);
+    case MATRIX_SYNC_FULL:
+        return 2 + count * row_size;
+    default:
+        return 2;
+    }
+}
+
+// Both of the row buffers need num_rows * row_size bytes, and are used internally
+void matrix_sync_sender_init(matrix_sync_sender_t* sender, uint8_t* acked_rows, uint8_t* published_rows,
+        uint8_t num_rows, uint8_t row_size);
+// Encodes the message that brings the receiver up to date with the rows, when the receiver
+// has acknowledged the given sequence number. The same message is returned until the rows
+// change, so this can be called as often as needed. Returns the size of the message.
+uint8_t matrix_sync_encode(matrix_sync_sender_t* sender, const uint8_t* rows, uint8_t ack, uint8_t* message);
+
+// The received rows are written directly to the rows buffer
+void matrix_sync_receiver_init(matrix_sync_receiver_t* receiver, uint8_t* rows, uint8_t num_rows, uint8_t row_size);
+// Returns false if the message is corrupt. The sequence number of the receiver
+// should be sent back to the sender as the acknowledgement
+bool matrix_sync_decode(matrix_sync_receiver_t* receiver, const uint8_t* message, uint8_t size);
+// Forget the state, so that the sender sends everything again
+void matrix_sync_receiver_reset(matrix_sync_receiver_t* receiver);
+
+#endif
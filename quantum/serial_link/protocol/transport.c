@@ -27,6 +27,10 @@ SOFTWARE.
 #include "serial_link/protocol/triple_buffered_object.h"
 #include <string.h>
 
+#if ROUTER_HEADROOM > LOCAL_OBJECT_HEADROOM || ROUTER_TAILROOM + 1 > LOCAL_OBJECT_EXTRA
+#error "The local objects don't have enough space reserved for the frame headers and trailers"
+#endif
+
 #define MAX_REMOTE_OBJECTS 16
 static remote_object_t* remote_objects[MAX_REMOTE_OBJECTS];
 static uint32_t num_remote_objects = 0;
@@ -103,8 +107,10 @@ void update_transport(void) {
         remote_object_t* obj = remote_objects[i];
         if (obj->object_type == MASTER_TO_ALL_SLAVES || obj->object_type == SLAVE_TO_MASTER) {
             triple_buffer_object_t* tb = (triple_buffer_object_t*)obj->buffer;
-            uint8_t* ptr = (uint8_t*)triple_buffer_read_internal(obj->object_size + LOCAL_OBJECT_EXTRA, tb);
+            uint8_t* ptr = (uint8_t*)triple_buffer_read_internal(LOCAL_OBJECT_SLOT_SIZE(obj->object_size), tb);
             if (ptr) {
+                // The frame is sent directly from the buffer, the object id is the first trailer
+                ptr += LOCAL_OBJECT_HEADROOM;
                 ptr[obj->object_size] = i;
                 uint8_t dest = obj->object_type == MASTER_TO_ALL_SLAVES ? 0xFF : 0;
                 router_send_frame(dest, ptr, obj->object_size + 1);
@@ -115,8 +121,9 @@ void update_transport(void) {
             unsigned int j;
             for (j=0;j<NUM_SLAVES;j++) {
                 triple_buffer_object_t* tb = (triple_buffer_object_t*)start;
-                uint8_t* ptr = (uint8_t*)triple_buffer_read_internal(obj->object_size + LOCAL_OBJECT_EXTRA, tb);
+                uint8_t* ptr = (uint8_t*)triple_buffer_read_internal(LOCAL_OBJECT_SLOT_SIZE(obj->object_size), tb);
                 if (ptr) {
+                    ptr += LOCAL_OBJECT_HEADROOM;
                     ptr[obj->object_size] = i;
                     uint8_t dest = j + 1;
                     router_send_frame(dest, ptr, obj->object_size + 1);
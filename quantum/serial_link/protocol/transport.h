@@ -29,6 +29,10 @@ SOFTWARE.
 #include "serial_link/system/serial_link.h"
 
 #define NUM_SLAVES 8
+// The local objects have space reserved around them, so that the lower layers
+// can add their headers and trailers and send them without copying.
+// The headroom is kept at 4 bytes, so that the alignment of the objects is preserved
+#define LOCAL_OBJECT_HEADROOM 4
 #define LOCAL_OBJECT_EXTRA 16
 
 // master -> slave = 1 local(target all), 1 remote object
@@ -48,8 +52,10 @@ typedef struct {
 
 #define REMOTE_OBJECT_SIZE(objectsize) \
     (sizeof(triple_buffer_object_t) + objectsize * 3)
+#define LOCAL_OBJECT_SLOT_SIZE(objectsize) \
+    (LOCAL_OBJECT_HEADROOM + objectsize + LOCAL_OBJECT_EXTRA)
 #define LOCAL_OBJECT_SIZE(objectsize) \
-    (sizeof(triple_buffer_object_t) + (objectsize + LOCAL_OBJECT_EXTRA) * 3)
+    (sizeof(triple_buffer_object_t) + LOCAL_OBJECT_SLOT_SIZE(objectsize) * 3)
 
 #define REMOTE_OBJECT_HELPER(name, type, num_local, num_remote) \
 typedef struct { \
@@ -70,7 +76,8 @@ typedef struct { \
     type* begin_write_##name(void) { \
         remote_object_t* obj = (remote_object_t*)&remote_object_##name; \
         triple_buffer_object_t* tb = (triple_buffer_object_t*)obj->buffer; \
-        return (type*)triple_buffer_begin_write_internal(sizeof(type) + LOCAL_OBJECT_EXTRA, tb); \
+        uint8_t* slot = (uint8_t*)triple_buffer_begin_write_internal(LOCAL_OBJECT_SLOT_SIZE(sizeof(type)), tb); \
+        return (type*)(slot + LOCAL_OBJECT_HEADROOM); \
     }\
     void end_write_##name(void) { \
         remote_object_t* obj = (remote_object_t*)&remote_object_##name; \
@@ -98,7 +105,8 @@ typedef struct { \
         uint8_t* start = obj->buffer;\
         start += slave * LOCAL_OBJECT_SIZE(obj->object_size); \
         triple_buffer_object_t* tb = (triple_buffer_object_t*)start; \
-        return (type*)triple_buffer_begin_write_internal(sizeof(type) + LOCAL_OBJECT_EXTRA, tb); \
+        uint8_t* slot = (uint8_t*)triple_buffer_begin_write_internal(LOCAL_OBJECT_SLOT_SIZE(sizeof(type)), tb); \
+        return (type*)(slot + LOCAL_OBJECT_HEADROOM); \
     }\
     void end_write_##name(uint8_t slave) { \
         remote_object_t* obj = (remote_object_t*)&remote_object_##name; \
@@ -126,7 +134,8 @@ typedef struct { \
     type* begin_write_##name(void) { \
         remote_object_t* obj = (remote_object_t*)&remote_object_##name; \
         triple_buffer_object_t* tb = (triple_buffer_object_t*)obj->buffer; \
-        return (type*)triple_buffer_begin_write_internal(sizeof(type) + LOCAL_OBJECT_EXTRA, tb); \
+        uint8_t* slot = (uint8_t*)triple_buffer_begin_write_internal(LOCAL_OBJECT_SLOT_SIZE(sizeof(type)), tb); \
+        return (type*)(slot + LOCAL_OBJECT_HEADROOM); \
     }\
     void end_write_##name(void) { \
         remote_object_t* obj = (remote_object_t*)&remote_object_##name; \
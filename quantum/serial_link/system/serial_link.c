@@ -28,8 +28,10 @@ SOFTWARE.
 #include "serial_link/protocol/byte_stuffer.h"
 #include "serial_link/protocol/transport.h"
 #include "serial_link/protocol/frame_router.h"
+#include "serial_link/protocol/matrix_sync.h"
 #include "matrix.h"
 #include <stdbool.h>
+#include <string.h>
 #include "print.h"
 #include "config.h"
 
@@ -169,23 +171,47 @@ void send_data(uint8_t link, const uint8_t* data, uint16_t size) {
 }
 
 static systime_t last_update = 0;
+static systime_t last_ack_update = 0;
 
-typedef struct {
-    matrix_row_t rows[MATRIX_ROWS];
-} matrix_object_t;
+#define MATRIX_MESSAGE_SIZE MATRIX_SYNC_MAX_MESSAGE_SIZE(MATRIX_ROWS, sizeof(matrix_row_t))
 
-static matrix_object_t last_matrix = {};
+// Only the changed rows are sent, see matrix_sync.h
+typedef struct {
+    uint8_t size;
+    uint8_t data[MATRIX_MESSAGE_SIZE];
+} matrix_message_t;
 
-SLAVE_TO_MASTER_OBJECT(keyboard_matrix, matrix_object_t);
+// The objects have a fixed size, so the heartbeat is sent separately
+typedef struct {
+    uint8_t data[2];
+} matrix_heartbeat_t;
+
+static matrix_sync_sender_t sync_sender;
+static uint8_t sync_acked_rows[MATRIX_ROWS * sizeof(matrix_row_t)];
+static uint8_t sync_published_rows[MATRIX_ROWS * sizeof(matrix_row_t)];
+static matrix_message_t last_message = {};
+static uint8_t matrix_ack = MATRIX_SYNC_NO_SEQUENCE;
+
+static matrix_sync_receiver_t sync_receiver;
+static matrix_row_t remote_matrix[MATRIX_ROWS];
+static uint8_t last_sent_ack = MATRIX_SYNC_NO_SEQUENCE;
+
+SLAVE_TO_MASTER_OBJECT(keyboard_matrix, matrix_message_t);
+SLAVE_TO_MASTER_OBJECT(keyboard_matrix_heartbeat, matrix_heartbeat_t);
+MASTER_TO_SINGLE_SLAVE_OBJECT(keyboard_matrix_ack, uint8_t);
 MASTER_TO_ALL_SLAVES_OBJECT(serial_link_connected, bool);
 
 static remote_object_t* remote_objects[] = {
     REMOTE_OBJECT(serial_link_connected),
     REMOTE_OBJECT(keyboard_matrix),
+    REMOTE_OBJECT(keyboard_matrix_heartbeat),
+    REMOTE_OBJECT(keyboard_matrix_ack),
 };
 
 void init_serial_link(void) {
     serial_link_connected = false;
+    matrix_sync_sender_init(&sync_sender, sync_acked_rows, sync_published_rows, MATRIX_ROWS, sizeof(matrix_row_t));
+    matrix_sync_receiver_init(&sync_receiver, (uint8_t*)remote_matrix, MATRIX_ROWS, sizeof(matrix_row_t));
     init_serial_link_hal();
     add_remote_objects(remote_objects, sizeof(remote_objects)/sizeof(remote_object_t*));
     init_byte_stuffer();
@@ -203,30 +229,58 @@ void serial_link_update(void) {
         serial_link_connected = true;
     }
 
-    matrix_object_t matrix;
-    bool changed = false;
+    matrix_row_t rows[MATRIX_ROWS];
     for(uint8_t i=0;i<MATRIX_ROWS;i++) {
-        matrix.rows[i] = matrix_get_row(i);
-        changed |= matrix.rows[i] != last_matrix.rows[i];
+        rows[i] = matrix_get_row(i);
+    }
+
+    // A new acknowledgement that doesn't match means that the last message was lost
+    uint8_t* ack = read_keyboard_matrix_ack();
+    if (ack) {
+        matrix_ack = *ack;
     }
+    matrix_message_t message;
+    message.size = matrix_sync_encode(&sync_sender, (uint8_t*)rows, matrix_ack, message.data);
+    bool heartbeat = MATRIX_SYNC_TYPE(message.data[0]) == MATRIX_SYNC_HEARTBEAT;
+    bool changed = message.size != last_message.size ||
+        memcmp(message.data, last_message.data, message.size) != 0;
 
     systime_t current_time = chVTGetSystemTimeX();
     systime_t delta = current_time - last_update;
-    if (changed || delta > US2ST(5000)) {
+    if (!heartbeat && (changed || ack)) {
         last_update = current_time;
-        last_matrix = matrix;
-        matrix_object_t* m = begin_write_keyboard_matrix();
-        for(uint8_t i=0;i<MATRIX_ROWS;i++) {
-            m->rows[i] = matrix.rows[i];
-        }
+        last_message = message;
+        *begin_write_keyboard_matrix() = message;
         end_write_keyboard_matrix();
         *begin_write_serial_link_connected() = true;
         end_write_serial_link_connected();
     }
+    else if (delta > US2ST(5000)) {
+        last_update = current_time;
+        last_message = message;
+        matrix_heartbeat_t* h = begin_write_keyboard_matrix_heartbeat();
+        h->data[0] = message.data[0];
+        h->data[1] = message.data[1];
+        end_write_keyboard_matrix_heartbeat();
+        *begin_write_serial_link_connected() = true;
+        end_write_serial_link_connected();
+    }
+
+    matrix_message_t* m = read_keyboard_matrix(0);
+    if (m && m->size <= MATRIX_MESSAGE_SIZE && matrix_sync_decode(&sync_receiver, m->data, m->size)) {
+        matrix_set_remote(remote_matrix, 0);
+    }
+    matrix_heartbeat_t* h = read_keyboard_matrix_heartbeat(0);
+    if (h) {
+        matrix_sync_decode(&sync_receiver, h->data, sizeof(h->data));
+    }
 
-    matrix_object_t* m = read_keyboard_matrix(0);
-    if (m) {
-        matrix_set_remote(m->rows, 0);
+    delta = current_time - last_ack_update;
+    if (sync_receiver.sequence != last_sent_ack || delta > US2ST(5000)) {
+        last_ack_update = current_time;
+        last_sent_ack = sync_receiver.sequence;
+        *begin_write_keyboard_matrix_ack(0) = last_sent_ack;
+        end_write_keyboard_matrix_ack(0);
     }
 }
 
@@ -481,3 +481,48 @@ TEST_F(ByteStuffer, sends_and_receives_full_roundtrip_254_bytes_and_then_zero) {
        byte_stuffer_recv_byte(1, d);
     }
 }
+
+TEST_F(ByteStuffer, sends_frame_in_place_with_a_single_copy) {
+    uint8_t buffer[] = {0xAA, 9, 0, 0x68, 0xAA};
+    byte_stuffer_send_frame_in_place(0, buffer + 1, 3);
+    uint8_t expected[] = {2, 9, 2, 0x68, 0};
+    EXPECT_THAT(sent_data, ElementsAreArray(expected));
+}
+
+TEST_F(ByteStuffer, sends_the_same_data_in_place_as_when_copying) {
+    uint8_t original_data[256];
+    srand(1);
+    for (uint16_t size = 1; size <= 254; size++) {
+        for (uint16_t i = 0; i < size; i++) {
+            original_data[i] = rand() % 4 == 0 ? 0 : rand();
+        }
+        sent_data.clear();
+        byte_stuffer_send_frame(0, original_data, size);
+        std::vector<uint8_t> expected = sent_data;
+
+        uint8_t buffer[BYTE_STUFFER_HEADROOM + 256 + BYTE_STUFFER_TAILROOM];
+        std::copy(original_data, original_data + size, buffer + BYTE_STUFFER_HEADROOM);
+        sent_data.clear();
+        byte_stuffer_send_frame_in_place(0, buffer + BYTE_STUFFER_HEADROOM, size);
+        EXPECT_THAT(sent_data, ElementsAreArray(expected)) << "size " << size;
+    }
+}
+
+TEST_F(ByteStuffer, sends_long_frames_in_place_by_copying) {
+    uint8_t buffer[BYTE_STUFFER_HEADROOM + 255 + BYTE_STUFFER_TAILROOM];
+    uint8_t* data = buffer + BYTE_STUFFER_HEADROOM;
+    int i;
+    for(i=0;i<255;i++) {
+        data[i] = i + 1;
+    }
+    byte_stuffer_send_frame_in_place(0, data, 255);
+    uint8_t expected[258];
+    expected[0] = 0xFF;
+    for(i=1;i<255;i++) {
+        expected[i] = i;
+    }
+    expected[255] = 2;
+    expected[256] = 255;
+    expected[257] = 0;
+    EXPECT_THAT(sent_data, ElementsAreArray(expected));
+}
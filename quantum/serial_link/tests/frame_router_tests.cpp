@@ -25,6 +25,8 @@ SOFTWARE.
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 #include <array>
+#include <chrono>
+#include <cstdio>
 extern "C" {
     #include "serial_link/protocol/transport.h"
     #include "serial_link/protocol/byte_stuffer.h"
@@ -51,6 +53,7 @@ public:
     void send_data(uint8_t link, const uint8_t* data, uint16_t size) {
         auto& buffer = current_router_buffer->send_buffers[link];
         std::copy(data, data + size, std::back_inserter(buffer));
+        num_send_data_calls++;
     }
 
     void receive_data(uint8_t link, uint8_t* data, uint16_t size) {
@@ -89,6 +92,7 @@ public:
 
     router_buffer router_buffers[8];
     router_buffer* current_router_buffer;
+    unsigned num_send_data_calls = 0;
 
     static FrameRouter* Instance;
 };
@@ -97,6 +101,7 @@ FrameRouter* FrameRouter::Instance = nullptr;
 
 
 typedef struct {
+    uint8_t headroom[4];
     std::array<uint8_t, 4> data;
     uint8_t extra[16];
 } frame_buffer_t;
@@ -117,7 +122,7 @@ TEST_F(FrameRouter, master_broadcast_is_received_by_everyone) {
     frame_buffer_t data;
     data.data = {0xAB, 0x70, 0x55, 0xBB};
     activate_router(0);
-    router_send_frame(0xFF, (uint8_t*)&data, 4);
+    router_send_frame(0xFF, data.data.data(), 4);
     EXPECT_GT(router_buffers[0].send_buffers[DOWN_LINK].size(), 0);
     EXPECT_EQ(router_buffers[0].send_buffers[UP_LINK].size(), 0);
     EXPECT_CALL(*this, transport_recv_frame(0, _, _))
@@ -137,7 +142,7 @@ TEST_F(FrameRouter, master_send_is_received_by_targets) {
     frame_buffer_t data;
     data.data = {0xAB, 0x70, 0x55, 0xBB};
     activate_router(0);
-    router_send_frame((1 << 1) | (1 << 2), (uint8_t*)&data, 4);
+    router_send_frame((1 << 1) | (1 << 2), data.data.data(), 4);
     EXPECT_GT(router_buffers[0].send_buffers[DOWN_LINK].size(), 0);
     EXPECT_EQ(router_buffers[0].send_buffers[UP_LINK].size(), 0);
 
@@ -162,7 +167,7 @@ TEST_F(FrameRouter, first_link_sends_to_master) {
     frame_buffer_t data;
     data.data = {0xAB, 0x70, 0x55, 0xBB};
     activate_router(1);
-    router_send_frame(0, (uint8_t*)&data, 4);
+    router_send_frame(0, data.data.data(), 4);
     EXPECT_GT(router_buffers[1].send_buffers[UP_LINK].size(), 0);
     EXPECT_EQ(router_buffers[1].send_buffers[DOWN_LINK].size(), 0);
 
@@ -177,7 +182,7 @@ TEST_F(FrameRouter, second_link_sends_to_master) {
     frame_buffer_t data;
     data.data = {0xAB, 0x70, 0x55, 0xBB};
     activate_router(2);
-    router_send_frame(0, (uint8_t*)&data, 4);
+    router_send_frame(0, data.data.data(), 4);
     EXPECT_GT(router_buffers[2].send_buffers[UP_LINK].size(), 0);
     EXPECT_EQ(router_buffers[2].send_buffers[DOWN_LINK].size(), 0);
 
@@ -196,7 +201,7 @@ TEST_F(FrameRouter, master_sends_to_master_does_nothing) {
     frame_buffer_t data;
     data.data = {0xAB, 0x70, 0x55, 0xBB};
     activate_router(0);
-    router_send_frame(0, (uint8_t*)&data, 4);
+    router_send_frame(0, data.data.data(), 4);
     EXPECT_EQ(router_buffers[0].send_buffers[UP_LINK].size(), 0);
     EXPECT_EQ(router_buffers[0].send_buffers[DOWN_LINK].size(), 0);
 }
@@ -205,7 +210,7 @@ TEST_F(FrameRouter, link_sends_to_other_link_does_nothing) {
     frame_buffer_t data;
     data.data = {0xAB, 0x70, 0x55, 0xBB};
     activate_router(1);
-    router_send_frame(2, (uint8_t*)&data, 4);
+    router_send_frame(2, data.data.data(), 4);
     EXPECT_EQ(router_buffers[1].send_buffers[UP_LINK].size(), 0);
     EXPECT_EQ(router_buffers[1].send_buffers[DOWN_LINK].size(), 0);
 }
@@ -214,7 +219,7 @@ TEST_F(FrameRouter, master_receives_on_uplink_does_nothing) {
     frame_buffer_t data;
     data.data = {0xAB, 0x70, 0x55, 0xBB};
     activate_router(1);
-    router_send_frame(0, (uint8_t*)&data, 4);
+    router_send_frame(0, data.data.data(), 4);
     EXPECT_GT(router_buffers[1].send_buffers[UP_LINK].size(), 0);
     EXPECT_EQ(router_buffers[1].send_buffers[DOWN_LINK].size(), 0);
 
@@ -227,3 +232,34 @@ TEST_F(FrameRouter, master_receives_on_uplink_does_nothing) {
     EXPECT_EQ(router_buffers[0].send_buffers[UP_LINK].size(), 0);
     EXPECT_EQ(router_buffers[0].send_buffers[DOWN_LINK].size(), 0);
 }
+
+TEST_F(FrameRouter, frame_is_sent_with_a_single_copy) {
+    frame_buffer_t data;
+    data.data = {0xAB, 0x00, 0x55, 0xBB};
+    activate_router(1);
+    router_send_frame(0, data.data.data(), 4);
+    printf("send_data calls per frame: %u\n", num_send_data_calls);
+    EXPECT_EQ(num_send_data_calls, 1);
+}
+
+// Not really a test, but prints how long it takes to send and receive a frame
+TEST_F(FrameRouter, frame_latency_benchmark) {
+    const int iterations = 100000;
+    EXPECT_CALL(*this, transport_recv_frame(1, _, _))
+        .Times(iterations);
+    unsigned send_calls = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        frame_buffer_t data;
+        data.data = {0xAB, (uint8_t)i, 0x55, 0xBB};
+        activate_router(1);
+        router_buffers[1].send_buffers[UP_LINK].clear();
+        num_send_data_calls = 0;
+        router_send_frame(0, data.data.data(), 4);
+        send_calls += num_send_data_calls;
+        simulate_transport(1, 0);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    printf("%.0f ns per frame, %.2f send_data calls per frame\n", ns, (double)send_calls / iterations);
+}
@@ -0,0 +1,144 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 agent <agent@local>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <string.h>
+extern "C" {
+#include "serial_link/protocol/frame_validator.h"
+#include "serial_link/protocol/crc.h"
+}
+
+using testing::_;
+using testing::ElementsAreArray;
+using testing::Args;
+
+class FrameValidatorCrc16 : public testing::Test {
+public:
+    FrameValidatorCrc16() {
+        Instance = this;
+    }
+
+    ~FrameValidatorCrc16() {
+        Instance = nullptr;
+    }
+
+    MOCK_METHOD3(route_incoming_frame, void (uint8_t link, uint8_t* data, uint16_t size));
+    MOCK_METHOD3(byte_stuffer_send_frame_in_place, void (uint8_t link, uint8_t* data, uint16_t size));
+
+    static FrameValidatorCrc16* Instance;
+};
+
+FrameValidatorCrc16* FrameValidatorCrc16::Instance = nullptr;
+
+extern "C" {
+void route_incoming_frame(uint8_t link, uint8_t* data, uint16_t size) {
+    FrameValidatorCrc16::Instance->route_incoming_frame(link, data, size);
+}
+
+void byte_stuffer_send_frame_in_place(uint8_t link, uint8_t* data, uint16_t size) {
+    FrameValidatorCrc16::Instance->byte_stuffer_send_frame_in_place(link, data, size);
+}
+}
+
+// These are compiled with SERIAL_LINK_CRC16_MAX_SIZE=8
+
+static void append_crc16(uint8_t* data, uint16_t size) {
+    uint16_t crc = crc16_ccitt(data, size);
+    memcpy(data + size, &crc, 2);
+}
+
+static void append_crc32(uint8_t* data, uint16_t size) {
+    uint32_t crc = crc32_calculate(data, size);
+    memcpy(data + size, &crc, 4);
+}
+
+TEST_F(FrameValidatorCrc16, sends_short_frames_with_crc16) {
+    uint8_t original[] = {1, 2, 3, 4, 5, 0, 0, 0, 0};
+    uint8_t expected[] = {1, 2, 3, 4, 5, 0, 0};
+    append_crc16(expected, 5);
+    EXPECT_CALL(*this, byte_stuffer_send_frame_in_place(_, _, _))
+        .With(Args<1, 2>(ElementsAreArray(expected)));
+    validator_send_frame(0, original, 5);
+}
+
+TEST_F(FrameValidatorCrc16, sends_frames_at_the_limit_with_crc16) {
+    uint8_t original[12] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint8_t expected[10] = {1, 2, 3, 4, 5, 6, 7, 8};
+    append_crc16(expected, 8);
+    EXPECT_CALL(*this, byte_stuffer_send_frame_in_place(_, _, _))
+        .With(Args<1, 2>(ElementsAreArray(expected)));
+    validator_send_frame(0, original, 8);
+}
+
+TEST_F(FrameValidatorCrc16, sends_long_frames_with_crc32) {
+    uint8_t original[13] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+    uint8_t expected[13] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+    append_crc32(expected, 9);
+    EXPECT_CALL(*this, byte_stuffer_send_frame_in_place(_, _, _))
+        .With(Args<1, 2>(ElementsAreArray(expected)));
+    validator_send_frame(0, original, 9);
+}
+
+TEST_F(FrameValidatorCrc16, validates_short_frame_with_correct_crc16) {
+    uint8_t data[] = {0x44, 0x10, 0xFF, 0, 0};
+    append_crc16(data, 3);
+    EXPECT_CALL(*this, route_incoming_frame(_, _, _))
+        .With(Args<1, 2>(ElementsAreArray(data, 3)));
+    validator_recv_frame(0, data, 5);
+}
+
+TEST_F(FrameValidatorCrc16, does_not_validate_short_frame_with_incorrect_crc16) {
+    uint8_t data[] = {0x44, 0x10, 0xFF, 0, 0};
+    append_crc16(data, 3);
+    data[4] ^= 1;
+    EXPECT_CALL(*this, route_incoming_frame(_, _, _))
+        .Times(0);
+    validator_recv_frame(0, data, 5);
+}
+
+TEST_F(FrameValidatorCrc16, validates_long_frame_with_correct_crc32) {
+    uint8_t data[13] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+    append_crc32(data, 9);
+    EXPECT_CALL(*this, route_incoming_frame(_, _, _))
+        .With(Args<1, 2>(ElementsAreArray(data, 9)));
+    validator_recv_frame(0, data, 13);
+}
+
+TEST_F(FrameValidatorCrc16, does_not_validate_frames_between_the_two_sizes) {
+    uint8_t data[12] = {1, 2, 3, 4, 5, 6, 7, 8};
+    append_crc32(data, 8);
+    EXPECT_CALL(*this, route_incoming_frame(_, _, _))
+        .Times(0);
+    validator_recv_frame(0, data, 12);
+    validator_recv_frame(0, data, 11);
+}
+
+TEST_F(FrameValidatorCrc16, doesnt_validate_frames_under_3_bytes) {
+    EXPECT_CALL(*this, route_incoming_frame(_, _, _))
+        .Times(0);
+    uint8_t data[] = {0xFF, 0xFF};
+    validator_recv_frame(0, data, 1);
+    validator_recv_frame(0, data, 2);
+}
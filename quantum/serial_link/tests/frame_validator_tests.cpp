@@ -24,8 +24,13 @@ SOFTWARE.
 
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
 extern "C" {
 #include "serial_link/protocol/frame_validator.h"
+#include "serial_link/protocol/crc.h"
 }
 
 using testing::_;
@@ -43,7 +48,7 @@ public:
     }
 
     MOCK_METHOD3(route_incoming_frame, void (uint8_t link, uint8_t* data, uint16_t size));
-    MOCK_METHOD3(byte_stuffer_send_frame, void (uint8_t link, uint8_t* data, uint16_t size));
+    MOCK_METHOD3(byte_stuffer_send_frame_in_place, void (uint8_t link, uint8_t* data, uint16_t size));
 
     static FrameValidator* Instance;
 };
@@ -55,8 +60,8 @@ void route_incoming_frame(uint8_t link, uint8_t* data, uint16_t size) {
     FrameValidator::Instance->route_incoming_frame(link, data, size);
 }
 
-void byte_stuffer_send_frame(uint8_t link, uint8_t* data, uint16_t size) {
-    FrameValidator::Instance->byte_stuffer_send_frame(link, data, size);
+void byte_stuffer_send_frame_in_place(uint8_t link, uint8_t* data, uint16_t size) {
+    FrameValidator::Instance->byte_stuffer_send_frame_in_place(link, data, size);
 }
 }
 
@@ -101,7 +106,7 @@ TEST_F(FrameValidator, validates_five_byte_frame_with_correct_crc) {
 TEST_F(FrameValidator, sends_one_byte_with_correct_crc) {
     uint8_t original[] = {0x44, 0, 0, 0, 0};
     uint8_t expected[] = {0x44, 0x04, 0x6A, 0xB3, 0xA3};
-    EXPECT_CALL(*this, byte_stuffer_send_frame(_, _, _))
+    EXPECT_CALL(*this, byte_stuffer_send_frame_in_place(_, _, _))
         .With(Args<1, 2>(ElementsAreArray(expected)));
     validator_send_frame(0, original, 1);
 }
@@ -109,7 +114,61 @@ TEST_F(FrameValidator, sends_one_byte_with_correct_crc) {
 TEST_F(FrameValidator, sends_five_bytes_with_correct_crc) {
     uint8_t original[] = {1, 2, 3, 4, 5, 0, 0, 0, 0};
     uint8_t expected[] = {1, 2, 3, 4, 5, 0xF4, 0x99, 0x0B, 0x47};
-    EXPECT_CALL(*this, byte_stuffer_send_frame(_, _, _))
+    EXPECT_CALL(*this, byte_stuffer_send_frame_in_place(_, _, _))
         .With(Args<1, 2>(ElementsAreArray(expected)));
     validator_send_frame(0, original, 5);
 }
+
+TEST(Crc32, all_implementations_calculate_the_standard_check_value) {
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    EXPECT_EQ(crc32_bytewise(check, sizeof(check)), 0xCBF43926);
+    EXPECT_EQ(crc32_slice_by_4(check, sizeof(check)), 0xCBF43926);
+    EXPECT_EQ(crc32_slice_by_8(check, sizeof(check)), 0xCBF43926);
+    EXPECT_EQ(crc32_calculate(check, sizeof(check)), 0xCBF43926);
+}
+
+TEST(Crc32, slice_by_n_is_equivalent_to_bytewise_for_all_sizes_and_alignments) {
+    std::vector<uint8_t> data(256 + 8);
+    srand(1);
+    for (auto& d : data) {
+        d = rand();
+    }
+    for (uint16_t offset = 0; offset < 8; offset++) {
+        for (uint16_t size = 0; size <= 256; size++) {
+            uint32_t expected = crc32_bytewise(&data[offset], size);
+            EXPECT_EQ(crc32_slice_by_4(&data[offset], size), expected) << "size " << size << " offset " << offset;
+            EXPECT_EQ(crc32_slice_by_8(&data[offset], size), expected) << "size " << size << " offset " << offset;
+        }
+    }
+}
+
+TEST(Crc16, calculates_the_standard_check_value) {
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    EXPECT_EQ(crc16_ccitt(check, sizeof(check)), 0x29B1);
+}
+
+template<typename F>
+static double crc_throughput(F crc, const std::vector<uint8_t>& data, int iterations) {
+    volatile uint32_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        sink = sink + crc(data.data(), data.size());
+    }
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return (double)data.size() * iterations / seconds / (1024 * 1024);
+}
+
+// Not really a test, but prints the relative speed of the implementations
+TEST(Crc32, throughput_benchmark) {
+    const int iterations = 2000;
+    for (uint16_t size : {16, 64, 1024}) {
+        std::vector<uint8_t> data(size, 0xA5);
+        double bytewise = crc_throughput(crc32_bytewise, data, iterations);
+        double slice4 = crc_throughput(crc32_slice_by_4, data, iterations);
+        double slice8 = crc_throughput(crc32_slice_by_8, data, iterations);
+        double crc16 = crc_throughput(crc16_ccitt, data, iterations);
+        printf("%4u byte frames: bytewise %.1f MB/s, slice-by-4 %.1f MB/s, slice-by-8 %.1f MB/s, crc16 %.1f MB/s\n",
+                size, bytewise, slice4, slice8, crc16);
+    }
+}
@@ -0,0 +1,178 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 agent <agent@local>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "gtest/gtest.h"
+#include <array>
+#include <cstdio>
+#include <random>
+extern "C" {
+    #include "serial_link/protocol/matrix_sync.h"
+}
+
+static const uint8_t num_rows = 6;
+static const uint8_t row_size = 2;
+static const int rows_size = num_rows * row_size;
+
+class MatrixSync : public testing::Test {
+public:
+    MatrixSync() {
+        matrix_sync_sender_init(&sender, acked.data(), published.data(), num_rows, row_size);
+        receiver_rows.fill(0xFF);
+        matrix_sync_receiver_init(&receiver, receiver_rows.data(), num_rows, row_size);
+        rows.fill(0);
+    }
+
+    uint8_t transfer() {
+        size = matrix_sync_encode(&sender, rows.data(), receiver.sequence, message.data());
+        EXPECT_LE(size, MATRIX_SYNC_MAX_MESSAGE_SIZE(num_rows, row_size));
+        EXPECT_EQ(size, matrix_sync_message_size(message[0], row_size));
+        EXPECT_TRUE(matrix_sync_decode(&receiver, message.data(), size));
+        return MATRIX_SYNC_TYPE(message[0]);
+    }
+
+    matrix_sync_sender_t sender;
+    matrix_sync_receiver_t receiver;
+    std::array<uint8_t, rows_size> acked;
+    std::array<uint8_t, rows_size> published;
+    std::array<uint8_t, rows_size> receiver_rows;
+    std::array<uint8_t, rows_size> rows;
+    std::array<uint8_t, MATRIX_SYNC_MAX_MESSAGE_SIZE(num_rows, row_size)> message;
+    uint8_t size;
+};
+
+TEST_F(MatrixSync, first_message_is_full) {
+    rows[3] = 5;
+    EXPECT_EQ(transfer(), MATRIX_SYNC_FULL);
+    EXPECT_EQ(size, 2 + rows_size);
+    EXPECT_EQ(receiver_rows, rows);
+}
+
+TEST_F(MatrixSync, heartbeat_is_sent_when_nothing_changes) {
+    transfer();
+    EXPECT_EQ(transfer(), MATRIX_SYNC_HEARTBEAT);
+    EXPECT_EQ(size, 2);
+    EXPECT_EQ(transfer(), MATRIX_SYNC_HEARTBEAT);
+    EXPECT_EQ(receiver_rows, rows);
+}
+
+TEST_F(MatrixSync, only_the_changed_row_is_sent) {
+    transfer();
+    transfer();
+    rows[4] = 1;
+    rows[5] = 2;
+    EXPECT_EQ(transfer(), MATRIX_SYNC_DELTA);
+    EXPECT_EQ(size, 3 + 1 + row_size);
+    EXPECT_EQ(message[3], 2);
+    EXPECT_EQ(receiver_rows, rows);
+    EXPECT_EQ(transfer(), MATRIX_SYNC_HEARTBEAT);
+}
+
+TEST_F(MatrixSync, full_message_is_sent_when_most_rows_change) {
+    transfer();
+    transfer();
+    for (int i = 0; i < rows_size; i++) {
+        rows[i] = i + 1;
+    }
+    EXPECT_EQ(transfer(), MATRIX_SYNC_FULL);
+    EXPECT_EQ(receiver_rows, rows);
+}
+
+TEST_F(MatrixSync, lost_delta_is_resent) {
+    transfer();
+    transfer();
+    rows[0] = 1;
+    size = matrix_sync_encode(&sender, rows.data(), receiver.sequence, message.data());
+    EXPECT_EQ(MATRIX_SYNC_TYPE(message[0]), MATRIX_SYNC_DELTA);
+    EXPECT_EQ(transfer(), MATRIX_SYNC_DELTA);
+    EXPECT_EQ(receiver_rows, rows);
+}
+
+TEST_F(MatrixSync, delta_based_on_a_lost_message_is_ignored) {
+    transfer();
+    transfer();
+    rows[0] = 1;
+    transfer();
+    uint8_t ack = receiver.sequence;
+    // The acknowledgement is lost, and another row changes
+    rows[2] = 1;
+    size = matrix_sync_encode(&sender, rows.data(), MATRIX_SYNC_NO_SEQUENCE, message.data());
+    EXPECT_EQ(MATRIX_SYNC_TYPE(message[0]), MATRIX_SYNC_FULL);
+    rows[2] = 0;
+    EXPECT_TRUE(matrix_sync_decode(&receiver, message.data(), size));
+    EXPECT_NE(receiver.sequence, ack);
+    transfer();
+    EXPECT_EQ(transfer(), MATRIX_SYNC_HEARTBEAT);
+    EXPECT_EQ(receiver_rows, rows);
+}
+
+TEST_F(MatrixSync, receiver_reset_causes_a_full_message) {
+    transfer();
+    transfer();
+    matrix_sync_receiver_reset(&receiver);
+    EXPECT_EQ(transfer(), MATRIX_SYNC_FULL);
+    EXPECT_EQ(transfer(), MATRIX_SYNC_HEARTBEAT);
+}
+
+TEST_F(MatrixSync, corrupt_messages_are_rejected) {
+    transfer();
+    rows[0] = 1;
+    size = matrix_sync_encode(&sender, rows.data(), receiver.sequence, message.data());
+    EXPECT_FALSE(matrix_sync_decode(&receiver, message.data(), size - 1));
+    message[3] = num_rows;
+    EXPECT_FALSE(matrix_sync_decode(&receiver, message.data(), size));
+    message[0] = 0xC0;
+    EXPECT_FALSE(matrix_sync_decode(&receiver, message.data(), 2));
+    EXPECT_NE(receiver_rows, rows);
+}
+
+TEST_F(MatrixSync, converges_over_a_lossy_link) {
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<int> byte(0, rows_size - 1);
+    uint8_t ack = receiver.sequence;
+    long bytes_sent = 0;
+    const int num_scans = 20000;
+    for (int scan = 0; scan < num_scans; scan++) {
+        if (percent(random) < 10) {
+            rows[byte(random)] ^= 1 << (percent(random) % 8);
+        }
+        size = matrix_sync_encode(&sender, rows.data(), ack, message.data());
+        bytes_sent += size;
+        if (percent(random) >= 20) {
+            EXPECT_TRUE(matrix_sync_decode(&receiver, message.data(), size));
+        }
+        if (percent(random) >= 20) {
+            ack = receiver.sequence;
+        }
+    }
+    // Let it settle without losses
+    for (int i = 0; i < 3; i++) {
+        transfer();
+    }
+    EXPECT_EQ(receiver_rows, rows);
+    EXPECT_EQ(transfer(), MATRIX_SYNC_HEARTBEAT);
+    long full_bytes = (long)num_scans * rows_size;
+    printf("Sent %ld bytes, full resend would be %ld bytes\n", bytes_sent, full_bytes);
+    EXPECT_LT(bytes_sent, full_bytes / 2);
+}
@@ -4,14 +4,27 @@ serial_link_byte_stuffer_SRC :=\
 
 serial_link_frame_validator_SRC := \
 	$(SERIAL_PATH)/tests/frame_validator_tests.cpp \
-	$(SERIAL_PATH)/protocol/frame_validator.c 
+	$(SERIAL_PATH)/protocol/frame_validator.c \
+	$(SERIAL_PATH)/protocol/crc.c
+
+serial_link_frame_validator_crc16_SRC := \
+	$(SERIAL_PATH)/tests/frame_validator_crc16_tests.cpp \
+	$(SERIAL_PATH)/protocol/frame_validator.c \
+	$(SERIAL_PATH)/protocol/crc.c
+
+serial_link_frame_validator_crc16_DEFS := -DSERIAL_LINK_CRC16_MAX_SIZE=8
 
 serial_link_frame_router_SRC := \
 	$(SERIAL_PATH)/tests/frame_router_tests.cpp \
 	$(SERIAL_PATH)/protocol/byte_stuffer.c \
 	$(SERIAL_PATH)/protocol/frame_validator.c \
+	$(SERIAL_PATH)/protocol/crc.c \
 	$(SERIAL_PATH)/protocol/frame_router.c
 
+serial_link_matrix_sync_SRC := \
+	$(SERIAL_PATH)/tests/matrix_sync_tests.cpp \
+	$(SERIAL_PATH)/protocol/matrix_sync.c
+
 serial_link_triple_buffered_object_SRC := \
 	$(SERIAL_PATH)/tests/triple_buffered_object_tests.cpp \
 	$(SERIAL_PATH)/protocol/triple_buffered_object.c 
@@ -5,7 +5,6 @@
 #include <util/twi.h>
 #include <stdbool.h>
 #include "i2c.h"
-#include "split_flags.h"
 
 #if defined(USE_I2C) || defined(EH)
 
@@ -17,10 +16,12 @@
 // poll loop takes at least 8 clock cycles to execute
 #define I2C_LOOP_TIMEOUT (9+1)*(F_CPU/SCL_CLOCK)/8
 
-#define BUFFER_POS_INC() (slave_buffer_pos = (slave_buffer_pos+1)%SLAVE_BUFFER_SIZE)
+#define BUFFER_POS_INC() (slave_buffer_pos = (slave_buffer_pos+1 < SLAVE_BUFFER_SIZE) ? slave_buffer_pos+1 : 0)
 
 volatile uint8_t i2c_slave_buffer[SLAVE_BUFFER_SIZE];
 
+volatile bool i2c_slave_reading = false;
+
 static volatile uint8_t slave_buffer_pos;
 static volatile bool slave_has_register_set = false;
 
@@ -138,6 +139,7 @@ ISR(TWI_vect) {
     case TW_SR_SLA_ACK:
       // this device has been addressed as a slave receiver
       slave_has_register_set = false;
+      i2c_slave_reading = false;
       break;
 
     case TW_SR_DATA_ACK:
@@ -157,13 +159,6 @@ ISR(TWI_vect) {
         slave_has_register_set = true;
       } else {      
         i2c_slave_buffer[slave_buffer_pos] = TWDR;
-        
-        if ( slave_buffer_pos == I2C_BACKLIT_START) {
-            BACKLIT_DIRTY = true;
-        } else if ( slave_buffer_pos == (I2C_RGB_START+3)) {
-            RGB_DIRTY = true;
-        }
-        
         BUFFER_POS_INC();
       }
       break;
@@ -172,12 +167,20 @@ ISR(TWI_vect) {
     case TW_ST_DATA_ACK:
       // master has addressed this device as a slave transmitter and is
       // requesting data.
+      i2c_slave_reading = true;
       TWDR = i2c_slave_buffer[slave_buffer_pos];
       BUFFER_POS_INC();
       break;
 
+    case TW_ST_DATA_NACK:
+    case TW_ST_LAST_DATA:
+      // the master has read everything it wanted
+      i2c_slave_reading = false;
+      break;
+
     case TW_BUS_ERROR: // something went wrong, reset twi state
       TWCR = 0;
+      i2c_slave_reading = false;
     default:
       break;
   }
@@ -2,6 +2,10 @@
 #define I2C_H
 
 #include <stdint.h>
+#include "config.h"
+#include "matrix.h"
+#include "serial_link/protocol/matrix_sync.h"
+#include "split_state.h"
 
 #ifndef F_CPU
 #define F_CPU 16000000UL
@@ -13,16 +17,16 @@
 #define I2C_ACK 1
 #define I2C_NACK 0
 
-// Address location defines (Keymap should be last, as it's size is dynamic)
-#define I2C_BACKLIT_START   0x00
-// Need 4 bytes for RGB (32 bit)
-#define I2C_RGB_START       0x01
-#define I2C_KEYMAP_START    0x06
+// Address location defines
+// The last sequence number the master has received, must be right before the keymap
+#define I2C_MATRIX_ACK_START 0x00
+// The keymap is sent as a matrix_sync message, that only contains the changed rows
+#define I2C_KEYMAP_START    0x01
+// The split_state objects, the master writes the changed ones directly here
+#define I2C_STATE_START     (I2C_KEYMAP_START + MATRIX_SYNC_MAX_MESSAGE_SIZE(MATRIX_ROWS/2, sizeof(matrix_row_t)))
 
 // Slave buffer (8bit per)
-// Rows per hand + backlit space + rgb space
-// TODO : Make this dynamically sized
-#define SLAVE_BUFFER_SIZE 0x20
+#define SLAVE_BUFFER_SIZE (I2C_STATE_START + SPLIT_STATE_AREA_SIZE)
 
 // i2c SCL clock frequency
 #ifndef SCL_CLOCK
@@ -31,6 +35,8 @@
 
 // Support 8bits right now (8 cols) will need to edit to take higher (code exists in delta split?)
 extern volatile uint8_t i2c_slave_buffer[SLAVE_BUFFER_SIZE];
+// Set while the master is reading from the slave, which must not change what it reads
+extern volatile bool i2c_slave_reading;
 
 void i2c_master_init(void);
 uint8_t i2c_master_start(uint8_t address);
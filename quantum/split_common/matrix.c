@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <stdint.h>
 #include <stdbool.h>
 #include <avr/io.h>
+#include <avr/interrupt.h>
 #include "wait.h"
 #include "print.h"
 #include "debug.h"
@@ -30,15 +31,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "pro_micro.h"
 #include "config.h"
 #include "timer.h"
-#include "split_flags.h"
-
-#ifdef RGBLIGHT_ENABLE
-#   include "rgblight.h"
-#endif
-#ifdef BACKLIGHT_ENABLE
-#   include "backlight.h"
-    extern backlight_config_t backlight_config;
-#endif
+#include "split_state.h"
+#include "serial_link/protocol/matrix_sync.h"
 
 #if defined(USE_I2C) || defined(EH)
 #  include "i2c.h"
@@ -69,8 +63,16 @@ static matrix_row_t matrix_debouncing[MATRIX_ROWS];
 
 #define ROWS_PER_HAND (MATRIX_ROWS/2)
 
+#define MATRIX_SYNC_MESSAGE_SIZE MATRIX_SYNC_MAX_MESSAGE_SIZE(ROWS_PER_HAND, sizeof(matrix_row_t))
+
 static uint8_t error_count = 0;
 
+// The slave only sends the rows that have changed since the master last acknowledged
+static matrix_sync_sender_t sync_sender;
+static matrix_sync_receiver_t sync_receiver;
+static uint8_t sync_acked_rows[ROWS_PER_HAND * sizeof(matrix_row_t)];
+static uint8_t sync_published_rows[ROWS_PER_HAND * sizeof(matrix_row_t)];
+
 static const uint8_t row_pins[MATRIX_ROWS] = MATRIX_ROW_PINS;
 static const uint8_t col_pins[MATRIX_COLS] = MATRIX_COL_PINS;
 
@@ -151,7 +153,11 @@ void matrix_init(void)
         matrix[i] = 0;
         matrix_debouncing[i] = 0;
     }
-    
+
+    int slaveOffset = (isLeftHand) ? (ROWS_PER_HAND) : 0;
+    matrix_sync_sender_init(&sync_sender, sync_acked_rows, sync_published_rows, ROWS_PER_HAND, sizeof(matrix_row_t));
+    matrix_sync_receiver_init(&sync_receiver, (uint8_t*)(matrix + slaveOffset), ROWS_PER_HAND, sizeof(matrix_row_t));
+
     matrix_init_quantum();
     
 }
@@ -208,31 +214,31 @@ uint8_t _matrix_scan(void)
 
 // Get rows from other half over i2c
 int i2c_transaction(void) {
-    int slaveOffset = (isLeftHand) ? (ROWS_PER_HAND) : 0;
     int err = 0;
-    
-    // write backlight info
-    #ifdef BACKLIGHT_ENABLE
-        if (BACKLIT_DIRTY) {
-            err = i2c_master_start(SLAVE_I2C_ADDRESS + I2C_WRITE);
-            if (err) goto i2c_error;
-            
-            // Backlight location
-            err = i2c_master_write(I2C_BACKLIT_START);
-            if (err) goto i2c_error;
-            
-            // Write backlight 
-            i2c_master_write(get_backlight_level());
-            
-            BACKLIT_DIRTY = false;
-        }
-    #endif
+
+    // write one changed shared state object, directly to its location
+    split_state_t* state = split_state_next_dirty();
+    if (state) {
+        err = i2c_master_start(SLAVE_I2C_ADDRESS + I2C_WRITE);
+        if (err) goto i2c_error;
+
+        err = i2c_master_write(I2C_STATE_START + state->offset);
+        if (err) goto i2c_error;
+
+        // The version is last, so the slave never sees a new version with old data
+        err = i2c_master_write_data((void*)split_state_record(state), split_state_record_size(state->id));
+        if (err) goto i2c_error;
+
+        split_state_mark_sent(state, split_state_version(state));
+    }
 
     err = i2c_master_start(SLAVE_I2C_ADDRESS + I2C_WRITE);
     if (err) goto i2c_error;
 
-    // start of matrix stored at I2C_KEYMAP_START
-    err = i2c_master_write(I2C_KEYMAP_START);
+    // Tell the slave what we have, the location is then at I2C_KEYMAP_START
+    err = i2c_master_write(I2C_MATRIX_ACK_START);
+    if (err) goto i2c_error;
+    err = i2c_master_write(sync_receiver.sequence);
     if (err) goto i2c_error;
 
     // Start read
@@ -240,37 +246,27 @@ int i2c_transaction(void) {
     if (err) goto i2c_error;
 
     if (!err) {
+        // The size of the rest of the message is in the first byte
+        uint8_t message[MATRIX_SYNC_MESSAGE_SIZE];
+        message[0] = i2c_master_read(I2C_ACK);
+        uint8_t size = matrix_sync_message_size(message[0], sizeof(matrix_row_t));
+        if (size > MATRIX_SYNC_MESSAGE_SIZE) {
+            size = MATRIX_SYNC_MESSAGE_SIZE;
+        }
         int i;
-        for (i = 0; i < ROWS_PER_HAND-1; ++i) {
-            matrix[slaveOffset+i] = i2c_master_read(I2C_ACK);
+        for (i = 1; i < size-1; ++i) {
+            message[i] = i2c_master_read(I2C_ACK);
         }
-        matrix[slaveOffset+i] = i2c_master_read(I2C_NACK);
+        message[i] = i2c_master_read(I2C_NACK);
         i2c_master_stop();
+        if (!matrix_sync_decode(&sync_receiver, message, size)) {
+            return 1;
+        }
     } else {
 i2c_error: // the cable is disconnceted, or something else went wrong
         i2c_reset_state();
         return err;
     }
-    
-    #ifdef RGBLIGHT_ENABLE
-        if (RGB_DIRTY) {
-            err = i2c_master_start(SLAVE_I2C_ADDRESS + I2C_WRITE);
-            if (err) goto i2c_error;
-            
-            // RGB Location
-            err = i2c_master_write(I2C_RGB_START);
-            if (err) goto i2c_error;
-            
-            uint32_t dword = eeconfig_read_rgblight();
-            
-            // Write RGB
-            err = i2c_master_write_data(&dword, 4);
-            if (err) goto i2c_error;
-            
-            RGB_DIRTY = false;
-            i2c_master_stop();
-        }
-    #endif
 
     return 0;
 }
@@ -278,24 +274,65 @@ i2c_error: // the cable is disconnceted, or something else went wrong
 #else // USE_SERIAL
 
 int serial_transaction(void) {
-    int slaveOffset = (isLeftHand) ? (ROWS_PER_HAND) : 0;
+    static uint16_t last_refresh = 0;
+#ifdef USE_SERIAL_USART
+    static split_state_t* in_flight_state = NULL;
+    static uint8_t in_flight_version = 0;
+#endif
 
-    if (serial_update_buffers()) {
-        return 1;
+    if (serial_transaction_pending()) {
+        return SERIAL_TRANSACTION_PENDING;
     }
 
-    for (int i = 0; i < ROWS_PER_HAND; ++i) {
-        matrix[slaveOffset+i] = serial_slave_buffer[i];
+    // The master doesn't know if the slave got the object, so send them again once in a while
+    if (timer_elapsed(last_refresh) > SPLIT_STATE_REFRESH_INTERVAL) {
+        last_refresh = timer_read();
+        split_state_refresh();
     }
-    
-    #ifdef RGBLIGHT_ENABLE
-        // Code to send RGB over serial goes here (not implemented yet)
-    #endif
-    
-    #ifdef BACKLIGHT_ENABLE
-        // Write backlight level for slave to read
-        serial_master_buffer[SERIAL_BACKLIT_START] = backlight_config.enable ? backlight_config.level : 0;
-    #endif
+
+    // Send one changed shared state object
+    split_state_t* state = split_state_next_dirty();
+    if (state) {
+        volatile uint8_t* record = split_state_record(state);
+        uint8_t size = split_state_record_size(state->id);
+        serial_master_buffer[SERIAL_STATE_ID_START] = state->id;
+        for (int i = 0; i < size; ++i) {
+            serial_master_buffer[SERIAL_STATE_START+i] = record[i];
+        }
+    } else {
+        serial_master_buffer[SERIAL_STATE_ID_START] = SPLIT_STATE_NONE;
+    }
+
+#ifdef USE_SERIAL_USART
+    // The exchange runs in the background, so the result is for the one started last time
+    split_state_t* sent_state = in_flight_state;
+    uint8_t sent_version = in_flight_version;
+    in_flight_state = state;
+    in_flight_version = state ? split_state_version(state) : 0;
+#else
+    split_state_t* sent_state = state;
+    uint8_t sent_version = state ? split_state_version(state) : 0;
+#endif
+
+    int err = serial_update_buffers();
+    if (err) {
+        return err;
+    }
+
+    if (sent_state) {
+        split_state_mark_sent(sent_state, sent_version);
+    }
+
+    uint8_t message[MATRIX_SYNC_MESSAGE_SIZE];
+    uint8_t size = serial_slave_message_size();
+    for (int i = 0; i < size; ++i) {
+        message[i] = serial_slave_buffer[i];
+    }
+    if (!matrix_sync_decode(&sync_receiver, message, size)) {
+        return 1;
+    }
+    // Sent with the next transaction
+    serial_master_buffer[SERIAL_MATRIX_ACK_START] = sync_receiver.sequence;
 
     return 0;
 }
@@ -305,12 +342,20 @@ uint8_t matrix_scan(void)
 {
     uint8_t ret = _matrix_scan();
 
+    split_state_update();
+
 #if defined(USE_I2C) || defined(EH)
-    if( i2c_transaction() ) {
+    int err = i2c_transaction();
 #else // USE_SERIAL
-    if( serial_transaction() ) {
+    int err = serial_transaction();
+    if (err == SERIAL_TRANSACTION_PENDING) {
+        // Nothing new from the other half yet
+        matrix_scan_quantum();
+        return ret;
+    }
 #endif
 
+    if (err) {
         error_count++;
 
         if (error_count > ERROR_DISCONNECT_COUNT) {
@@ -319,6 +364,12 @@ uint8_t matrix_scan(void)
             for (int i = 0; i < ROWS_PER_HAND; ++i) {
                 matrix[slaveOffset+i] = 0;
             }
+            // and make it send everything when it comes back
+            matrix_sync_receiver_reset(&sync_receiver);
+            split_state_mark_all_dirty();
+#if !defined(USE_I2C) && !defined(EH)
+            serial_master_buffer[SERIAL_MATRIX_ACK_START] = sync_receiver.sequence;
+#endif
         }
     } else {
         error_count = 0;
@@ -331,15 +382,32 @@ void matrix_slave_scan(void) {
     _matrix_scan();
 
     int offset = (isLeftHand) ? 0 : ROWS_PER_HAND;
+    uint8_t message[MATRIX_SYNC_MESSAGE_SIZE];
 
+    // The encoder returns the same message until the rows change, so when it
+    // can't be copied now, the next scan copies it
 #if defined(USE_I2C) || defined(EH)
-    for (int i = 0; i < ROWS_PER_HAND; ++i) {
-        i2c_slave_buffer[I2C_KEYMAP_START+i] = matrix[offset+i];
-    }   
+    uint8_t size = matrix_sync_encode(&sync_sender, (uint8_t*)(matrix + offset),
+        i2c_slave_buffer[I2C_MATRIX_ACK_START], message);
+    // The master reads the message byte by byte from the interrupt, so it's
+    // left alone until the read is done, or the master would get half of each
+    cli();
+    if (!i2c_slave_reading) {
+        for (int i = 0; i < size; ++i) {
+            i2c_slave_buffer[I2C_KEYMAP_START+i] = message[i];
+        }
+    }
+    sei();
 #else // USE_SERIAL
-    for (int i = 0; i < ROWS_PER_HAND; ++i) {
-        serial_slave_buffer[i] = matrix[offset+i];
+    // The serial interrupt sends the whole buffer at once, so copying it with
+    // interrupts disabled is enough
+    uint8_t size = matrix_sync_encode(&sync_sender, (uint8_t*)(matrix + offset),
+        serial_master_buffer[SERIAL_MATRIX_ACK_START], message);
+    cli();
+    for (int i = 0; i < size; ++i) {
+        serial_slave_buffer[i] = message[i];
     }
+    sei();
 #endif
     matrix_slave_scan_user();
 }
@@ -12,7 +12,7 @@
 #include <stdbool.h>
 #include "serial.h"
 
-#ifndef USE_I2C
+#if !defined(USE_I2C) && !defined(USE_SERIAL_USART)
 
 // Serial pulse period in microseconds. Its probably a bad idea to lower this
 // value.
@@ -125,7 +125,8 @@ ISR(SERIAL_PIN_INTERRUPT) {
   sync_send();
 
   uint8_t checksum = 0;
-  for (int i = 0; i < SERIAL_SLAVE_BUFFER_LENGTH; ++i) {
+  uint8_t size = serial_slave_message_size();
+  for (int i = 0; i < size; ++i) {
     serial_write_byte(serial_slave_buffer[i]);
     sync_send();
     checksum += serial_slave_buffer[i];
@@ -140,8 +141,13 @@ ISR(SERIAL_PIN_INTERRUPT) {
   _delay_us(SERIAL_DELAY/2);
 
   uint8_t checksum_computed = 0;
-  for (int i = 0; i < SERIAL_MASTER_BUFFER_LENGTH; ++i) {
+  uint8_t master_size = SERIAL_STATE_START;
+  for (int i = 0; i < master_size; ++i) {
     serial_master_buffer[i] = serial_read_byte();
+    // the size of the record depends on which object it is
+    if (i == SERIAL_STATE_ID_START) {
+      master_size = serial_master_message_size();
+    }
     sync_send();
     checksum_computed += serial_master_buffer[i];
   }
@@ -154,9 +160,14 @@ ISR(SERIAL_PIN_INTERRUPT) {
     status |= SLAVE_DATA_CORRUPT;
   } else {
     status &= ~SLAVE_DATA_CORRUPT;
+    split_state_receive(serial_master_buffer[SERIAL_STATE_ID_START], serial_master_buffer + SERIAL_STATE_START);
   }
 }
 
+bool serial_transaction_pending(void) {
+  return false;
+}
+
 inline
 bool serial_slave_DATA_CORRUPT(void) {
   return status & SLAVE_DATA_CORRUPT;
@@ -193,9 +204,14 @@ int serial_update_buffers(void) {
   sync_recv();
 
   uint8_t checksum_computed = 0;
-  // receive data from the slave
-  for (int i = 0; i < SERIAL_SLAVE_BUFFER_LENGTH; ++i) {
+  // receive data from the slave, the first byte tells how much there is
+  uint8_t size = 1;
+  for (int i = 0; i < size; ++i) {
     serial_slave_buffer[i] = serial_read_byte();
+    // do this while the slave is still sending the sync pulse
+    if (i == 0) {
+      size = serial_slave_message_size();
+    }
     sync_recv();
     checksum_computed += serial_slave_buffer[i];
   }
@@ -209,7 +225,8 @@ int serial_update_buffers(void) {
 
   uint8_t checksum = 0;
   // send data to the slave
-  for (int i = 0; i < SERIAL_MASTER_BUFFER_LENGTH; ++i) {
+  uint8_t master_size = serial_master_message_size();
+  for (int i = 0; i < master_size; ++i) {
     serial_write_byte(serial_master_buffer[i]);
     sync_recv();
     checksum += serial_master_buffer[i];
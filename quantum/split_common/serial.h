@@ -2,7 +2,10 @@
 #define MY_SERIAL_H
 
 #include "config.h"
+#include "matrix.h"
 #include <stdbool.h>
+#include "serial_link/protocol/matrix_sync.h"
+#include "split_state.h"
 
 /* TODO:  some defines for interrupt setup */
 #define SERIAL_PIN_DDR DDRD
@@ -11,19 +14,40 @@
 #define SERIAL_PIN_MASK _BV(PD0)
 #define SERIAL_PIN_INTERRUPT INT0_vect
 
-#define SERIAL_SLAVE_BUFFER_LENGTH MATRIX_ROWS/2
-#define SERIAL_MASTER_BUFFER_LENGTH 1
+// The slave sends a matrix_sync message, only the used part of the buffer is transferred
+#define SERIAL_SLAVE_BUFFER_LENGTH MATRIX_SYNC_MAX_MESSAGE_SIZE(MATRIX_ROWS/2, sizeof(matrix_row_t))
+// The master sends the acknowledgement, and one changed split_state record
+#define SERIAL_MASTER_BUFFER_LENGTH (2 + SPLIT_STATE_AREA_SIZE)
 
 // Address location defines 
-#define SERIAL_BACKLIT_START   0x00
+#define SERIAL_MATRIX_ACK_START 0x00
+#define SERIAL_STATE_ID_START   0x01
+#define SERIAL_STATE_START      0x02
 
 // Buffers for master - slave communication
 extern volatile uint8_t serial_slave_buffer[SERIAL_SLAVE_BUFFER_LENGTH];
 extern volatile uint8_t serial_master_buffer[SERIAL_MASTER_BUFFER_LENGTH];
 
+// Returned by serial_update_buffers when the previous exchange hasn't finished
+#define SERIAL_TRANSACTION_PENDING 2
+
 void serial_master_init(void);
 void serial_slave_init(void);
 int serial_update_buffers(void);
+// The USART transport runs the exchange in the background, this is true until
+// it's done. The bit-banged one finishes in serial_update_buffers.
+bool serial_transaction_pending(void);
 bool serial_slave_data_corrupt(void);
 
+// The size of the message in serial_slave_buffer
+static inline uint8_t serial_slave_message_size(void) {
+  uint8_t size = matrix_sync_message_size(serial_slave_buffer[0], sizeof(matrix_row_t));
+  return size < SERIAL_SLAVE_BUFFER_LENGTH ? size : SERIAL_SLAVE_BUFFER_LENGTH;
+}
+
+// The size of the message in serial_master_buffer
+static inline uint8_t serial_master_message_size(void) {
+  return SERIAL_STATE_START + split_state_record_size(serial_master_buffer[SERIAL_STATE_ID_START]);
+}
+
 #endif
@@ -0,0 +1,300 @@
+/*
+ * Split serial transport on the hardware USART
+ *
+ * Uses USART1 in half duplex, with TX (PD3) and RX (PD2) tied together on both
+ * halves, and a single wire between them. Only the transmitting side enables
+ * its transmitter, the other side leaves the pin as an input with pull-up.
+ *
+ * A frame is [length] [length bytes of data] [crc8]. The master sends
+ * serial_master_buffer, and the slave answers with serial_slave_buffer straight
+ * from the receive interrupt. Everything is interrupt driven, so the master
+ * starts the exchange and picks up the answer on the next scan.
+ *
+ * Bytes of a frame follow each other closely, so a quiet line ends any frame.
+ * The slave drops what it has received after SERIAL_USART_IDLE_TIME without a
+ * byte, which brings it back in step after a lost or extra byte. After a
+ * failed exchange, the master waits for the same quiet time before it sends
+ * again, in case the slave is still answering.
+ *
+ * Both halves start at SERIAL_USART_SPEED. If the link doesn't work, they halve
+ * the speed until they find one that does. The slave changes speed sooner than
+ * the master, so that it goes through all of them while the master waits on one.
+ */
+
+#ifndef F_CPU
+#define F_CPU 16000000
+#endif
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/crc16.h>
+#include <stdbool.h>
+#include "serial.h"
+#include "timer.h"
+
+#ifdef USE_SERIAL_USART
+
+#ifndef SERIAL_USART_SPEED
+#define SERIAL_USART_SPEED 1000000
+#endif
+
+// How many times the speed can be halved
+#ifndef SERIAL_USART_NUM_SPEEDS
+#define SERIAL_USART_NUM_SPEEDS 4
+#endif
+
+// How long the master waits for the answer, in milliseconds
+#ifndef SERIAL_USART_TIMEOUT
+#define SERIAL_USART_TIMEOUT 5
+#endif
+
+// How long the line is quiet between frames, in milliseconds. A byte takes
+// at most 80us at the lowest speed, and with the millisecond timer two ticks
+// make sure that at least one whole millisecond has passed.
+#ifndef SERIAL_USART_IDLE_TIME
+#define SERIAL_USART_IDLE_TIME 2
+#endif
+
+#if SERIAL_USART_IDLE_TIME >= SERIAL_USART_TIMEOUT
+#error "SERIAL_USART_IDLE_TIME has to be shorter than SERIAL_USART_TIMEOUT"
+#endif
+
+// Double speed mode, so it's divided by 8 instead of 16
+#define SERIAL_USART_UBRR(speed_index) ((F_CPU / 8 / (SERIAL_USART_SPEED >> (speed_index))) - 1)
+
+#define SLAVE_ERROR_LIMIT 8
+#define MASTER_ERROR_LIMIT (SLAVE_ERROR_LIMIT * (SERIAL_USART_NUM_SPEEDS + 1))
+
+#define MAX_BUFFER_LENGTH (SERIAL_SLAVE_BUFFER_LENGTH > SERIAL_MASTER_BUFFER_LENGTH ? \
+  SERIAL_SLAVE_BUFFER_LENGTH : SERIAL_MASTER_BUFFER_LENGTH)
+#define FRAME_SIZE (MAX_BUFFER_LENGTH + 2)
+
+uint8_t volatile serial_slave_buffer[SERIAL_SLAVE_BUFFER_LENGTH] = {0};
+uint8_t volatile serial_master_buffer[SERIAL_MASTER_BUFFER_LENGTH] = {0};
+
+enum {
+  STATE_IDLE,
+  STATE_SENDING,
+  STATE_RECEIVING,
+  STATE_DONE,
+  STATE_FAILED,
+};
+
+static volatile uint8_t state = STATE_IDLE;
+static bool is_master = false;
+static uint8_t speed_index = 0;
+static uint8_t error_count = 0;
+static uint16_t exchange_start = 0;
+
+static volatile uint8_t tx_frame[FRAME_SIZE];
+static volatile uint8_t tx_size;
+static volatile uint8_t tx_pos;
+static volatile uint8_t rx_frame[FRAME_SIZE];
+static volatile uint8_t rx_pos;
+static volatile uint16_t rx_time = 0;
+
+static uint8_t frame_crc(volatile uint8_t* frame, uint8_t size) {
+  uint8_t crc = 0;
+  for (uint8_t i = 0; i < size; ++i) {
+    crc = _crc8_ccitt_update(crc, frame[i]);
+  }
+  return crc;
+}
+
+static void set_speed(uint8_t index) {
+  speed_index = index % SERIAL_USART_NUM_SPEEDS;
+  UBRR1 = SERIAL_USART_UBRR(speed_index);
+}
+
+static void count_error(uint8_t limit) {
+  if (++error_count >= limit) {
+    error_count = 0;
+    set_speed(speed_index + 1);
+  }
+}
+
+static void start_listening(void) {
+  rx_pos = 0;
+  UCSR1B = _BV(RXEN1) | _BV(RXCIE1);
+}
+
+static void stop(void) {
+  UCSR1B = 0;
+}
+
+static void start_sending(volatile uint8_t* data, uint8_t size) {
+  tx_frame[0] = size;
+  for (uint8_t i = 0; i < size; ++i) {
+    tx_frame[i + 1] = data[i];
+  }
+  tx_frame[size + 1] = frame_crc(tx_frame, size + 1);
+  tx_size = size + 2;
+  tx_pos = 0;
+  state = STATE_SENDING;
+  // Clear a transmit complete that is left from before
+  UCSR1A = _BV(U2X1) | _BV(TXC1);
+  UCSR1B = _BV(TXEN1) | _BV(UDRIE1);
+}
+
+static void usart_init(void) {
+  // Both pins are inputs with pull-up when not in use
+  DDRD &= ~(_BV(PD2) | _BV(PD3));
+  PORTD |= _BV(PD2) | _BV(PD3);
+  UCSR1A = _BV(U2X1);
+  // 8N1
+  UCSR1C = _BV(UCSZ11) | _BV(UCSZ10);
+  set_speed(0);
+}
+
+void serial_master_init(void) {
+  is_master = true;
+  usart_init();
+  stop();
+  state = STATE_IDLE;
+}
+
+void serial_slave_init(void) {
+  is_master = false;
+  usart_init();
+  state = STATE_RECEIVING;
+  start_listening();
+}
+
+ISR(USART1_UDRE_vect) {
+  UDR1 = tx_frame[tx_pos++];
+  if (tx_pos == tx_size) {
+    UCSR1B = _BV(TXEN1) | _BV(TXCIE1);
+  }
+}
+
+// The last byte has left, release the line
+ISR(USART1_TX_vect) {
+  state = STATE_RECEIVING;
+  start_listening();
+}
+
+static bool line_idle(void) {
+  cli();
+  uint16_t last = rx_time;
+  sei();
+  return timer_elapsed(last) >= SERIAL_USART_IDLE_TIME;
+}
+
+static void frame_failed(void) {
+  if (is_master) {
+    // Keeps listening, to see when the slave is done
+    state = STATE_FAILED;
+  } else {
+    rx_pos = 0;
+    count_error(SLAVE_ERROR_LIMIT);
+  }
+}
+
+static void frame_received(void) {
+  uint8_t size = rx_frame[0];
+  if (frame_crc(rx_frame, size + 1) != rx_frame[size + 1]) {
+    frame_failed();
+    return;
+  }
+  if (is_master) {
+    stop();
+    state = STATE_DONE;
+    return;
+  }
+
+  volatile uint8_t* data = rx_frame + 1;
+  if (size < SERIAL_STATE_START ||
+      size != SERIAL_STATE_START + split_state_record_size(data[SERIAL_STATE_ID_START])) {
+    frame_failed();
+    return;
+  }
+  for (uint8_t i = 0; i < size; ++i) {
+    serial_master_buffer[i] = data[i];
+  }
+  split_state_receive(serial_master_buffer[SERIAL_STATE_ID_START], serial_master_buffer + SERIAL_STATE_START);
+  error_count = 0;
+  start_sending(serial_slave_buffer, serial_slave_message_size());
+}
+
+ISR(USART1_RX_vect) {
+  uint8_t status = UCSR1A;
+  uint8_t data = UDR1;
+  uint8_t max_size = is_master ? SERIAL_SLAVE_BUFFER_LENGTH : SERIAL_MASTER_BUFFER_LENGTH;
+  uint16_t now = timer_read();
+  // After a quiet line, this is the start of a new frame
+  if (rx_pos != 0 && TIMER_DIFF_16(now, rx_time) >= SERIAL_USART_IDLE_TIME) {
+    rx_pos = 0;
+  }
+  rx_time = now;
+  // A failed master only waits for the line to be quiet
+  if (is_master && state != STATE_RECEIVING) {
+    return;
+  }
+  if (status & (_BV(FE1) | _BV(DOR1))) {
+    frame_failed();
+    return;
+  }
+  if (rx_pos == 0 && (data == 0 || data > max_size)) {
+    frame_failed();
+    return;
+  }
+  rx_frame[rx_pos++] = data;
+  if (rx_pos == rx_frame[0] + 2) {
+    frame_received();
+  }
+}
+
+bool serial_transaction_pending(void) {
+  if (state == STATE_SENDING || state == STATE_RECEIVING) {
+    if (timer_elapsed(exchange_start) <= SERIAL_USART_TIMEOUT) {
+      return true;
+    }
+    // The slave didn't answer in time, but it can still be sending
+    cli();
+    state = STATE_FAILED;
+    start_listening();
+    sei();
+  }
+  return false;
+}
+
+// Returns the result of the previous exchange, and starts a new one
+//
+// Returns:
+// 0 => serial_slave_buffer has new data
+// 1 => slave did not respond
+// SERIAL_TRANSACTION_PENDING => nothing was started before
+int serial_update_buffers(void) {
+  if (serial_transaction_pending()) {
+    return SERIAL_TRANSACTION_PENDING;
+  }
+  // Both halves could be sending at the same time otherwise
+  if (state == STATE_FAILED && !line_idle()) {
+    return SERIAL_TRANSACTION_PENDING;
+  }
+
+  int result = SERIAL_TRANSACTION_PENDING;
+  if (state == STATE_DONE) {
+    uint8_t size = rx_frame[0];
+    for (uint8_t i = 0; i < size; ++i) {
+      serial_slave_buffer[i] = rx_frame[i + 1];
+    }
+    error_count = 0;
+    result = 0;
+  } else if (state == STATE_FAILED) {
+    count_error(MASTER_ERROR_LIMIT);
+    result = 1;
+  }
+
+  exchange_start = timer_read();
+  cli();
+  start_sending(serial_master_buffer, serial_master_message_size());
+  sei();
+  return result;
+}
+
+bool serial_slave_data_corrupt(void) {
+  return error_count != 0;
+}
+
+#endif
@@ -0,0 +1,124 @@
+#include <avr/interrupt.h>
+#include <string.h>
+#include "split_state.h"
+
+#if defined(USE_I2C) || defined(EH)
+#  include "i2c.h"
+// The master writes directly to the slave memory
+#  define STATE_AREA (i2c_slave_buffer + I2C_STATE_START)
+#else
+static volatile uint8_t state_area[SPLIT_STATE_AREA_SIZE];
+#  define STATE_AREA state_area
+#endif
+
+split_state_t* split_states[SPLIT_STATE_MAX_OBJECTS];
+uint8_t split_state_count = 0;
+
+static uint8_t area_used = 0;
+static uint8_t next_state = 0;
+
+bool split_state_register(split_state_t* state) {
+    if (split_state_count >= SPLIT_STATE_MAX_OBJECTS || area_used + state->size + 1 > SPLIT_STATE_AREA_SIZE) {
+        return false;
+    }
+    state->id = split_state_count;
+    state->offset = area_used;
+    state->synced_version = 0;
+    area_used += state->size + 1;
+    split_states[split_state_count++] = state;
+    return true;
+}
+
+volatile uint8_t* split_state_record(split_state_t* state) {
+    return STATE_AREA + state->offset;
+}
+
+void split_state_write(split_state_t* state, const void* data) {
+    volatile uint8_t* record = split_state_record(state);
+    volatile uint8_t* version = record + state->size;
+    const uint8_t* src = (const uint8_t*)data;
+    // The first write is always sent, since the slave might start with something else
+    bool changed = *version == 0;
+    for (uint8_t i = 0; i < state->size; i++) {
+        changed |= record[i] != src[i];
+        record[i] = src[i];
+    }
+    if (changed) {
+        (*version)++;
+        if (*version == 0) {
+            (*version)++;
+        }
+    }
+}
+
+static bool is_dirty(split_state_t* state) {
+    return split_state_version(state) != state->synced_version;
+}
+
+split_state_t* split_state_next_dirty(void) {
+    // Round robin, so that a frequently changing object doesn't starve the others
+    for (uint8_t i = 0; i < split_state_count; i++) {
+        split_state_t* state = split_states[next_state];
+        next_state = (next_state + 1) % split_state_count;
+        if (is_dirty(state)) {
+            return state;
+        }
+    }
+    return NULL;
+}
+
+uint8_t split_state_version(split_state_t* state) {
+    return split_state_record(state)[state->size];
+}
+
+void split_state_mark_sent(split_state_t* state, uint8_t version) {
+    state->synced_version = version;
+}
+
+void split_state_mark_all_dirty(void) {
+    for (uint8_t i = 0; i < split_state_count; i++) {
+        split_states[i]->synced_version = split_state_version(split_states[i]) - 1;
+    }
+}
+
+void split_state_refresh(void) {
+    if (split_state_count > 0) {
+        split_state_t* state = split_states[next_state];
+        state->synced_version = split_state_version(state) - 1;
+    }
+}
+
+void split_state_receive(uint8_t id, const volatile uint8_t* record) {
+    uint8_t size = split_state_record_size(id);
+    if (size) {
+        volatile uint8_t* dst = split_state_record(split_states[id]);
+        for (uint8_t i = 0; i < size; i++) {
+            dst[i] = record[i];
+        }
+    }
+}
+
+void split_state_apply(void) {
+    uint8_t data[SPLIT_STATE_AREA_SIZE];
+    for (uint8_t i = 0; i < split_state_count; i++) {
+        split_state_t* state = split_states[i];
+        volatile uint8_t* record = split_state_record(state);
+        // Only the copy is done with interrupts disabled, so that the data
+        // matches the version
+        cli();
+        uint8_t version = record[state->size];
+        bool changed = version != state->synced_version;
+        if (changed) {
+            for (uint8_t j = 0; j < state->size; j++) {
+                data[j] = record[j];
+            }
+        }
+        sei();
+        if (changed) {
+            state->synced_version = version;
+            if (state->apply) {
+                state->apply(data);
+            }
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef SPLIT_STATE_H
+#define SPLIT_STATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+* Shared state that the master sends to the slave half
+*
+* Every registered object has a version, which the master increments when the data
+* changes, and only the objects with a new version are sent. The slave applies the
+* objects from its main loop, so the apply functions can take as long as they need.
+*
+* Both halves have to register the same objects in the same order.
+**/
+
+// The data of all the objects, plus one version byte for each
+#ifndef SPLIT_STATE_AREA_SIZE
+#define SPLIT_STATE_AREA_SIZE 24
+#endif
+
+#ifndef SPLIT_STATE_MAX_OBJECTS
+#define SPLIT_STATE_MAX_OBJECTS 8
+#endif
+
+// How often the master resends an object, when it can't know if the slave got it
+#ifndef SPLIT_STATE_REFRESH_INTERVAL
+#define SPLIT_STATE_REFRESH_INTERVAL 500
+#endif
+
+#define SPLIT_STATE_NONE 0xFF
+
+typedef void (*split_state_apply_t)(const void* data);
+
+typedef struct {
+    uint8_t size;
+    // Called on the slave, with a copy of the data
+    split_state_apply_t apply;
+    // The rest is set by split_state_register
+    uint8_t id;
+    uint8_t offset;
+    // The version the slave has, on the slave the version that was applied
+    uint8_t synced_version;
+} split_state_t;
+
+extern split_state_t* split_states[SPLIT_STATE_MAX_OBJECTS];
+extern uint8_t split_state_count;
+
+// A record is the data followed by the version
+static inline uint8_t split_state_record_size(uint8_t id) {
+    return id < split_state_count ? split_states[id]->size + 1 : 0;
+}
+
+// Returns false if there's no room for the object
+bool split_state_register(split_state_t* state);
+volatile uint8_t* split_state_record(split_state_t* state);
+uint8_t split_state_version(split_state_t* state);
+
+// Master
+void split_state_write(split_state_t* state, const void* data);
+// Returns NULL if the slave is up to date
+split_state_t* split_state_next_dirty(void);
+// The version is the one that was in the record when it was sent
+void split_state_mark_sent(split_state_t* state, uint8_t version);
+void split_state_mark_all_dirty(void);
+// Sends the next object again
+void split_state_refresh(void);
+
+// Slave
+void split_state_receive(uint8_t id, const volatile uint8_t* record);
+void split_state_apply(void);
+
+#endif
@@ -9,13 +9,16 @@
 #include "keyboard.h"
 #include "config.h"
 #include "timer.h"
-#include "split_flags.h"
+#include "split_state.h"
+#include "action_layer.h"
 
 #ifdef RGBLIGHT_ENABLE
 #   include "rgblight.h"
+    extern rgblight_config_t rgblight_config;
 #endif
 #ifdef BACKLIGHT_ENABLE
 #   include "backlight.h"
+    extern backlight_config_t backlight_config;
 #endif
 
 #ifdef SPLIT_HAND_PIN
@@ -32,6 +35,65 @@ volatile bool isLeftHand = true;
 
 volatile uint8_t setTries = 0;
 
+#ifndef NO_ACTION_LAYER
+static void apply_layer_state(const void* data) {
+    layer_state_set(*(const uint32_t*)data);
+}
+
+static split_state_t layer_split_state = { sizeof(uint32_t), apply_layer_state };
+#endif
+
+#ifdef RGBLIGHT_ENABLE
+static void apply_rgblight(const void* data) {
+    rgblight_update_dword(*(const uint32_t*)data);
+}
+
+static split_state_t rgblight_split_state = { sizeof(uint32_t), apply_rgblight };
+#endif
+
+#ifdef BACKLIGHT_ENABLE
+static void apply_backlight(const void* data) {
+    backlight_set(*(const uint8_t*)data);
+}
+
+static split_state_t backlight_split_state = { sizeof(uint8_t), apply_backlight };
+#endif
+
+__attribute__ ((weak))
+void split_state_init_user(void) {
+}
+
+__attribute__ ((weak))
+void split_state_init_kb(void) {
+    split_state_init_user();
+}
+
+static void split_state_setup(void) {
+#ifndef NO_ACTION_LAYER
+    split_state_register(&layer_split_state);
+#endif
+#ifdef RGBLIGHT_ENABLE
+    split_state_register(&rgblight_split_state);
+#endif
+#ifdef BACKLIGHT_ENABLE
+    split_state_register(&backlight_split_state);
+#endif
+    split_state_init_kb();
+}
+
+void split_state_update(void) {
+#ifndef NO_ACTION_LAYER
+    split_state_write(&layer_split_state, &layer_state);
+#endif
+#ifdef RGBLIGHT_ENABLE
+    split_state_write(&rgblight_split_state, &rgblight_config.raw);
+#endif
+#ifdef BACKLIGHT_ENABLE
+    uint8_t level = backlight_config.enable ? backlight_config.level : 0;
+    split_state_write(&backlight_split_state, &level);
+#endif
+}
+
 static void setup_handedness(void) {
   #ifdef SPLIT_HAND_PIN
     // Test pin SPLIT_HAND_PIN for High/Low, if low it's right hand
@@ -60,10 +122,6 @@ static void keyboard_master_setup(void) {
 #else
   serial_master_init();
 #endif
-
-    // For master the Backlight info needs to be sent on startup
-    // Otherwise the salve won't start with the proper info until an update
-    BACKLIT_DIRTY = true;
 }
 
 static void keyboard_slave_setup(void) {
@@ -83,6 +141,7 @@ bool has_usb(void) {
 
 void split_keyboard_setup(void) {
    setup_handedness();
+   split_state_setup();
 
    if (has_usb()) {
       keyboard_master_setup();
@@ -104,42 +163,8 @@ void keyboard_slave_loop(void) {
     // Matrix Slave Scan
     matrix_slave_scan();
     
-    // Read Backlight Info
-    #ifdef BACKLIGHT_ENABLE
-        if (BACKLIT_DIRTY) {
-            #ifdef USE_I2C
-                backlight_set(i2c_slave_buffer[I2C_BACKLIT_START]);
-            #else // USE_SERIAL
-                backlight_set(serial_master_buffer[SERIAL_BACKLIT_START]);
-            #endif
-            BACKLIT_DIRTY = false;
-        }
-    #endif
-    // Read RGB Info
-    #ifdef RGBLIGHT_ENABLE
-        #ifdef USE_I2C
-            if (RGB_DIRTY) {
-                // Disable interupts (RGB data is big)
-                cli();
-                // Create new DWORD for RGB data
-                uint32_t dword; 
-                
-                // Fill the new DWORD with the data that was sent over
-                uint8_t *dword_dat = (uint8_t *)(&dword);
-                for (int i = 0; i < 4; i++) {
-                    dword_dat[i] = i2c_slave_buffer[I2C_RGB_START+i];
-                }
-                
-                // Update the RGB now with the new data and set RGB_DIRTY to false
-                rgblight_update_dword(dword);
-                RGB_DIRTY = false;
-                // Re-enable interupts now that RGB is set
-                sei();
-            }
-        #else // USE_SERIAL
-            // Add serial implementation for RGB here
-        #endif
-    #endif
+    // Apply the backlight, RGB and other state from the master
+    split_state_apply();
    }
 }
 
@@ -18,6 +18,12 @@ void split_keyboard_setup(void);
 bool has_usb(void);
 void keyboard_slave_loop(void);
 
+// Sends the shared state to the slave, called by the master on every scan
+void split_state_update(void);
+// Register extra split_state objects here, on both halves
+void split_state_init_kb(void);
+void split_state_init_user(void);
+
 void matrix_master_OLED_init (void);
 
 #endif
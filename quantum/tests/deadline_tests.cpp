@@ -0,0 +1,178 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "gtest/gtest.h"
+#include <string.h>
+#include <vector>
+
+extern "C" {
+    #include "deadline.h"
+}
+
+static uint16_t fake_time = 0;
+
+extern "C" uint16_t timer_read(void) {
+    return fake_time;
+}
+
+#define NUM_DEADLINES (DEADLINE_MAX + 4)
+
+static deadline_t deadlines[NUM_DEADLINES];
+static std::vector<int> fired;
+
+static void record(deadline_t* deadline) {
+    fired.push_back(deadline - deadlines);
+}
+
+static void rearm(deadline_t* deadline) {
+    record(deadline);
+    deadline_set(deadline, deadline->time + 10, record);
+}
+
+class Deadline : public testing::Test {
+public:
+    Deadline() {
+        fake_time = 0;
+        fired.clear();
+        memset(deadlines, 0, sizeof(deadlines));
+    }
+    ~Deadline() {
+        for (int i = 0; i < NUM_DEADLINES; i++) {
+            deadline_cancel(&deadlines[i]);
+        }
+    }
+    void run_until(uint16_t time) {
+        while (fake_time != time) {
+            fake_time++;
+            deadline_task();
+        }
+    }
+};
+
+TEST_F(Deadline, FiresInTheOrderOfTheTimes) {
+    deadline_set(&deadlines[0], 30, record);
+    deadline_set(&deadlines[1], 10, record);
+    deadline_set(&deadlines[2], 20, record);
+    run_until(9);
+    EXPECT_TRUE(fired.empty());
+    run_until(10);
+    EXPECT_EQ(fired, std::vector<int>({1}));
+    run_until(100);
+    EXPECT_EQ(fired, std::vector<int>({1, 2, 0}));
+}
+
+TEST_F(Deadline, FiresOnlyOnce) {
+    deadline_set(&deadlines[0], 10, record);
+    run_until(10);
+    EXPECT_FALSE(deadline_is_set(&deadlines[0]));
+    run_until(100);
+    EXPECT_EQ(fired, std::vector<int>({0}));
+}
+
+TEST_F(Deadline, ACancelledDeadlineDoesNotFire) {
+    deadline_set(&deadlines[0], 10, record);
+    deadline_set(&deadlines[1], 20, record);
+    deadline_set(&deadlines[2], 30, record);
+    deadline_cancel(&deadlines[0]);
+    EXPECT_FALSE(deadline_is_set(&deadlines[0]));
+    // Cancelling it again does nothing
+    deadline_cancel(&deadlines[0]);
+    run_until(100);
+    EXPECT_EQ(fired, std::vector<int>({1, 2}));
+}
+
+TEST_F(Deadline, SettingItAgainMovesIt) {
+    deadline_set(&deadlines[0], 10, record);
+    deadline_set(&deadlines[1], 20, record);
+    deadline_set(&deadlines[0], 30, record);
+    run_until(100);
+    EXPECT_EQ(fired, std::vector<int>({1, 0}));
+}
+
+TEST_F(Deadline, TheCallbackCanSetItAgain) {
+    deadline_set(&deadlines[0], 10, rearm);
+    run_until(15);
+    EXPECT_EQ(fired, std::vector<int>({0}));
+    EXPECT_TRUE(deadline_is_set(&deadlines[0]));
+    run_until(20);
+    EXPECT_EQ(fired, std::vector<int>({0, 0}));
+    EXPECT_FALSE(deadline_is_set(&deadlines[0]));
+}
+
+TEST_F(Deadline, WorksWhenTheTimerWraps) {
+    fake_time = 65500;
+    deadline_set(&deadlines[0], 20, record);
+    deadline_set(&deadlines[1], 65530, record);
+    deadline_set(&deadlines[2], 5, record);
+    run_until(65535);
+    EXPECT_EQ(fired, std::vector<int>({1}));
+    run_until(4);
+    EXPECT_EQ(fired, std::vector<int>({1}));
+    run_until(100);
+    EXPECT_EQ(fired, std::vector<int>({1, 2, 0}));
+}
+
+TEST_F(Deadline, AnExpiredDeadlineFiresOnTheNextTask) {
+    fake_time = 50;
+    deadline_set(&deadlines[0], 40, record);
+    deadline_task();
+    EXPECT_EQ(fired, std::vector<int>({0}));
+}
+
+TEST_F(Deadline, StillFiresWhenTheHeapIsFull) {
+    for (int i = 0; i < DEADLINE_MAX; i++) {
+        EXPECT_TRUE(deadline_set(&deadlines[i], 100 + i, record));
+    }
+    EXPECT_FALSE(deadline_set(&deadlines[DEADLINE_MAX], 10, record));
+    EXPECT_FALSE(deadline_set(&deadlines[DEADLINE_MAX + 1], 20, record));
+    EXPECT_TRUE(deadline_is_set(&deadlines[DEADLINE_MAX]));
+    run_until(10);
+    EXPECT_EQ(fired, std::vector<int>({DEADLINE_MAX}));
+    run_until(20);
+    EXPECT_EQ(fired, std::vector<int>({DEADLINE_MAX, DEADLINE_MAX + 1}));
+    run_until(200);
+    EXPECT_EQ(fired.size(), DEADLINE_MAX + 2);
+}
+
+TEST_F(Deadline, TheOnesThatDidNotFitMoveIntoTheHeap) {
+    for (int i = 0; i < DEADLINE_MAX; i++) {
+        deadline_set(&deadlines[i], 10, record);
+    }
+    deadline_set(&deadlines[DEADLINE_MAX], 30, record);
+    deadline_set(&deadlines[DEADLINE_MAX + 1], 20, record);
+    run_until(10);
+    EXPECT_EQ(fired.size(), DEADLINE_MAX);
+    // There's room again, so these are ordered by the heap
+    fired.clear();
+    deadline_task();
+    EXPECT_TRUE(deadline_set(&deadlines[0], 25, record));
+    run_until(100);
+    EXPECT_EQ(fired, std::vector<int>({DEADLINE_MAX + 1, 0, DEADLINE_MAX}));
+}
+
+TEST_F(Deadline, ADeadlineThatDidNotFitCanBeCancelled) {
+    for (int i = 0; i < DEADLINE_MAX; i++) {
+        deadline_set(&deadlines[i], 100, record);
+    }
+    deadline_set(&deadlines[DEADLINE_MAX], 10, record);
+    deadline_set(&deadlines[DEADLINE_MAX + 1], 20, record);
+    deadline_set(&deadlines[DEADLINE_MAX + 2], 30, record);
+    deadline_cancel(&deadlines[DEADLINE_MAX + 1]);
+    EXPECT_FALSE(deadline_is_set(&deadlines[DEADLINE_MAX + 1]));
+    run_until(50);
+    EXPECT_EQ(fired, std::vector<int>({DEADLINE_MAX, DEADLINE_MAX + 2}));
+}
@@ -0,0 +1,133 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "gtest/gtest.h"
+
+extern "C" {
+    #include "rgb_matrix_power.h"
+}
+
+// The tests are built with a budget of 500mA, and 2mA per channel
+#define FULL_CHANNELS(n) ((n) * 255UL)
+
+class RGBMatrixPower : public testing::Test {
+public:
+    RGBMatrixPower() {
+        rgb_matrix_power_init(0);
+    }
+};
+
+TEST_F(RGBMatrixPower, TicksFollowTheTimer) {
+    EXPECT_EQ(rgb_matrix_power_tick(49), 0);
+    EXPECT_EQ(rgb_matrix_power_tick(50), 1);
+    EXPECT_EQ(rgb_matrix_power_tick(120), 1);
+    // The 20ms that were left over count towards the next tick
+    EXPECT_EQ(rgb_matrix_power_tick(150), 1);
+    EXPECT_EQ(rgb_matrix_power_tick(400), 5);
+}
+
+TEST_F(RGBMatrixPower, TicksGoOnWhenTheTimerWraps) {
+    rgb_matrix_power_init(65500);
+    EXPECT_EQ(rgb_matrix_power_tick(14), 1);
+    EXPECT_EQ(rgb_matrix_power_tick(64), 1);
+}
+
+TEST_F(RGBMatrixPower, AFrameIsDueEveryTickWhenDrawingIsFast) {
+    EXPECT_FALSE(rgb_matrix_power_frame_due());
+    rgb_matrix_power_tick(50);
+    EXPECT_TRUE(rgb_matrix_power_frame_due());
+    rgb_matrix_power_frame_done(50, 0);
+    EXPECT_FALSE(rgb_matrix_power_frame_due());
+    rgb_matrix_power_tick(100);
+    EXPECT_TRUE(rgb_matrix_power_frame_due());
+    EXPECT_EQ(rgb_matrix_power_stats()->frame_ticks, 1);
+}
+
+TEST_F(RGBMatrixPower, SlowFramesAreDrawnLessOften) {
+    uint16_t now = 0;
+    for (int i = 0; i < 100; i++) {
+        rgb_matrix_power_frame_done(now, 40);
+        now += 10;
+    }
+    // 40ms is 25% of 160ms, which is four ticks
+    EXPECT_EQ(rgb_matrix_power_stats()->frame_ticks, 4);
+    EXPECT_NEAR(rgb_matrix_power_stats()->frame_time, 40 * 16, 8);
+
+    rgb_matrix_power_tick(150);
+    EXPECT_FALSE(rgb_matrix_power_frame_due());
+    rgb_matrix_power_tick(200);
+    EXPECT_TRUE(rgb_matrix_power_frame_due());
+}
+
+TEST_F(RGBMatrixPower, TheFrameRateComesBackWhenDrawingGetsFaster) {
+    for (int i = 0; i < 100; i++) {
+        rgb_matrix_power_frame_done(0, 40);
+    }
+    for (int i = 0; i < 100; i++) {
+        rgb_matrix_power_frame_done(0, 0);
+    }
+    EXPECT_EQ(rgb_matrix_power_stats()->frame_ticks, 1);
+}
+
+TEST_F(RGBMatrixPower, TheFrameRateHasALimit) {
+    for (int i = 0; i < 100; i++) {
+        rgb_matrix_power_frame_done(0, 1000);
+    }
+    EXPECT_EQ(rgb_matrix_power_stats()->frame_ticks, RGB_MATRIX_MAX_FRAME_TICKS);
+}
+
+TEST_F(RGBMatrixPower, CountsTheFramesInASecond) {
+    for (uint16_t now = 50; now <= 1000; now += 50) {
+        rgb_matrix_power_frame_done(now, 0);
+    }
+    EXPECT_EQ(rgb_matrix_power_stats()->fps, 20);
+    for (uint16_t now = 1100; now <= 2000; now += 100) {
+        rgb_matrix_power_frame_done(now, 0);
+    }
+    EXPECT_EQ(rgb_matrix_power_stats()->fps, 10);
+}
+
+TEST_F(RGBMatrixPower, EstimatesTheCurrent) {
+    EXPECT_EQ(rgb_matrix_power_current(0), 0);
+    EXPECT_EQ(rgb_matrix_power_current(FULL_CHANNELS(100)), 200);
+    EXPECT_EQ(rgb_matrix_power_current(FULL_CHANNELS(288)), 576);
+}
+
+TEST_F(RGBMatrixPower, FramesWithinTheBudgetAreNotDimmed) {
+    EXPECT_EQ(rgb_matrix_power_limit(FULL_CHANNELS(100)), 255);
+    EXPECT_EQ(rgb_matrix_power_limit(FULL_CHANNELS(250)), 255);
+    EXPECT_EQ(rgb_matrix_power_stats()->current, 500);
+    EXPECT_EQ(rgb_matrix_power_stats()->limited, 0);
+}
+
+TEST_F(RGBMatrixPower, FramesOverTheBudgetAreDimmedToFit) {
+    uint8_t scale = rgb_matrix_power_limit(FULL_CHANNELS(500));
+    EXPECT_EQ(scale, 127);
+    // What the drivers do with the scale
+    uint32_t total = 500 * ((255 * (scale + 1)) >> 8);
+    EXPECT_LE(rgb_matrix_power_current(total), 500);
+    EXPECT_LE(rgb_matrix_power_stats()->current, 500);
+    EXPECT_EQ(rgb_matrix_power_stats()->current_max, 1000);
+    EXPECT_EQ(rgb_matrix_power_stats()->limited, 1);
+}
+
+TEST_F(RGBMatrixPower, AFrameJustOverTheBudgetStaysWithinIt) {
+    uint8_t scale = rgb_matrix_power_limit(FULL_CHANNELS(251));
+    EXPECT_LT(scale, 255);
+    uint32_t total = 251 * ((255 * (scale + 1)) >> 8);
+    EXPECT_LE(total, FULL_CHANNELS(250));
+}
@@ -0,0 +1,208 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "gtest/gtest.h"
+
+extern "C" {
+    #include "rgb_matrix_program.h"
+}
+
+class RGBMatrixProgram : public testing::Test {
+public:
+    RGBMatrixProgram() {
+        frame.time = 0;
+        frame.color.h = 10;
+        frame.color.s = 20;
+        frame.color.v = 30;
+        frame.last_age = 255;
+        frame.last_x = 0;
+        frame.last_y = 0;
+        led.x = 0;
+        led.y = 0;
+        led.age = 255;
+    }
+    HSV run(const uint8_t* program) {
+        return rgb_matrix_program_run(program, &frame, &led);
+    }
+    rgb_program_frame_t frame;
+    rgb_program_led_t led;
+};
+
+TEST_F(RGBMatrixProgram, AnEmptyProgramLeavesTheConfiguredColor) {
+    const uint8_t program[] = { RGBP_END };
+    HSV hsv = run(program);
+    EXPECT_EQ(hsv.h, 10);
+    EXPECT_EQ(hsv.s, 20);
+    EXPECT_EQ(hsv.v, 30);
+}
+
+TEST_F(RGBMatrixProgram, LoadsAndStoresTheRegisters) {
+    led.x = 100;
+    led.y = 50;
+    const uint8_t program[] = {
+        RGBP_LOAD | RGBP_X, RGBP_STORE | RGBP_H,
+        RGBP_LOAD | RGBP_Y, RGBP_STORE | RGBP_S,
+        RGBP_LOAD | RGBP_CONST, 200, RGBP_STORE | RGBP_V,
+        RGBP_END,
+    };
+    HSV hsv = run(program);
+    EXPECT_EQ(hsv.h, 100);
+    EXPECT_EQ(hsv.s, 50);
+    EXPECT_EQ(hsv.v, 200);
+}
+
+TEST_F(RGBMatrixProgram, ReadsTheRegistersAfterTheyAreStored) {
+    const uint8_t program[] = {
+        RGBP_LOAD | RGBP_CONST, 7, RGBP_STORE | RGBP_H,
+        RGBP_LOAD | RGBP_H, RGBP_ADD | RGBP_HUE, RGBP_STORE | RGBP_V,
+        RGBP_END,
+    };
+    HSV hsv = run(program);
+    EXPECT_EQ(hsv.h, 7);
+    EXPECT_EQ(hsv.v, 17);
+}
+
+TEST_F(RGBMatrixProgram, AddWrapsAndAddsSaturates) {
+    const uint8_t program[] = {
+        RGBP_LOAD | RGBP_CONST, 200, RGBP_ADD | RGBP_CONST, 100, RGBP_STORE | RGBP_H,
+        RGBP_LOAD | RGBP_CONST, 200, RGBP_ADDS | RGBP_CONST, 100, RGBP_STORE | RGBP_S,
+        RGBP_LOAD | RGBP_CONST, 50, RGBP_SUBS | RGBP_CONST, 100, RGBP_STORE | RGBP_V,
+        RGBP_END,
+    };
+    HSV hsv = run(program);
+    EXPECT_EQ(hsv.h, 44);
+    EXPECT_EQ(hsv.s, 255);
+    EXPECT_EQ(hsv.v, 0);
+}
+
+TEST_F(RGBMatrixProgram, DiffMinAndMax) {
+    const uint8_t program[] = {
+        RGBP_LOAD | RGBP_CONST, 50, RGBP_DIFF | RGBP_CONST, 80, RGBP_STORE | RGBP_H,
+        RGBP_LOAD | RGBP_CONST, 50, RGBP_MIN | RGBP_CONST, 80, RGBP_STORE | RGBP_S,
+        RGBP_LOAD | RGBP_CONST, 50, RGBP_MAX | RGBP_CONST, 80, RGBP_STORE | RGBP_V,
+        RGBP_END,
+    };
+    HSV hsv = run(program);
+    EXPECT_EQ(hsv.h, 30);
+    EXPECT_EQ(hsv.s, 50);
+    EXPECT_EQ(hsv.v, 80);
+}
+
+TEST_F(RGBMatrixProgram, ScaleKeepsTheFullRange) {
+    const uint8_t program[] = {
+        RGBP_LOAD | RGBP_CONST, 255, RGBP_SCALE | RGBP_CONST, 255, RGBP_STORE | RGBP_H,
+        RGBP_LOAD | RGBP_CONST, 200, RGBP_SCALE | RGBP_CONST, 0, RGBP_STORE | RGBP_S,
+        RGBP_LOAD | RGBP_CONST, 200, RGBP_SCALE | RGBP_CONST, 127, RGBP_STORE | RGBP_V,
+        RGBP_END,
+    };
+    HSV hsv = run(program);
+    EXPECT_EQ(hsv.h, 255);
+    EXPECT_EQ(hsv.s, 0);
+    EXPECT_EQ(hsv.v, 100);
+}
+
+TEST_F(RGBMatrixProgram, MulSaturates) {
+    const uint8_t program[] = {
+        RGBP_LOAD | RGBP_CONST, 20, RGBP_MUL | RGBP_CONST, 3, RGBP_STORE | RGBP_H,
+        RGBP_LOAD | RGBP_CONST, 20, RGBP_MUL | RGBP_CONST, 13, RGBP_STORE | RGBP_S,
+        RGBP_END,
+    };
+    HSV hsv = run(program);
+    EXPECT_EQ(hsv.h, 60);
+    EXPECT_EQ(hsv.s, 255);
+}
+
+TEST_F(RGBMatrixProgram, WaveGoesUpAndBackDown) {
+    const uint8_t program[] = { RGBP_LOAD | RGBP_TIME, RGBP_WAVE, RGBP_STORE | RGBP_V, RGBP_END };
+    frame.time = 0;
+    EXPECT_EQ(run(program).v, 0);
+    frame.time = 64;
+    EXPECT_EQ(run(program).v, 128);
+    frame.time = 127;
+    EXPECT_EQ(run(program).v, 254);
+    frame.time = 128;
+    EXPECT_EQ(run(program).v, 254);
+    frame.time = 255;
+    EXPECT_EQ(run(program).v, 0);
+}
+
+TEST_F(RGBMatrixProgram, InvDoesNotTakeAConstant) {
+    // The byte after RGBP_INV is the next instruction, not a value
+    const uint8_t program[] = {
+        RGBP_LOAD | RGBP_CONST, 55, RGBP_INV, RGBP_STORE | RGBP_V, RGBP_END,
+    };
+    EXPECT_EQ(run(program).v, 200);
+}
+
+TEST_F(RGBMatrixProgram, DistanceIsCloseToEuclidean) {
+    const uint8_t program[] = { RGBP_LOAD | RGBP_DIST, RGBP_STORE | RGBP_V, RGBP_END };
+    frame.last_x = 100;
+    frame.last_y = 32;
+    led.x = 100;
+    led.y = 32;
+    EXPECT_EQ(run(program).v, 0);
+    led.x = 60;
+    EXPECT_EQ(run(program).v, 40);
+    led.y = 2;
+    // 50 on a circle
+    EXPECT_EQ(run(program).v, 55);
+    frame.last_x = 0;
+    led.x = 224;
+    EXPECT_EQ(run(program).v, 239);
+    frame.last_y = 0;
+    led.y = 64;
+    led.x = 224;
+    frame.last_x = 0;
+    EXPECT_EQ(run(program).v, 255);
+}
+
+TEST_F(RGBMatrixProgram, ReadsTheAges) {
+    led.age = 3;
+    frame.last_age = 9;
+    const uint8_t program[] = {
+        RGBP_LOAD | RGBP_AGE, RGBP_STORE | RGBP_H,
+        RGBP_LOAD | RGBP_LAST_AGE, RGBP_STORE | RGBP_S,
+        RGBP_END,
+    };
+    HSV hsv = run(program);
+    EXPECT_EQ(hsv.h, 3);
+    EXPECT_EQ(hsv.s, 9);
+}
+
+TEST_F(RGBMatrixProgram, StopsAtTheEnd) {
+    const uint8_t program[] = {
+        RGBP_LOAD | RGBP_CONST, 0, RGBP_STORE | RGBP_V, RGBP_END,
+        RGBP_LOAD | RGBP_CONST, 99, RGBP_STORE | RGBP_H, RGBP_END,
+    };
+    HSV hsv = run(program);
+    EXPECT_EQ(hsv.h, 10);
+    EXPECT_EQ(hsv.v, 0);
+}
+
+TEST_F(RGBMatrixProgram, DecayFadesOutTheKeysThatWereHit) {
+    // decay 4, as util/rgb_matrix_compile.py writes it
+    const uint8_t program[] = {
+        0x17, 0x70, 0x04, 0xB0, 0x6C, 0xAC, 0x00,
+    };
+    frame.color.v = 255;
+    led.age = 0;
+    EXPECT_EQ(run(program).v, 255);
+    led.age = 32;
+    EXPECT_EQ(run(program).v, 127);
+    led.age = 64;
+    EXPECT_EQ(run(program).v, 0);
+}
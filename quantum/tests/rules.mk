@@ -0,0 +1,35 @@
+# Copyright 2026 agent <agent@local>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+rgb_matrix_program_SRC := \
+	$(QUANTUM_PATH)/tests/rgb_matrix_program_tests.cpp \
+	$(QUANTUM_PATH)/rgb_matrix_program.c
+
+rgb_matrix_program_INC := $(QUANTUM_PATH)
+rgb_matrix_program_INC += $(TMK_PATH)/common
+
+rgb_matrix_power_SRC := \
+	$(QUANTUM_PATH)/tests/rgb_matrix_power_tests.cpp \
+	$(QUANTUM_PATH)/rgb_matrix_power.c
+
+rgb_matrix_power_INC := $(QUANTUM_PATH)
+rgb_matrix_power_DEFS := -DRGB_MATRIX_CURRENT_BUDGET=500 -DRGB_MATRIX_CHANNEL_CURRENT=2000
+
+deadline_SRC := \
+	$(QUANTUM_PATH)/tests/deadline_tests.cpp \
+	$(QUANTUM_PATH)/deadline.c
+
+deadline_INC := $(QUANTUM_PATH)
+deadline_INC += $(TMK_PATH)/common
@@ -0,0 +1,4 @@
+TEST_LIST +=\
+	rgb_matrix_program\
+	rgb_matrix_power\
+	deadline
@@ -46,6 +46,7 @@ bool lcd_backlight_keyframe_animate_color(keyframe_animation_t* animation, visua
             LCD_SAT(state->current_lcd_color),
             LCD_INT(state->current_lcd_color));
 
+    visualizer_mark_drawn(NULL);
     return true;
 }
 
@@ -57,6 +58,7 @@ bool lcd_backlight_keyframe_set_color(keyframe_animation_t* animation, visualize
             LCD_HUE(state->current_lcd_color),
             LCD_SAT(state->current_lcd_color),
             LCD_INT(state->current_lcd_color));
+    visualizer_mark_drawn(NULL);
     return false;
 }
 
@@ -64,6 +66,7 @@ bool lcd_backlight_keyframe_disable(keyframe_animation_t* animation, visualizer_
     (void)animation;
     (void)state;
     lcd_backlight_hal_color(0, 0, 0);
+    visualizer_mark_drawn(NULL);
     return false;
 }
 
@@ -73,5 +76,6 @@ bool lcd_backlight_keyframe_enable(keyframe_animation_t* animation, visualizer_s
     lcd_backlight_color(LCD_HUE(state->current_lcd_color),
         LCD_SAT(state->current_lcd_color),
         LCD_INT(state->current_lcd_color));
+    visualizer_mark_drawn(NULL);
     return false;
 }
@@ -58,12 +58,14 @@ static uint8_t compute_gradient_color(float t, float index, float num) {
 bool led_backlight_keyframe_fade_in_all(keyframe_animation_t* animation, visualizer_state_t* state) {
     (void)state;
     keyframe_fade_all_leds_from_to(animation, 0, 255);
+    visualizer_mark_drawn(LED_DISPLAY);
     return true;
 }
 
 bool led_backlight_keyframe_fade_out_all(keyframe_animation_t* animation, visualizer_state_t* state) {
     (void)state;
     keyframe_fade_all_leds_from_to(animation, 255, 0);
+    visualizer_mark_drawn(LED_DISPLAY);
     return true;
 }
 
@@ -76,6 +78,7 @@ bool led_backlight_keyframe_left_to_right_gradient(keyframe_animation_t* animati
         uint8_t color = compute_gradient_color(t, i, NUM_COLS);
         gdispGDrawLine(LED_DISPLAY, i, 0, i, NUM_ROWS - 1, LUMA2COLOR(color));
     }
+    visualizer_mark_drawn(LED_DISPLAY);
     return true;
 }
 
@@ -88,6 +91,7 @@ bool led_backlight_keyframe_top_to_bottom_gradient(keyframe_animation_t* animati
         uint8_t color = compute_gradient_color(t, i, NUM_ROWS);
         gdispGDrawLine(LED_DISPLAY, 0, i, NUM_COLS - 1, i, LUMA2COLOR(color));
     }
+    visualizer_mark_drawn(LED_DISPLAY);
     return true;
 }
 
@@ -111,6 +115,7 @@ bool led_backlight_keyframe_crossfade(keyframe_animation_t* animation, visualize
             gdispGDrawPixel(LED_DISPLAY, j, i, color);
         }
     }
+    visualizer_mark_drawn(LED_DISPLAY);
     return true;
 }
 
@@ -118,6 +123,7 @@ bool led_backlight_keyframe_mirror_orientation(keyframe_animation_t* animation,
     (void)state;
     (void)animation;
     gdispGSetOrientation(LED_DISPLAY, GDISP_ROTATE_180);
+    visualizer_mark_drawn(NULL);
     return false;
 }
 
@@ -125,6 +131,7 @@ bool led_backlight_keyframe_normal_orientation(keyframe_animation_t* animation,
     (void)state;
     (void)animation;
     gdispGSetOrientation(LED_DISPLAY, GDISP_ROTATE_0);
+    visualizer_mark_drawn(NULL);
     return false;
 }
 
@@ -132,6 +139,7 @@ bool led_backlight_keyframe_disable(keyframe_animation_t* animation, visualizer_
     (void)state;
     (void)animation;
     gdispGSetPowerMode(LED_DISPLAY, powerOff);
+    visualizer_mark_drawn(NULL);
     return false;
 }
 
@@ -139,5 +147,6 @@ bool led_backlight_keyframe_enable(keyframe_animation_t* animation, visualizer_s
     (void)state;
     (void)animation;
     gdispGSetPowerMode(LED_DISPLAY, powerOn);
+    visualizer_mark_drawn(NULL);
     return false;
 }
@@ -94,6 +94,39 @@ static uint8_t user_data[VISUALIZER_USER_DATA_SIZE];
 #define MAX_SIMULTANEOUS_ANIMATIONS 4
 static keyframe_animation_t* animations[MAX_SIMULTANEOUS_ANIMATIONS] = {};
 
+#define LCD_DISPLAY_BIT (1 << 0)
+#define LED_DISPLAY_BIT (1 << 1)
+#define ALL_DISPLAY_BITS (LCD_DISPLAY_BIT | LED_DISPLAY_BIT)
+
+typedef struct {
+    systemticks_t frame_time;
+    systemticks_t last_flush;
+    uint32_t frames;
+    uint32_t dropped_frames;
+} display_schedule_t;
+
+#ifdef LCD_ENABLE
+static display_schedule_t lcd_schedule;
+#endif
+#ifdef BACKLIGHT_ENABLE
+static display_schedule_t led_schedule;
+#endif
+
+// Displays drawn to during the current update, and displays waiting for a flush
+static uint8_t displays_drawn = 0;
+static uint8_t displays_pending = 0;
+static bool drawn_reported = false;
+
+// Set by update_status, and cleared by the visualizer thread when it reads the status,
+// both with the system lock held
+static volatile bool status_update_pending = false;
+
+static uint32_t num_updates = 0;
+static systemticks_t min_update_time = 0;
+static systemticks_t max_update_time = 0;
+static systemticks_t total_update_time = 0;
+static uint32_t coalesced_updates = 0;
+
 #ifdef SERIAL_LINK_ENABLE
 MASTER_TO_ALL_SLAVES_OBJECT(current_status, visualizer_keyboard_status_t);
 
@@ -165,6 +198,29 @@ void stop_all_keyframe_animations(void) {
     }
 }
 
+void visualizer_mark_drawn(GDisplay* display) {
+    drawn_reported = true;
+    if (display == NULL) {
+        return;
+    }
+    if (display == LCD_DISPLAY) {
+        displays_drawn |= LCD_DISPLAY_BIT;
+    }
+    if (display == LED_DISPLAY) {
+        displays_drawn |= LED_DISPLAY_BIT;
+    }
+}
+
+static bool run_keyframe(keyframe_animation_t* animation, visualizer_state_t* state) {
+    drawn_reported = false;
+    bool ret = (*animation->frame_functions[animation->current_frame])(animation, state);
+    if (!drawn_reported) {
+        // Assume the worst for keyframes that don't report what they draw
+        displays_drawn |= ALL_DISPLAY_BITS;
+    }
+    return ret;
+}
+
 static uint8_t get_num_running_animations(void) {
     uint8_t count = 0;
     for (int i=0;i<MAX_SIMULTANEOUS_ANIMATIONS;i++) {
@@ -193,7 +249,7 @@ static bool update_keyframe_animation(keyframe_animation_t* animation, visualize
             if (animation->need_update) {
                 animation->time_left_in_frame = 0;
                 animation->last_update_of_frame = true;
-                (*animation->frame_functions[animation->current_frame])(animation, state);
+                run_keyframe(animation, state);
                 animation->last_update_of_frame = false;
             }
             animation->current_frame++;
@@ -214,7 +270,7 @@ static bool update_keyframe_animation(keyframe_animation_t* animation, visualize
         }
     }
     if (animation->need_update) {
-        animation->need_update = (*animation->frame_functions[animation->current_frame])(animation, state);
+        animation->need_update = run_keyframe(animation, state);
         animation->first_update_of_frame = false;
     }
 
@@ -241,6 +297,98 @@ void run_next_keyframe(keyframe_animation_t* animation, visualizer_state_t* stat
     (*temp_animation.frame_functions[next_frame])(&temp_animation, &temp_state);
 }
 
+static systemticks_t fps_to_frame_time(uint32_t fps) {
+    return fps ? gfxMillisecondsToTicks(1000 / fps) : 0;
+}
+
+static uint32_t ticks_to_us(systemticks_t ticks) {
+#ifdef PROTOCOL_CHIBIOS
+    return ST2US(ticks);
+#else
+    // On windows the system ticks is the same as milliseconds
+    return ticks * 1000;
+#endif
+}
+
+// Flushes the display if it has been drawn to, but not more often than the frame rate cap allows
+// If the flush has to be postponed, the sleep time is reduced so that it happens in time
+static void schedule_flush(GDisplay* display, display_schedule_t* schedule, uint8_t bit,
+        systemticks_t now, systemticks_t* sleep_time) {
+    if (displays_drawn & bit) {
+        if (displays_pending & bit) {
+            // The previous frame was overwritten before it was shown
+            schedule->dropped_frames++;
+        }
+        displays_pending |= bit;
+    }
+    if (!(displays_pending & bit)) {
+        return;
+    }
+    systemticks_t since_flush = now - schedule->last_flush;
+    if (since_flush >= schedule->frame_time) {
+        gdispGFlush(display);
+        schedule->last_flush = now;
+        schedule->frames++;
+        displays_pending &= ~bit;
+    }
+    else {
+        systemticks_t wait = schedule->frame_time - since_flush;
+        if (*sleep_time == TIME_INFINITE || wait < *sleep_time) {
+            *sleep_time = wait;
+        }
+    }
+}
+
+static void record_update_time(systemticks_t update_time) {
+    gfxSystemLock();
+    if (num_updates == 0 || update_time < min_update_time) {
+        min_update_time = update_time;
+    }
+    if (update_time > max_update_time) {
+        max_update_time = update_time;
+    }
+    total_update_time += update_time;
+    num_updates++;
+    gfxSystemUnlock();
+}
+
+void visualizer_get_stats(visualizer_stats_t* stats) {
+    memset(stats, 0, sizeof(visualizer_stats_t));
+    gfxSystemLock();
+    stats->num_updates = num_updates;
+    stats->min_update_time = ticks_to_us(min_update_time);
+    stats->max_update_time = ticks_to_us(max_update_time);
+    stats->avg_update_time = num_updates ? ticks_to_us(total_update_time / num_updates) : 0;
+    stats->coalesced_updates = coalesced_updates;
+#ifdef LCD_ENABLE
+    stats->lcd_frames = lcd_schedule.frames;
+    stats->lcd_dropped_frames = lcd_schedule.dropped_frames;
+#endif
+#ifdef BACKLIGHT_ENABLE
+    stats->led_frames = led_schedule.frames;
+    stats->led_dropped_frames = led_schedule.dropped_frames;
+#endif
+    gfxSystemUnlock();
+}
+
+void visualizer_reset_stats(void) {
+    gfxSystemLock();
+    num_updates = 0;
+    min_update_time = 0;
+    max_update_time = 0;
+    total_update_time = 0;
+    coalesced_updates = 0;
+#ifdef LCD_ENABLE
+    lcd_schedule.frames = 0;
+    lcd_schedule.dropped_frames = 0;
+#endif
+#ifdef BACKLIGHT_ENABLE
+    led_schedule.frames = 0;
+    led_schedule.dropped_frames = 0;
+#endif
+    gfxSystemUnlock();
+}
+
 // TODO: Optimize the stack size, this is probably way too big
 static DECLARE_THREAD_STACK(visualizerThreadStack, 1024);
 static DECLARE_THREAD_FUNCTION(visualizerThread, arg) {
@@ -286,11 +434,27 @@ static DECLARE_THREAD_FUNCTION(visualizerThread, arg) {
     systemticks_t current_time = gfxSystemTicks();
     bool force_update = true;
 
+#ifdef LCD_ENABLE
+    lcd_schedule.frame_time = fps_to_frame_time(VISUALIZER_LCD_MAX_FPS);
+    lcd_schedule.last_flush = current_time - lcd_schedule.frame_time;
+#endif
+#ifdef BACKLIGHT_ENABLE
+    led_schedule.frame_time = fps_to_frame_time(VISUALIZER_LED_MAX_FPS);
+    led_schedule.last_flush = current_time - led_schedule.frame_time;
+#endif
+    // Whatever the initialization drew has to be shown
+    displays_pending = ALL_DISPLAY_BITS;
+
     while(true) {
         systemticks_t new_time = gfxSystemTicks();
         systemticks_t delta = new_time - current_time;
         current_time = new_time;
         bool enabled = visualizer_enabled;
+        displays_drawn = 0;
+        // Any status change after this point will wake us up again
+        gfxSystemLock();
+        status_update_pending = false;
+        gfxSystemUnlock();
         if (force_update || !same_status(&state.status, &current_status)) {
             force_update = false;
     #if BACKLIGHT_ENABLE
@@ -299,6 +463,7 @@ static DECLARE_THREAD_FUNCTION(visualizerThread, arg) {
                     gdispGSetPowerMode(LED_DISPLAY, powerOn);
                     uint16_t percent = (uint16_t)current_status.backlight_level * 100 / BACKLIGHT_LEVELS;
                     gdispGSetBacklight(LED_DISPLAY, percent);
+                    displays_drawn |= LED_DISPLAY_BIT;
                 }
                 else {
                     gdispGSetPowerMode(LED_DISPLAY, powerOff);
@@ -319,6 +484,8 @@ static DECLARE_THREAD_FUNCTION(visualizerThread, arg) {
                     update_user_visualizer_state(&state, &prev_status);
                 }
                 state.prev_lcd_color = state.current_lcd_color;
+                // The user code is free to draw directly
+                displays_drawn |= ALL_DISPLAY_BITS;
             }
         }
         if (!enabled && state.status.suspended && current_status.suspended == false) {
@@ -329,6 +496,7 @@ static DECLARE_THREAD_FUNCTION(visualizerThread, arg) {
             stop_all_keyframe_animations();
             user_visualizer_resume(&state);
             state.prev_lcd_color = state.current_lcd_color;
+            displays_drawn |= ALL_DISPLAY_BITS;
         }
         sleep_time = TIME_INFINITE;
         for (int i=0;i<MAX_SIMULTANEOUS_ANIMATIONS;i++) {
@@ -336,12 +504,13 @@ static DECLARE_THREAD_FUNCTION(visualizerThread, arg) {
                 update_keyframe_animation(animations[i], &state, delta, &sleep_time);
             }
         }
+        systemticks_t before_flush = gfxSystemTicks();
 #ifdef BACKLIGHT_ENABLE
-        gdispGFlush(LED_DISPLAY);
+        schedule_flush(LED_DISPLAY, &led_schedule, LED_DISPLAY_BIT, before_flush, &sleep_time);
 #endif
 
 #ifdef LCD_ENABLE
-        gdispGFlush(LCD_DISPLAY);
+        schedule_flush(LCD_DISPLAY, &lcd_schedule, LCD_DISPLAY_BIT, before_flush, &sleep_time);
 #endif
 
 #ifdef EMULATOR
@@ -356,6 +525,7 @@ static DECLARE_THREAD_FUNCTION(visualizerThread, arg) {
 
         systemticks_t after_update = gfxSystemTicks();
         unsigned update_delta = after_update - current_time;
+        record_update_time(update_delta);
         if (sleep_time != TIME_INFINITE) {
             if (sleep_time > update_delta) {
                 sleep_time -= update_delta;
@@ -412,9 +582,29 @@ void visualizer_init(void) {
 
 void update_status(bool changed) {
     if (changed) {
-        GSourceListener* listener = geventGetSourceListener((GSourceHandle)&current_status, NULL);
-        if (listener) {
-            geventSendEvent(listener);
+        // The flag is checked and set in one go, so that a change can't slip
+        // in between the visualizer thread clearing it and this setting it
+        gfxSystemLock();
+        bool send = !status_update_pending;
+        if (send) {
+            status_update_pending = true;
+        }
+        else {
+            // The visualizer thread hasn't read the previous change yet, so it
+            // will pick up this one at the same time
+            coalesced_updates++;
+        }
+        gfxSystemUnlock();
+        if (send) {
+            GSourceListener* listener = geventGetSourceListener((GSourceHandle)&current_status, NULL);
+            if (listener) {
+                geventSendEvent(listener);
+            }
+            else {
+                gfxSystemLock();
+                status_update_pending = false;
+                gfxSystemUnlock();
+            }
         }
     }
 #ifdef SERIAL_LINK_ENABLE
@@ -133,6 +133,37 @@ void stop_keyframe_animation(keyframe_animation_t* animation);
 // This runs the next keyframe, but does not update the animation state
 // Useful for crossfades for example
 void run_next_keyframe(keyframe_animation_t* animation, visualizer_state_t* state);
+// Keyframe functions should call this to tell the scheduler which display they drew to,
+// only those displays are then flushed. Pass NULL if the keyframe didn't draw anything.
+// If a keyframe doesn't call this at all, all displays are assumed to need a flush
+void visualizer_mark_drawn(GDisplay* display);
+
+// The maximum number of flushes per second for each display, define these in config.h
+// to override the defaults
+#ifndef VISUALIZER_LCD_MAX_FPS
+#define VISUALIZER_LCD_MAX_FPS 30
+#endif
+#ifndef VISUALIZER_LED_MAX_FPS
+#define VISUALIZER_LED_MAX_FPS 60
+#endif
+
+// Timing statistics for the visualizer thread, the times are in microseconds
+typedef struct {
+    uint32_t num_updates;
+    uint32_t min_update_time;
+    uint32_t avg_update_time;
+    uint32_t max_update_time;
+    // Status changes that were merged into an already pending update
+    uint32_t coalesced_updates;
+    uint32_t lcd_frames;
+    uint32_t lcd_dropped_frames;
+    uint32_t led_frames;
+    uint32_t led_dropped_frames;
+} visualizer_stats_t;
+
+// Can be called from any thread
+void visualizer_get_stats(visualizer_stats_t* stats);
+void visualizer_reset_stats(void);
 
 // The master can set userdata which will be transferred to the slave
 #ifdef VISUALIZER_USER_DATA_SIZE
@@ -19,5 +19,6 @@
 bool keyframe_no_operation(keyframe_animation_t* animation, visualizer_state_t* state) {
     (void)animation;
     (void)state;
+    visualizer_mark_drawn(NULL);
     return false;
 }
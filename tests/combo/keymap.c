@@ -0,0 +1,120 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+
+// Every pair of the 20 keys on the first two rows is a combo, and the third
+// row has combos of three keys next to each other, wrapping around
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {
+        // 0     1      2      3      4      5      6      7      8      9
+        {KC_A,   KC_B,  KC_C,  KC_D,  KC_E,  KC_F,  KC_G,  KC_H,  KC_I,  KC_J},
+        {KC_K,   KC_L,  KC_M,  KC_N,  KC_O,  KC_P,  KC_Q,  KC_R,  KC_S,  KC_T},
+        {KC_U,   KC_V,  KC_W,  KC_X,  KC_Y,  KC_Z,  KC_1,  KC_2,  KC_3,  KC_4},
+        {KC_SPC, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+    },
+};
+
+// The unused keys are zero, which is COMBO_END
+const uint16_t PROGMEM combo_keys[COMBO_COUNT][4] = {
+    {KC_A, KC_B}, {KC_A, KC_C}, {KC_A, KC_D}, {KC_A, KC_E}, {KC_A, KC_F}, {KC_A, KC_G},
+    {KC_A, KC_H}, {KC_A, KC_I}, {KC_A, KC_J}, {KC_A, KC_K}, {KC_A, KC_L}, {KC_A, KC_M},
+    {KC_A, KC_N}, {KC_A, KC_O}, {KC_A, KC_P}, {KC_A, KC_Q}, {KC_A, KC_R}, {KC_A, KC_S},
+    {KC_A, KC_T}, {KC_B, KC_C}, {KC_B, KC_D}, {KC_B, KC_E}, {KC_B, KC_F}, {KC_B, KC_G},
+    {KC_B, KC_H}, {KC_B, KC_I}, {KC_B, KC_J}, {KC_B, KC_K}, {KC_B, KC_L}, {KC_B, KC_M},
+    {KC_B, KC_N}, {KC_B, KC_O}, {KC_B, KC_P}, {KC_B, KC_Q}, {KC_B, KC_R}, {KC_B, KC_S},
+    {KC_B, KC_T}, {KC_C, KC_D}, {KC_C, KC_E}, {KC_C, KC_F}, {KC_C, KC_G}, {KC_C, KC_H},
+    {KC_C, KC_I}, {KC_C, KC_J}, {KC_C, KC_K}, {KC_C, KC_L}, {KC_C, KC_M}, {KC_C, KC_N},
+    {KC_C, KC_O}, {KC_C, KC_P}, {KC_C, KC_Q}, {KC_C, KC_R}, {KC_C, KC_S}, {KC_C, KC_T},
+    {KC_D, KC_E}, {KC_D, KC_F}, {KC_D, KC_G}, {KC_D, KC_H}, {KC_D, KC_I}, {KC_D, KC_J},
+    {KC_D, KC_K}, {KC_D, KC_L}, {KC_D, KC_M}, {KC_D, KC_N}, {KC_D, KC_O}, {KC_D, KC_P},
+    {KC_D, KC_Q}, {KC_D, KC_R}, {KC_D, KC_S}, {KC_D, KC_T}, {KC_E, KC_F}, {KC_E, KC_G},
+    {KC_E, KC_H}, {KC_E, KC_I}, {KC_E, KC_J}, {KC_E, KC_K}, {KC_E, KC_L}, {KC_E, KC_M},
+    {KC_E, KC_N}, {KC_E, KC_O}, {KC_E, KC_P}, {KC_E, KC_Q}, {KC_E, KC_R}, {KC_E, KC_S},
+    {KC_E, KC_T}, {KC_F, KC_G}, {KC_F, KC_H}, {KC_F, KC_I}, {KC_F, KC_J}, {KC_F, KC_K},
+    {KC_F, KC_L}, {KC_F, KC_M}, {KC_F, KC_N}, {KC_F, KC_O}, {KC_F, KC_P}, {KC_F, KC_Q},
+    {KC_F, KC_R}, {KC_F, KC_S}, {KC_F, KC_T}, {KC_G, KC_H}, {KC_G, KC_I}, {KC_G, KC_J},
+    {KC_G, KC_K}, {KC_G, KC_L}, {KC_G, KC_M}, {KC_G, KC_N}, {KC_G, KC_O}, {KC_G, KC_P},
+    {KC_G, KC_Q}, {KC_G, KC_R}, {KC_G, KC_S}, {KC_G, KC_T}, {KC_H, KC_I}, {KC_H, KC_J},
+    {KC_H, KC_K}, {KC_H, KC_L}, {KC_H, KC_M}, {KC_H, KC_N}, {KC_H, KC_O}, {KC_H, KC_P},
+    {KC_H, KC_Q}, {KC_H, KC_R}, {KC_H, KC_S}, {KC_H, KC_T}, {KC_I, KC_J}, {KC_I, KC_K},
+    {KC_I, KC_L}, {KC_I, KC_M}, {KC_I, KC_N}, {KC_I, KC_O}, {KC_I, KC_P}, {KC_I, KC_Q},
+    {KC_I, KC_R}, {KC_I, KC_S}, {KC_I, KC_T}, {KC_J, KC_K}, {KC_J, KC_L}, {KC_J, KC_M},
+    {KC_J, KC_N}, {KC_J, KC_O}, {KC_J, KC_P}, {KC_J, KC_Q}, {KC_J, KC_R}, {KC_J, KC_S},
+    {KC_J, KC_T}, {KC_K, KC_L}, {KC_K, KC_M}, {KC_K, KC_N}, {KC_K, KC_O}, {KC_K, KC_P},
+    {KC_K, KC_Q}, {KC_K, KC_R}, {KC_K, KC_S}, {KC_K, KC_T}, {KC_L, KC_M}, {KC_L, KC_N},
+    {KC_L, KC_O}, {KC_L, KC_P}, {KC_L, KC_Q}, {KC_L, KC_R}, {KC_L, KC_S}, {KC_L, KC_T},
+    {KC_M, KC_N}, {KC_M, KC_O}, {KC_M, KC_P}, {KC_M, KC_Q}, {KC_M, KC_R}, {KC_M, KC_S},
+    {KC_M, KC_T}, {KC_N, KC_O}, {KC_N, KC_P}, {KC_N, KC_Q}, {KC_N, KC_R}, {KC_N, KC_S},
+    {KC_N, KC_T}, {KC_O, KC_P}, {KC_O, KC_Q}, {KC_O, KC_R}, {KC_O, KC_S}, {KC_O, KC_T},
+    {KC_P, KC_Q}, {KC_P, KC_R}, {KC_P, KC_S}, {KC_P, KC_T}, {KC_Q, KC_R}, {KC_Q, KC_S},
+    {KC_Q, KC_T}, {KC_R, KC_S}, {KC_R, KC_T}, {KC_S, KC_T}, {KC_U, KC_V, KC_W}, {KC_V, KC_W, KC_X},
+    {KC_W, KC_X, KC_Y}, {KC_X, KC_Y, KC_Z}, {KC_Y, KC_Z, KC_1}, {KC_Z, KC_1, KC_2}, {KC_1, KC_2, KC_3}, {KC_2, KC_3, KC_4},
+    {KC_3, KC_4, KC_U}, {KC_4, KC_U, KC_V},
+};
+
+combo_t key_combos[COMBO_COUNT] = {
+    COMBO(combo_keys[0], KC_F1 + 0), COMBO(combo_keys[1], KC_F1 + 1), COMBO(combo_keys[2], KC_F1 + 2), COMBO(combo_keys[3], KC_F1 + 3),
+    COMBO(combo_keys[4], KC_F1 + 4), COMBO(combo_keys[5], KC_F1 + 5), COMBO(combo_keys[6], KC_F1 + 6), COMBO(combo_keys[7], KC_F1 + 7),
+    COMBO(combo_keys[8], KC_F1 + 8), COMBO(combo_keys[9], KC_F1 + 9), COMBO(combo_keys[10], KC_F1 + 10), COMBO(combo_keys[11], KC_F1 + 11),
+    COMBO(combo_keys[12], KC_F1 + 0), COMBO(combo_keys[13], KC_F1 + 1), COMBO(combo_keys[14], KC_F1 + 2), COMBO(combo_keys[15], KC_F1 + 3),
+    COMBO(combo_keys[16], KC_F1 + 4), COMBO(combo_keys[17], KC_F1 + 5), COMBO(combo_keys[18], KC_F1 + 6), COMBO(combo_keys[19], KC_F1 + 7),
+    COMBO(combo_keys[20], KC_F1 + 8), COMBO(combo_keys[21], KC_F1 + 9), COMBO(combo_keys[22], KC_F1 + 10), COMBO(combo_keys[23], KC_F1 + 11),
+    COMBO(combo_keys[24], KC_F1 + 0), COMBO(combo_keys[25], KC_F1 + 1), COMBO(combo_keys[26], KC_F1 + 2), COMBO(combo_keys[27], KC_F1 + 3),
+    COMBO(combo_keys[28], KC_F1 + 4), COMBO(combo_keys[29], KC_F1 + 5), COMBO(combo_keys[30], KC_F1 + 6), COMBO(combo_keys[31], KC_F1 + 7),
+    COMBO(combo_keys[32], KC_F1 + 8), COMBO(combo_keys[33], KC_F1 + 9), COMBO(combo_keys[34], KC_F1 + 10), COMBO(combo_keys[35], KC_F1 + 11),
+    COMBO(combo_keys[36], KC_F1 + 0), COMBO(combo_keys[37], KC_F1 + 1), COMBO(combo_keys[38], KC_F1 + 2), COMBO(combo_keys[39], KC_F1 + 3),
+    COMBO(combo_keys[40], KC_F1 + 4), COMBO(combo_keys[41], KC_F1 + 5), COMBO(combo_keys[42], KC_F1 + 6), COMBO(combo_keys[43], KC_F1 + 7),
+    COMBO(combo_keys[44], KC_F1 + 8), COMBO(combo_keys[45], KC_F1 + 9), COMBO(combo_keys[46], KC_F1 + 10), COMBO(combo_keys[47], KC_F1 + 11),
+    COMBO(combo_keys[48], KC_F1 + 0), COMBO(combo_keys[49], KC_F1 + 1), COMBO(combo_keys[50], KC_F1 + 2), COMBO(combo_keys[51], KC_F1 + 3),
+    COMBO(combo_keys[52], KC_F1 + 4), COMBO(combo_keys[53], KC_F1 + 5), COMBO(combo_keys[54], KC_F1 + 6), COMBO(combo_keys[55], KC_F1 + 7),
+    COMBO(combo_keys[56], KC_F1 + 8), COMBO(combo_keys[57], KC_F1 + 9), COMBO(combo_keys[58], KC_F1 + 10), COMBO(combo_keys[59], KC_F1 + 11),
+    COMBO(combo_keys[60], KC_F1 + 0), COMBO(combo_keys[61], KC_F1 + 1), COMBO(combo_keys[62], KC_F1 + 2), COMBO(combo_keys[63], KC_F1 + 3),
+    COMBO(combo_keys[64], KC_F1 + 4), COMBO(combo_keys[65], KC_F1 + 5), COMBO(combo_keys[66], KC_F1 + 6), COMBO(combo_keys[67], KC_F1 + 7),
+    COMBO(combo_keys[68], KC_F1 + 8), COMBO(combo_keys[69], KC_F1 + 9), COMBO(combo_keys[70], KC_F1 + 10), COMBO(combo_keys[71], KC_F1 + 11),
+    COMBO(combo_keys[72], KC_F1 + 0), COMBO(combo_keys[73], KC_F1 + 1), COMBO(combo_keys[74], KC_F1 + 2), COMBO(combo_keys[75], KC_F1 + 3),
+    COMBO(combo_keys[76], KC_F1 + 4), COMBO(combo_keys[77], KC_F1 + 5), COMBO(combo_keys[78], KC_F1 + 6), COMBO(combo_keys[79], KC_F1 + 7),
+    COMBO(combo_keys[80], KC_F1 + 8), COMBO(combo_keys[81], KC_F1 + 9), COMBO(combo_keys[82], KC_F1 + 10), COMBO(combo_keys[83], KC_F1 + 11),
+    COMBO(combo_keys[84], KC_F1 + 0), COMBO(combo_keys[85], KC_F1 + 1), COMBO(combo_keys[86], KC_F1 + 2), COMBO(combo_keys[87], KC_F1 + 3),
+    COMBO(combo_keys[88], KC_F1 + 4), COMBO(combo_keys[89], KC_F1 + 5), COMBO(combo_keys[90], KC_F1 + 6), COMBO(combo_keys[91], KC_F1 + 7),
+    COMBO(combo_keys[92], KC_F1 + 8), COMBO(combo_keys[93], KC_F1 + 9), COMBO(combo_keys[94], KC_F1 + 10), COMBO(combo_keys[95], KC_F1 + 11),
+    COMBO(combo_keys[96], KC_F1 + 0), COMBO(combo_keys[97], KC_F1 + 1), COMBO(combo_keys[98], KC_F1 + 2), COMBO(combo_keys[99], KC_F1 + 3),
+    COMBO(combo_keys[100], KC_F1 + 4), COMBO(combo_keys[101], KC_F1 + 5), COMBO(combo_keys[102], KC_F1 + 6), COMBO(combo_keys[103], KC_F1 + 7),
+    COMBO(combo_keys[104], KC_F1 + 8), COMBO(combo_keys[105], KC_F1 + 9), COMBO(combo_keys[106], KC_F1 + 10), COMBO(combo_keys[107], KC_F1 + 11),
+    COMBO(combo_keys[108], KC_F1 + 0), COMBO(combo_keys[109], KC_F1 + 1), COMBO(combo_keys[110], KC_F1 + 2), COMBO(combo_keys[111], KC_F1 + 3),
+    COMBO(combo_keys[112], KC_F1 + 4), COMBO(combo_keys[113], KC_F1 + 5), COMBO(combo_keys[114], KC_F1 + 6), COMBO(combo_keys[115], KC_F1 + 7),
+    COMBO(combo_keys[116], KC_F1 + 8), COMBO(combo_keys[117], KC_F1 + 9), COMBO(combo_keys[118], KC_F1 + 10), COMBO(combo_keys[119], KC_F1 + 11),
+    COMBO(combo_keys[120], KC_F1 + 0), COMBO(combo_keys[121], KC_F1 + 1), COMBO(combo_keys[122], KC_F1 + 2), COMBO(combo_keys[123], KC_F1 + 3),
+    COMBO(combo_keys[124], KC_F1 + 4), COMBO(combo_keys[125], KC_F1 + 5), COMBO(combo_keys[126], KC_F1 + 6), COMBO(combo_keys[127], KC_F1 + 7),
+    COMBO(combo_keys[128], KC_F1 + 8), COMBO(combo_keys[129], KC_F1 + 9), COMBO(combo_keys[130], KC_F1 + 10), COMBO(combo_keys[131], KC_F1 + 11),
+    COMBO(combo_keys[132], KC_F1 + 0), COMBO(combo_keys[133], KC_F1 + 1), COMBO(combo_keys[134], KC_F1 + 2), COMBO(combo_keys[135], KC_F1 + 3),
+    COMBO(combo_keys[136], KC_F1 + 4), COMBO(combo_keys[137], KC_F1 + 5), COMBO(combo_keys[138], KC_F1 + 6), COMBO(combo_keys[139], KC_F1 + 7),
+    COMBO(combo_keys[140], KC_F1 + 8), COMBO(combo_keys[141], KC_F1 + 9), COMBO(combo_keys[142], KC_F1 + 10), COMBO(combo_keys[143], KC_F1 + 11),
+    COMBO(combo_keys[144], KC_F1 + 0), COMBO(combo_keys[145], KC_F1 + 1), COMBO(combo_keys[146], KC_F1 + 2), COMBO(combo_keys[147], KC_F1 + 3),
+    COMBO(combo_keys[148], KC_F1 + 4), COMBO(combo_keys[149], KC_F1 + 5), COMBO(combo_keys[150], KC_F1 + 6), COMBO(combo_keys[151], KC_F1 + 7),
+    COMBO(combo_keys[152], KC_F1 + 8), COMBO(combo_keys[153], KC_F1 + 9), COMBO(combo_keys[154], KC_F1 + 10), COMBO(combo_keys[155], KC_F1 + 11),
+    COMBO(combo_keys[156], KC_F1 + 0), COMBO(combo_keys[157], KC_F1 + 1), COMBO(combo_keys[158], KC_F1 + 2), COMBO(combo_keys[159], KC_F1 + 3),
+    COMBO(combo_keys[160], KC_F1 + 4), COMBO(combo_keys[161], KC_F1 + 5), COMBO(combo_keys[162], KC_F1 + 6), COMBO(combo_keys[163], KC_F1 + 7),
+    COMBO(combo_keys[164], KC_F1 + 8), COMBO(combo_keys[165], KC_F1 + 9), COMBO(combo_keys[166], KC_F1 + 10), COMBO(combo_keys[167], KC_F1 + 11),
+    COMBO(combo_keys[168], KC_F1 + 0), COMBO(combo_keys[169], KC_F1 + 1), COMBO(combo_keys[170], KC_F1 + 2), COMBO(combo_keys[171], KC_F1 + 3),
+    COMBO(combo_keys[172], KC_F1 + 4), COMBO(combo_keys[173], KC_F1 + 5), COMBO(combo_keys[174], KC_F1 + 6), COMBO(combo_keys[175], KC_F1 + 7),
+    COMBO(combo_keys[176], KC_F1 + 8), COMBO(combo_keys[177], KC_F1 + 9), COMBO(combo_keys[178], KC_F1 + 10), COMBO(combo_keys[179], KC_F1 + 11),
+    COMBO(combo_keys[180], KC_F1 + 0), COMBO(combo_keys[181], KC_F1 + 1), COMBO(combo_keys[182], KC_F1 + 2), COMBO(combo_keys[183], KC_F1 + 3),
+    COMBO(combo_keys[184], KC_F1 + 4), COMBO(combo_keys[185], KC_F1 + 5), COMBO(combo_keys[186], KC_F1 + 6), COMBO(combo_keys[187], KC_F1 + 7),
+    COMBO(combo_keys[188], KC_F1 + 8), COMBO(combo_keys[189], KC_F1 + 9), COMBO(combo_keys[190], KC_F1 + 10), COMBO(combo_keys[191], KC_F1 + 11),
+    COMBO(combo_keys[192], KC_F1 + 0), COMBO(combo_keys[193], KC_F1 + 1), COMBO(combo_keys[194], KC_F1 + 2), COMBO(combo_keys[195], KC_F1 + 3),
+    COMBO(combo_keys[196], KC_F1 + 4), COMBO(combo_keys[197], KC_F1 + 5), COMBO(combo_keys[198], KC_F1 + 6), COMBO(combo_keys[199], KC_F1 + 7),
+};
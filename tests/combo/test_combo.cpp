@@ -0,0 +1,173 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <utility>
+#include <vector>
+#include "test_common.hpp"
+
+using testing::_;
+using testing::AnyNumber;
+using testing::InSequence;
+
+extern "C" {
+    extern combo_t key_combos[COMBO_COUNT];
+}
+
+class Combo : public TestFixture {};
+
+typedef std::vector<std::pair<uint8_t, uint8_t>> combo_positions;
+
+// What process_combo used to find by searching the keys of every combo
+static combo_positions search_every_combo(uint16_t keycode) {
+    combo_positions positions;
+    for (int combo = 0; combo < COMBO_COUNT; combo++) {
+        int position = -1;
+        for (int i = 0; key_combos[combo].keys[i] != COMBO_END; i++) {
+            if (key_combos[combo].keys[i] == keycode) {
+                position = i;
+            }
+        }
+        if (position != -1) {
+            positions.emplace_back(combo, position);
+        }
+    }
+    return positions;
+}
+
+static combo_positions search_index(uint16_t keycode) {
+    const combo_key_t* keys;
+    uint16_t count = combo_keys_for(keycode, &keys);
+    combo_positions positions;
+    for (uint16_t i = 0; i < count; i++) {
+        EXPECT_EQ(keys[i].keycode, keycode);
+        positions.emplace_back(keys[i].combo, keys[i].position);
+    }
+    return positions;
+}
+
+TEST_F(Combo, IndexFindsTheSameCombosAsSearchingAll) {
+    ASSERT_TRUE(combo_index_init());
+    for (uint16_t keycode = 0; keycode < 0x400; keycode++) {
+        EXPECT_EQ(search_index(keycode), search_every_combo(keycode)) << "keycode " << keycode;
+    }
+    EXPECT_EQ(search_index(KC_A).size(), 19);
+    EXPECT_EQ(search_index(KC_U).size(), 3);
+    EXPECT_EQ(search_index(KC_SPC).size(), 0);
+}
+
+TEST_F(Combo, PressingTheFirstCombo) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    press_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_F1)));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Combo, PressingTheLastPairCombo) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(8, 1);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    press_key(9, 1);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_F10)));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Combo, PressingAThreeKeyCombo) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(0, 2);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    press_key(1, 2);
+    run_one_scan_loop();
+    press_key(2, 2);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_F11)));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Combo, PressingAComboWithoutTheIndex) {
+    TestDriver driver;
+    InSequence s;
+
+    combo_index_enable(false);
+    press_key(0, 2);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    press_key(1, 2);
+    run_one_scan_loop();
+    press_key(2, 2);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_F11)));
+    run_one_scan_loop();
+    combo_index_enable(true);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Combo, KeyInNoComboIsSentRightAway) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(0, 3);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_SPC)));
+    run_one_scan_loop();
+    release_key(0, 3);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+template<typename F>
+static double nanoseconds_per_event(int events, F f) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < events; i++) {
+        f();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / events;
+}
+
+TEST_F(Combo, PerEventCost) {
+    const int events = 100000;
+    keyrecord_t record = {};
+    record.event.key = {0, 3};
+    record.event.time = 1;
+    volatile bool processed = true;
+
+    auto process = [&]() {
+        record.event.pressed = !record.event.pressed;
+        processed = processed && process_combo(KC_SPC, &record);
+    };
+    double indexed = nanoseconds_per_event(events, process);
+    // The same as building with COMBO_INDEX_SIZE 0
+    combo_index_enable(false);
+    double searched = nanoseconds_per_event(events, process);
+    combo_index_enable(true);
+    EXPECT_TRUE(processed);
+    std::cout << "[          ] Key in none of " << COMBO_COUNT << " combos: "
+        << indexed << " ns per event with the index, "
+        << searched << " ns searching every combo" << std::endl;
+}
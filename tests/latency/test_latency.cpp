@@ -0,0 +1,149 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "test_common.hpp"
+#include "action_tapping.h"
+
+extern "C" {
+    #include "latency_trace.h"
+}
+
+using testing::_;
+using testing::AnyNumber;
+
+// The test platform's profiler ticks are microseconds, which only move with the
+// fake timer, so everything that happens in one scan has no latency
+class Latency : public TestFixture {
+public:
+    Latency() {
+        latency_trace_clear();
+    }
+
+    const profile_stats_t* stage(latency_trace_stage_t s) {
+        return latency_trace_get(s);
+    }
+};
+
+TEST_F(Latency, NormalKeyIsReportedInTheSameScan) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    press_key(0, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    run_one_scan_loop();
+    for (int i = 0; i < LATENCY_TRACE_STAGES; i++) {
+        EXPECT_EQ(stage((latency_trace_stage_t)i)->count, 2);
+        EXPECT_EQ(stage((latency_trace_stage_t)i)->max, 0);
+    }
+    EXPECT_EQ(stage(LATENCY_TRACE_TOTAL)->histogram[0], 2);
+    EXPECT_EQ(latency_trace_dropped(), 0);
+}
+
+TEST_F(Latency, TapKeyWaitsForTheRelease) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    press_key(1, 0);
+    run_one_scan_loop();
+    idle_for(49);
+    release_key(1, 0);
+    run_one_scan_loop();
+    // The press is processed with the release 50 ms later, and both are reported then
+    EXPECT_EQ(stage(LATENCY_TRACE_QUEUE)->count, 2);
+    EXPECT_EQ(stage(LATENCY_TRACE_QUEUE)->max, 50000);
+    EXPECT_EQ(stage(LATENCY_TRACE_QUEUE)->min, 0);
+    EXPECT_EQ(stage(LATENCY_TRACE_REPORT)->max, 0);
+    EXPECT_EQ(stage(LATENCY_TRACE_TOTAL)->max, 50000);
+}
+
+TEST_F(Latency, HeldTapKeyWaitsForTheTappingTerm) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    press_key(1, 0);
+    run_one_scan_loop();
+    press_key(0, 0);
+    idle_for(TAPPING_TERM + 10);
+    // Holding the layer key doesn't change the report, but the A that waited for it does
+    EXPECT_EQ(stage(LATENCY_TRACE_TOTAL)->count, 1);
+    EXPECT_GE(stage(LATENCY_TRACE_TOTAL)->max, (TAPPING_TERM - 2) * 1000);
+    EXPECT_LE(stage(LATENCY_TRACE_TOTAL)->max, TAPPING_TERM * 1000);
+    release_key(0, 0);
+    release_key(1, 0);
+    run_one_scan_loop();
+}
+
+TEST_F(Latency, TapDanceIsReportedWhenItTimesOut) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    press_key(2, 0);
+    run_one_scan_loop();
+    release_key(2, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(stage(LATENCY_TRACE_TOTAL)->count, 0);
+    idle_for(TAPPING_TERM + 10);
+    // Only the E is counted, the release that follows belongs to the same tap
+    EXPECT_EQ(stage(LATENCY_TRACE_QUEUE)->count, 1);
+    EXPECT_EQ(stage(LATENCY_TRACE_QUEUE)->max, (TAPPING_TERM + 1) * 1000);
+    EXPECT_EQ(stage(LATENCY_TRACE_TOTAL)->max, (TAPPING_TERM + 1) * 1000);
+}
+
+TEST_F(Latency, ComboKeyIsReportedWhenTheComboTimesOut) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    press_key(3, 0);
+    run_one_scan_loop();
+    idle_for(COMBO_TERM + 10);
+    EXPECT_EQ(stage(LATENCY_TRACE_QUEUE)->count, 1);
+    EXPECT_EQ(stage(LATENCY_TRACE_QUEUE)->max, (COMBO_TERM + 1) * 1000);
+    release_key(3, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(stage(LATENCY_TRACE_QUEUE)->count, 2);
+    EXPECT_EQ(stage(LATENCY_TRACE_QUEUE)->min, 0);
+}
+
+TEST_F(Latency, ComboIsReportedWithTheLastKey) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    press_key(3, 0);
+    run_one_scan_loop();
+    idle_for(9);
+    press_key(4, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(stage(LATENCY_TRACE_TOTAL)->count, 1);
+    EXPECT_EQ(stage(LATENCY_TRACE_TOTAL)->max, 0);
+    release_key(3, 0);
+    release_key(4, 0);
+    run_one_scan_loop();
+}
+
+TEST_F(Latency, RawHidSendsTheStages) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    press_key(1, 0);
+    run_one_scan_loop();
+    idle_for(19);
+    release_key(1, 0);
+    run_one_scan_loop();
+
+    uint8_t data[32] = {LATENCY_TRACE_RAW_HID_ID, PROFILE_RAW_HID_STATS, LATENCY_TRACE_QUEUE};
+    EXPECT_TRUE(latency_trace_raw_hid_receive(data, sizeof(data)));
+    EXPECT_EQ(data[3], LATENCY_TRACE_STAGES);
+    EXPECT_EQ(data[4], 2);
+    EXPECT_EQ(data[16] | (data[17] << 8), 20000);
+
+    uint8_t other[32] = {PROFILE_RAW_HID_ID, PROFILE_RAW_HID_STATS, LATENCY_TRACE_QUEUE};
+    EXPECT_FALSE(latency_trace_raw_hid_receive(other, sizeof(other)));
+}
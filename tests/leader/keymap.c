@@ -0,0 +1,71 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {
+        // 0      1      2      3      4      5      6      7      8      9
+        {KC_LEAD, KC_F,  KC_D,  KC_S,  KC_A,  KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO,   KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO,   KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO,   KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+    },
+};
+
+// Leader F, leader D, and leader D S D S D S D S
+const leader_key_t PROGMEM leader_dsdsdsds[] = {
+    LEADER_ACTION(KC_S, 3),
+    LEADER_END
+};
+const leader_key_t PROGMEM leader_dsdsdsd[] = {
+    LEADER_NODE(KC_D, leader_dsdsdsds),
+    LEADER_END
+};
+const leader_key_t PROGMEM leader_dsdsds[] = {
+    LEADER_NODE(KC_S, leader_dsdsdsd),
+    LEADER_END
+};
+const leader_key_t PROGMEM leader_dsdsd[] = {
+    LEADER_NODE(KC_D, leader_dsdsds),
+    LEADER_END
+};
+const leader_key_t PROGMEM leader_dsds[] = {
+    LEADER_NODE(KC_S, leader_dsdsd),
+    LEADER_END
+};
+const leader_key_t PROGMEM leader_dsd[] = {
+    LEADER_NODE(KC_D, leader_dsds),
+    LEADER_END
+};
+const leader_key_t PROGMEM leader_ds[] = {
+    LEADER_NODE(KC_S, leader_dsd),
+    LEADER_END
+};
+const leader_key_t PROGMEM leader_trie[] = {
+    LEADER_ACTION(KC_F, 1),
+    LEADER_NODE_ACTION(KC_D, leader_ds, 2),
+    LEADER_END
+};
+
+uint16_t leader_actions[8];
+uint8_t leader_action_count = 0;
+
+void process_leader_action(uint16_t action) {
+    if (leader_action_count < sizeof(leader_actions) / sizeof(leader_actions[0])) {
+        leader_actions[leader_action_count++] = action;
+    }
+}
@@ -0,0 +1,105 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+using testing::_;
+using testing::AnyNumber;
+using testing::InSequence;
+
+extern "C" {
+    extern uint16_t leader_actions[8];
+    extern uint8_t leader_action_count;
+}
+
+class Leader : public TestFixture {
+public:
+    Leader() {
+        leader_action_count = 0;
+    }
+
+    void tap_key(uint8_t col) {
+        press_key(col, 0);
+        run_one_scan_loop();
+        release_key(col, 0);
+        run_one_scan_loop();
+    }
+};
+
+TEST_F(Leader, UniqueSequenceFiresWithoutWaiting) {
+    TestDriver driver;
+    // The releases of the keys in the sequence still send empty reports
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    tap_key(0);
+    tap_key(1);
+    EXPECT_EQ(leader_action_count, 1);
+    EXPECT_EQ(leader_actions[0], 1);
+}
+
+TEST_F(Leader, SequenceThatContinuesFiresAfterTheTimeout) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    tap_key(0);
+    tap_key(2);
+    idle_for(LEADER_TIMEOUT - 10);
+    EXPECT_EQ(leader_action_count, 0);
+    idle_for(20);
+    EXPECT_EQ(leader_action_count, 1);
+    EXPECT_EQ(leader_actions[0], 2);
+}
+
+TEST_F(Leader, LongerSequenceThanFiveKeys) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    tap_key(0);
+    for (int i = 0; i < 4; i++) {
+        tap_key(2);
+        idle_for(LEADER_TIMEOUT / 2);
+        tap_key(3);
+        idle_for(LEADER_TIMEOUT / 2);
+    }
+    EXPECT_EQ(leader_action_count, 1);
+    EXPECT_EQ(leader_actions[0], 3);
+}
+
+TEST_F(Leader, UnknownSequenceEndsTheLeader) {
+    TestDriver driver;
+    InSequence s;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    tap_key(0);
+    tap_key(4);
+    EXPECT_EQ(leader_action_count, 0);
+    press_key(4, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    run_one_scan_loop();
+    release_key(4, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(Leader, NothingFiresIfNoKeyFollows) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    tap_key(0);
+    idle_for(LEADER_TIMEOUT + 10);
+    EXPECT_EQ(leader_action_count, 0);
+    press_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_F)));
+    run_one_scan_loop();
+    release_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
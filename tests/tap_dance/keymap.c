@@ -0,0 +1,43 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {
+        // 0      1       2       3       4       5       6       7       8       9
+        {TD(0),   TD(1),  TD(2),  TD(3),  TD(4),  TD(5),  TD(6),  TD(7),  TD(8),  TD(9)},
+        {TD(10),  TD(11), KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_SPC},
+        {KC_NO,   KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO},
+        {KC_NO,   KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO,  KC_NO},
+    },
+};
+
+// Tapped once the dances send A to L, tapped twice M to X
+qk_tap_dance_action_t tap_dance_actions[] = {
+    ACTION_TAP_DANCE_DOUBLE(KC_A, KC_M),
+    ACTION_TAP_DANCE_DOUBLE(KC_B, KC_N),
+    ACTION_TAP_DANCE_DOUBLE(KC_C, KC_O),
+    ACTION_TAP_DANCE_DOUBLE(KC_D, KC_P),
+    ACTION_TAP_DANCE_DOUBLE(KC_E, KC_Q),
+    ACTION_TAP_DANCE_DOUBLE(KC_F, KC_R),
+    ACTION_TAP_DANCE_DOUBLE(KC_G, KC_S),
+    ACTION_TAP_DANCE_DOUBLE(KC_H, KC_T),
+    ACTION_TAP_DANCE_DOUBLE(KC_I, KC_U),
+    ACTION_TAP_DANCE_DOUBLE(KC_J, KC_V),
+    ACTION_TAP_DANCE_DOUBLE(KC_K, KC_W),
+    ACTION_TAP_DANCE_DOUBLE(KC_L, KC_X),
+};
@@ -0,0 +1,147 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include "action_tapping.h"
+
+using testing::InSequence;
+
+class TapDance : public TestFixture {
+public:
+    void tap_key(uint8_t col, uint8_t row = 0) {
+        press_key(col, row);
+        run_one_scan_loop();
+        release_key(col, row);
+        run_one_scan_loop();
+    }
+
+    static void expect_reports(TestDriver& driver, std::initializer_list<std::vector<uint8_t>> reports) {
+        for (auto& keys : reports) {
+            EXPECT_CALL(driver, send_keyboard_mock(testing::MakeMatcher(new KeyboardReportMatcher(keys))));
+        }
+    }
+};
+
+TEST_F(TapDance, TapOnce) {
+    TestDriver driver;
+    InSequence s;
+    expect_reports(driver, {{}, {KC_A}, {}, {}});
+    tap_key(0);
+    idle_for(TAPPING_TERM + 10);
+}
+
+TEST_F(TapDance, TapTwice) {
+    TestDriver driver;
+    InSequence s;
+    expect_reports(driver, {{KC_M}, {}, {}});
+    tap_key(0);
+    tap_key(0);
+    idle_for(TAPPING_TERM + 10);
+}
+
+TEST_F(TapDance, HoldingAllTheDances) {
+    TestDriver driver;
+    InSequence s;
+    // Every dance that is pressed interrupts the held ones before it,
+    // which only fits six keys in the report
+    expect_reports(driver, {
+        {}, {KC_A},
+        {KC_A}, {KC_A, KC_B},
+        {KC_A, KC_B}, {KC_A, KC_B, KC_C},
+        {KC_A, KC_B, KC_C}, {KC_A, KC_B, KC_C, KC_D},
+        {KC_A, KC_B, KC_C, KC_D}, {KC_A, KC_B, KC_C, KC_D, KC_E},
+        {KC_A, KC_B, KC_C, KC_D, KC_E}, {KC_A, KC_B, KC_C, KC_D, KC_E, KC_F},
+        {KC_A, KC_B, KC_C, KC_D, KC_E, KC_F}, {KC_A, KC_B, KC_C, KC_D, KC_E, KC_F},
+        {KC_A, KC_B, KC_C, KC_D, KC_E, KC_F}, {KC_A, KC_B, KC_C, KC_D, KC_E, KC_F},
+        {KC_A, KC_B, KC_C, KC_D, KC_E, KC_F}, {KC_A, KC_B, KC_C, KC_D, KC_E, KC_F},
+        {KC_A, KC_B, KC_C, KC_D, KC_E, KC_F}, {KC_A, KC_B, KC_C, KC_D, KC_E, KC_F},
+        {KC_A, KC_B, KC_C, KC_D, KC_E, KC_F}, {KC_A, KC_B, KC_C, KC_D, KC_E, KC_F},
+    });
+    for (int i = 0; i < 12; i++) {
+        press_key(i % 10, i / 10);
+        run_one_scan_loop();
+    }
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // The last one is still dancing when the others are released
+    expect_reports(driver, {
+        {KC_B, KC_C, KC_D, KC_E, KC_F}, {KC_B, KC_C, KC_D, KC_E, KC_F},
+        {KC_C, KC_D, KC_E, KC_F}, {KC_C, KC_D, KC_E, KC_F},
+        {KC_D, KC_E, KC_F}, {KC_D, KC_E, KC_F},
+        {KC_E, KC_F}, {KC_E, KC_F},
+        {KC_F}, {KC_F},
+        {}, {},
+        {}, {},
+        {}, {},
+        {}, {},
+        {}, {},
+        {}, {},
+        {}, {KC_L}, {}, {},
+    });
+    for (int i = 0; i < 12; i++) {
+        release_key(i % 10, i / 10);
+        run_one_scan_loop();
+    }
+    idle_for(TAPPING_TERM + 10);
+}
+
+TEST_F(TapDance, RollingFromDanceToDance) {
+    TestDriver driver;
+    InSequence s;
+    expect_reports(driver, {{}, {KC_A}, {}, {}});
+    for (int i = 1; i < 11; i++) {
+        expect_reports(driver, {{}, {(uint8_t)(KC_A + i)}, {}, {}, {}, {(uint8_t)(KC_A + i)}, {}, {}});
+    }
+    expect_reports(driver, {{}, {KC_L}, {}, {}});
+    for (int i = 0; i < 11; i++) {
+        press_key(i % 10, i / 10);
+        run_one_scan_loop();
+        press_key((i + 1) % 10, (i + 1) / 10);
+        run_one_scan_loop();
+        release_key(i % 10, i / 10);
+        run_one_scan_loop();
+        release_key((i + 1) % 10, (i + 1) / 10);
+        run_one_scan_loop();
+    }
+    idle_for(TAPPING_TERM + 10);
+}
+
+TEST_F(TapDance, InterruptedByAnotherDanceAndAKey) {
+    TestDriver driver;
+    InSequence s;
+    expect_reports(driver, {{KC_P}, {}, {}, {}, {KC_E}, {}, {}, {KC_SPC}, {}});
+    tap_key(3);
+    tap_key(3);
+    tap_key(4);
+    tap_key(9, 1);
+    idle_for(TAPPING_TERM + 10);
+}
+
+TEST_F(TapDance, HeldDancesTimeOut) {
+    TestDriver driver;
+    InSequence s;
+    expect_reports(driver, {{}, {KC_F}, {KC_F}, {KC_F, KC_G}, {KC_G}, {KC_G}, {}, {}});
+    press_key(5, 0);
+    run_one_scan_loop();
+    press_key(6, 0);
+    run_one_scan_loop();
+    idle_for(TAPPING_TERM + 10);
+    release_key(5, 0);
+    run_one_scan_loop();
+    release_key(6, 0);
+    run_one_scan_loop();
+    idle_for(TAPPING_TERM + 10);
+}
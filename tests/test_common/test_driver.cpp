@@ -15,6 +15,7 @@
  */
 
 #include "test_driver.hpp"
+#include "latency_trace.h"
 
 TestDriver* TestDriver::m_this = nullptr;
 
@@ -41,7 +42,9 @@ uint8_t TestDriver::keyboard_leds(void) {
 
 void TestDriver::send_keyboard(report_keyboard_t* report) {
     m_this->send_keyboard_mock(*report);
-
+    // The host reads it right away
+    LATENCY_TRACE_QUEUED();
+    LATENCY_TRACE_SENT();
 }
 
 void TestDriver::send_mouse(report_mouse_t* report) {
@@ -103,6 +103,18 @@ ifeq ($(strip $(BACKLIGHT_ENABLE)), yes)
     TMK_COMMON_DEFS += -DBACKLIGHT_ENABLE
 endif
 
+ifeq ($(strip $(LATENCY_TRACE_ENABLE)), yes)
+    TMK_COMMON_SRC += $(COMMON_DIR)/latency_trace.c
+    TMK_COMMON_DEFS += -DLATENCY_TRACE_ENABLE
+    PROFILE_ENABLE = yes
+endif
+
+ifeq ($(strip $(PROFILE_ENABLE)), yes)
+    TMK_COMMON_SRC += $(COMMON_DIR)/profile.c
+    TMK_COMMON_SRC += $(PLATFORM_COMMON_DIR)/profile_ticks.c
+    TMK_COMMON_DEFS += -DPROFILE_ENABLE
+endif
+
 ifeq ($(strip $(BLUETOOTH_ENABLE)), yes)
     TMK_COMMON_DEFS += -DBLUETOOTH_ENABLE
 	TMK_COMMON_DEFS += -DNO_USB_STARTUP_CHECK
@@ -27,6 +27,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action_util.h"
 #include "action.h"
 #include "wait.h"
+#include "latency_trace.h"
 
 #ifdef DEBUG_ACTION
 #include "debug.h"
@@ -173,8 +174,11 @@ void process_record(keyrecord_t *record)
 {
     if (IS_NOEVENT(record->event)) { return; }
 
-    if(!process_record_quantum(record))
+    LATENCY_TRACE_BEGIN(record->event.ticks);
+    if(!process_record_quantum(record)) {
+        LATENCY_TRACE_END();
         return;
+    }
 
     action_t action = store_or_get_action(record->event.pressed, record->event.key);
     dprint("ACTION: "); debug_action(action);
@@ -185,6 +189,7 @@ void process_record(keyrecord_t *record)
     dprintln();
 
     process_action(record, action);
+    LATENCY_TRACE_END();
 }
 
 /** \brief Take an action and processes it.
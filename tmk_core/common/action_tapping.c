@@ -165,6 +165,9 @@ bool process_tapping(keyrecord_t *keyp)
                                 .tap = tapping_key.tap,
                                 .event.key = tapping_key.event.key,
                                 .event.time = event.time,
+#ifdef LATENCY_TRACE_ENABLE
+                                .event.ticks = event.ticks,
+#endif
                                 .event.pressed = false
                         });
                     } else {
@@ -209,6 +212,9 @@ bool process_tapping(keyrecord_t *keyp)
                                 .tap = tapping_key.tap,
                                 .event.key = tapping_key.event.key,
                                 .event.time = event.time,
+#ifdef LATENCY_TRACE_ENABLE
+                                .event.ticks = event.ticks,
+#endif
                                 .event.pressed = false
                         });
                     } else {
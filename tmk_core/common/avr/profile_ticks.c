@@ -0,0 +1,55 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <avr/io.h>
+#include <util/atomic.h>
+#include "timer.h"
+#include "profile.h"
+
+#ifndef __AVR_ATmega32A__
+#define PROFILE_COMPARE_FLAG (TIFR0 & _BV(OCF0A))
+#else
+#define PROFILE_COMPARE_FLAG (TIFR & _BV(OCF0))
+#endif
+
+// Timer 0 is already running for timer.c
+void profile_ticks_init(void) {
+}
+
+// Timer 0 counts from 0 to TIMER_RAW_TOP in CTC mode, and its interrupt counts the periods in timer_count
+uint32_t profile_ticks(void) {
+    uint32_t count;
+    uint8_t raw;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        count = timer_count;
+        raw = TIMER_RAW;
+        // The compare match can have happened after timer_count was read, and
+        // the interrupt is waiting. If the counter has already started again, it's
+        // a new period.
+        if (PROFILE_COMPARE_FLAG) {
+            raw = TIMER_RAW;
+            if (raw != TIMER_RAW_TOP) {
+                count++;
+            }
+        }
+    }
+    return count * (TIMER_RAW_TOP + 1) + raw;
+}
+
+uint32_t profile_ticks_freq(void) {
+    return TIMER_RAW_FREQ;
+}
@@ -0,0 +1,79 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ch.h"
+#include "hal.h"
+#include "profile.h"
+
+#if __CORTEX_M >= 3
+
+// The DWT cycle counter, which runs at the core clock
+#ifndef PROFILE_TICKS_FREQ
+#  if defined(STM32_SYSCLK)
+#    define PROFILE_TICKS_FREQ STM32_SYSCLK
+#  elif defined(KINETIS_SYSCLK_FREQUENCY)
+#    define PROFILE_TICKS_FREQ KINETIS_SYSCLK_FREQUENCY
+#  else
+#    error "Define PROFILE_TICKS_FREQ as the core clock frequency"
+#  endif
+#endif
+
+void profile_ticks_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+#if __CORTEX_M == 7
+    DWT->LAR = 0xC5ACCE55;
+#endif
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t profile_ticks(void) {
+    return DWT->CYCCNT;
+}
+
+#else
+
+// Cortex-M0 has no cycle counter, so it counts system ticks. They are made 32
+// bit, like in timer.c, which assumes that it's called at least once before
+// the system time wraps around.
+#define PROFILE_TICKS_FREQ CH_CFG_ST_FREQUENCY
+
+static systime_t last_systime;
+static uint32_t ticks;
+
+void profile_ticks_init(void) {
+    last_systime = chVTGetSystemTimeX();
+    ticks = 0;
+}
+
+// Called from threads and from the USB interrupts, so the update is done with
+// the kernel locked, in whichever of them it is
+uint32_t profile_ticks(void) {
+    syssts_t sts = chSysGetStatusAndLockX();
+    systime_t now = chVTGetSystemTimeX();
+    ticks += (systime_t)(now - last_systime);
+    last_systime = now;
+    uint32_t result = ticks;
+    chSysRestoreStatusX(sts);
+    return result;
+}
+
+#endif
+
+uint32_t profile_ticks_freq(void) {
+    return PROFILE_TICKS_FREQ;
+}
@@ -32,6 +32,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "sleep_led.h"
 #include "led.h"
 #include "command.h"
+#include "profile.h"
+#include "latency_trace.h"
+#ifdef TOPRE_MATRIX_ENABLE
+#include "topre_matrix.h"
+#endif
 #include "backlight.h"
 #include "quantum.h"
 #include "version.h"
@@ -170,6 +175,10 @@ static void command_common_help(void)
 #ifdef SLEEP_LED_ENABLE
 		STR(MAGIC_KEY_SLEEP_LED   ) ":	Sleep LED Test\n"
 #endif
+
+#ifdef PROFILE_ENABLE
+		STR(MAGIC_KEY_PROFILE     ) ":	Print and Clear Profile\n"
+#endif
     );
 }
 
@@ -257,6 +266,10 @@ static void print_status(void)
 #   if USB_COUNT_SOF
     print_val_hex8(usbSofCount);
 #   endif
+#endif
+
+#ifdef TOPRE_MATRIX_ENABLE
+    topre_matrix_print_stats();
 #endif
 	return;
 }
@@ -322,6 +335,19 @@ static bool command_common(uint8_t code)
             break;
 #endif
 
+#ifdef PROFILE_ENABLE
+
+		// print the scan rate and timings, and start again
+        case MAGIC_KC(MAGIC_KEY_PROFILE):
+            profile_print();
+            profile_clear();
+#ifdef LATENCY_TRACE_ENABLE
+            latency_trace_print();
+            latency_trace_clear();
+#endif
+            break;
+#endif
+
 #ifdef BOOTMAGIC_ENABLE
 
 		// print stored eeprom config
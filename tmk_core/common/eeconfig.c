@@ -26,6 +26,9 @@ void eeconfig_init(void)
 #ifdef STENO_ENABLE
     eeprom_update_byte(EECONFIG_STENOMODE,      0);
 #endif
+#ifdef TOPRE_MATRIX_ENABLE
+    eeprom_update_byte(EECONFIG_TOPRE,          0);
+#endif
 }
 
 /** \brief eeconfig enable
@@ -113,3 +116,28 @@ uint8_t eeconfig_read_audio(void)      { return eeprom_read_byte(EECONFIG_AUDIO)
  */
 void eeconfig_update_audio(uint8_t val) { eeprom_update_byte(EECONFIG_AUDIO, val); }
 #endif
+
+#ifdef TOPRE_MATRIX_ENABLE
+/** \brief eeconfig read topre
+ *
+ * Reads the level where each key of a Topre matrix reads off, and returns
+ * false when they haven't been saved.
+ */
+bool eeconfig_read_topre(uint8_t *levels, uint16_t count)
+{
+    if (eeprom_read_byte(EECONFIG_TOPRE) != EECONFIG_TOPRE_MARKER) {
+        return false;
+    }
+    eeprom_read_block(levels, EECONFIG_TOPRE_LEVELS, count);
+    return true;
+}
+/** \brief eeconfig update topre
+ *
+ * Saves the level where each key of a Topre matrix reads off.
+ */
+void eeconfig_update_topre(const uint8_t *levels, uint16_t count)
+{
+    eeprom_update_block(levels, EECONFIG_TOPRE_LEVELS, count);
+    eeprom_update_byte(EECONFIG_TOPRE, EECONFIG_TOPRE_MARKER);
+}
+#endif
@@ -37,6 +37,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define EECONFIG_STENOMODE                          (uint8_t *)13
 // EEHANDS for two handed boards
 #define EECONFIG_HANDEDNESS         				(uint8_t *)14
+// Topre calibration, a marker and then a level for each key
+#define EECONFIG_TOPRE                              (uint8_t *)16
+#define EECONFIG_TOPRE_LEVELS                       (uint8_t *)17
+
+#define EECONFIG_TOPRE_MARKER                       0x7C
 
 
 /* debug bit */
@@ -83,4 +88,10 @@ uint8_t eeconfig_read_audio(void);
 void eeconfig_update_audio(uint8_t val);
 #endif
 
+#ifdef TOPRE_MATRIX_ENABLE
+// Returns false when the keys haven't been calibrated
+bool eeconfig_read_topre(uint8_t *levels, uint16_t count);
+void eeconfig_update_topre(const uint8_t *levels, uint16_t count);
+#endif
+
 #endif
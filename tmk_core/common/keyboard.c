@@ -31,6 +31,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "eeconfig.h"
 #include "backlight.h"
 #include "action_layer.h"
+#include "profile.h"
+#include "latency_trace.h"
 #ifdef BOOTMAGIC_ENABLE
 #   include "bootmagic.h"
 #else
@@ -151,6 +153,12 @@ bool is_keyboard_master(void) {
  */
 void keyboard_init(void) {
     timer_init();
+#ifdef PROFILE_ENABLE
+    profile_init();
+#endif
+#ifdef LATENCY_TRACE_ENABLE
+    latency_trace_init();
+#endif
 // To use PORTF disable JTAG with writing JTD bit twice within four cycles.
 #if  (defined(__AVR_AT90USB1286__) || defined(__AVR_AT90USB1287__) || defined(__AVR_ATmega32U4__))
   MCUCR |= _BV(JTD);
@@ -216,7 +224,15 @@ void keyboard_task(void)
     uint8_t keys_processed = 0;
 #endif
 
+    PROFILE_LOOP();
+    LATENCY_TRACE_TASK();
+
+    PROFILE_BEGIN(PROFILE_MATRIX_SCAN);
     matrix_scan();
+    PROFILE_END(PROFILE_MATRIX_SCAN);
+#ifdef LATENCY_TRACE_ENABLE
+    uint32_t scan_ticks = latency_trace_now();
+#endif
     if (is_keyboard_master()) {
         for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
             matrix_row = matrix_get_row(r);
@@ -239,11 +255,16 @@ void keyboard_task(void)
                 if (debug_matrix) matrix_print();
                 for (uint8_t c = 0; c < MATRIX_COLS; c++) {
                     if (matrix_change & ((matrix_row_t)1<<c)) {
+                        PROFILE_BEGIN(PROFILE_ACTION_EXEC);
                         action_exec((keyevent_t){
                             .key = (keypos_t){ .row = r, .col = c },
                             .pressed = (matrix_row & ((matrix_row_t)1<<c)),
-                            .time = (timer_read() | 1) /* time should not be 0 */
+                            .time = (timer_read() | 1), /* time should not be 0 */
+#ifdef LATENCY_TRACE_ENABLE
+                            .ticks = scan_ticks,
+#endif
                         });
+                        PROFILE_END(PROFILE_ACTION_EXEC);
                         // record a processed key
                         matrix_prev[r] ^= ((matrix_row_t)1<<c);
 #ifdef QMK_KEYS_PER_SCAN
@@ -262,7 +283,11 @@ void keyboard_task(void)
     // we can get here with some keys processed now.
     if (!keys_processed)
 #endif
-    action_exec(TICK);
+    {
+        PROFILE_BEGIN(PROFILE_ACTION_EXEC);
+        action_exec(TICK);
+        PROFILE_END(PROFILE_ACTION_EXEC);
+    }
 
 MATRIX_LOOP_END:
 
@@ -37,6 +37,9 @@ typedef struct {
     keypos_t key;
     bool     pressed;
     uint16_t time;
+#ifdef LATENCY_TRACE_ENABLE
+    uint32_t ticks;     // profiler ticks of the scan, see latency_trace.h
+#endif
 } keyevent_t;
 
 /* equivalent test of keypos_t */
@@ -0,0 +1,185 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <string.h>
+#include "latency_trace.h"
+#include "print.h"
+
+enum {
+    USB_IDLE,
+    USB_REPORTED,   // given to the host driver
+    USB_QUEUED,     // in the endpoint
+    USB_SENT,       // read by the host, waiting for latency_trace_task
+};
+
+static profile_stats_t stages[LATENCY_TRACE_STAGES];
+static uint8_t histogram_shift = 0;
+static uint16_t dropped = 0;
+
+static report_keyboard_t last_report;
+
+// The event that is being processed, and hasn't changed the report yet
+static uint32_t event_ticks = 0;
+static uint32_t processed_ticks;
+
+// The event of the report that the host hasn't read yet
+static volatile uint8_t usb_state = USB_IDLE;
+static uint32_t flight_event_ticks;
+static uint32_t flight_report_ticks;
+static volatile uint32_t sent_ticks;
+
+void latency_trace_init(void) {
+    histogram_shift = profile_histogram_shift(LATENCY_TRACE_HISTOGRAM_MIN_US);
+    latency_trace_clear();
+}
+
+void latency_trace_clear(void) {
+    for (uint8_t i = 0; i < LATENCY_TRACE_STAGES; i++) {
+        profile_stats_clear(&stages[i]);
+    }
+    dropped = 0;
+}
+
+// An event time stamp can be one tick late, because it's never 0
+static uint32_t since(uint32_t now, uint32_t then) {
+    return (int32_t)(now - then) < 0 ? 0 : now - then;
+}
+
+uint32_t latency_trace_now(void) {
+    uint32_t ticks = profile_ticks();
+    return ticks ? ticks : 1;
+}
+
+void latency_trace_begin(uint32_t ticks) {
+    event_ticks = ticks;
+    processed_ticks = profile_ticks();
+}
+
+void latency_trace_end(void) {
+    event_ticks = 0;
+}
+
+void latency_trace_report(const report_keyboard_t* report) {
+    uint32_t now = profile_ticks();
+    if (memcmp(&last_report, report, sizeof(last_report)) == 0) {
+        return;
+    }
+    memcpy(&last_report, report, sizeof(last_report));
+    if (event_ticks == 0) {
+        return;
+    }
+
+    latency_trace_task();
+    // The driver didn't take the previous report
+    if (usb_state == USB_REPORTED) {
+        usb_state = USB_IDLE;
+    }
+    if (usb_state != USB_IDLE) {
+        dropped++;
+        event_ticks = 0;
+        return;
+    }
+
+    profile_stats_add(&stages[LATENCY_TRACE_QUEUE], histogram_shift, since(processed_ticks, event_ticks));
+    profile_stats_add(&stages[LATENCY_TRACE_REPORT], histogram_shift, now - processed_ticks);
+    flight_event_ticks = event_ticks;
+    flight_report_ticks = now;
+    usb_state = USB_REPORTED;
+    event_ticks = 0;
+}
+
+void latency_trace_queued(void) {
+    if (usb_state == USB_REPORTED) {
+        usb_state = USB_QUEUED;
+    }
+}
+
+void latency_trace_sent(void) {
+    if (usb_state == USB_QUEUED) {
+        sent_ticks = profile_ticks();
+        usb_state = USB_SENT;
+    }
+}
+
+bool latency_trace_in_flight(void) {
+    return usb_state == USB_QUEUED;
+}
+
+__attribute__ ((weak))
+void latency_trace_poll(void) {
+}
+
+void latency_trace_task(void) {
+    if (usb_state == USB_QUEUED) {
+        latency_trace_poll();
+    }
+    if (usb_state == USB_SENT) {
+        profile_stats_add(&stages[LATENCY_TRACE_USB], histogram_shift, sent_ticks - flight_report_ticks);
+        profile_stats_add(&stages[LATENCY_TRACE_TOTAL], histogram_shift, since(sent_ticks, flight_event_ticks));
+        usb_state = USB_IDLE;
+    }
+}
+
+const profile_stats_t* latency_trace_get(latency_trace_stage_t stage) {
+    latency_trace_task();
+    return &stages[stage];
+}
+
+uint32_t latency_trace_bucket_limit(uint8_t bucket) {
+    return profile_histogram_limit(histogram_shift, bucket);
+}
+
+uint16_t latency_trace_dropped(void) {
+    return dropped;
+}
+
+void latency_trace_print(void) {
+#ifndef NO_PRINT
+    latency_trace_task();
+    print("\n\t- Latency -\n");
+    xprintf("dropped: %u\n", dropped);
+    for (uint8_t i = 0; i < LATENCY_TRACE_STAGES; i++) {
+        switch (i) {
+            case LATENCY_TRACE_QUEUE:   print("queue");     break;
+            case LATENCY_TRACE_REPORT:  print("report");    break;
+            case LATENCY_TRACE_USB:     print("usb");       break;
+            case LATENCY_TRACE_TOTAL:   print("total");     break;
+        }
+        profile_stats_print(&stages[i], histogram_shift);
+    }
+#endif
+}
+
+bool latency_trace_raw_hid_receive(uint8_t* data, uint8_t length) {
+    if (length < 4 || data[0] != LATENCY_TRACE_RAW_HID_ID) {
+        return false;
+    }
+    uint8_t stage = data[2];
+    if (data[1] == PROFILE_RAW_HID_CLEAR) {
+        latency_trace_clear();
+        return true;
+    }
+    for (uint8_t i = 3; i < length; i++) {
+        data[i] = 0;
+    }
+    data[3] = LATENCY_TRACE_STAGES;
+    latency_trace_task();
+    if (stage < LATENCY_TRACE_STAGES) {
+        profile_stats_raw_hid(&stages[stage], histogram_shift, data, length);
+    }
+    return true;
+}
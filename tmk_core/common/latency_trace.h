@@ -0,0 +1,113 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "profile.h"
+#include "report.h"
+
+/* Keypress latency tracing
+ *
+ * Every key event gets the profiler's tick count of the scan that found it,
+ * in keyevent_t.ticks. It stays with the record while tapping, combos and
+ * tap dance hold on to the key, and when the key finally does something,
+ * latency_trace_begin takes it. The first keyboard report that is different
+ * from the previous one belongs to that event, and the time is measured
+ * until the host has read the report from the endpoint.
+ *
+ * Only one report is followed at a time, so an event whose report is sent
+ * while the previous report is still waiting for the host is counted as
+ * dropped. Events that don't change the report aren't counted at all.
+ *
+ * Enabled with LATENCY_TRACE_ENABLE = yes, which also enables the profiler.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    LATENCY_TRACE_QUEUE,   // from the scan until the event is processed, which tapping, combos and tap dance delay
+    LATENCY_TRACE_REPORT,  // from processing until the report goes to the host driver
+    LATENCY_TRACE_USB,     // from the host driver until the host has read the report
+    LATENCY_TRACE_TOTAL,   // from the scan until the host has read the report
+    LATENCY_TRACE_STAGES
+} latency_trace_stage_t;
+
+#ifndef LATENCY_TRACE_HISTOGRAM_MIN_US
+#define LATENCY_TRACE_HISTOGRAM_MIN_US 125
+#endif
+
+// The first byte of raw HID reports for the tracer, which are like the profiler's
+#ifndef LATENCY_TRACE_RAW_HID_ID
+#define LATENCY_TRACE_RAW_HID_ID 0xF1
+#endif
+
+void latency_trace_init(void);
+void latency_trace_clear(void);
+
+// The time stamp of a key event, which is never 0
+uint32_t latency_trace_now(void);
+
+// Called around the processing of an event, with its time stamp
+void latency_trace_begin(uint32_t ticks);
+void latency_trace_end(void);
+// Called by host_keyboard_send before the report goes to the driver
+void latency_trace_report(const report_keyboard_t* report);
+// Called by the host driver when the report is in the endpoint
+void latency_trace_queued(void);
+// Called by the host driver when the host has read the report, also from an interrupt
+void latency_trace_sent(void);
+bool latency_trace_in_flight(void);
+// Implemented by host drivers that check for sent reports instead of calling
+// latency_trace_sent from an interrupt, called while a report is in flight
+void latency_trace_poll(void);
+// Takes the time of a sent report into the statistics
+void latency_trace_task(void);
+
+const profile_stats_t* latency_trace_get(latency_trace_stage_t stage);
+uint32_t latency_trace_bucket_limit(uint8_t bucket);
+// Events whose report couldn't be followed
+uint16_t latency_trace_dropped(void);
+
+void latency_trace_print(void);
+bool latency_trace_raw_hid_receive(uint8_t* data, uint8_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef LATENCY_TRACE_ENABLE
+#define LATENCY_TRACE_BEGIN(ticks) latency_trace_begin(ticks)
+#define LATENCY_TRACE_END() latency_trace_end()
+#define LATENCY_TRACE_REPORT(report) latency_trace_report(report)
+#define LATENCY_TRACE_QUEUED() latency_trace_queued()
+#define LATENCY_TRACE_SENT() latency_trace_sent()
+#define LATENCY_TRACE_TASK() latency_trace_task()
+#else
+#define LATENCY_TRACE_BEGIN(ticks)
+#define LATENCY_TRACE_END()
+#define LATENCY_TRACE_REPORT(report)
+#define LATENCY_TRACE_QUEUED()
+#define LATENCY_TRACE_SENT()
+#define LATENCY_TRACE_TASK()
+#endif
+
+#endif
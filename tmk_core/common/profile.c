@@ -0,0 +1,220 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "profile.h"
+#include "print.h"
+
+uint32_t profile_begin_ticks[PROFILE_POINTS];
+
+static profile_stats_t stats[PROFILE_POINTS];
+static uint8_t histogram_shift = 0;
+static bool loop_started = false;
+static uint32_t loop_ticks;
+
+uint8_t profile_histogram_shift(uint32_t min_us) {
+    // The first bucket is the smallest power of two ticks that covers min_us
+    uint32_t min_ticks = (uint64_t)profile_ticks_freq() * min_us / 1000000;
+    uint8_t shift = 0;
+    while (shift < 31 && ((uint32_t)1 << shift) < min_ticks) {
+        shift++;
+    }
+    return shift;
+}
+
+void profile_stats_clear(profile_stats_t* s) {
+    s->count = 0;
+    s->sum = 0;
+    s->min = UINT32_MAX;
+    s->max = 0;
+    for (uint8_t b = 0; b < PROFILE_HISTOGRAM_BUCKETS; b++) {
+        s->histogram[b] = 0;
+    }
+}
+
+void profile_stats_add(profile_stats_t* s, uint8_t shift, uint32_t ticks) {
+    s->count++;
+    s->sum += ticks;
+    if (ticks < s->min) {
+        s->min = ticks;
+    }
+    if (ticks > s->max) {
+        s->max = ticks;
+    }
+    uint32_t v = ticks >> shift;
+    uint8_t bucket = 0;
+    while (v && bucket < PROFILE_HISTOGRAM_BUCKETS - 1) {
+        v >>= 1;
+        bucket++;
+    }
+    if (s->histogram[bucket] != UINT16_MAX) {
+        s->histogram[bucket]++;
+    }
+}
+
+uint32_t profile_stats_average(const profile_stats_t* s) {
+    if (s->count == 0) {
+        return 0;
+    }
+    return s->sum / s->count;
+}
+
+uint32_t profile_histogram_limit(uint8_t shift, uint8_t bucket) {
+    if (bucket >= PROFILE_HISTOGRAM_BUCKETS - 1) {
+        return UINT32_MAX;
+    }
+    return (uint32_t)1 << (shift + bucket);
+}
+
+void profile_init(void) {
+    profile_ticks_init();
+    histogram_shift = profile_histogram_shift(PROFILE_HISTOGRAM_MIN_US);
+    profile_clear();
+}
+
+void profile_clear(void) {
+    for (uint8_t i = 0; i < PROFILE_POINTS; i++) {
+        profile_stats_clear(&stats[i]);
+    }
+    loop_started = false;
+}
+
+void profile_record(profile_point_t point, uint32_t ticks) {
+    profile_stats_add(&stats[point], histogram_shift, ticks);
+}
+
+void profile_loop(void) {
+    uint32_t now = profile_ticks();
+    if (loop_started) {
+        profile_record(PROFILE_LOOP, now - loop_ticks);
+    }
+    loop_ticks = now;
+    loop_started = true;
+}
+
+const profile_stats_t* profile_get(profile_point_t point) {
+    return &stats[point];
+}
+
+uint32_t profile_average(profile_point_t point) {
+    return profile_stats_average(&stats[point]);
+}
+
+uint32_t profile_bucket_limit(uint8_t bucket) {
+    return profile_histogram_limit(histogram_shift, bucket);
+}
+
+uint32_t profile_scan_rate(void) {
+    const profile_stats_t* s = &stats[PROFILE_LOOP];
+    if (s->sum == 0) {
+        return 0;
+    }
+    return (uint64_t)s->count * profile_ticks_freq() / s->sum;
+}
+
+uint32_t profile_ticks_to_us(uint32_t ticks) {
+    return (uint64_t)ticks * 1000000 / profile_ticks_freq();
+}
+
+// Prints what comes after the name
+void profile_stats_print(const profile_stats_t* s, uint8_t shift) {
+#ifndef NO_PRINT
+    xprintf(": %lu times, min %lu avg %lu max %lu us\n", s->count,
+        profile_ticks_to_us(s->count ? s->min : 0), profile_ticks_to_us(profile_stats_average(s)),
+        profile_ticks_to_us(s->max));
+    for (uint8_t b = 0; b < PROFILE_HISTOGRAM_BUCKETS - 1; b++) {
+        xprintf(" <%lu:%u", profile_ticks_to_us(profile_histogram_limit(shift, b)), s->histogram[b]);
+    }
+    xprintf(" more:%u\n", s->histogram[PROFILE_HISTOGRAM_BUCKETS - 1]);
+#endif
+}
+
+#ifndef NO_PRINT
+static void print_name(profile_point_t point) {
+    switch (point) {
+        case PROFILE_LOOP:          print("loop");              break;
+        case PROFILE_MATRIX_SCAN:   print("matrix_scan");       break;
+        case PROFILE_ACTION_EXEC:   print("action_exec");       break;
+        case PROFILE_SCAN_QUANTUM:  print("scan_quantum");      break;
+        case PROFILE_RGB_MATRIX:    print("rgb_matrix");        break;
+        case PROFILE_DEADLINES:     print("deadlines");         break;
+        case PROFILE_AUDIO:         print("audio");             break;
+        case PROFILE_KEYBOARD_SEND: print("keyboard_send");     break;
+        case PROFILE_USER:          print("user");              break;
+        default:                                                break;
+    }
+}
+#endif
+
+void profile_print(void) {
+#ifndef NO_PRINT
+    print("\n\t- Profile -\n");
+    xprintf("scans/s: %lu\n", profile_scan_rate());
+    for (uint8_t i = 0; i < PROFILE_POINTS; i++) {
+        if (stats[i].count == 0) {
+            continue;
+        }
+        print_name(i);
+        profile_stats_print(&stats[i], histogram_shift);
+    }
+#endif
+}
+
+static void put16(uint8_t* data, uint16_t value) {
+    data[0] = value & 0xFF;
+    data[1] = value >> 8;
+}
+
+static void put32(uint8_t* data, uint32_t value) {
+    put16(data, value & 0xFFFF);
+    put16(data + 2, value >> 16);
+}
+
+// Fills in the answer from data[4], for a stats or histogram request in data[1]
+void profile_stats_raw_hid(const profile_stats_t* s, uint8_t shift, uint8_t* data, uint8_t length) {
+    if (data[1] == PROFILE_RAW_HID_STATS && length >= 24) {
+        put32(data + 4, s->count);
+        put32(data + 8, s->count ? s->min : 0);
+        put32(data + 12, profile_stats_average(s));
+        put32(data + 16, s->max);
+        put32(data + 20, profile_ticks_freq());
+    } else if (data[1] == PROFILE_RAW_HID_HISTOGRAM && length >= 9) {
+        put32(data + 4, profile_histogram_limit(shift, 0));
+        data[8] = PROFILE_HISTOGRAM_BUCKETS;
+        for (uint8_t b = 0; b < PROFILE_HISTOGRAM_BUCKETS && 9 + b * 2 + 2 <= length; b++) {
+            put16(data + 9 + b * 2, s->histogram[b]);
+        }
+    }
+}
+
+bool profile_raw_hid_receive(uint8_t* data, uint8_t length) {
+    if (length < 4 || data[0] != PROFILE_RAW_HID_ID) {
+        return false;
+    }
+    uint8_t point = data[2];
+    if (data[1] == PROFILE_RAW_HID_CLEAR) {
+        profile_clear();
+        return true;
+    }
+    for (uint8_t i = 3; i < length; i++) {
+        data[i] = 0;
+    }
+    data[3] = PROFILE_POINTS;
+    if (point < PROFILE_POINTS) {
+        profile_stats_raw_hid(&stats[point], histogram_shift, data, length);
+    }
+    return true;
+}
@@ -0,0 +1,134 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Scan rate and latency profiler
+ *
+ * PROFILE_BEGIN and PROFILE_END around a piece of code measure how long it
+ * takes, in ticks of the platform's fastest free running counter. On ARM
+ * that is the cycle counter, or the ChibiOS system time on Cortex-M0. On AVR
+ * it's timer 0's count within the millisecond on top of timer_count, so a
+ * tick is 1/TIMER_RAW_FREQ, which is 4us at 16MHz. Each point keeps
+ * the count, min, average and max, and a histogram where every bucket is
+ * twice as wide as the previous, all in a fixed structure.
+ *
+ * PROFILE_LOOP measures the time between two calls, which is how long the
+ * whole main loop takes, and how many scans there are in a second.
+ *
+ * Enabled with PROFILE_ENABLE = yes. Otherwise the macros are empty, so they
+ * can stay in the code. The results are printed with Magic + P, or with
+ * profile_print, and can be read over raw HID with profile_raw_hid_receive.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    PROFILE_LOOP,
+    PROFILE_MATRIX_SCAN,
+    PROFILE_ACTION_EXEC,
+    PROFILE_SCAN_QUANTUM,
+    PROFILE_RGB_MATRIX,
+    PROFILE_DEADLINES,     // combo and tap dance timeouts
+    PROFILE_AUDIO,
+    PROFILE_KEYBOARD_SEND,
+    PROFILE_USER,          // free for the keyboard or keymap
+    PROFILE_POINTS
+} profile_point_t;
+
+#ifndef PROFILE_HISTOGRAM_BUCKETS
+#define PROFILE_HISTOGRAM_BUCKETS 8
+#endif
+
+// The upper limit of the first bucket, which is rounded up to a power of two ticks
+#ifndef PROFILE_HISTOGRAM_MIN_US
+#define PROFILE_HISTOGRAM_MIN_US 8
+#endif
+
+// The first byte of raw HID reports for the profiler
+#ifndef PROFILE_RAW_HID_ID
+#define PROFILE_RAW_HID_ID 0xF0
+#endif
+
+enum {
+    PROFILE_RAW_HID_STATS,     // count, min, avg and max in ticks, and the ticks per second
+    PROFILE_RAW_HID_HISTOGRAM, // the buckets, and the upper limit of the first in ticks
+    PROFILE_RAW_HID_CLEAR,
+};
+
+typedef struct {
+    uint32_t count;
+    uint64_t sum;
+    uint32_t min;
+    uint32_t max;
+    uint16_t histogram[PROFILE_HISTOGRAM_BUCKETS]; // saturated at UINT16_MAX
+} profile_stats_t;
+
+// Implemented by the platform, in profile_ticks.c
+void profile_ticks_init(void);
+uint32_t profile_ticks(void);
+uint32_t profile_ticks_freq(void);
+
+// Statistics that can be kept with another histogram scale, for other measurements
+uint8_t profile_histogram_shift(uint32_t min_us);
+void profile_stats_clear(profile_stats_t* stats);
+void profile_stats_add(profile_stats_t* stats, uint8_t shift, uint32_t ticks);
+uint32_t profile_stats_average(const profile_stats_t* stats);
+uint32_t profile_histogram_limit(uint8_t shift, uint8_t bucket);
+void profile_stats_print(const profile_stats_t* stats, uint8_t shift);
+void profile_stats_raw_hid(const profile_stats_t* stats, uint8_t shift, uint8_t* data, uint8_t length);
+
+void profile_init(void);
+void profile_clear(void);
+void profile_record(profile_point_t point, uint32_t ticks);
+void profile_loop(void);
+
+const profile_stats_t* profile_get(profile_point_t point);
+uint32_t profile_average(profile_point_t point);
+// The upper limit of a histogram bucket in ticks, UINT32_MAX for the last
+uint32_t profile_bucket_limit(uint8_t bucket);
+// Loops in a second, since profile_clear
+uint32_t profile_scan_rate(void);
+uint32_t profile_ticks_to_us(uint32_t ticks);
+
+void profile_print(void);
+// Answers the request in data, when it's for the profiler, and returns true.
+// The answer is written over the request, and should be sent back with raw_hid_send.
+bool profile_raw_hid_receive(uint8_t* data, uint8_t length);
+
+extern uint32_t profile_begin_ticks[PROFILE_POINTS];
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef PROFILE_ENABLE
+#define PROFILE_BEGIN(point) do { profile_begin_ticks[point] = profile_ticks(); } while (0)
+#define PROFILE_END(point) profile_record(point, profile_ticks() - profile_begin_ticks[point])
+#define PROFILE_LOOP() profile_loop()
+#else
+#define PROFILE_BEGIN(point)
+#define PROFILE_END(point)
+#define PROFILE_LOOP()
+#endif
+
+#endif
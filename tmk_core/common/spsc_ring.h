@@ -0,0 +1,131 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Single-producer, single-consumer ring buffer
+ *
+ * Hands data from an interrupt to the main loop, or the other way around,
+ * without disabling interrupts. The producer only writes the head and the
+ * consumer only writes the tail. Both are free-running 8-bit counters, so the
+ * size has to be a power of two, up to 128.
+ *
+ * SPSC_RING(name, type, size) defines the type name_t and these functions:
+ *   name_push, name_push_bulk                 for the producer
+ *   name_pop, name_pop_bulk, name_peek,
+ *   name_clear                                for the consumer
+ *   name_count, name_empty, name_full         for either side
+ *
+ * The ring also keeps the most items that were queued at once in high_water,
+ * and the number of items the producer had to drop, up to 255, in dropped.
+ */
+
+// Keeps the compiler from moving the buffer accesses across the index updates.
+// The producer and the consumer run on the same core, so this is enough.
+#define SPSC_RING_BARRIER() __asm__ __volatile__ ("" ::: "memory")
+
+// Called where the consumer can be interrupted by the producer, for the tests
+#ifndef SPSC_RING_PREEMPT
+#define SPSC_RING_PREEMPT()
+#endif
+
+#define SPSC_RING(name, type, size) \
+typedef char name##_size_check[(((size) & ((size) - 1)) == 0 && (size) <= 128) ? 1 : -1]; \
+\
+typedef struct { \
+    type buffer[size]; \
+    volatile uint8_t head; \
+    volatile uint8_t tail; \
+    uint8_t high_water; \
+    uint8_t dropped; \
+} name##_t; \
+\
+static inline uint8_t name##_count(const name##_t *ring) { \
+    return (uint8_t)(ring->head - ring->tail); \
+} \
+\
+static inline bool name##_empty(const name##_t *ring) { \
+    return ring->head == ring->tail; \
+} \
+\
+static inline bool name##_full(const name##_t *ring) { \
+    return name##_count(ring) == (size); \
+} \
+\
+static inline uint8_t name##_push_bulk(name##_t *ring, const type *items, uint8_t count) { \
+    uint8_t head = ring->head; \
+    uint8_t space = (size) - (uint8_t)(head - ring->tail); \
+    if (count > space) { \
+        uint8_t dropped = ring->dropped + (count - space); \
+        ring->dropped = dropped < ring->dropped ? 0xFF : dropped; \
+        count = space; \
+    } \
+    for (uint8_t i = 0; i < count; i++) { \
+        ring->buffer[(uint8_t)(head + i) & ((size) - 1)] = items[i]; \
+    } \
+    SPSC_RING_BARRIER(); \
+    ring->head = head + count; \
+    uint8_t used = (size) - space + count; \
+    if (used > ring->high_water) { \
+        ring->high_water = used; \
+    } \
+    return count; \
+} \
+\
+static inline bool name##_push(name##_t *ring, const type *item) { \
+    return name##_push_bulk(ring, item, 1) == 1; \
+} \
+\
+static inline uint8_t name##_pop_bulk(name##_t *ring, type *items, uint8_t count) { \
+    uint8_t tail = ring->tail; \
+    uint8_t available = (uint8_t)(ring->head - tail); \
+    SPSC_RING_BARRIER(); \
+    if (count > available) { \
+        count = available; \
+    } \
+    for (uint8_t i = 0; i < count; i++) { \
+        items[i] = ring->buffer[(uint8_t)(tail + i) & ((size) - 1)]; \
+        SPSC_RING_PREEMPT(); \
+    } \
+    SPSC_RING_BARRIER(); \
+    ring->tail = tail + count; \
+    return count; \
+} \
+\
+static inline bool name##_pop(name##_t *ring, type *item) { \
+    return name##_pop_bulk(ring, item, 1) == 1; \
+} \
+\
+static inline bool name##_peek(name##_t *ring, type *item) { \
+    uint8_t tail = ring->tail; \
+    if (ring->head == tail) { \
+        return false; \
+    } \
+    SPSC_RING_BARRIER(); \
+    *item = ring->buffer[tail & ((size) - 1)]; \
+    return true; \
+} \
+\
+static inline void name##_clear(name##_t *ring) { \
+    ring->tail = ring->head; \
+}
+
+#endif
@@ -0,0 +1,31 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "timer.h"
+#include "profile.h"
+
+// Microseconds of the fake timer, which only moves in milliseconds
+void profile_ticks_init(void) {
+}
+
+uint32_t profile_ticks(void) {
+    return timer_read32() * 1000;
+}
+
+uint32_t profile_ticks_freq(void) {
+    return 1000000;
+}
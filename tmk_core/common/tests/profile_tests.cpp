@@ -0,0 +1,218 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "gtest/gtest.h"
+
+extern "C" {
+    #include "profile.h"
+}
+
+// A fake counter at 1 MHz, so that a tick is a microsecond
+static uint32_t ticks = 0;
+static uint32_t ticks_freq = 1000000;
+
+extern "C" {
+    void profile_ticks_init(void) {}
+    uint32_t profile_ticks(void) { return ticks; }
+    uint32_t profile_ticks_freq(void) { return ticks_freq; }
+}
+
+class Profile : public testing::Test {
+public:
+    Profile() {
+        ticks = 0;
+        ticks_freq = 1000000;
+        profile_init();
+    }
+
+    void measure(profile_point_t point, uint32_t duration) {
+        PROFILE_BEGIN(point);
+        ticks += duration;
+        PROFILE_END(point);
+    }
+};
+
+TEST_F(Profile, StartsEmpty) {
+    for (int i = 0; i < PROFILE_POINTS; i++) {
+        const profile_stats_t* s = profile_get((profile_point_t)i);
+        EXPECT_EQ(s->count, 0);
+        EXPECT_EQ(s->max, 0);
+        EXPECT_EQ(profile_average((profile_point_t)i), 0);
+    }
+    EXPECT_EQ(profile_scan_rate(), 0);
+}
+
+TEST_F(Profile, KeepsMinAverageAndMax) {
+    measure(PROFILE_MATRIX_SCAN, 100);
+    measure(PROFILE_MATRIX_SCAN, 300);
+    measure(PROFILE_MATRIX_SCAN, 200);
+    const profile_stats_t* s = profile_get(PROFILE_MATRIX_SCAN);
+    EXPECT_EQ(s->count, 3);
+    EXPECT_EQ(s->min, 100);
+    EXPECT_EQ(s->max, 300);
+    EXPECT_EQ(profile_average(PROFILE_MATRIX_SCAN), 200);
+    EXPECT_EQ(profile_get(PROFILE_ACTION_EXEC)->count, 0);
+}
+
+TEST_F(Profile, NestedPointsAreMeasuredSeparately) {
+    PROFILE_BEGIN(PROFILE_MATRIX_SCAN);
+    ticks += 10;
+    measure(PROFILE_SCAN_QUANTUM, 40);
+    ticks += 5;
+    PROFILE_END(PROFILE_MATRIX_SCAN);
+    EXPECT_EQ(profile_get(PROFILE_MATRIX_SCAN)->max, 55);
+    EXPECT_EQ(profile_get(PROFILE_SCAN_QUANTUM)->max, 40);
+}
+
+TEST_F(Profile, WorksWhenTheCounterWraps) {
+    ticks = UINT32_MAX - 10;
+    measure(PROFILE_KEYBOARD_SEND, 30);
+    EXPECT_EQ(profile_get(PROFILE_KEYBOARD_SEND)->max, 30);
+}
+
+TEST_F(Profile, HistogramBucketsDouble) {
+    // The first bucket is below 8 us, and each one is twice as wide
+    EXPECT_EQ(profile_bucket_limit(0), 8);
+    EXPECT_EQ(profile_bucket_limit(1), 16);
+    EXPECT_EQ(profile_bucket_limit(PROFILE_HISTOGRAM_BUCKETS - 2), 8u << (PROFILE_HISTOGRAM_BUCKETS - 2));
+    EXPECT_EQ(profile_bucket_limit(PROFILE_HISTOGRAM_BUCKETS - 1), UINT32_MAX);
+
+    measure(PROFILE_USER, 0);
+    measure(PROFILE_USER, 7);
+    measure(PROFILE_USER, 8);
+    measure(PROFILE_USER, 15);
+    measure(PROFILE_USER, 16);
+    measure(PROFILE_USER, 100000);
+    const profile_stats_t* s = profile_get(PROFILE_USER);
+    EXPECT_EQ(s->histogram[0], 2);
+    EXPECT_EQ(s->histogram[1], 2);
+    EXPECT_EQ(s->histogram[2], 1);
+    EXPECT_EQ(s->histogram[PROFILE_HISTOGRAM_BUCKETS - 1], 1);
+}
+
+TEST_F(Profile, HistogramFollowsTheTickFrequency) {
+    // 4 us ticks, like AVR at 16 MHz, so the first bucket is 2 ticks
+    ticks_freq = 250000;
+    profile_init();
+    EXPECT_EQ(profile_bucket_limit(0), 2);
+    measure(PROFILE_USER, 1);
+    measure(PROFILE_USER, 2);
+    EXPECT_EQ(profile_get(PROFILE_USER)->histogram[0], 1);
+    EXPECT_EQ(profile_get(PROFILE_USER)->histogram[1], 1);
+    EXPECT_EQ(profile_ticks_to_us(profile_bucket_limit(0)), 8);
+}
+
+TEST_F(Profile, HistogramSaturates) {
+    for (uint32_t i = 0; i < UINT16_MAX + 10; i++) {
+        profile_record(PROFILE_USER, 1);
+    }
+    EXPECT_EQ(profile_get(PROFILE_USER)->histogram[0], UINT16_MAX);
+    EXPECT_EQ(profile_get(PROFILE_USER)->count, UINT16_MAX + 10);
+}
+
+TEST_F(Profile, LoopMeasuresTheTimeBetweenCalls) {
+    profile_loop();
+    EXPECT_EQ(profile_get(PROFILE_LOOP)->count, 0);
+    ticks += 500;
+    profile_loop();
+    ticks += 1500;
+    profile_loop();
+    const profile_stats_t* s = profile_get(PROFILE_LOOP);
+    EXPECT_EQ(s->count, 2);
+    EXPECT_EQ(s->min, 500);
+    EXPECT_EQ(s->max, 1500);
+    // Two loops in 2 ms
+    EXPECT_EQ(profile_scan_rate(), 1000);
+}
+
+TEST_F(Profile, ClearStartsAgain) {
+    measure(PROFILE_AUDIO, 50);
+    profile_loop();
+    ticks += 1000;
+    profile_clear();
+    EXPECT_EQ(profile_get(PROFILE_AUDIO)->count, 0);
+    EXPECT_EQ(profile_get(PROFILE_AUDIO)->histogram[3], 0);
+    // The loop that was going on when cleared isn't counted
+    ticks += 200;
+    profile_loop();
+    EXPECT_EQ(profile_get(PROFILE_LOOP)->count, 0);
+    ticks += 300;
+    profile_loop();
+    EXPECT_EQ(profile_get(PROFILE_LOOP)->max, 300);
+    measure(PROFILE_AUDIO, 10);
+    EXPECT_EQ(profile_get(PROFILE_AUDIO)->min, 10);
+}
+
+static uint32_t get32(const uint8_t* data) {
+    return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+TEST_F(Profile, RawHidIgnoresOtherReports) {
+    uint8_t data[32] = {0x01, PROFILE_RAW_HID_STATS, PROFILE_MATRIX_SCAN, 0xAA};
+    EXPECT_FALSE(profile_raw_hid_receive(data, sizeof(data)));
+    EXPECT_EQ(data[3], 0xAA);
+}
+
+TEST_F(Profile, RawHidSendsStats) {
+    ticks_freq = 72000000;
+    measure(PROFILE_MATRIX_SCAN, 1000);
+    measure(PROFILE_MATRIX_SCAN, 70000);
+    uint8_t data[32] = {PROFILE_RAW_HID_ID, PROFILE_RAW_HID_STATS, PROFILE_MATRIX_SCAN, 0xAA};
+    EXPECT_TRUE(profile_raw_hid_receive(data, sizeof(data)));
+    EXPECT_EQ(data[0], PROFILE_RAW_HID_ID);
+    EXPECT_EQ(data[3], PROFILE_POINTS);
+    EXPECT_EQ(get32(data + 4), 2);
+    EXPECT_EQ(get32(data + 8), 1000);
+    EXPECT_EQ(get32(data + 12), 35500);
+    EXPECT_EQ(get32(data + 16), 70000);
+    EXPECT_EQ(get32(data + 20), 72000000);
+}
+
+TEST_F(Profile, RawHidSendsZeroMinWhenNothingWasMeasured) {
+    uint8_t data[32] = {PROFILE_RAW_HID_ID, PROFILE_RAW_HID_STATS, PROFILE_AUDIO};
+    EXPECT_TRUE(profile_raw_hid_receive(data, sizeof(data)));
+    EXPECT_EQ(get32(data + 4), 0);
+    EXPECT_EQ(get32(data + 8), 0);
+}
+
+TEST_F(Profile, RawHidSendsTheHistogram) {
+    measure(PROFILE_ACTION_EXEC, 3);
+    measure(PROFILE_ACTION_EXEC, 20);
+    measure(PROFILE_ACTION_EXEC, 20);
+    uint8_t data[32] = {PROFILE_RAW_HID_ID, PROFILE_RAW_HID_HISTOGRAM, PROFILE_ACTION_EXEC};
+    EXPECT_TRUE(profile_raw_hid_receive(data, sizeof(data)));
+    EXPECT_EQ(get32(data + 4), 8);
+    EXPECT_EQ(data[8], PROFILE_HISTOGRAM_BUCKETS);
+    EXPECT_EQ(data[9] | (data[10] << 8), 1);
+    EXPECT_EQ(data[11] | (data[12] << 8), 0);
+    EXPECT_EQ(data[13] | (data[14] << 8), 2);
+}
+
+TEST_F(Profile, RawHidAnswersUnknownPointsWithTheNumberOfPoints) {
+    uint8_t data[32] = {PROFILE_RAW_HID_ID, PROFILE_RAW_HID_STATS, 0xFF, 0xAA, 0xAA};
+    EXPECT_TRUE(profile_raw_hid_receive(data, sizeof(data)));
+    EXPECT_EQ(data[3], PROFILE_POINTS);
+    EXPECT_EQ(get32(data + 4), 0);
+}
+
+TEST_F(Profile, RawHidClears) {
+    measure(PROFILE_MATRIX_SCAN, 100);
+    uint8_t data[32] = {PROFILE_RAW_HID_ID, PROFILE_RAW_HID_CLEAR};
+    EXPECT_TRUE(profile_raw_hid_receive(data, sizeof(data)));
+    EXPECT_EQ(profile_get(PROFILE_MATRIX_SCAN)->count, 0);
+}
@@ -0,0 +1,23 @@
+# Copyright 2026 agent <agent@local>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+spsc_ring_SRC := $(TMK_PATH)/common/tests/spsc_ring_tests.cpp
+spsc_ring_INC := $(TMK_PATH)/common
+
+profile_SRC := \
+	$(TMK_PATH)/common/tests/profile_tests.cpp \
+	$(TMK_PATH)/common/profile.c
+profile_INC := $(TMK_PATH)/common
+profile_DEFS := -DPROFILE_ENABLE -DNO_PRINT
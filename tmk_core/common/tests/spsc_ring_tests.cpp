@@ -0,0 +1,193 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "gtest/gtest.h"
+#include <cstring>
+#include <deque>
+#include <random>
+#include <vector>
+
+// Lets the simulated interrupt run in the middle of the consumer
+static void (*interrupt)(void) = nullptr;
+#define SPSC_RING_PREEMPT() do { if (interrupt) interrupt(); } while (0)
+
+extern "C" {
+    #include "spsc_ring.h"
+}
+
+SPSC_RING(byte_ring, uint8_t, 8)
+SPSC_RING(word_ring, uint16_t, 16)
+
+class SpscRing : public testing::Test {
+public:
+    SpscRing() {
+        memset(&bytes, 0, sizeof(bytes));
+        memset(&words, 0, sizeof(words));
+        interrupt = nullptr;
+    }
+    ~SpscRing() {
+        interrupt = nullptr;
+    }
+    byte_ring_t bytes;
+    word_ring_t words;
+};
+
+TEST_F(SpscRing, StartsEmpty) {
+    uint8_t item;
+    EXPECT_TRUE(byte_ring_empty(&bytes));
+    EXPECT_FALSE(byte_ring_full(&bytes));
+    EXPECT_EQ(byte_ring_count(&bytes), 0);
+    EXPECT_FALSE(byte_ring_pop(&bytes, &item));
+    EXPECT_FALSE(byte_ring_peek(&bytes, &item));
+}
+
+TEST_F(SpscRing, ItemsComeOutInOrder) {
+    for (uint8_t i = 1; i <= 5; i++) {
+        EXPECT_TRUE(byte_ring_push(&bytes, &i));
+    }
+    EXPECT_EQ(byte_ring_count(&bytes), 5);
+    uint8_t item;
+    EXPECT_TRUE(byte_ring_peek(&bytes, &item));
+    EXPECT_EQ(item, 1);
+    for (uint8_t i = 1; i <= 5; i++) {
+        EXPECT_TRUE(byte_ring_pop(&bytes, &item));
+        EXPECT_EQ(item, i);
+    }
+    EXPECT_TRUE(byte_ring_empty(&bytes));
+}
+
+TEST_F(SpscRing, UsesTheWholeBuffer) {
+    for (uint8_t i = 0; i < 8; i++) {
+        EXPECT_TRUE(byte_ring_push(&bytes, &i));
+    }
+    EXPECT_TRUE(byte_ring_full(&bytes));
+    uint8_t item = 8;
+    EXPECT_FALSE(byte_ring_push(&bytes, &item));
+    EXPECT_EQ(bytes.dropped, 1);
+    EXPECT_EQ(bytes.high_water, 8);
+    EXPECT_TRUE(byte_ring_pop(&bytes, &item));
+    EXPECT_EQ(item, 0);
+}
+
+TEST_F(SpscRing, CountsDroppedItemsUpTo255) {
+    uint8_t items[8] = {0};
+    byte_ring_push_bulk(&bytes, items, 8);
+    for (int i = 0; i < 40; i++) {
+        EXPECT_EQ(byte_ring_push_bulk(&bytes, items, 8), 0);
+    }
+    EXPECT_EQ(bytes.dropped, 255);
+}
+
+TEST_F(SpscRing, BulkOperationsWrapAround) {
+    uint8_t in[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint8_t out[8];
+    EXPECT_EQ(byte_ring_push_bulk(&bytes, in, 6), 6);
+    EXPECT_EQ(byte_ring_pop_bulk(&bytes, out, 4), 4);
+    EXPECT_EQ(out[3], 4);
+    // Only six fit, the rest are dropped
+    EXPECT_EQ(byte_ring_push_bulk(&bytes, in, 8), 6);
+    EXPECT_EQ(bytes.dropped, 2);
+    EXPECT_EQ(byte_ring_pop_bulk(&bytes, out, 8), 8);
+    uint8_t expected[8] = {5, 6, 1, 2, 3, 4, 5, 6};
+    for (int i = 0; i < 8; i++) {
+        EXPECT_EQ(out[i], expected[i]);
+    }
+    EXPECT_EQ(bytes.high_water, 8);
+}
+
+TEST_F(SpscRing, HighWaterKeepsTheMaximum) {
+    uint8_t in[3] = {0};
+    uint8_t out[3];
+    byte_ring_push_bulk(&bytes, in, 3);
+    byte_ring_pop_bulk(&bytes, out, 3);
+    byte_ring_push_bulk(&bytes, in, 2);
+    EXPECT_EQ(bytes.high_water, 3);
+}
+
+TEST_F(SpscRing, ClearDiscardsEverything) {
+    uint8_t in[3] = {0};
+    byte_ring_push_bulk(&bytes, in, 3);
+    byte_ring_clear(&bytes);
+    EXPECT_TRUE(byte_ring_empty(&bytes));
+    EXPECT_EQ(byte_ring_push_bulk(&bytes, in, 3), 3);
+    EXPECT_EQ(byte_ring_count(&bytes), 3);
+}
+
+// Numbers the items the interrupt sends, and remembers the ones that fit
+static std::mt19937 random_engine;
+static word_ring_t* isr_ring;
+static uint16_t next_value;
+static std::deque<uint16_t> accepted;
+static unsigned attempted;
+static unsigned dropped;
+
+static void isr_producer(void) {
+    if (random_engine() % 4 != 0) {
+        return;
+    }
+    uint16_t items[20];
+    uint8_t count = random_engine() % 20 + 1;
+    for (uint8_t i = 0; i < count; i++) {
+        items[i] = next_value++;
+    }
+    attempted += count;
+    uint8_t pushed = word_ring_push_bulk(isr_ring, items, count);
+    accepted.insert(accepted.end(), items, items + pushed);
+    dropped += count - pushed;
+    EXPECT_EQ(isr_ring->dropped, dropped < 255 ? dropped : 255);
+}
+
+TEST_F(SpscRing, FuzzWithAnInterruptProducer) {
+    random_engine.seed(1234);
+    isr_ring = &words;
+    next_value = 0;
+    accepted.clear();
+    attempted = 0;
+    dropped = 0;
+    unsigned total_dropped = 0;
+    interrupt = isr_producer;
+
+    unsigned received = 0;
+    for (int i = 0; i < 100000; i++) {
+        isr_producer();
+        uint16_t out[20];
+        uint8_t wanted = random_engine() % 20 + 1;
+        uint8_t count = word_ring_pop_bulk(&words, out, wanted);
+        ASSERT_LE(count, 16);
+        for (uint8_t j = 0; j < count; j++) {
+            ASSERT_FALSE(accepted.empty());
+            ASSERT_EQ(out[j], accepted.front());
+            accepted.pop_front();
+        }
+        received += count;
+        // Drops are only counted up to 255, start over every time
+        total_dropped += dropped;
+        dropped = 0;
+        words.dropped = 0;
+    }
+    interrupt = nullptr;
+    uint16_t out[16];
+    uint8_t count = word_ring_pop_bulk(&words, out, 16);
+    for (uint8_t j = 0; j < count; j++) {
+        ASSERT_EQ(out[j], accepted.front());
+        accepted.pop_front();
+    }
+    received += count;
+    EXPECT_TRUE(accepted.empty());
+    EXPECT_EQ(received + total_dropped, attempted);
+    EXPECT_EQ(words.high_water, 16);
+}
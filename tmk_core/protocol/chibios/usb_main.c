@@ -30,6 +30,7 @@
 #include "wait.h"
 #include "usb_descriptor.h"
 #include "usb_driver.h"
+#include "latency_trace.h"
 
 #ifdef NKRO_ENABLE
   #include "keycode_config.h"
@@ -592,17 +593,17 @@ void init_usb_driver(USBDriver *usbp) {
  */
 /* keyboard IN callback hander (a kbd report has made it IN) */
 void kbd_in_cb(USBDriver *usbp, usbep_t ep) {
-  /* STUB */
   (void)usbp;
   (void)ep;
+  LATENCY_TRACE_SENT();
 }
 
 #ifdef NKRO_ENABLE
 /* nkro IN callback hander (a nkro report has made it IN) */
 void nkro_in_cb(USBDriver *usbp, usbep_t ep) {
-  /* STUB */
   (void)usbp;
   (void)ep;
+  LATENCY_TRACE_SENT();
 }
 #endif /* NKRO_ENABLE */
 
@@ -676,6 +677,7 @@ void send_keyboard(report_keyboard_t *report) {
       osalThreadSuspendS(&(&USB_DRIVER)->epc[NKRO_IN_EPNUM]->in_state->thread);
     }
     usbStartTransmitI(&USB_DRIVER, NKRO_IN_EPNUM, (uint8_t *)report, sizeof(report_keyboard_t));
+    LATENCY_TRACE_QUEUED();
     osalSysUnlock();
   } else
 #endif /* NKRO_ENABLE */
@@ -691,6 +693,7 @@ void send_keyboard(report_keyboard_t *report) {
       osalThreadSuspendS(&(&USB_DRIVER)->epc[KEYBOARD_IN_EPNUM]->in_state->thread);
     }
     usbStartTransmitI(&USB_DRIVER, KEYBOARD_IN_EPNUM, (uint8_t *)report, KEYBOARD_EPSIZE);
+    LATENCY_TRACE_QUEUED();
     osalSysUnlock();
   }
   keyboard_report_sent = *report;
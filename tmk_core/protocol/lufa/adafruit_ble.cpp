@@ -8,7 +8,7 @@
 #include "pincontrol.h"
 #include "timer.h"
 #include "action_util.h"
-#include "ringbuffer.hpp"
+#include "spsc_ring.h"
 #include <string.h>
 
 // These are the pin assignments for the 32u4 boards.
@@ -93,11 +93,13 @@ struct queue_item {
 };
 
 // Items that we wish to send
-static RingBuffer<queue_item, 40> send_buf;
+SPSC_RING(send_ring, struct queue_item, 32)
+static send_ring_t send_buf;
 // Pending response; while pending, we can't send any more requests.
 // This records the time at which we sent the command for which we
 // are expecting a response.
-static RingBuffer<uint16_t, 2> resp_buf;
+SPSC_RING(resp_ring, uint16_t, 1)
+static resp_ring_t resp_buf;
 
 static bool process_queue_item(struct queue_item *item, uint16_t timeout);
 
@@ -316,7 +318,7 @@ static bool sdep_recv_pkt(struct sdep_msg *msg, uint16_t timeout) {
 
 static void resp_buf_read_one(bool greedy) {
   uint16_t last_send;
-  if (!resp_buf.peek(last_send)) {
+  if (!resp_ring_peek(&resp_buf, &last_send)) {
     return;
   }
 
@@ -327,21 +329,21 @@ again:
     if (sdep_recv_pkt(&msg, SdepTimeout)) {
       if (!msg.more) {
         // We got it; consume this entry
-        resp_buf.get(last_send);
+        resp_ring_pop(&resp_buf, &last_send);
         dprintf("recv latency %dms\n", TIMER_DIFF_16(timer_read(), last_send));
       }
 
-      if (greedy && resp_buf.peek(last_send) && digitalRead(AdafruitBleIRQPin)) {
+      if (greedy && resp_ring_peek(&resp_buf, &last_send) && digitalRead(AdafruitBleIRQPin)) {
         goto again;
       }
     }
 
   } else if (timer_elapsed(last_send) > SdepTimeout * 2) {
     dprintf("waiting_for_result: timeout, resp_buf size %d\n",
-            (int)resp_buf.size());
+            (int)resp_ring_count(&resp_buf));
 
     // Timed out: consume this entry
-    resp_buf.get(last_send);
+    resp_ring_pop(&resp_buf, &last_send);
   }
 }
 
@@ -349,17 +351,17 @@ static void send_buf_send_one(uint16_t timeout = SdepTimeout) {
   struct queue_item item;
 
   // Don't send anything more until we get an ACK
-  if (!resp_buf.empty()) {
+  if (!resp_ring_empty(&resp_buf)) {
     return;
   }
 
-  if (!send_buf.peek(item)) {
+  if (!send_ring_peek(&send_buf, &item)) {
     return;
   }
   if (process_queue_item(&item, timeout)) {
     // commit that peek
-    send_buf.get(item);
-    dprintf("send_buf_send_one: have %d remaining\n", (int)send_buf.size());
+    send_ring_pop(&send_buf, &item);
+    dprintf("send_buf_send_one: have %d remaining\n", (int)send_ring_count(&send_buf));
   } else {
     dprint("failed to send, will retry\n");
     _delay_ms(SdepTimeout);
@@ -369,7 +371,7 @@ static void send_buf_send_one(uint16_t timeout = SdepTimeout) {
 
 static void resp_buf_wait(const char *cmd) {
   bool didPrint = false;
-  while (!resp_buf.empty()) {
+  while (!resp_ring_empty(&resp_buf)) {
     if (!didPrint) {
       dprintf("wait on buf for %s\n", cmd);
       didPrint = true;
@@ -498,7 +500,7 @@ static bool at_command(const char *cmd, char *resp, uint16_t resplen,
 
   if (resp == NULL) {
     auto now = timer_read();
-    while (!resp_buf.enqueue(now)) {
+    while (!resp_ring_push(&resp_buf, &now)) {
       resp_buf_read_one(false);
     }
     auto later = timer_read();
@@ -609,7 +611,7 @@ void adafruit_ble_task(void) {
   resp_buf_read_one(true);
   send_buf_send_one(SdepShortTimeout);
 
-  if (resp_buf.empty() && (state.event_flags & UsingEvents) &&
+  if (resp_ring_empty(&resp_buf) && (state.event_flags & UsingEvents) &&
       digitalRead(AdafruitBleIRQPin)) {
     // Must be an event update
     if (at_command_P(PSTR("AT+EVENTSTATUS"), resbuf, sizeof(resbuf))) {
@@ -657,7 +659,7 @@ void adafruit_ble_task(void) {
   // voltage level always seems to be around 3200mV.  We may want to just rip
   // this code out.
   if (timer_elapsed(state.last_battery_update) > BatteryUpdateInterval &&
-      resp_buf.empty()) {
+      resp_ring_empty(&resp_buf)) {
     state.last_battery_update = timer_read();
 
     if (at_command_P(PSTR("AT+HWVBAT"), resbuf, sizeof(resbuf))) {
@@ -740,7 +742,7 @@ bool adafruit_ble_send_keys(uint8_t hid_modifier_mask, uint8_t *keys,
     item.key.keys[4] = nkeys >= 4 ? keys[4] : 0;
     item.key.keys[5] = nkeys >= 5 ? keys[5] : 0;
 
-    if (!send_buf.enqueue(item)) {
+    if (!send_ring_push(&send_buf, &item)) {
       if (!didWait) {
         dprint("wait for buf space\n");
         didWait = true;
@@ -766,7 +768,7 @@ bool adafruit_ble_send_consumer_key(uint16_t keycode, int hold_duration) {
   item.queue_type = QTConsumer;
   item.consumer = keycode;
 
-  while (!send_buf.enqueue(item)) {
+  while (!send_ring_push(&send_buf, &item)) {
     send_buf_send_one();
   }
   return true;
@@ -784,7 +786,7 @@ bool adafruit_ble_send_mouse_move(int8_t x, int8_t y, int8_t scroll,
   item.mousemove.pan = pan;
   item.mousemove.buttons = buttons;
 
-  while (!send_buf.enqueue(item)) {
+  while (!send_ring_push(&send_buf, &item)) {
     send_buf_send_one();
   }
   return true;
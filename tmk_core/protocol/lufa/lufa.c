@@ -90,6 +90,12 @@
 	#include "raw_hid.h"
 #endif
 
+#ifdef LATENCY_TRACE_ENABLE
+  #include "latency_trace.h"
+
+  static uint8_t latency_endpoint;
+#endif
+
 uint8_t keyboard_idle = 0;
 /* 0: Boot Protocol, 1: Report Protocol(default) */
 uint8_t keyboard_protocol = 1;
@@ -659,9 +665,29 @@ static void send_keyboard(report_keyboard_t *report)
 
     /* Finalize the stream transfer to send the last packet */
     Endpoint_ClearIN();
+#ifdef LATENCY_TRACE_ENABLE
+    latency_endpoint = Endpoint_GetCurrentEndpoint();
+    latency_trace_queued();
+#endif
 
     keyboard_report_sent = *report;
 }
+
+#ifdef LATENCY_TRACE_ENABLE
+/** \brief Latency trace poll
+ *
+ * The bank of the keyboard endpoint is free again when the host has read the report
+ */
+void latency_trace_poll(void)
+{
+    uint8_t ep = Endpoint_GetCurrentEndpoint();
+    Endpoint_SelectEndpoint(latency_endpoint);
+    if (Endpoint_IsINReady()) {
+        latency_trace_sent();
+    }
+    Endpoint_SelectEndpoint(ep);
+}
+#endif
  
 /** \brief Send Mouse
  *
@@ -23,14 +23,32 @@
 #define NULL 0
 #endif
 
+//an input queue entry with up to three bytes of a stream, the count is in the low bits
+#define INPUT_BYTES 0x10
+
+//USB-MIDI code index numbers
+#define CIN_SYS_COMMON_2 0x2
+#define CIN_SYS_COMMON_3 0x3
+#define CIN_SYSEX_START_OR_CONT 0x4
+#define CIN_SYSEX_ENDS_IN_1 0x5 //also single byte system common
+#define CIN_SYSEX_ENDS_IN_2 0x6
+#define CIN_SYSEX_ENDS_IN_3 0x7
+#define CIN_NOTEOFF 0x8
+#define CIN_PITCHBEND 0xE
+#define CIN_SINGLE_BYTE 0xF
+
+//the number of queued packets midi_device_process takes at a time
+#define INPUT_BATCH_SIZE 8
+
 //forward declarations, internally used to call the callbacks
 void midi_input_callbacks(MidiDevice * device, uint16_t cnt, uint8_t byte0, uint8_t byte1, uint8_t byte2);
 void midi_process_byte(MidiDevice * device, uint8_t input);
+static void midi_process_packet(MidiDevice * device, uint8_t event, uint8_t * data);
 
 void midi_device_init(MidiDevice * device){
   device->input_state = IDLE;
   device->input_count = 0;
-  bytequeue_init(&device->input_queue, device->input_queue_data, MIDI_INPUT_QUEUE_LENGTH);
+  midi_input_queue_clear(&device->input_queue);
 
   //three byte funcs
   device->input_cc_callback = NULL;
@@ -58,10 +76,28 @@ void midi_device_init(MidiDevice * device){
   device->pre_input_process_callback = NULL;
 }
 
+bool midi_device_input_full(MidiDevice * device) {
+  return midi_input_queue_full(&device->input_queue);
+}
+
+static bool input_queue_push(MidiDevice * device, uint8_t event, uint8_t byte0, uint8_t byte1, uint8_t byte2) {
+  midi_event_packet_t packet = {event, {byte0, byte1, byte2}};
+  return midi_input_queue_push(&device->input_queue, &packet);
+}
+
 void midi_device_input(MidiDevice * device, uint8_t cnt, uint8_t * input) {
   uint8_t i;
-  for (i = 0; i < cnt; i++)
-    bytequeue_enqueue(&device->input_queue, input[i]);
+  for (i = 0; i < cnt; i += 3) {
+    uint8_t left = cnt - i;
+    if (left > 3)
+      left = 3;
+    input_queue_push(device, INPUT_BYTES | left,
+        input[i], left > 1 ? input[i + 1] : 0, left > 2 ? input[i + 2] : 0);
+  }
+}
+
+bool midi_device_input_packet(MidiDevice * device, uint8_t event, uint8_t byte0, uint8_t byte1, uint8_t byte2) {
+  return input_queue_push(device, event & 0x0F, byte0, byte1, byte2);
 }
 
 void midi_device_set_send_func(MidiDevice * device, midi_var_byte_func_t send_func){
@@ -77,17 +113,84 @@ void midi_device_process(MidiDevice * device) {
   if(device->pre_input_process_callback)
     device->pre_input_process_callback(device);
 
-  //pull stuff off the queue and process
-  byteQueueIndex_t len = bytequeue_length(&device->input_queue);
-  uint16_t i;
-  //TODO limit number of bytes processed?
-  for(i = 0; i < len; i++) {
-    uint8_t val = bytequeue_get(&device->input_queue, 0);
-    midi_process_byte(device, val);
-    bytequeue_remove(&device->input_queue, 1);
+  //process what is queued in batches
+  midi_event_packet_t packets[INPUT_BATCH_SIZE];
+  uint8_t count;
+  while ((count = midi_input_queue_pop_bulk(&device->input_queue, packets, INPUT_BATCH_SIZE))) {
+    uint8_t i;
+    for (i = 0; i < count; i++) {
+      midi_event_packet_t * packet = &packets[i];
+      if (packet->event & INPUT_BYTES) {
+        uint8_t j;
+        for (j = 0; j < (packet->event & 0x03); j++)
+          midi_process_byte(device, packet->data[j]);
+      } else {
+        midi_process_packet(device, packet->event, packet->data);
+      }
+    }
   }
 }
 
+static void midi_process_packet(MidiDevice * device, uint8_t event, uint8_t * data) {
+  uint8_t cnt;
+  switch (event) {
+    case CIN_SYSEX_START_OR_CONT:
+      if (data[0] == SYSEX_BEGIN)
+        device->input_count = 0;
+      else if (device->input_state != SYSEX_MESSAGE)
+        return;
+      device->input_state = SYSEX_MESSAGE;
+      device->input_count += 3;
+      midi_input_callbacks(device, device->input_count, data[0], data[1], data[2]);
+      return;
+    case CIN_SYSEX_ENDS_IN_1:
+      if (data[0] != SYSEX_END) {
+        cnt = 1;
+        break;
+      }
+      //fall through
+    case CIN_SYSEX_ENDS_IN_2:
+    case CIN_SYSEX_ENDS_IN_3:
+      if (data[0] == SYSEX_BEGIN)
+        device->input_count = 0;
+      else if (device->input_state != SYSEX_MESSAGE)
+        return;
+      device->input_state = SYSEX_MESSAGE;
+      device->input_count += event - CIN_SYSEX_ENDS_IN_1 + 1;
+      midi_input_callbacks(device, device->input_count, data[0], data[1], data[2]);
+      device->input_state = IDLE;
+      device->input_count = 0;
+      return;
+    case CIN_SINGLE_BYTE:
+      {
+        //like realtime bytes, these don't interrupt a sysex
+        input_state_t state = device->input_state;
+        device->input_state = ONE_BYTE_MESSAGE;
+        midi_input_callbacks(device, 1, data[0], 0, 0);
+        device->input_state = state;
+      }
+      return;
+    case CIN_SYS_COMMON_2:
+      cnt = 2;
+      break;
+    case CIN_SYS_COMMON_3:
+      cnt = 3;
+      break;
+    case CIN_NOTEOFF ... CIN_PITCHBEND:
+      cnt = midi_packet_length(data[0]);
+      if (cnt == UNDEFINED)
+        return;
+      break;
+    default:
+      return;
+  }
+
+  device->input_state = (input_state_t)cnt;
+  midi_input_callbacks(device, cnt, data[0], data[1], data[2]);
+  device->input_state = IDLE;
+  device->input_count = 0;
+}
+
 void midi_process_byte(MidiDevice * device, uint8_t input) {
   if (midi_is_realtime(input)) {
     //call callback, store and restore state
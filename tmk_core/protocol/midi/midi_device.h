@@ -48,8 +48,13 @@ extern "C" {
  */
 
 #include "midi_function_types.h"
-#include "bytequeue/bytequeue.h"
-#define MIDI_INPUT_QUEUE_LENGTH 192
+#include "spsc_ring.h"
+
+//the number of packets in the input queue, a power of two up to 128
+#ifndef MIDI_INPUT_QUEUE_LENGTH
+#define MIDI_INPUT_QUEUE_LENGTH 32
+#endif
+
 
 typedef enum {
    IDLE, 
@@ -60,6 +65,17 @@ typedef enum {
 
 typedef void (* midi_no_byte_func_t)(MidiDevice * device);
 
+/**
+ * @brief An entry in the input queue, a USB-MIDI event packet without the
+ * cable number, or up to three bytes of a MIDI stream.
+ */
+typedef struct {
+   uint8_t event;
+   uint8_t data[3];
+} midi_event_packet_t;
+
+SPSC_RING(midi_input_queue, midi_event_packet_t, MIDI_INPUT_QUEUE_LENGTH)
+
 /**
  * \struct _midi_device
  *
@@ -108,8 +124,7 @@ struct _midi_device {
    uint16_t input_count;
 
    //for queueing data between the input and the processing functions
-   uint8_t input_queue_data[MIDI_INPUT_QUEUE_LENGTH];
-   byteQueue_t input_queue;
+   midi_input_queue_t input_queue;
 };
 
 /**
@@ -124,6 +139,27 @@ struct _midi_device {
  */
 void midi_device_input(MidiDevice * device, uint8_t cnt, uint8_t * input);
 
+/**
+ * @brief Process an input USB-MIDI event packet. The packet is parsed as a
+ * whole, from its code index number, instead of byte by byte.
+ *
+ * @param device the midi device to associate the input with
+ * @param event the first byte of the packet, the cable number is ignored
+ * @param byte0 the first MIDI byte of the packet
+ * @param byte1 the second MIDI byte of the packet
+ * @param byte2 the third MIDI byte of the packet
+ * @return false if the input queue is full, and the packet was dropped
+ */
+bool midi_device_input_packet(MidiDevice * device, uint8_t event, uint8_t byte0, uint8_t byte1, uint8_t byte2);
+
+/**
+ * @brief Check if the input queue is full. A device can leave its input where
+ * it is until midi_device_process has made room.
+ *
+ * @param device the midi device to check
+ */
+bool midi_device_input_full(MidiDevice * device);
+
 /**
  * @brief Set the callback function that will be used for sending output
  * data bytes.  This is only used if you're creating a custom device.
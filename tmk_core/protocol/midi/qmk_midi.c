@@ -77,29 +77,9 @@ static void usb_send_func(MidiDevice * device, uint16_t cnt, uint8_t byte0, uint
 
 static void usb_get_midi(MidiDevice * device) {
   MIDI_EventPacket_t event;
-  while (recv_midi_packet(&event)) {
-
-    midi_packet_length_t length = midi_packet_length(event.Data1);
-    uint8_t input[3];
-    input[0] = event.Data1;
-    input[1] = event.Data2;
-    input[2] = event.Data3;
-    if (length == UNDEFINED) {
-      //sysex
-      if (event.Event == MIDI_EVENT(0, SYSEX_START_OR_CONT) || event.Event == MIDI_EVENT(0, SYSEX_ENDS_IN_3)) {
-        length = 3;
-      } else if (event.Event == MIDI_EVENT(0, SYSEX_ENDS_IN_2)) {
-        length = 2;
-      } else if(event.Event ==  MIDI_EVENT(0, SYSEX_ENDS_IN_1)) {
-        length = 1;
-      } else {
-        //XXX what to do?
-      }
-    }
-
-    //pass the data to the device input function
-    if (length != UNDEFINED)
-      midi_device_input(device, length, input);
+  //what doesn't fit in the input queue stays in the endpoint until the next time
+  while (!midi_device_input_full(device) && recv_midi_packet(&event)) {
+    midi_device_input_packet(device, event.Event, event.Data1, event.Data2, event.Data3);
   }
 }
 
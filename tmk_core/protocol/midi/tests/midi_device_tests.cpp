@@ -0,0 +1,281 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "gtest/gtest.h"
+#include <array>
+#include <cstdio>
+#include <string>
+#include <vector>
+extern "C" {
+    #include "midi.h"
+}
+
+typedef std::vector<uint8_t> stream_t;
+typedef std::array<uint8_t, 4> packet_t;
+
+static std::vector<std::string> events;
+
+static void log_event(const char* name, int count, uint8_t byte0, uint8_t byte1 = 0, uint8_t byte2 = 0) {
+    char event[32];
+    const char* format[] = {"%s %02X", "%s %02X %02X", "%s %02X %02X %02X"};
+    snprintf(event, sizeof(event), format[count - 1], name, byte0, byte1, byte2);
+    events.push_back(event);
+}
+
+#define LOG_THREE(name) [](MidiDevice*, uint8_t b0, uint8_t b1, uint8_t b2) { log_event(name, 3, b0, b1, b2); }
+#define LOG_TWO(name) [](MidiDevice*, uint8_t b0, uint8_t b1) { log_event(name, 2, b0, b1); }
+#define LOG_ONE(name) [](MidiDevice*, uint8_t b0) { log_event(name, 1, b0); }
+
+// Converts a MIDI byte stream to USB-MIDI packets, like a host does
+static std::vector<packet_t> to_packets(const stream_t& stream) {
+    std::vector<packet_t> packets;
+    std::vector<uint8_t> message;
+    uint8_t status = 0;
+    bool sysex = false;
+
+    auto emit = [&](uint8_t cin) {
+        packet_t packet = {cin, 0, 0, 0};
+        std::copy(message.begin(), message.end(), packet.begin() + 1);
+        packets.push_back(packet);
+        message.clear();
+    };
+
+    for (uint8_t byte : stream) {
+        if (midi_is_realtime(byte)) {
+            packets.push_back({0x0F, byte, 0, 0});
+        } else if (byte == SYSEX_BEGIN) {
+            sysex = true;
+            status = 0;
+            message = {byte};
+        } else if (sysex) {
+            message.push_back(byte);
+            if (byte == SYSEX_END) {
+                emit(0x04 + message.size());
+                sysex = false;
+            } else if (message.size() == 3) {
+                emit(0x04);
+            }
+        } else if (midi_is_statusbyte(byte)) {
+            message = {byte};
+            status = byte < 0xF0 ? byte : 0;
+            if (midi_packet_length(byte) == ONE) {
+                emit(0x05);
+            }
+        } else if (status || !message.empty()) {
+            if (message.empty()) {
+                message = {status};
+            }
+            message.push_back(byte);
+            if (message.size() == midi_packet_length(message[0])) {
+                uint8_t status_byte = message[0];
+                if (status_byte < 0xF0) {
+                    emit(status_byte >> 4);
+                } else {
+                    emit(message.size() == 2 ? 0x02 : 0x03);
+                }
+            }
+        }
+    }
+    return packets;
+}
+
+class MidiDeviceTest : public testing::Test {
+public:
+    MidiDeviceTest() {
+        events.clear();
+        midi_device_init(&device);
+        midi_register_noteon_callback(&device, LOG_THREE("noteon"));
+        midi_register_noteoff_callback(&device, LOG_THREE("noteoff"));
+        midi_register_cc_callback(&device, LOG_THREE("cc"));
+        midi_register_aftertouch_callback(&device, LOG_THREE("aftertouch"));
+        midi_register_pitchbend_callback(&device, LOG_THREE("pitchbend"));
+        midi_register_songposition_callback(&device, LOG_THREE("songposition"));
+        midi_register_progchange_callback(&device, LOG_TWO("progchange"));
+        midi_register_chanpressure_callback(&device, LOG_TWO("chanpressure"));
+        midi_register_songselect_callback(&device, LOG_TWO("songselect"));
+        midi_register_tc_quarterframe_callback(&device, LOG_TWO("quarterframe"));
+        midi_register_realtime_callback(&device, LOG_ONE("realtime"));
+        midi_register_tunerequest_callback(&device, LOG_ONE("tunerequest"));
+        midi_register_sysex_callback(&device, [](MidiDevice*, uint16_t start, uint8_t length, uint8_t* data) {
+            std::string event = "sysex " + std::to_string(start);
+            for (int i = 0; i < length; i++) {
+                char byte[4];
+                snprintf(byte, sizeof(byte), " %02X", data[i]);
+                event += byte;
+            }
+            events.push_back(event);
+        });
+    }
+
+    // Replays the bytes in chunks, processing whenever the queue is full
+    std::vector<std::string> replay_bytes(const stream_t& stream, size_t chunk) {
+        events.clear();
+        for (size_t i = 0; i < stream.size(); i += chunk) {
+            if (midi_device_input_full(&device)) {
+                midi_device_process(&device);
+            }
+            uint8_t size = std::min(chunk, stream.size() - i);
+            midi_device_input(&device, size, const_cast<uint8_t*>(&stream[i]));
+        }
+        midi_device_process(&device);
+        return events;
+    }
+
+    std::vector<std::string> replay_packets(const std::vector<packet_t>& packets) {
+        events.clear();
+        for (auto& packet : packets) {
+            if (midi_device_input_full(&device)) {
+                midi_device_process(&device);
+            }
+            EXPECT_TRUE(midi_device_input_packet(&device, packet[0], packet[1], packet[2], packet[3]));
+        }
+        midi_device_process(&device);
+        return events;
+    }
+
+    // Checks that the stream gives the expected events, both as bytes and as packets
+    void expect_replay(const stream_t& stream, const std::vector<std::string>& expected) {
+        for (size_t chunk = 1; chunk <= 3; chunk++) {
+            EXPECT_EQ(replay_bytes(stream, chunk), expected) << "in chunks of " << chunk;
+        }
+        EXPECT_EQ(replay_packets(to_packets(stream)), expected) << "as packets";
+    }
+
+    MidiDevice device;
+};
+
+TEST_F(MidiDeviceTest, ChannelMessages) {
+    expect_replay({0x91, 0x3C, 0x40, 0x81, 0x3C, 0x00, 0xB2, 0x07, 0x64, 0xC3, 0x05, 0xD4, 0x20, 0xE5, 0x00, 0x40}, {
+        "noteon 01 3C 40",
+        "noteoff 01 3C 00",
+        "cc 02 07 64",
+        "progchange 03 05",
+        "chanpressure 04 20",
+        "pitchbend 05 00 40",
+    });
+}
+
+TEST_F(MidiDeviceTest, RunningStatus) {
+    expect_replay({0x90, 0x3C, 0x40, 0x3E, 0x40, 0x40, 0x00, 0xC0, 0x01, 0x02}, {
+        "noteon 00 3C 40",
+        "noteon 00 3E 40",
+        "noteon 00 40 00",
+        "progchange 00 01",
+        "progchange 00 02",
+    });
+}
+
+TEST_F(MidiDeviceTest, SystemCommon) {
+    expect_replay({0xF2, 0x10, 0x20, 0xF3, 0x04, 0xF1, 0x35, 0xF6}, {
+        "songposition F2 10 20",
+        "songselect F3 04",
+        "quarterframe F1 35",
+        "tunerequest F6",
+    });
+}
+
+TEST_F(MidiDeviceTest, Sysex) {
+    expect_replay({0xF0, 0x7E, 0x7F, 0x06, 0x01, 0xF7}, {
+        "sysex 0 F0 7E 7F",
+        "sysex 3 06 01 F7",
+    });
+}
+
+TEST_F(MidiDeviceTest, SysexOfAllLengths) {
+    expect_replay({0xF0, 0xF7, 0xF0, 0x01, 0xF7, 0xF0, 0x01, 0x02, 0xF7, 0xF0, 0x01, 0x02, 0x03, 0xF7}, {
+        "sysex 0 F0 F7",
+        "sysex 0 F0 01 F7",
+        "sysex 0 F0 01 02",
+        "sysex 3 F7",
+        "sysex 0 F0 01 02",
+        "sysex 3 03 F7",
+    });
+}
+
+TEST_F(MidiDeviceTest, RealtimeInsideOtherMessages) {
+    expect_replay({0x90, 0xF8, 0x3C, 0x40, 0xF0, 0x01, 0xFA, 0x02, 0x03, 0xFC, 0xF7, 0x3E, 0xFE}, {
+        "realtime F8",
+        "noteon 00 3C 40",
+        "realtime FA",
+        "sysex 0 F0 01 02",
+        "realtime FC",
+        "sysex 3 03 F7",
+        "realtime FE",
+    });
+}
+
+// A capture of a keyboard playing a chord with the sustain pedal and the
+// pitch wheel, with clock running and a device inquiry in the middle
+static const stream_t capture = {
+    0xFA, 0xF8, 0x90, 0x3C, 0x64, 0x40, 0x62, 0xF8, 0x43, 0x60, 0xB0, 0x40, 0x7F,
+    0xE0, 0x00, 0x40, 0x10, 0x40, 0xF8, 0x20, 0x40, 0xF0, 0x7E, 0x7F, 0x06, 0xF8,
+    0x01, 0xF7, 0x80, 0x3C, 0x00, 0x40, 0x00, 0x43, 0x00, 0xF8, 0xB0, 0x40, 0x00,
+    0xA0, 0x3C, 0x10, 0xF8, 0xFC,
+};
+
+TEST_F(MidiDeviceTest, ReplayCapture) {
+    expect_replay(capture, {
+        "realtime FA",
+        "realtime F8",
+        "noteon 00 3C 64",
+        "noteon 00 40 62",
+        "realtime F8",
+        "noteon 00 43 60",
+        "cc 00 40 7F",
+        "pitchbend 00 00 40",
+        "pitchbend 00 10 40",
+        "realtime F8",
+        "pitchbend 00 20 40",
+        "sysex 0 F0 7E 7F",
+        "realtime F8",
+        "sysex 3 06 01 F7",
+        "noteoff 00 3C 00",
+        "noteoff 00 40 00",
+        "noteoff 00 43 00",
+        "realtime F8",
+        "cc 00 40 00",
+        "aftertouch 00 3C 10",
+        "realtime F8",
+        "realtime FC",
+    });
+}
+
+TEST_F(MidiDeviceTest, ReplayCaptureWithoutProcessingUntilTheQueueIsFull) {
+    std::vector<std::string> first = replay_bytes(capture, 3);
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(replay_bytes(capture, 3), first);
+    }
+}
+
+TEST_F(MidiDeviceTest, PacketsAreDroppedWhenTheQueueIsFull) {
+    for (int i = 0; i < MIDI_INPUT_QUEUE_LENGTH; i++) {
+        EXPECT_FALSE(midi_device_input_full(&device));
+        EXPECT_TRUE(midi_device_input_packet(&device, 0x09, 0x90, i, 0x40));
+    }
+    EXPECT_TRUE(midi_device_input_full(&device));
+    EXPECT_FALSE(midi_device_input_packet(&device, 0x09, 0x90, 0x7F, 0x40));
+    midi_device_process(&device);
+    EXPECT_EQ(events.size(), MIDI_INPUT_QUEUE_LENGTH);
+    EXPECT_EQ(events.back(), "noteon 00 1F 40");
+    EXPECT_FALSE(midi_device_input_full(&device));
+}
+
+TEST_F(MidiDeviceTest, TheCableNumberIsIgnored) {
+    EXPECT_TRUE(midi_device_input_packet(&device, 0x39, 0x90, 0x3C, 0x40));
+    midi_device_process(&device);
+    EXPECT_EQ(events, std::vector<std::string>({"noteon 00 3C 40"}));
+}
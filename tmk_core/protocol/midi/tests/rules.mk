@@ -0,0 +1,24 @@
+# Copyright 2026 agent <agent@local>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+MIDI_PATH = $(TMK_PATH)/protocol/midi
+
+midi_device_SRC := \
+	$(MIDI_PATH)/tests/midi_device_tests.cpp \
+	$(MIDI_PATH)/midi_device.c \
+	$(MIDI_PATH)/midi.c
+
+midi_device_INC := $(MIDI_PATH)
+midi_device_INC += $(TMK_PATH)/common
@@ -91,6 +91,38 @@ uint8_t ps2_host_send(uint8_t data);
 uint8_t ps2_host_recv_response(void);
 uint8_t ps2_host_recv(void);
 void ps2_host_set_led(uint8_t usb_led);
+/* drops the bytes that nothing has read */
+void ps2_host_flush(void);
+
+/*
+ * Stream mode packets, with PS2_USE_INT and PS2_USE_USART
+ *
+ * After ps2_host_set_packet_size, the interrupt assembles packets of that
+ * many bytes into a queue, which keeps the number of packets it had to drop.
+ * Size 0 turns it off.
+ */
+#define PS2_PACKET_MAX 4
+#ifndef PS2_PACKET_QUEUE_SIZE
+#define PS2_PACKET_QUEUE_SIZE 8
+#endif
+// A quiet time in ms that ends a packet, longer than between the bytes of one
+#ifndef PS2_PACKET_GAP
+#define PS2_PACKET_GAP 5
+#endif
+
+typedef struct {
+    uint8_t data[PS2_PACKET_MAX];
+} ps2_packet_t;
+
+void ps2_host_set_packet_size(uint8_t size);
+bool ps2_host_peek_packet(ps2_packet_t *packet);
+bool ps2_host_recv_packet(ps2_packet_t *packet);
+uint8_t ps2_host_packets_dropped(void);
+
+/* for the drivers, returns false when the byte isn't part of a packet */
+bool ps2_packet_receive(uint8_t data);
+void ps2_packet_pause(bool pause);
+void ps2_packet_error(void);
 
 
 /*--------------------------------------------------------------------
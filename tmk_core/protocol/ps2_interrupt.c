@@ -45,6 +45,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "ps2.h"
 #include "ps2_io.h"
 #include "print.h"
+#include "spsc_ring.h"
 
 
 #define WAIT(stat, us, err) do { \
@@ -61,7 +62,6 @@ uint8_t ps2_error = PS2_ERR_NONE;
 static inline uint8_t pbuf_dequeue(void);
 static inline void pbuf_enqueue(uint8_t data);
 static inline bool pbuf_has_data(void);
-static inline void pbuf_clear(void);
 
 
 void ps2_host_init(void)
@@ -79,6 +79,7 @@ uint8_t ps2_host_send(uint8_t data)
     ps2_error = PS2_ERR_NONE;
 
     PS2_INT_OFF();
+    ps2_packet_pause(true);
 
     /* terminate a transmission if we have */
     inhibit();
@@ -122,10 +123,13 @@ uint8_t ps2_host_send(uint8_t data)
 
     idle();
     PS2_INT_ON();
-    return ps2_host_recv_response();
+    uint8_t response = ps2_host_recv_response();
+    ps2_packet_pause(false);
+    return response;
 ERROR:
     idle();
     PS2_INT_ON();
+    ps2_packet_pause(false);
     return 0;
 }
 
@@ -202,7 +206,9 @@ ISR(PS2_INT_VECT)
         case STOP:
             if (!data_in())
                 goto ERROR;
-            pbuf_enqueue(data);
+            if (!ps2_packet_receive(data)) {
+                pbuf_enqueue(data);
+            }
             goto DONE;
             break;
         default:
@@ -211,6 +217,7 @@ ISR(PS2_INT_VECT)
     goto RETURN;
 ERROR:
     ps2_error = state;
+    ps2_packet_error();
 DONE:
     state = INIT;
     data = 0;
@@ -231,49 +238,27 @@ void ps2_host_set_led(uint8_t led)
  * Ring buffer to store scan codes from keyboard
  *------------------------------------------------------------------*/
 #define PBUF_SIZE 32
-static uint8_t pbuf[PBUF_SIZE];
-static uint8_t pbuf_head = 0;
-static uint8_t pbuf_tail = 0;
+SPSC_RING(pbuf_ring, uint8_t, PBUF_SIZE)
+static pbuf_ring_t pbuf;
 static inline void pbuf_enqueue(uint8_t data)
 {
-    uint8_t sreg = SREG;
-    cli();
-    uint8_t next = (pbuf_head + 1) % PBUF_SIZE;
-    if (next != pbuf_tail) {
-        pbuf[pbuf_head] = data;
-        pbuf_head = next;
-    } else {
+    if (!pbuf_ring_push(&pbuf, &data)) {
         print("pbuf: full\n");
     }
-    SREG = sreg;
 }
 static inline uint8_t pbuf_dequeue(void)
 {
     uint8_t val = 0;
-
-    uint8_t sreg = SREG;
-    cli();
-    if (pbuf_head != pbuf_tail) {
-        val = pbuf[pbuf_tail];
-        pbuf_tail = (pbuf_tail + 1) % PBUF_SIZE;
-    }
-    SREG = sreg;
-
+    pbuf_ring_pop(&pbuf, &val);
     return val;
 }
 static inline bool pbuf_has_data(void)
 {
-    uint8_t sreg = SREG;
-    cli();
-    bool has_data = (pbuf_head != pbuf_tail);
-    SREG = sreg;
-    return has_data;
+    return !pbuf_ring_empty(&pbuf);
 }
-static inline void pbuf_clear(void)
+
+void ps2_host_flush(void)
 {
-    uint8_t sreg = SREG;
-    cli();
-    pbuf_head = pbuf_tail = 0;
-    SREG = sreg;
+    pbuf_ring_clear(&pbuf);
 }
 
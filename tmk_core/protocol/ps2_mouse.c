@@ -28,13 +28,23 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 /* ============================= MACROS ============================ */
 
+/* the interrupt driven hosts collect stream mode packets */
+#if defined(PS2_USE_INT) || defined(PS2_USE_USART)
+#define PS2_MOUSE_USE_PACKETS
+#endif
+
 static report_mouse_t mouse_report = {};
+static uint8_t ps2_mouse_packet_size = 3;
 
 static inline void ps2_mouse_print_report(report_mouse_t *mouse_report);
 static inline void ps2_mouse_convert_report_to_hid(report_mouse_t *mouse_report);
 static inline void ps2_mouse_clear_report(report_mouse_t *mouse_report);
 static inline void ps2_mouse_enable_scrolling(void);
 static inline void ps2_mouse_scroll_button_task(report_mouse_t *mouse_report);
+static inline void ps2_mouse_update_packets(void);
+#ifdef PS2_MOUSE_USE_PACKETS
+static void ps2_mouse_stream_task(void);
+#endif
 
 /* ============================= IMPLEMENTATION ============================ */
 
@@ -63,6 +73,7 @@ void ps2_mouse_init(void) {
     ps2_mouse_set_scaling_2_1();
 #endif
 
+    ps2_mouse_update_packets();
     ps2_mouse_init_user();
 }
 
@@ -74,6 +85,13 @@ void ps2_mouse_task(void) {
     static uint8_t buttons_prev = 0;
     extern int tp_buttons;
 
+#ifdef PS2_MOUSE_USE_PACKETS
+    if (PS2_MOUSE_STREAM_MODE == ps2_mouse_mode) {
+        ps2_mouse_stream_task();
+        return;
+    }
+#endif
+
     /* receives packet from mouse */
     uint8_t rcv;
     rcv = ps2_host_send(PS2_MOUSE_READ_DATA);
@@ -122,11 +140,13 @@ void ps2_mouse_enable_data_reporting(void) {
 void ps2_mouse_set_remote_mode(void) {
     PS2_MOUSE_SEND_SAFE(PS2_MOUSE_SET_REMOTE_MODE, "ps2 mouse set remote mode");
     ps2_mouse_mode = PS2_MOUSE_REMOTE_MODE;
+    ps2_mouse_update_packets();
 }
 
 void ps2_mouse_set_stream_mode(void) {
     PS2_MOUSE_SEND_SAFE(PS2_MOUSE_SET_STREAM_MODE, "ps2 mouse set stream mode");
     ps2_mouse_mode = PS2_MOUSE_STREAM_MODE;
+    ps2_mouse_update_packets();
 }
 
 void ps2_mouse_set_scaling_2_1(void) {
@@ -205,6 +225,11 @@ static inline void ps2_mouse_enable_scrolling(void) {
     PS2_MOUSE_SEND(PS2_MOUSE_SET_SAMPLE_RATE, "Set sample rate");
     PS2_MOUSE_SEND(80, "80");
     PS2_MOUSE_SEND(PS2_MOUSE_GET_DEVICE_ID, "Finished enabling scroll wheel");
+    // a wheel mouse answers with ID 3, or 4 with five buttons, and sends 4 byte packets
+    uint8_t id = ps2_host_recv_response();
+    if (id == 3 || id == 4) {
+        ps2_mouse_packet_size = 4;
+    }
     _delay_ms(20);
 }
 
@@ -257,3 +282,100 @@ static inline void ps2_mouse_scroll_button_task(report_mouse_t *mouse_report) {
 
     RELEASE_SCROLL_BUTTONS;
 }
+
+static inline void ps2_mouse_update_packets(void) {
+#ifdef PS2_MOUSE_USE_PACKETS
+    if (PS2_MOUSE_STREAM_MODE == ps2_mouse_mode) {
+        ps2_host_set_packet_size(ps2_mouse_packet_size);
+        // Movement that came before is left over from the commands, not a response
+        ps2_host_flush();
+    } else {
+        ps2_host_set_packet_size(0);
+    }
+#endif
+}
+
+#ifdef PS2_MOUSE_USE_PACKETS
+/* 9-bit movement of a packet, with overflow as the largest value */
+static inline int16_t ps2_mouse_packet_axis(uint8_t status, uint8_t value, uint8_t sign, uint8_t overflow) {
+    if (status & (1<<overflow)) {
+        return (status & (1<<sign)) ? -256 : 255;
+    }
+    return (status & (1<<sign)) ? (int16_t)value - 256 : value;
+}
+
+static inline int8_t ps2_mouse_take(int16_t *value) {
+    int8_t part = *value < -127 ? -127 : (*value > 127 ? 127 : *value);
+    *value -= part;
+    return part;
+}
+
+/* Sends the movement of all the packets that came in since the last call as
+ * one report. A button change ends the report, so that every press and release
+ * gets to the host, and movement that doesn't fit is left for the next one.
+ */
+static void ps2_mouse_stream_task(void) {
+    extern int tp_buttons;
+    static int16_t x = 0, y = 0, v = 0;
+    static uint8_t buttons = 0;
+    static uint8_t buttons_sent = 0;
+    static uint8_t dropped = 0;
+    ps2_packet_t packet;
+
+    while (ps2_host_peek_packet(&packet)) {
+        uint8_t packet_buttons = packet.data[0] & PS2_MOUSE_BTN_MASK;
+        if (packet_buttons != buttons && (x || y || v)) {
+            // send the movement with the old buttons first
+            break;
+        }
+        ps2_host_recv_packet(&packet);
+#ifdef PS2_MOUSE_DEBUG_RAW
+        if (debug_mouse) {
+            xprintf("ps2_mouse: [%02X|%02X %02X %02X]\n", packet.data[0], packet.data[1], packet.data[2], packet.data[3]);
+        }
+#endif
+        int16_t dx = ps2_mouse_packet_axis(packet.data[0], packet.data[1], PS2_MOUSE_X_SIGN, PS2_MOUSE_X_OVFLW);
+        int16_t dy = ps2_mouse_packet_axis(packet.data[0], packet.data[2], PS2_MOUSE_Y_SIGN, PS2_MOUSE_Y_OVFLW);
+#ifdef PS2_MOUSE_INVERT_X
+        dx = -dx;
+#endif
+#ifndef PS2_MOUSE_INVERT_Y // NOTE if not!
+        // invert coordinate of y to conform to USB HID mouse
+        dy = -dy;
+#endif
+        x += dx * PS2_MOUSE_X_MULTIPLIER;
+        y += dy * PS2_MOUSE_Y_MULTIPLIER;
+        if (ps2_mouse_packet_size == 4) {
+            v -= (int8_t)(packet.data[3] & PS2_MOUSE_SCROLL_MASK) * PS2_MOUSE_V_MULTIPLIER;
+        }
+        if (packet_buttons != buttons) {
+            buttons = packet_buttons;
+            break;
+        }
+    }
+
+    uint8_t packets_dropped = ps2_host_packets_dropped();
+    if (packets_dropped != dropped) {
+        if (debug_mouse) xprintf("ps2_mouse: %u packets dropped\n", (uint8_t)(packets_dropped - dropped));
+        dropped = packets_dropped;
+    }
+
+    uint8_t report_buttons = buttons | tp_buttons;
+    if (!x && !y && !v && !((report_buttons ^ buttons_sent) & PS2_MOUSE_BTN_MASK)) {
+        return;
+    }
+    buttons_sent = report_buttons;
+    mouse_report.buttons = report_buttons;
+    mouse_report.x = ps2_mouse_take(&x);
+    mouse_report.y = ps2_mouse_take(&y);
+    mouse_report.v = ps2_mouse_take(&v);
+#if PS2_MOUSE_SCROLL_BTN_MASK
+    ps2_mouse_scroll_button_task(&mouse_report);
+#endif
+#ifdef PS2_MOUSE_DEBUG_HID
+    ps2_mouse_print_report(&mouse_report);
+#endif
+    host_mouse_send(&mouse_report);
+    ps2_mouse_clear_report(&mouse_report);
+}
+#endif
@@ -0,0 +1,105 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Stream mode packets for the interrupt driven PS/2 hosts
+ *
+ * Once the mouse is in stream mode, the interrupt puts the bytes together
+ * into packets, so that the main loop only sees whole ones. While a command
+ * is sent the bytes go to the driver's buffer as before.
+ *
+ * A packet has no start marker besides the sync bit, which any other byte can
+ * have too. So a packet is also started over when the mouse has been quiet for
+ * PS2_PACKET_GAP ms, the bytes of a packet come right after each other.
+ */
+
+#include <stdbool.h>
+#include "ps2.h"
+#include "spsc_ring.h"
+#include "timer.h"
+
+// Always set in the first byte of a mouse packet
+#define PACKET_SYNC_BIT 0x08
+
+SPSC_RING(packet_ring, ps2_packet_t, PS2_PACKET_QUEUE_SIZE)
+
+static packet_ring_t packets;
+static ps2_packet_t packet;
+static uint8_t packet_size;
+static uint8_t position;
+static uint16_t last_byte;
+static volatile bool paused;
+
+void ps2_host_set_packet_size(uint8_t size)
+{
+    paused = true;
+    position = 0;
+    packet_size = size < PS2_PACKET_MAX ? size : PS2_PACKET_MAX;
+    packet_ring_clear(&packets);
+    paused = false;
+}
+
+bool ps2_host_peek_packet(ps2_packet_t *p)
+{
+    return packet_ring_peek(&packets, p);
+}
+
+bool ps2_host_recv_packet(ps2_packet_t *p)
+{
+    return packet_ring_pop(&packets, p);
+}
+
+uint8_t ps2_host_packets_dropped(void)
+{
+    return packets.dropped;
+}
+
+void ps2_packet_pause(bool pause)
+{
+    // The interrupt leaves the position alone while paused
+    paused = true;
+    position = 0;
+    paused = pause;
+}
+
+bool ps2_packet_receive(uint8_t data)
+{
+    if (!packet_size || paused) {
+        return false;
+    }
+    uint16_t now = timer_read();
+    if (position != 0 && TIMER_DIFF_16(now, last_byte) >= PS2_PACKET_GAP) {
+        // The rest of the packet was lost
+        position = 0;
+    }
+    last_byte = now;
+    if (position == 0 && !(data & PACKET_SYNC_BIT)) {
+        // Not the start of a packet, wait for one
+        return true;
+    }
+    packet.data[position++] = data;
+    if (position == packet_size) {
+        packet_ring_push(&packets, &packet);
+        position = 0;
+    }
+    return true;
+}
+
+void ps2_packet_error(void)
+{
+    position = 0;
+}
@@ -40,6 +40,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <avr/interrupt.h>
 #include <util/delay.h>
 #include "serial.h"
+#include "spsc_ring.h"
 
 /*
  *  Stupid Inefficient Busy-wait Software Serial
@@ -88,32 +89,23 @@ void serial_init(void)
 
 /* RX ring buffer */
 #define RBUF_SIZE   8
-static uint8_t rbuf[RBUF_SIZE];
-static uint8_t rbuf_head = 0;
-static uint8_t rbuf_tail = 0;
+SPSC_RING(rbuf_ring, uint8_t, RBUF_SIZE)
+static rbuf_ring_t rbuf;
 
 
 uint8_t serial_recv(void)
 {
     uint8_t data = 0;
-    if (rbuf_head == rbuf_tail) {
-        return 0;
-    }
-
-    data = rbuf[rbuf_tail];
-    rbuf_tail = (rbuf_tail + 1) % RBUF_SIZE;
+    rbuf_ring_pop(&rbuf, &data);
     return data;
 }
 
 int16_t serial_recv2(void)
 {
-    uint8_t data = 0;
-    if (rbuf_head == rbuf_tail) {
+    uint8_t data;
+    if (!rbuf_ring_pop(&rbuf, &data)) {
         return -1;
     }
-
-    data = rbuf[rbuf_tail];
-    rbuf_tail = (rbuf_tail + 1) % RBUF_SIZE;
     return data;
 }
 
@@ -225,15 +217,10 @@ ISR(SERIAL_SOFT_RXD_VECT)
     /* to center of stop bit */
     _delay_us(WAIT_US);
 
-    uint8_t next = (rbuf_head + 1) % RBUF_SIZE;
 #if defined(SERIAL_SOFT_PARITY_EVEN) || defined(SERIAL_SOFT_PARITY_ODD)
-    if ((parity == SERIAL_SOFT_PARITY_VAL) && next != rbuf_tail) {
-#else
-    if (next != rbuf_tail) {
+    if (parity == SERIAL_SOFT_PARITY_VAL)
 #endif
-        rbuf[rbuf_head] = data;
-        rbuf_head = next;
-    }
+    rbuf_ring_push(&rbuf, &data);
 
     SERIAL_SOFT_RXD_INT_EXIT();
     SERIAL_SOFT_DEBUG_TGL();
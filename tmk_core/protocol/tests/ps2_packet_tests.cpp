@@ -0,0 +1,152 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "gtest/gtest.h"
+#include <vector>
+
+extern "C" {
+    #include "ps2.h"
+}
+
+static uint16_t fake_time = 0;
+
+extern "C" uint16_t timer_read(void) {
+    return fake_time;
+}
+
+typedef std::vector<uint8_t> bytes;
+
+class PS2Packet : public testing::Test {
+public:
+    PS2Packet() {
+        fake_time = 0;
+        ps2_packet_pause(false);
+        ps2_host_set_packet_size(3);
+    }
+    // Like the interrupt, one byte per ms
+    void receive(const bytes& data) {
+        for (uint8_t b : data) {
+            EXPECT_TRUE(ps2_packet_receive(b));
+            fake_time++;
+        }
+    }
+    std::vector<bytes> packets() {
+        std::vector<bytes> result;
+        ps2_packet_t packet;
+        while (ps2_host_recv_packet(&packet)) {
+            result.push_back(bytes(packet.data, packet.data + 3));
+        }
+        return result;
+    }
+};
+
+TEST_F(PS2Packet, PutsTheBytesTogether) {
+    receive({0x08, 0x01, 0x02, 0x09, 0x03, 0x04});
+    EXPECT_EQ(packets(), std::vector<bytes>({{0x08, 0x01, 0x02}, {0x09, 0x03, 0x04}}));
+}
+
+TEST_F(PS2Packet, WaitsForAWholePacket) {
+    receive({0x08, 0x01});
+    EXPECT_TRUE(packets().empty());
+    receive({0x02});
+    EXPECT_EQ(packets().size(), 1);
+}
+
+TEST_F(PS2Packet, PeekLeavesThePacketInTheQueue) {
+    receive({0x08, 0x01, 0x02});
+    ps2_packet_t packet;
+    EXPECT_TRUE(ps2_host_peek_packet(&packet));
+    EXPECT_EQ(packet.data[1], 0x01);
+    EXPECT_EQ(packets().size(), 1);
+}
+
+TEST_F(PS2Packet, BytesAreNotPacketsWhenTheSizeIsZero) {
+    ps2_host_set_packet_size(0);
+    EXPECT_FALSE(ps2_packet_receive(0x08));
+    EXPECT_TRUE(packets().empty());
+}
+
+TEST_F(PS2Packet, FourBytePackets) {
+    ps2_host_set_packet_size(4);
+    receive({0x08, 0x01, 0x02, 0x0F, 0x18});
+    ps2_packet_t packet;
+    EXPECT_TRUE(ps2_host_recv_packet(&packet));
+    EXPECT_EQ(bytes(packet.data, packet.data + 4), bytes({0x08, 0x01, 0x02, 0x0F}));
+    EXPECT_FALSE(ps2_host_recv_packet(&packet));
+}
+
+TEST_F(PS2Packet, SkipsBytesWithoutTheSyncBitAtTheStart) {
+    receive({0x01, 0x02, 0x08, 0x03, 0x04});
+    EXPECT_EQ(packets(), std::vector<bytes>({{0x08, 0x03, 0x04}}));
+}
+
+TEST_F(PS2Packet, StartsOverAfterAQuietTime) {
+    // The last byte of a packet was lost, and the next one has the sync bit
+    receive({0x08, 0x01});
+    fake_time += PS2_PACKET_GAP;
+    receive({0x09, 0x18, 0x02});
+    EXPECT_EQ(packets(), std::vector<bytes>({{0x09, 0x18, 0x02}}));
+}
+
+TEST_F(PS2Packet, AShortPauseIsStillTheSamePacket) {
+    receive({0x08, 0x01});
+    fake_time += PS2_PACKET_GAP - 2;
+    receive({0x02});
+    EXPECT_EQ(packets(), std::vector<bytes>({{0x08, 0x01, 0x02}}));
+}
+
+TEST_F(PS2Packet, TheQuietTimeWorksWhenTheTimerWraps) {
+    fake_time = 65534;
+    receive({0x08, 0x01});
+    fake_time += PS2_PACKET_GAP;
+    receive({0x09, 0x18, 0x02});
+    EXPECT_EQ(packets(), std::vector<bytes>({{0x09, 0x18, 0x02}}));
+}
+
+TEST_F(PS2Packet, AnErrorStartsOver) {
+    receive({0x08, 0x01});
+    ps2_packet_error();
+    receive({0x09, 0x03, 0x04});
+    EXPECT_EQ(packets(), std::vector<bytes>({{0x09, 0x03, 0x04}}));
+}
+
+TEST_F(PS2Packet, BytesGoToTheDriverWhilePaused) {
+    receive({0x08, 0x01});
+    ps2_packet_pause(true);
+    EXPECT_FALSE(ps2_packet_receive(0xFA));
+    ps2_packet_pause(false);
+    receive({0x09, 0x03, 0x04});
+    EXPECT_EQ(packets(), std::vector<bytes>({{0x09, 0x03, 0x04}}));
+}
+
+TEST_F(PS2Packet, CountsThePacketsThatDidNotFit) {
+    uint8_t dropped = ps2_host_packets_dropped();
+    for (int i = 0; i < PS2_PACKET_QUEUE_SIZE + 2; i++) {
+        receive({0x08, (uint8_t)i, 0x00});
+    }
+    EXPECT_EQ((uint8_t)(ps2_host_packets_dropped() - dropped), 2);
+    std::vector<bytes> received = packets();
+    ASSERT_EQ(received.size(), PS2_PACKET_QUEUE_SIZE);
+    EXPECT_EQ(received[0][1], 0);
+}
+
+TEST_F(PS2Packet, SettingTheSizeDropsWhatWasQueued) {
+    receive({0x08, 0x01, 0x02, 0x08, 0x03});
+    ps2_host_set_packet_size(3);
+    receive({0x04});
+    EXPECT_TRUE(packets().empty());
+}
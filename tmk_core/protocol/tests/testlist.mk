@@ -0,0 +1,2 @@
+TEST_LIST +=\
+	ps2_packet
@@ -0,0 +1,462 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <string.h>
+#include "nkro_merge.h"
+#include "spsc_ring.h"
+#include "util.h"
+
+#define USAGE_PAGE_KEYBOARD 0x07
+// The keyboard reports these in every array item when too many keys are held
+#define USAGE_ERROR_ROLLOVER 0x01
+#define USAGE_ERROR_UNDEFINED 0x03
+
+#define KEY_BYTES 32
+#define KEY_BIT(code) (1 << ((code) & 7))
+
+// Report descriptor items, see the HID specification 6.2.2
+#define ITEM_SIZE(prefix) ((prefix) & 0x03)
+#define ITEM_TYPE(prefix) (((prefix) >> 2) & 0x03)
+#define ITEM_TAG(prefix)  ((prefix) >> 4)
+#define ITEM_LONG 0xFE
+
+enum {
+    TYPE_MAIN,
+    TYPE_GLOBAL,
+    TYPE_LOCAL,
+};
+
+#define MAIN_INPUT 0x08
+#define MAIN_OUTPUT 0x09
+#define MAIN_FEATURE 0x0B
+#define GLOBAL_USAGE_PAGE 0x00
+#define GLOBAL_LOGICAL_MIN 0x01
+#define GLOBAL_LOGICAL_MAX 0x02
+#define GLOBAL_REPORT_SIZE 0x07
+#define GLOBAL_REPORT_ID 0x08
+#define GLOBAL_REPORT_COUNT 0x09
+#define LOCAL_USAGE 0x00
+#define LOCAL_USAGE_MIN 0x01
+#define LOCAL_USAGE_MAX 0x02
+
+#define INPUT_CONSTANT 0x01
+#define INPUT_VARIABLE 0x02
+
+typedef struct {
+    uint8_t code;
+    uint8_t device;
+    bool pressed;
+    uint16_t time;
+} nkro_event_t;
+
+SPSC_RING(nkro_queue, nkro_event_t, NKRO_MERGE_QUEUE_SIZE)
+
+static nkro_queue_t queue;
+// Set when a change didn't fit in the queue, the matrix then catches up
+// with merged_keys directly
+static bool queue_overflow;
+
+static uint8_t device_keys[NKRO_MERGE_DEVICES][KEY_BYTES];
+static uint8_t merged_keys[KEY_BYTES];
+static uint8_t matrix_keys[KEY_BYTES];
+static nkro_merge_stats_t stats[NKRO_MERGE_DEVICES];
+
+// The report descriptor is parsed as it comes in, one descriptor at a time
+static struct {
+    uint8_t prefix;
+    uint8_t remaining;
+    uint8_t skip;
+    uint8_t index;
+    uint32_t value;
+    uint8_t report;
+    // global items
+    uint16_t usage_page;
+    uint32_t logical_min;
+    uint32_t logical_max;
+    uint8_t report_size;
+    uint8_t report_count;
+    // local items
+    uint32_t usage_min;
+    uint32_t usage_max;
+    bool has_usage;
+} parser;
+
+static uint8_t find_report(nkro_layout_t* layout, uint8_t id) {
+    for (uint8_t i = 0; i < layout->num_reports; i++) {
+        nkro_report_t* report = &layout->reports[i];
+        if (report->id == id && report->interface == layout->interface) {
+            return i;
+        }
+    }
+    if (layout->num_reports == NKRO_MERGE_REPORTS) {
+        return NKRO_MERGE_REPORTS;
+    }
+    nkro_report_t* report = &layout->reports[layout->num_reports];
+    report->id = id;
+    report->interface = layout->interface;
+    report->bits = 0;
+    return layout->num_reports++;
+}
+
+static void add_field(nkro_layout_t* layout, uint8_t flags) {
+    uint32_t usage_min = parser.usage_min;
+    uint32_t usage_max = parser.usage_max;
+    uint16_t page = parser.usage_page;
+    // Usages can carry their own page in the high word
+    if (usage_min > 0xFFFF) {
+        page = usage_min >> 16;
+        usage_min &= 0xFFFF;
+        usage_max &= 0xFFFF;
+    }
+    if (page != USAGE_PAGE_KEYBOARD || (flags & INPUT_CONSTANT)) {
+        return;
+    }
+    bool bitmap = flags & INPUT_VARIABLE;
+    if (!parser.has_usage) {
+        usage_min = bitmap ? 0 : parser.logical_min;
+        usage_max = bitmap ? parser.report_count - 1u : parser.logical_max;
+    }
+    if (usage_min > 0xFF || parser.report_size == 0 || parser.report_size > 16 ||
+        (bitmap && parser.report_size != 1) || parser.logical_min > 0xFF) {
+        return;
+    }
+    if (layout->num_fields == NKRO_MERGE_FIELDS || parser.report == NKRO_MERGE_REPORTS) {
+        return;
+    }
+    nkro_field_t* field = &layout->fields[layout->num_fields++];
+    field->report = parser.report;
+    field->usage_min = usage_min;
+    field->usage_max = usage_max > 0xFF ? 0xFF : usage_max;
+    field->logical_min = parser.logical_min;
+    field->size = parser.report_size;
+    field->count = parser.report_count;
+    field->offset = layout->reports[parser.report].bits;
+}
+
+static void parse_item(nkro_layout_t* layout) {
+    uint8_t tag = ITEM_TAG(parser.prefix);
+    uint32_t value = parser.value;
+
+    switch (ITEM_TYPE(parser.prefix)) {
+    case TYPE_MAIN:
+        if (tag == MAIN_INPUT) {
+            add_field(layout, value);
+            if (parser.report != NKRO_MERGE_REPORTS) {
+                layout->reports[parser.report].bits += parser.report_size * parser.report_count;
+            }
+        }
+        parser.usage_min = 0;
+        parser.usage_max = 0;
+        parser.has_usage = false;
+        break;
+    case TYPE_GLOBAL:
+        switch (tag) {
+        case GLOBAL_USAGE_PAGE:   parser.usage_page = value; break;
+        case GLOBAL_LOGICAL_MIN:  parser.logical_min = value; break;
+        case GLOBAL_LOGICAL_MAX:  parser.logical_max = value; break;
+        case GLOBAL_REPORT_SIZE:  parser.report_size = value; break;
+        case GLOBAL_REPORT_COUNT: parser.report_count = value; break;
+        case GLOBAL_REPORT_ID:
+            if (layout->num_reports == 1 && layout->reports[0].bits == 0 &&
+                layout->reports[0].id == 0 && layout->reports[0].interface == layout->interface) {
+                // Nothing was in the report without an ID
+                layout->num_reports = 0;
+            }
+            parser.report = find_report(layout, value);
+            break;
+        }
+        break;
+    case TYPE_LOCAL:
+        switch (tag) {
+        case LOCAL_USAGE:
+            if (!parser.has_usage) {
+                parser.usage_min = value;
+            }
+            parser.usage_max = value;
+            parser.has_usage = true;
+            break;
+        case LOCAL_USAGE_MIN:
+            parser.usage_min = value;
+            parser.has_usage = true;
+            break;
+        case LOCAL_USAGE_MAX:
+            parser.usage_max = value;
+            parser.has_usage = true;
+            break;
+        }
+        break;
+    }
+}
+
+void nkro_layout_clear(nkro_layout_t* layout) {
+    memset(layout, 0, sizeof(nkro_layout_t));
+}
+
+void nkro_layout_begin(nkro_layout_t* layout, uint8_t interface) {
+    memset(&parser, 0, sizeof(parser));
+    layout->interface = interface;
+    parser.report = find_report(layout, 0);
+}
+
+void nkro_layout_parse(nkro_layout_t* layout, const uint8_t* data, uint16_t len) {
+    for (uint16_t i = 0; i < len; i++) {
+        uint8_t byte = data[i];
+        if (parser.skip) {
+            parser.skip--;
+        } else if (parser.remaining) {
+            parser.value |= (uint32_t)byte << (8 * parser.index++);
+            if (--parser.remaining == 0) {
+                parse_item(layout);
+            }
+        } else if (parser.prefix == ITEM_LONG) {
+            // The size of a long item, then its tag and the data
+            parser.skip = byte + 1;
+            parser.prefix = 0;
+        } else {
+            parser.prefix = byte;
+            parser.value = 0;
+            parser.index = 0;
+            if (byte != ITEM_LONG) {
+                parser.remaining = ITEM_SIZE(byte) == 3 ? 4 : ITEM_SIZE(byte);
+                if (parser.remaining == 0) {
+                    parse_item(layout);
+                }
+            }
+        }
+    }
+}
+
+bool nkro_layout_end(nkro_layout_t* layout) {
+    return layout->num_fields != 0;
+}
+
+void nkro_layout_boot(nkro_layout_t* layout) {
+    nkro_layout_clear(layout);
+    layout->num_reports = 1;
+    layout->reports[0].bits = 64;
+    layout->num_fields = 2;
+    layout->fields[0] = (nkro_field_t) {
+        .usage_min = 0xE0, .usage_max = 0xE7, .size = 1, .count = 8, .offset = 0
+    };
+    layout->fields[1] = (nkro_field_t) {
+        .usage_min = 0x00, .usage_max = 0xFF, .size = 8, .count = 6, .offset = 16
+    };
+}
+
+// Finds which report this is. With report IDs it's the one with the ID in the
+// first byte. Otherwise the interface isn't known, so it's the report that
+// has the same length, or the longest one that fits.
+static const nkro_report_t* find_input_report(const nkro_layout_t* layout, const uint8_t* buf, uint8_t len) {
+    const nkro_report_t* found = NULL;
+    uint8_t found_score = 0;
+    for (uint8_t i = 0; i < layout->num_reports; i++) {
+        const nkro_report_t* report = &layout->reports[i];
+        uint8_t bytes = (report->bits + 7) / 8 + (report->id ? 1 : 0);
+        if (report->bits == 0 || len < bytes || (report->id && buf[0] != report->id)) {
+            continue;
+        }
+        uint8_t score = (report->id ? 4 : 1) + (len == bytes ? 2 : 0);
+        if (score > found_score || (score == found_score && report->bits > found->bits)) {
+            found = report;
+            found_score = score;
+        }
+    }
+    return found;
+}
+
+static uint16_t read_bits(const uint8_t* data, uint16_t offset, uint8_t size) {
+    uint16_t value = 0;
+    for (uint8_t i = 0; i < size; i++, offset++) {
+        if (data[offset / 8] & KEY_BIT(offset)) {
+            value |= 1 << i;
+        }
+    }
+    return value;
+}
+
+static void queue_change(uint8_t device, uint8_t code, bool pressed, uint16_t time) {
+    nkro_event_t event = {code, device, pressed, time};
+    if (queue_overflow || !nkro_queue_push(&queue, &event)) {
+        queue_overflow = true;
+    }
+}
+
+static void set_key(uint8_t device, uint8_t code, bool pressed, uint16_t time) {
+    uint8_t index = code / 8;
+    uint8_t bit = KEY_BIT(code);
+    if (pressed) {
+        device_keys[device][index] |= bit;
+        if (!(merged_keys[index] & bit)) {
+            merged_keys[index] |= bit;
+            queue_change(device, code, true, time);
+        }
+    } else {
+        device_keys[device][index] &= ~bit;
+        for (uint8_t i = 0; i < NKRO_MERGE_DEVICES; i++) {
+            if (device_keys[i][index] & bit) {
+                return;
+            }
+        }
+        merged_keys[index] &= ~bit;
+        queue_change(device, code, false, time);
+    }
+}
+
+static void update_keys(uint8_t device, const uint8_t* keys, uint16_t time) {
+    bool changed = false;
+    for (uint8_t i = 0; i < KEY_BYTES; i++) {
+        uint8_t change = keys[i] ^ device_keys[device][i];
+        for (uint8_t j = 0; change; j++, change >>= 1) {
+            if (change & 1) {
+                set_key(device, i * 8 + j, keys[i] & (1 << j), time);
+                changed = true;
+            }
+        }
+    }
+    if (changed) {
+        stats[device].reports++;
+    }
+}
+
+void nkro_merge_report(uint8_t device, const nkro_layout_t* layout, const uint8_t* buf, uint8_t len, uint16_t time) {
+    if (device >= NKRO_MERGE_DEVICES) {
+        return;
+    }
+    const nkro_report_t* report = find_input_report(layout, buf, len);
+    if (!report) {
+        return;
+    }
+    uint8_t report_index = report - layout->reports;
+    const uint8_t* data = report->id ? buf + 1 : buf;
+
+    // Only the keys this report covers are replaced, the others can come in
+    // other reports
+    uint8_t keys[KEY_BYTES];
+    memcpy(keys, device_keys[device], KEY_BYTES);
+    for (uint8_t i = 0; i < layout->num_fields; i++) {
+        const nkro_field_t* field = &layout->fields[i];
+        if (field->report != report_index) {
+            continue;
+        }
+        uint16_t last = field->size == 1 ? field->usage_min + field->count - 1 : field->usage_max;
+        if (last > 0xFF) {
+            last = 0xFF;
+        }
+        for (uint16_t code = field->usage_min; code <= last; code++) {
+            keys[code / 8] &= ~KEY_BIT(code);
+        }
+    }
+    for (uint8_t i = 0; i < layout->num_fields; i++) {
+        const nkro_field_t* field = &layout->fields[i];
+        if (field->report != report_index) {
+            continue;
+        }
+        for (uint8_t j = 0; j < field->count; j++) {
+            uint16_t value = read_bits(data, field->offset + j * field->size, field->size);
+            uint16_t code;
+            if (field->size == 1) {
+                if (!value) {
+                    continue;
+                }
+                code = field->usage_min + j;
+                if (code > 0xFF || code <= USAGE_ERROR_UNDEFINED) {
+                    continue;
+                }
+            } else {
+                if (value < field->logical_min) {
+                    continue;
+                }
+                code = field->usage_min + value - field->logical_min;
+                if (code > field->usage_max || code == 0) {
+                    continue;
+                }
+                if (code >= USAGE_ERROR_ROLLOVER && code <= USAGE_ERROR_UNDEFINED) {
+                    // The keyboard doesn't know which keys are held, keep the old ones
+                    return;
+                }
+            }
+            keys[code / 8] |= KEY_BIT(code);
+        }
+    }
+    update_keys(device, keys, time);
+}
+
+void nkro_merge_release(uint8_t device, uint16_t time) {
+    if (device >= NKRO_MERGE_DEVICES) {
+        return;
+    }
+    uint8_t keys[KEY_BYTES] = {0};
+    update_keys(device, keys, time);
+}
+
+bool nkro_merge_apply(uint16_t now) {
+    nkro_event_t event;
+    if (nkro_queue_pop(&queue, &event)) {
+        if (event.pressed) {
+            matrix_keys[event.code / 8] |= KEY_BIT(event.code);
+        } else {
+            matrix_keys[event.code / 8] &= ~KEY_BIT(event.code);
+        }
+        nkro_merge_stats_t* device_stats = &stats[event.device];
+        device_stats->latency_last = now - event.time;
+        if (device_stats->latency_last > device_stats->latency_max) {
+            device_stats->latency_max = device_stats->latency_last;
+        }
+        return true;
+    }
+    if (queue_overflow) {
+        // The order is lost, so take the differences one key at a time
+        for (uint8_t i = 0; i < KEY_BYTES; i++) {
+            uint8_t change = matrix_keys[i] ^ merged_keys[i];
+            if (change) {
+                matrix_keys[i] ^= change & -change;
+                return true;
+            }
+        }
+        queue_overflow = false;
+    }
+    return false;
+}
+
+bool nkro_merge_is_on(uint8_t code) {
+    return matrix_keys[code / 8] & KEY_BIT(code);
+}
+
+uint16_t nkro_merge_get_row(uint8_t row) {
+    return matrix_keys[row * 2] | (uint16_t)matrix_keys[row * 2 + 1] << 8;
+}
+
+uint8_t nkro_merge_key_count(void) {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < KEY_BYTES; i++) {
+        count += bitpop(matrix_keys[i]);
+    }
+    return count;
+}
+
+const nkro_merge_stats_t* nkro_merge_stats(uint8_t device) {
+    return &stats[device];
+}
+
+void nkro_merge_clear(void) {
+    nkro_queue_clear(&queue);
+    queue_overflow = false;
+    memset(device_keys, 0, sizeof(device_keys));
+    memset(merged_keys, 0, sizeof(merged_keys));
+    memset(matrix_keys, 0, sizeof(matrix_keys));
+    memset(stats, 0, sizeof(stats));
+}
@@ -0,0 +1,121 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NKRO_MERGE_H
+#define NKRO_MERGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Merges the keys of several USB keyboards into one 256 key state
+ *
+ * Each keyboard is described by an nkro_layout_t, read from its report
+ * descriptor, so that both boot protocol and NKRO bitmap reports can be
+ * parsed. Every report updates a bitmap of the keys held on that keyboard,
+ * replacing the keys that its fields cover, so a keyboard that reports the
+ * same keys on two interfaces has the keys of its last report.
+ *
+ * A key changes in the merged state when it's the first keyboard to press it,
+ * or the last to release it. Those changes are queued in the order the
+ * reports came in, with the time of the report, and nkro_merge_apply takes
+ * them one at a time into the state the matrix sees.
+ *
+ * Keys are HID usages of the keyboard page, which are also the keycodes, so
+ * the matrix is 16x16 with the row in the high nibble of the usage.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef NKRO_MERGE_DEVICES
+#define NKRO_MERGE_DEVICES 4
+#endif
+
+// The keyboard page inputs of one keyboard that can be parsed
+#ifndef NKRO_MERGE_FIELDS
+#define NKRO_MERGE_FIELDS 4
+#endif
+
+// The different reports of one keyboard, for the report IDs and interfaces
+#ifndef NKRO_MERGE_REPORTS
+#define NKRO_MERGE_REPORTS 4
+#endif
+
+// Key changes waiting for the matrix, a power of two
+#ifndef NKRO_MERGE_QUEUE_SIZE
+#define NKRO_MERGE_QUEUE_SIZE 16
+#endif
+
+typedef struct {
+    uint8_t report;       // index in nkro_layout_t.reports
+    uint8_t usage_min;
+    uint8_t usage_max;
+    uint8_t logical_min;
+    uint8_t size;         // bits per item, 1 for a bitmap
+    uint8_t count;
+    uint16_t offset;      // in bits, after the report ID
+} nkro_field_t;
+
+typedef struct {
+    uint8_t id;           // 0 when the report doesn't start with an ID
+    uint8_t interface;
+    uint16_t bits;        // size of the report, not counting the ID
+} nkro_report_t;
+
+typedef struct {
+    nkro_field_t fields[NKRO_MERGE_FIELDS];
+    nkro_report_t reports[NKRO_MERGE_REPORTS];
+    uint8_t num_fields;
+    uint8_t num_reports;
+    uint8_t interface;
+} nkro_layout_t;
+
+typedef struct {
+    uint16_t reports;     // reports that changed keys
+    uint16_t latency_last;
+    uint16_t latency_max; // from the report to the matrix, in milliseconds
+} nkro_merge_stats_t;
+
+// The layout of a boot protocol keyboard report
+void nkro_layout_boot(nkro_layout_t* layout);
+
+// Reads report descriptors into the layout. nkro_layout_begin is called
+// before each interface's descriptor, which can then come in any number of
+// parts. Returns false when the descriptors had no keys.
+void nkro_layout_clear(nkro_layout_t* layout);
+void nkro_layout_begin(nkro_layout_t* layout, uint8_t interface);
+void nkro_layout_parse(nkro_layout_t* layout, const uint8_t* data, uint16_t len);
+bool nkro_layout_end(nkro_layout_t* layout);
+
+// Takes an input report of a keyboard, received at time
+void nkro_merge_report(uint8_t device, const nkro_layout_t* layout, const uint8_t* buf, uint8_t len, uint16_t time);
+// Releases all keys of a keyboard, when it's unplugged
+void nkro_merge_release(uint8_t device, uint16_t time);
+
+// Takes the oldest change into the matrix, and returns false if there was none
+bool nkro_merge_apply(uint16_t now);
+bool nkro_merge_is_on(uint8_t code);
+uint16_t nkro_merge_get_row(uint8_t row);
+uint8_t nkro_merge_key_count(void);
+const nkro_merge_stats_t* nkro_merge_stats(uint8_t device);
+void nkro_merge_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
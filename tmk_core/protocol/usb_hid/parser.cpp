@@ -2,6 +2,7 @@
 #include "usb_hid.h"
 
 #include "debug.h"
+#include "timer.h"
 
 
 void KBDReportParser::Parse(HID *hid, bool is_rpt_id, uint8_t len, uint8_t *buf)
@@ -15,3 +16,51 @@ void KBDReportParser::Parse(HID *hid, bool is_rpt_id, uint8_t len, uint8_t *buf)
     }
     dprint("\r\n");
 }
+
+
+class ReportDescParser : public USBReadParser
+{
+public:
+    ReportDescParser(nkro_layout_t *layout) : layout(layout) {}
+    void Parse(const uint16_t len, const uint8_t *pbuf, const uint16_t &offset) {
+        nkro_layout_parse(layout, pbuf, len);
+    }
+private:
+    nkro_layout_t *layout;
+};
+
+uint8_t NKROKeyboard::OnInitSuccessful()
+{
+    ReportDescParser parser(&layout);
+    nkro_layout_clear(&layout);
+    for (uint8_t i = 0; i < maxHidInterfaces; i++) {
+        if (hidInterfaces[i].epIndex[epInterruptInIndex] == 0) {
+            continue;
+        }
+        nkro_layout_begin(&layout, hidInterfaces[i].bmInterface);
+        GetReportDescr(hidInterfaces[i].bmInterface, &parser);
+    }
+    if (!nkro_layout_end(&layout)) {
+        dprintf("device %d: no keys in the report descriptor, using boot reports\n", device);
+        nkro_layout_boot(&layout);
+    }
+    dprintf("device %d: %d reports, %d key fields\n", device, layout.num_reports, layout.num_fields);
+    return 0;
+}
+
+uint8_t NKROKeyboard::Release()
+{
+    nkro_merge_release(device, timer_read());
+    return HIDUniversal::Release();
+}
+
+void NKROKeyboard::ParseHIDData(HID *hid, bool is_rpt_id, uint8_t len, uint8_t *buf)
+{
+    nkro_merge_report(device, &layout, buf, len, timer_read());
+
+    dprintf("input %d:", device);
+    for (uint8_t i = 0; i < len; i++) {
+        dprintf(" %02X", buf[i]);
+    }
+    dprint("\r\n");
+}
@@ -2,7 +2,9 @@
 #define PARSER_H
 
 #include "hid.h"
+#include "hiduniversal.h"
 #include "report.h"
+#include "nkro_merge.h"
 
 class KBDReportParser : public HIDReportParser
 {
@@ -12,4 +14,19 @@ public:
     virtual void Parse(HID *hid, bool is_rpt_id, uint8_t len, uint8_t *buf);
 };
 
+// A keyboard in report protocol, which reads its report descriptors to parse
+// both boot and NKRO reports, and passes the keys on to nkro_merge
+class NKROKeyboard : public HIDUniversal
+{
+public:
+    NKROKeyboard(USB *usb, uint8_t device) : HIDUniversal(usb), device(device) {}
+    uint8_t Release();
+    nkro_layout_t layout;
+protected:
+    uint8_t OnInitSuccessful();
+    void ParseHIDData(HID *hid, bool is_rpt_id, uint8_t len, uint8_t *buf);
+private:
+    uint8_t device;
+};
+
 #endif
@@ -0,0 +1,238 @@
+/* Copyright 2026 agent <agent@local>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "gtest/gtest.h"
+#include <utility>
+#include <vector>
+extern "C" {
+    #include "nkro_merge.h"
+}
+
+typedef std::pair<uint8_t, bool> change_t;
+typedef std::vector<change_t> changes_t;
+
+// A boot keyboard, with the LED output in the middle
+static const uint8_t boot_descriptor[] = {
+    0x05, 0x01, 0x09, 0x06, 0xA1, 0x01,
+    0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x08, 0x81, 0x02,
+    0x95, 0x01, 0x75, 0x08, 0x81, 0x01,
+    0x95, 0x05, 0x75, 0x01, 0x05, 0x08, 0x19, 0x01, 0x29, 0x05, 0x91, 0x02,
+    0x95, 0x01, 0x75, 0x03, 0x91, 0x01,
+    0x95, 0x06, 0x75, 0x08, 0x15, 0x00, 0x25, 0x65, 0x05, 0x07, 0x19, 0x00, 0x29, 0x65, 0x81, 0x00,
+    0xC0,
+};
+
+// A mouse with report ID 1, and a keyboard bitmap with report ID 2
+static const uint8_t nkro_descriptor[] = {
+    0x05, 0x01, 0x09, 0x02, 0xA1, 0x01, 0x85, 0x01,
+    0x05, 0x09, 0x19, 0x01, 0x29, 0x03, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x03, 0x81, 0x02,
+    0x75, 0x05, 0x95, 0x01, 0x81, 0x01,
+    0x05, 0x01, 0x09, 0x30, 0x09, 0x31, 0x15, 0x81, 0x25, 0x7F, 0x75, 0x08, 0x95, 0x02, 0x81, 0x06,
+    0xC0,
+    0x05, 0x01, 0x09, 0x06, 0xA1, 0x01, 0x85, 0x02,
+    0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x08, 0x81, 0x02,
+    0x19, 0x00, 0x29, 0x77, 0x95, 0x78, 0x81, 0x02,
+    0xC0,
+};
+
+class NkroMerge : public testing::Test {
+public:
+    NkroMerge() {
+        nkro_merge_clear();
+        nkro_layout_boot(&boot);
+        nkro_layout_clear(&nkro);
+        nkro_layout_begin(&nkro, 0);
+        nkro_layout_parse(&nkro, boot_descriptor, sizeof(boot_descriptor));
+        nkro_layout_begin(&nkro, 1);
+        // The descriptor comes in parts, which can split items
+        nkro_layout_parse(&nkro, nkro_descriptor, 11);
+        nkro_layout_parse(&nkro, nkro_descriptor + 11, sizeof(nkro_descriptor) - 11);
+    }
+
+    // Takes all the changes into the matrix, and returns them in order
+    changes_t apply(uint16_t now = 0) {
+        changes_t changes;
+        for (;;) {
+            bool before[256];
+            for (int i = 0; i < 256; i++) {
+                before[i] = nkro_merge_is_on(i);
+            }
+            if (!nkro_merge_apply(now)) {
+                break;
+            }
+            for (int i = 0; i < 256; i++) {
+                if (nkro_merge_is_on(i) != before[i]) {
+                    changes.push_back(change_t(i, !before[i]));
+                }
+            }
+        }
+        return changes;
+    }
+
+    void boot_report(uint8_t device, uint8_t mods, std::vector<uint8_t> keys, uint16_t time = 0) {
+        uint8_t report[8] = {mods};
+        for (size_t i = 0; i < keys.size(); i++) {
+            report[2 + i] = keys[i];
+        }
+        nkro_merge_report(device, &boot, report, sizeof(report), time);
+    }
+
+    void nkro_report(uint8_t device, uint8_t mods, std::vector<uint8_t> keys, uint16_t time = 0) {
+        uint8_t report[17] = {2, mods};
+        for (uint8_t key : keys) {
+            report[2 + key / 8] |= 1 << (key % 8);
+        }
+        nkro_merge_report(device, &nkro, report, sizeof(report), time);
+    }
+
+    nkro_layout_t boot;
+    nkro_layout_t nkro;
+};
+
+TEST_F(NkroMerge, ParsesTheReportDescriptors) {
+    EXPECT_TRUE(nkro_layout_end(&nkro));
+    ASSERT_EQ(nkro.num_fields, 4);
+    // The boot report keeps its layout, the LED output doesn't count
+    EXPECT_EQ(nkro.fields[1].offset, 16);
+    EXPECT_EQ(nkro.fields[1].size, 8);
+    EXPECT_EQ(nkro.fields[1].count, 6);
+    EXPECT_EQ(nkro.fields[1].usage_max, 0x65);
+    EXPECT_EQ(nkro.reports[nkro.fields[0].report].bits, 64);
+    // The bitmap is after the modifiers of report 2
+    const nkro_report_t& report = nkro.reports[nkro.fields[3].report];
+    EXPECT_EQ(report.id, 2);
+    EXPECT_EQ(report.interface, 1);
+    EXPECT_EQ(report.bits, 128);
+    EXPECT_EQ(nkro.fields[3].offset, 8);
+    EXPECT_EQ(nkro.fields[3].size, 1);
+    EXPECT_EQ(nkro.fields[3].count, 120);
+}
+
+TEST_F(NkroMerge, DescriptorWithoutKeys) {
+    nkro_layout_t layout;
+    nkro_layout_clear(&layout);
+    nkro_layout_begin(&layout, 0);
+    nkro_layout_parse(&layout, nkro_descriptor, 49);
+    EXPECT_FALSE(nkro_layout_end(&layout));
+}
+
+TEST_F(NkroMerge, BootReports) {
+    boot_report(0, 0x02, {0x04, 0x05});
+    EXPECT_EQ(apply(), changes_t({{0x04, true}, {0x05, true}, {0xE1, true}}));
+    EXPECT_EQ(nkro_merge_key_count(), 3);
+    EXPECT_EQ(nkro_merge_get_row(0), 0x0030);
+    EXPECT_EQ(nkro_merge_get_row(0xE), 0x0002);
+    boot_report(0, 0, {0x05});
+    EXPECT_EQ(apply(), changes_t({{0x04, false}, {0xE1, false}}));
+    boot_report(0, 0, {});
+    EXPECT_EQ(apply(), changes_t({{0x05, false}}));
+    EXPECT_EQ(nkro_merge_key_count(), 0);
+}
+
+TEST_F(NkroMerge, NkroReportsHaveNoRolloverLimit) {
+    std::vector<uint8_t> keys;
+    for (uint8_t key = 0x04; key < 0x04 + 12; key++) {
+        keys.push_back(key);
+    }
+    nkro_report(0, 0x01, keys);
+    EXPECT_EQ(apply().size(), 13u);
+    EXPECT_EQ(nkro_merge_key_count(), 13);
+    EXPECT_TRUE(nkro_merge_is_on(0x0F));
+    EXPECT_TRUE(nkro_merge_is_on(0xE0));
+}
+
+TEST_F(NkroMerge, BootAndNkroReportsOfTheSameKeyboard) {
+    // Both interfaces cover the same keys, so the last report has them all
+    uint8_t boot[8] = {0, 0, 0x04};
+    nkro_merge_report(0, &nkro, boot, sizeof(boot), 0);
+    nkro_report(0, 0, {0x30});
+    EXPECT_EQ(apply(), changes_t({{0x04, true}, {0x04, false}, {0x30, true}}));
+    nkro_merge_report(0, &nkro, boot, sizeof(boot), 0);
+    EXPECT_EQ(apply(), changes_t({{0x04, true}, {0x30, false}}));
+}
+
+TEST_F(NkroMerge, ReportsFromOtherPagesAreIgnored) {
+    uint8_t mouse[4] = {1, 0x07, 0x10, 0x10};
+    nkro_merge_report(0, &nkro, mouse, sizeof(mouse), 0);
+    EXPECT_EQ(apply(), changes_t());
+}
+
+TEST_F(NkroMerge, KeysAreMergedBetweenKeyboards) {
+    boot_report(0, 0, {0x04});
+    nkro_report(1, 0, {0x04, 0x05});
+    EXPECT_EQ(apply(), changes_t({{0x04, true}, {0x05, true}}));
+    boot_report(0, 0, {});
+    EXPECT_EQ(apply(), changes_t());
+    nkro_report(1, 0, {0x05});
+    EXPECT_EQ(apply(), changes_t({{0x04, false}}));
+}
+
+TEST_F(NkroMerge, ChangesComeInTheOrderOfTheReports) {
+    boot_report(1, 0, {0x10});
+    boot_report(0, 0, {0x05});
+    boot_report(1, 0, {});
+    boot_report(2, 0, {0x04});
+    EXPECT_EQ(apply(), changes_t({{0x10, true}, {0x05, true}, {0x10, false}, {0x04, true}}));
+}
+
+TEST_F(NkroMerge, RolloverErrorKeepsTheKeys) {
+    boot_report(0, 0, {0x04, 0x05});
+    apply();
+    boot_report(0, 0, {0x01, 0x01, 0x01, 0x01, 0x01, 0x01});
+    EXPECT_EQ(apply(), changes_t());
+    EXPECT_EQ(nkro_merge_key_count(), 2);
+}
+
+TEST_F(NkroMerge, UnpluggedKeyboardReleasesItsKeys) {
+    boot_report(0, 0, {0x04});
+    boot_report(1, 0, {0x04, 0x05});
+    apply();
+    nkro_merge_release(1, 0);
+    EXPECT_EQ(apply(), changes_t({{0x05, false}}));
+    EXPECT_TRUE(nkro_merge_is_on(0x04));
+}
+
+TEST_F(NkroMerge, CatchesUpWhenTheQueueOverflows) {
+    std::vector<uint8_t> keys;
+    for (uint8_t key = 0x04; key < 0x04 + NKRO_MERGE_QUEUE_SIZE + 10; key++) {
+        keys.push_back(key);
+    }
+    nkro_report(0, 0, keys);
+    apply();
+    EXPECT_EQ(nkro_merge_key_count(), keys.size());
+    nkro_report(0, 0, {});
+    apply();
+    EXPECT_EQ(nkro_merge_key_count(), 0);
+    // And it goes back to the queue
+    boot_report(0, 0, {0x20});
+    boot_report(0, 0, {0x21});
+    EXPECT_EQ(apply(), changes_t({{0x20, true}, {0x20, false}, {0x21, true}}));
+}
+
+TEST_F(NkroMerge, MeasuresTheLatencyPerKeyboard) {
+    boot_report(0, 0, {0x04}, 100);
+    boot_report(1, 0, {0x05}, 103);
+    nkro_merge_apply(105);
+    nkro_merge_apply(110);
+    boot_report(0, 0, {}, 120);
+    nkro_merge_apply(121);
+    EXPECT_EQ(nkro_merge_stats(0)->reports, 2);
+    EXPECT_EQ(nkro_merge_stats(0)->latency_last, 1);
+    EXPECT_EQ(nkro_merge_stats(0)->latency_max, 5);
+    EXPECT_EQ(nkro_merge_stats(1)->latency_last, 7);
+    EXPECT_EQ(nkro_merge_stats(1)->latency_max, 7);
+}
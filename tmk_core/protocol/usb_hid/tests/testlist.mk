@@ -0,0 +1,2 @@
+TEST_LIST +=\
+	nkro_merge
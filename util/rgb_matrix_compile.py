@@ -0,0 +1,225 @@
+#!/usr/bin/env python
+# Copyright 2026 agent <agent@local>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""Compiles RGB matrix effects into programs for quantum/rgb_matrix_program.c
+
+    util/rgb_matrix_compile.py effects.txt > keymaps/mine/effects.h
+
+Each effect is a list of steps between "effect <name>" and "end". A step is
+either one of the instructions of the interpreter, or one of the shorthands
+below, which expand into several of them. Everything after a # is a comment.
+
+    gradient x|y <amount>   hue changes by amount/255 of the position
+    rotate [<amount>]       hue goes around with the time
+    breathe                 brightness goes up and down with the time
+    ripple <speed> <width>  a ring that grows from the last key that was hit
+    decay <rate>            keys light up when hit, and fade out at rate per tick
+
+    load|add|adds|subs|diff|scale|mul|min|max <source>|<0-255>
+    store h|s|v
+    inv
+    wave
+
+The sources are x, y, time, hue, sat, val, age, dist, last_age, h, s and v.
+"""
+
+from __future__ import print_function
+
+import argparse
+import re
+import sys
+
+# These match quantum/rgb_matrix_program.h
+OPS = {
+    'load': 0x10,
+    'add': 0x20,
+    'adds': 0x30,
+    'subs': 0x40,
+    'diff': 0x50,
+    'scale': 0x60,
+    'mul': 0x70,
+    'min': 0x80,
+    'max': 0x90,
+    'store': 0xA0,
+    'inv': 0xB0,
+    'wave': 0xC0,
+}
+END = 0x00
+
+SOURCES = {
+    'x': 1,
+    'y': 2,
+    'time': 3,
+    'hue': 4,
+    'sat': 5,
+    'val': 6,
+    'age': 7,
+    'dist': 8,
+    'last_age': 9,
+    'h': 10,
+    's': 11,
+    'v': 12,
+}
+CONST = 0
+
+# The mode is 6 bits in rgb_config_t, and the built-in effects come first
+MAX_EFFECTS = 45
+
+UNARY = ('inv', 'wave')
+REGISTERS = ('h', 's', 'v')
+
+SHORTHANDS = {
+    'gradient': lambda axis, amount: [
+        ('load', axis), ('scale', amount), ('add', 'h'), ('store', 'h')],
+    'rotate': lambda amount='255': [
+        ('load', 'time'), ('scale', amount), ('add', 'h'), ('store', 'h')],
+    'breathe': lambda: [
+        ('load', 'time'), ('wave',), ('scale', 'v'), ('store', 'v')],
+    'ripple': lambda speed, width: [
+        ('load', 'last_age'), ('mul', speed), ('diff', 'dist'), ('mul', width),
+        ('inv',), ('scale', 'v'), ('store', 'v')],
+    'decay': lambda rate: [
+        ('load', 'age'), ('mul', rate), ('inv',), ('scale', 'v'), ('store', 'v')],
+}
+
+
+class CompileError(Exception):
+    pass
+
+
+def assemble(op, args):
+    """Returns the bytes of one instruction."""
+    if op not in OPS:
+        raise CompileError('unknown step "%s"' % op)
+    if op in UNARY:
+        if args:
+            raise CompileError('"%s" takes no operand' % op)
+        return [OPS[op]]
+    if len(args) != 1:
+        raise CompileError('"%s" takes one operand' % op)
+    operand = args[0]
+    if op == 'store':
+        if operand not in REGISTERS:
+            raise CompileError('"store" needs one of %s' % ', '.join(REGISTERS))
+        return [OPS[op] | SOURCES[operand]]
+    if operand in SOURCES:
+        return [OPS[op] | SOURCES[operand]]
+    try:
+        value = int(operand, 0)
+    except ValueError:
+        raise CompileError('unknown operand "%s"' % operand)
+    if not 0 <= value <= 255:
+        raise CompileError('%d is not 0-255' % value)
+    return [OPS[op] | CONST, value]
+
+
+def compile_step(words):
+    """Returns the bytes of one step, with the shorthands expanded."""
+    name, args = words[0], words[1:]
+    if name in SHORTHANDS:
+        try:
+            instructions = SHORTHANDS[name](*args)
+        except TypeError:
+            raise CompileError('wrong number of operands for "%s"' % name)
+        if name == 'gradient' and args[0] not in ('x', 'y'):
+            raise CompileError('"gradient" goes over x or y')
+        code = []
+        for instruction in instructions:
+            code += assemble(instruction[0], list(instruction[1:]))
+        return code
+    return assemble(name, args)
+
+
+def parse(lines):
+    """Returns a list of (name, bytes) for the effects."""
+    effects = []
+    current = None
+    for number, line in enumerate(lines, 1):
+        words = line.split('#', 1)[0].split()
+        if not words:
+            continue
+        try:
+            if words[0] == 'effect':
+                if current is not None:
+                    raise CompileError('"effect" before the "end" of %s' % current[0])
+                if len(words) != 2 or not re.match(r'^[A-Za-z_][A-Za-z0-9_]*$', words[1]):
+                    raise CompileError('"effect" needs a name that is a C identifier')
+                if words[1] in (name for name, _ in effects):
+                    raise CompileError('effect %s is already defined' % words[1])
+                current = (words[1], [])
+            elif words[0] == 'end':
+                if current is None:
+                    raise CompileError('"end" without "effect"')
+                current[1].append(END)
+                effects.append(current)
+                current = None
+            elif current is None:
+                raise CompileError('"%s" outside of an effect' % words[0])
+            else:
+                current[1].extend(compile_step(words))
+        except CompileError as e:
+            raise CompileError('line %d: %s' % (number, e))
+    if current is not None:
+        raise CompileError('effect %s has no "end"' % current[0])
+    if not effects:
+        raise CompileError('no effects')
+    if len(effects) > MAX_EFFECTS:
+        raise CompileError('%d effects, but there can be at most %d' % (len(effects), MAX_EFFECTS))
+    return effects
+
+
+def write_header(effects, source, out):
+    out.write('// Generated by util/rgb_matrix_compile.py from %s, edit that instead.\n' % source)
+    out.write('// Include it in one file, with RGB_MATRIX_PROGRAMS defined in config.h.\n\n')
+    out.write('#include "progmem.h"\n\n')
+    for name, code in effects:
+        out.write('// %s, %d bytes\n' % (name, len(code)))
+        out.write('static const uint8_t PROGMEM rgb_program_%s[] = {\n' % name)
+        for i in range(0, len(code), 12):
+            out.write('    %s,\n' % ', '.join('0x%02X' % b for b in code[i:i + 12]))
+        out.write('};\n\n')
+    out.write('// The modes after RGB_MATRIX_EFFECT_MAX, in this order\n')
+    out.write('const uint8_t * const rgb_matrix_programs[] PROGMEM = {\n')
+    for name, _ in effects:
+        out.write('    rgb_program_%s,\n' % name)
+    out.write('};\n\n')
+    out.write('const uint8_t rgb_matrix_program_count = %d;\n' % len(effects))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('input', help='the effect descriptions')
+    parser.add_argument('-o', '--output', help='the header to write, instead of stdout')
+    args = parser.parse_args()
+
+    with open(args.input) as f:
+        lines = f.readlines()
+    try:
+        effects = parse(lines)
+    except CompileError as e:
+        print('%s: %s' % (args.input, e), file=sys.stderr)
+        return 1
+
+    if args.output:
+        with open(args.output, 'w') as out:
+            write_header(effects, args.input, out)
+    else:
+        write_header(effects, args.input, sys.stdout)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())